@@ -0,0 +1,86 @@
+#include "bvh.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace simple_renderer {
+
+void Bvh::Build(const std::vector<Vector3f> &item_min,
+                const std::vector<Vector3f> &item_max) {
+  nodes_.clear();
+  item_indices_.clear();
+  const size_t count = std::min(item_min.size(), item_max.size());
+  if (count == 0) {
+    return;
+  }
+
+  std::vector<Vector3f> centers(count);
+  for (size_t i = 0; i < count; ++i) {
+    centers[i] = (item_min[i] + item_max[i]) * 0.5f;
+  }
+  item_indices_.resize(count);
+  std::iota(item_indices_.begin(), item_indices_.end(), 0u);
+
+  // 中位数划分的二叉树节点数不超过 2n - 1
+  nodes_.reserve(2 * count - 1);
+  BvhNode root;
+  root.first = 0;
+  root.count = static_cast<uint32_t>(count);
+  nodes_.push_back(root);
+  Subdivide(0, centers, item_min, item_max);
+}
+
+void Bvh::Subdivide(uint32_t node_index, const std::vector<Vector3f> &centers,
+                    const std::vector<Vector3f> &item_min,
+                    const std::vector<Vector3f> &item_max) {
+  const uint32_t first = nodes_[node_index].first;
+  const uint32_t count = nodes_[node_index].count;
+
+  // 合并节点内所有图元的包围盒，同时统计中心点范围
+  Vector3f bmin = item_min[item_indices_[first]];
+  Vector3f bmax = item_max[item_indices_[first]];
+  Vector3f cmin = centers[item_indices_[first]];
+  Vector3f cmax = cmin;
+  for (uint32_t i = first + 1; i < first + count; ++i) {
+    const uint32_t item = item_indices_[i];
+    bmin = glm::min(bmin, item_min[item]);
+    bmax = glm::max(bmax, item_max[item]);
+    cmin = glm::min(cmin, centers[item]);
+    cmax = glm::max(cmax, centers[item]);
+  }
+  nodes_[node_index].bounds_min = bmin;
+  nodes_[node_index].bounds_max = bmax;
+
+  if (count <= kMaxLeafItems) {
+    return;
+  }
+
+  // 按中心点跨度最大的轴取中位数划分
+  const Vector3f extent = cmax - cmin;
+  int axis = 0;
+  if (extent.y > extent[axis]) axis = 1;
+  if (extent.z > extent[axis]) axis = 2;
+  const uint32_t mid = first + count / 2;
+  std::nth_element(item_indices_.begin() + first, item_indices_.begin() + mid,
+                   item_indices_.begin() + first + count,
+                   [&centers, axis](uint32_t a, uint32_t b) {
+                     return centers[a][axis] < centers[b][axis];
+                   });
+
+  const auto left = static_cast<uint32_t>(nodes_.size());
+  BvhNode left_node;
+  left_node.first = first;
+  left_node.count = mid - first;
+  BvhNode right_node;
+  right_node.first = mid;
+  right_node.count = first + count - mid;
+  nodes_.push_back(left_node);
+  nodes_.push_back(right_node);
+
+  nodes_[node_index].first = left;
+  nodes_[node_index].count = 0;
+  Subdivide(left, centers, item_min, item_max);
+  Subdivide(left + 1, centers, item_min, item_max);
+}
+
+}  // namespace simple_renderer
@@ -0,0 +1,64 @@
+#include "clipping.hpp"
+
+namespace simple_renderer {
+
+namespace {
+
+/// 裁剪平面的有符号距离，内侧 >= 0
+using PlaneDistance = float (*)(const Vector4f&);
+
+constexpr PlaneDistance kClipPlanes[] = {
+    [](const Vector4f& p) { return p.z + p.w; },               // 近平面
+    [](const Vector4f& p) { return kGuardBand * p.w + p.x; },  // 左
+    [](const Vector4f& p) { return kGuardBand * p.w - p.x; },  // 右
+    [](const Vector4f& p) { return kGuardBand * p.w + p.y; },  // 下
+    [](const Vector4f& p) { return kGuardBand * p.w - p.y; },  // 上
+};
+
+/// 对单个平面裁剪 in，结果写入 out
+void ClipAgainstPlane(const ClipPolygon& in, PlaneDistance distance,
+                      ClipPolygon& out) {
+  out.count = 0;
+  if (in.count == 0) {
+    return;
+  }
+  const ClipVertex* previous = &in.vertices[in.count - 1];
+  float previous_distance = distance(previous->position);
+  for (size_t i = 0; i < in.count; ++i) {
+    const ClipVertex& current = in.vertices[i];
+    const float current_distance = distance(current.position);
+    // 边跨越平面时插入交点
+    if ((previous_distance >= 0.0f) != (current_distance >= 0.0f)) {
+      const float t =
+          previous_distance / (previous_distance - current_distance);
+      out.vertices[out.count++] = {
+          glm::mix(previous->position, current.position, t),
+          glm::mix(previous->barycentric, current.barycentric, t)};
+    }
+    if (current_distance >= 0.0f) {
+      out.vertices[out.count++] = current;
+    }
+    previous = &current;
+    previous_distance = current_distance;
+  }
+}
+
+}  // namespace
+
+ClipPolygon ClipTriangle(const Vector4f& p0, const Vector4f& p1,
+                         const Vector4f& p2) {
+  ClipPolygon polygons[2];
+  polygons[0].vertices[0] = {p0, Vector3f(1.0f, 0.0f, 0.0f)};
+  polygons[0].vertices[1] = {p1, Vector3f(0.0f, 1.0f, 0.0f)};
+  polygons[0].vertices[2] = {p2, Vector3f(0.0f, 0.0f, 1.0f)};
+  polygons[0].count = 3;
+
+  size_t current = 0;
+  for (const PlaneDistance plane : kClipPlanes) {
+    ClipAgainstPlane(polygons[current], plane, polygons[current ^ 1]);
+    current ^= 1;
+  }
+  return polygons[current];
+}
+
+}  // namespace simple_renderer
@@ -0,0 +1,136 @@
+#include "depth_pyramid.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+#include "config.h"
+
+namespace simple_renderer {
+
+void DepthPyramid::Build(const float *depth, size_t width, size_t height) {
+  levels_.clear();
+  if (depth == nullptr || width == 0 || height == 0) {
+    return;
+  }
+
+  // 第 0 层：原分辨率，min/max 相同
+  Level base;
+  base.width = width;
+  base.height = height;
+  base.min_depth.assign(depth, depth + width * height);
+  base.max_depth = base.min_depth;
+  levels_.push_back(std::move(base));
+
+  // 逐层 2x2 归约，奇数尺寸时边缘纹素只覆盖 1 列/行
+  while (levels_.back().width > 1 || levels_.back().height > 1) {
+    const Level &src = levels_.back();
+    Level dst;
+    dst.width = (src.width + 1) / 2;
+    dst.height = (src.height + 1) / 2;
+    dst.min_depth.resize(dst.width * dst.height);
+    dst.max_depth.resize(dst.width * dst.height);
+
+#pragma omp parallel for num_threads(kNProc) schedule(static)
+    for (size_t y = 0; y < dst.height; ++y) {
+      const size_t sy0 = y * 2;
+      const size_t sy1 = std::min(sy0 + 1, src.height - 1);
+      for (size_t x = 0; x < dst.width; ++x) {
+        const size_t sx0 = x * 2;
+        const size_t sx1 = std::min(sx0 + 1, src.width - 1);
+        const size_t i00 = sx0 + sy0 * src.width;
+        const size_t i10 = sx1 + sy0 * src.width;
+        const size_t i01 = sx0 + sy1 * src.width;
+        const size_t i11 = sx1 + sy1 * src.width;
+        dst.min_depth[x + y * dst.width] =
+            std::min({src.min_depth[i00], src.min_depth[i10],
+                      src.min_depth[i01], src.min_depth[i11]});
+        dst.max_depth[x + y * dst.width] =
+            std::max({src.max_depth[i00], src.max_depth[i10],
+                      src.max_depth[i01], src.max_depth[i11]});
+      }
+    }
+    levels_.push_back(std::move(dst));
+  }
+}
+
+size_t DepthPyramid::SelectLevel(float min_x, float min_y, float max_x,
+                                 float max_y, size_t &x0, size_t &y0,
+                                 size_t &x1, size_t &y1) const {
+  const Level &base = levels_[0];
+  auto clamp_coord = [](float v, size_t limit) -> size_t {
+    if (!(v > 0.0f)) return 0;  // 同时处理 NaN
+    const float max_v = static_cast<float>(limit - 1);
+    return static_cast<size_t>(std::min(std::floor(v), max_v));
+  };
+  const size_t px0 = clamp_coord(min_x, base.width);
+  const size_t py0 = clamp_coord(min_y, base.height);
+  const size_t px1 = clamp_coord(max_x, base.width);
+  const size_t py1 = clamp_coord(max_y, base.height);
+
+  // 提升层级直到矩形在该层最多跨 2 个纹素
+  size_t level = 0;
+  while (level + 1 < levels_.size() &&
+         (((px1 >> level) - (px0 >> level)) > 1 ||
+          ((py1 >> level) - (py0 >> level)) > 1)) {
+    ++level;
+  }
+  const Level &l = levels_[level];
+  x0 = std::min(px0 >> level, l.width - 1);
+  y0 = std::min(py0 >> level, l.height - 1);
+  x1 = std::min(px1 >> level, l.width - 1);
+  y1 = std::min(py1 >> level, l.height - 1);
+  return level;
+}
+
+float DepthPyramid::QueryMaxDepth(float min_x, float min_y, float max_x,
+                                  float max_y) const {
+  if (levels_.empty()) {
+    return std::numeric_limits<float>::infinity();
+  }
+  size_t x0, y0, x1, y1;
+  const Level &l = levels_[SelectLevel(min_x, min_y, max_x, max_y, x0, y0,
+                                       x1, y1)];
+  float result = std::numeric_limits<float>::lowest();
+  for (size_t y = y0; y <= y1; ++y) {
+    for (size_t x = x0; x <= x1; ++x) {
+      result = std::max(result, l.max_depth[x + y * l.width]);
+    }
+  }
+  return result;
+}
+
+float DepthPyramid::QueryMinDepth(float min_x, float min_y, float max_x,
+                                  float max_y) const {
+  if (levels_.empty()) {
+    return std::numeric_limits<float>::lowest();
+  }
+  size_t x0, y0, x1, y1;
+  const Level &l = levels_[SelectLevel(min_x, min_y, max_x, max_y, x0, y0,
+                                       x1, y1)];
+  float result = std::numeric_limits<float>::max();
+  for (size_t y = y0; y <= y1; ++y) {
+    for (size_t x = x0; x <= x1; ++x) {
+      result = std::min(result, l.min_depth[x + y * l.width]);
+    }
+  }
+  return result;
+}
+
+bool DepthPyramid::IsOccluded(const ScreenBounds &bounds) const {
+  if (levels_.empty() || bounds.crosses_near) {
+    return false;
+  }
+  const float width = static_cast<float>(levels_[0].width);
+  const float height = static_cast<float>(levels_[0].height);
+  // 矩形完全在屏幕外：不属于遮挡判定范围，交给视锥体剔除
+  if (bounds.max_x < 0.0f || bounds.max_y < 0.0f || bounds.min_x >= width ||
+      bounds.min_y >= height) {
+    return false;
+  }
+  return bounds.min_z >
+         QueryMaxDepth(bounds.min_x, bounds.min_y, bounds.max_x, bounds.max_y);
+}
+
+}  // namespace simple_renderer
@@ -0,0 +1,53 @@
+#ifndef SIMPLERENDER_SRC_INCLUDE_ALIGNED_ALLOCATOR_HPP_
+#define SIMPLERENDER_SRC_INCLUDE_ALIGNED_ALLOCATOR_HPP_
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace simple_renderer {
+
+/// SIMD 数据流的对齐字节数（AVX 寄存器宽度）
+inline constexpr size_t kSimdAlignment = 32;
+
+/**
+ * @brief 按固定字节对齐分配内存的分配器，供 SoA 数据流使用
+ * @tparam T 元素类型
+ * @tparam Alignment 对齐字节数
+ */
+template <class T, size_t Alignment = kSimdAlignment>
+class AlignedAllocator {
+ public:
+  using value_type = T;
+
+  template <class U>
+  struct rebind {
+    using other = AlignedAllocator<U, Alignment>;
+  };
+
+  AlignedAllocator() noexcept = default;
+  template <class U>
+  AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+  [[nodiscard]] T* allocate(size_t n) {
+    return static_cast<T*>(
+        ::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+  }
+
+  void deallocate(T* p, size_t) noexcept {
+    ::operator delete(p, std::align_val_t(Alignment));
+  }
+
+  template <class U>
+  bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept {
+    return true;
+  }
+};
+
+/// 按 kSimdAlignment 对齐的动态数组
+template <class T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+}  // namespace simple_renderer
+
+#endif  // SIMPLERENDER_SRC_INCLUDE_ALIGNED_ALLOCATOR_HPP_
@@ -0,0 +1,101 @@
+#ifndef SIMPLERENDER_SRC_INCLUDE_BVH_HPP_
+#define SIMPLERENDER_SRC_INCLUDE_BVH_HPP_
+
+#include <cstdint>
+#include <vector>
+
+#include "math.hpp"
+
+namespace simple_renderer {
+
+/**
+ * @brief BVH 节点（扁平数组存储）
+ *
+ * - 内部节点：左子节点为 first，右子节点为 first + 1，count 为 0；
+ * - 叶子节点：覆盖 item_indices[first, first + count)。
+ */
+struct BvhNode {
+  Vector3f bounds_min = Vector3f(0.0f);
+  Vector3f bounds_max = Vector3f(0.0f);
+  uint32_t first = 0;
+  uint32_t count = 0;
+
+  [[nodiscard]] bool IsLeaf() const { return count > 0; }
+};
+
+/**
+ * @brief 轴对齐包围盒层次结构
+ *
+ * 对一组带 AABB 的图元（网格实例、meshlet 等）建树，加载时构建一次。
+ * 遍历时由调用方提供剔除谓词，整棵子树被剔除时其中的图元不再访问。
+ */
+class Bvh {
+ public:
+  Bvh() = default;
+  Bvh(const Bvh&) = default;
+  Bvh(Bvh&&) = default;
+  auto operator=(const Bvh&) -> Bvh& = default;
+  auto operator=(Bvh&&) -> Bvh& = default;
+  ~Bvh() = default;
+
+  /**
+   * @brief 构建 BVH（按最长轴中位数划分）
+   * @param item_min 每个图元的包围盒最小点
+   * @param item_max 每个图元的包围盒最大点
+   */
+  void Build(const std::vector<Vector3f>& item_min,
+             const std::vector<Vector3f>& item_max);
+
+  /**
+   * @brief 自顶向下遍历
+   * @param is_culled bool(const Vector3f& bmin, const Vector3f& bmax)，
+   *        返回 true 时跳过该节点及其子树
+   * @param visit void(uint32_t item)，对未被剔除叶子中的每个图元调用
+   */
+  template <typename CullFn, typename VisitFn>
+  void Traverse(CullFn&& is_culled, VisitFn&& visit) const {
+    if (nodes_.empty()) {
+      return;
+    }
+    uint32_t stack[kMaxDepth];
+    uint32_t top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+      const BvhNode& node = nodes_[stack[--top]];
+      if (is_culled(node.bounds_min, node.bounds_max)) {
+        continue;
+      }
+      if (node.IsLeaf()) {
+        for (uint32_t i = 0; i < node.count; ++i) {
+          visit(item_indices_[node.first + i]);
+        }
+      } else {
+        stack[top++] = node.first + 1;
+        stack[top++] = node.first;
+      }
+    }
+  }
+
+  [[nodiscard]] bool IsEmpty() const { return nodes_.empty(); }
+  [[nodiscard]] const std::vector<BvhNode>& GetNodes() const { return nodes_; }
+  [[nodiscard]] const std::vector<uint32_t>& GetItemIndices() const {
+    return item_indices_;
+  }
+
+ private:
+  // 叶子最多容纳的图元数
+  static constexpr uint32_t kMaxLeafItems = 4;
+  // 中位数划分保证树高约为 log2(n)，64 层足以覆盖 32 位图元索引
+  static constexpr uint32_t kMaxDepth = 64;
+
+  void Subdivide(uint32_t node_index, const std::vector<Vector3f>& centers,
+                 const std::vector<Vector3f>& item_min,
+                 const std::vector<Vector3f>& item_max);
+
+  std::vector<BvhNode> nodes_;
+  std::vector<uint32_t> item_indices_;
+};
+
+}  // namespace simple_renderer
+
+#endif  // SIMPLERENDER_SRC_INCLUDE_BVH_HPP_
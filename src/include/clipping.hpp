@@ -0,0 +1,57 @@
+#ifndef SIMPLERENDER_SRC_INCLUDE_CLIPPING_HPP_
+#define SIMPLERENDER_SRC_INCLUDE_CLIPPING_HPP_
+
+#include <array>
+#include <cstddef>
+
+#include "math.hpp"
+
+namespace simple_renderer {
+
+/**
+ * @brief 保护带大小（NDC 单位）
+ *
+ * 只有 |x| 或 |y| 超过 kGuardBand * w 的顶点才需要对侧平面裁剪；
+ * 保护带内、视口外的部分由光栅化器的包围盒裁剪到屏幕范围。
+ * 16 倍视口时屏幕坐标仍远在 float 边函数的精度范围内。
+ */
+inline constexpr float kGuardBand = 16.0f;
+
+/// 三角形经近平面与 4 个保护带平面裁剪后的最大顶点数
+inline constexpr size_t kMaxClipVertices = 3 + 5;
+
+/**
+ * @brief 裁剪多边形的顶点
+ *
+ * 裁剪空间中属性随位置线性变化，新顶点的属性由原三角形顶点属性
+ * 按 barycentric 加权得到。
+ */
+struct ClipVertex {
+  Vector4f position;     //!< 裁剪空间坐标
+  Vector3f barycentric;  //!< 相对原三角形三个顶点的权重
+};
+
+/**
+ * @brief 裁剪后的凸多边形（按原三角形的环绕方向）
+ */
+struct ClipPolygon {
+  std::array<ClipVertex, kMaxClipVertices> vertices;
+  size_t count = 0;
+};
+
+/**
+ * @brief 在齐次裁剪空间中裁剪三角形（Sutherland–Hodgman）
+ *
+ * 依次对近平面 z >= -w 与保护带平面 |x|, |y| <= kGuardBand * w 裁剪，
+ * 结果中所有顶点 w > 0，可安全地做透视除法。
+ * @param p0 第一个顶点的裁剪空间坐标
+ * @param p1 第二个顶点的裁剪空间坐标
+ * @param p2 第三个顶点的裁剪空间坐标
+ * @return 裁剪后的多边形，完全被裁掉时 count < 3
+ */
+ClipPolygon ClipTriangle(const Vector4f& p0, const Vector4f& p1,
+                         const Vector4f& p2);
+
+}  // namespace simple_renderer
+
+#endif  // SIMPLERENDER_SRC_INCLUDE_CLIPPING_HPP_
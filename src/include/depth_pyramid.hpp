@@ -0,0 +1,98 @@
+#ifndef SIMPLERENDER_SRC_INCLUDE_DEPTH_PYRAMID_HPP_
+#define SIMPLERENDER_SRC_INCLUDE_DEPTH_PYRAMID_HPP_
+
+#include <cstddef>
+#include <vector>
+
+namespace simple_renderer {
+
+/**
+ * @brief 包围体投影到屏幕后的保守范围
+ *
+ * 坐标为像素单位（与视口变换一致），深度为 NDC z（与深度缓冲一致）。
+ */
+struct ScreenBounds {
+  float min_x = 0.0f;
+  float min_y = 0.0f;
+  float max_x = 0.0f;
+  float max_y = 0.0f;
+  float min_z = 0.0f;  //!< 包围体最近深度
+  float max_z = 0.0f;  //!< 包围体最远深度
+  bool outside = false;       //!< 整体位于视锥体某一平面之外
+  bool crosses_near = false;  //!< 跨越相机平面，投影不可靠（保守视为可见）
+};
+
+/**
+ * @brief 层级深度金字塔（Hi‑Z，min/max）
+ *
+ * - 第 0 层为深度缓冲原分辨率拷贝，第 k 层每个纹素覆盖第 k-1 层的 2x2 区域；
+ * - max 金字塔用于遮挡剔除：包围体最近深度比区域内最远深度还远，则被完全遮挡；
+ * - min 金字塔用于快速接受：包围体最远深度比区域内最近深度还近，则一定可见。
+ *
+ * 由上一帧深度或本帧遮挡体（occluder）通道的深度构建。
+ */
+class DepthPyramid {
+ public:
+  DepthPyramid() = default;
+  DepthPyramid(const DepthPyramid&) = default;
+  DepthPyramid(DepthPyramid&&) = default;
+  auto operator=(const DepthPyramid&) -> DepthPyramid& = default;
+  auto operator=(DepthPyramid&&) -> DepthPyramid& = default;
+  ~DepthPyramid() = default;
+
+  /**
+   * @brief 从深度缓冲构建金字塔
+   * @param depth 深度缓冲（width*height，行优先）
+   * @param width 宽度
+   * @param height 高度
+   */
+  void Build(const float* depth, size_t width, size_t height);
+
+  /// 清空金字塔，之后 IsValid 返回 false
+  void Reset() { levels_.clear(); }
+
+  [[nodiscard]] bool IsValid() const { return !levels_.empty(); }
+  [[nodiscard]] size_t GetLevelCount() const { return levels_.size(); }
+  [[nodiscard]] size_t GetWidth() const {
+    return levels_.empty() ? 0 : levels_[0].width;
+  }
+  [[nodiscard]] size_t GetHeight() const {
+    return levels_.empty() ? 0 : levels_[0].height;
+  }
+
+  /**
+   * @brief 查询屏幕矩形内的最远深度（保守）
+   * @return 覆盖矩形的若干纹素中 max 深度的最大值
+   */
+  [[nodiscard]] float QueryMaxDepth(float min_x, float min_y, float max_x,
+                                    float max_y) const;
+  /**
+   * @brief 查询屏幕矩形内的最近深度（保守）
+   */
+  [[nodiscard]] float QueryMinDepth(float min_x, float min_y, float max_x,
+                                    float max_y) const;
+
+  /**
+   * @brief 判断投影后的包围体是否被完全遮挡
+   * @note 金字塔无效、包围体跨越相机平面时返回 false（保守）
+   */
+  [[nodiscard]] bool IsOccluded(const ScreenBounds& bounds) const;
+
+ private:
+  struct Level {
+    size_t width = 0;
+    size_t height = 0;
+    std::vector<float> min_depth;
+    std::vector<float> max_depth;
+  };
+
+  /// 选择使矩形最多覆盖 2x2（对齐偏移时 3x3）个纹素的层级，并返回纹素范围
+  size_t SelectLevel(float min_x, float min_y, float max_x, float max_y,
+                     size_t& x0, size_t& y0, size_t& x1, size_t& y1) const;
+
+  std::vector<Level> levels_;
+};
+
+}  // namespace simple_renderer
+
+#endif  // SIMPLERENDER_SRC_INCLUDE_DEPTH_PYRAMID_HPP_
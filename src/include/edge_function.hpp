@@ -0,0 +1,177 @@
+#ifndef SIMPLERENDER_SRC_INCLUDE_EDGE_FUNCTION_HPP_
+#define SIMPLERENDER_SRC_INCLUDE_EDGE_FUNCTION_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "math.hpp"
+
+namespace simple_renderer {
+
+/// 屏幕坐标的亚像素精度（24.8 定点）
+inline constexpr int32_t kSubPixelBits = 8;
+inline constexpr int32_t kSubPixelScale = 1 << kSubPixelBits;
+
+/// 分层光栅化的块尺寸（像素）
+inline constexpr int32_t kRasterBlockSize = 8;
+
+/// 小三角形路径的采样模板尺寸（像素），包围盒不超过该尺寸的三角形走小三角形路径
+inline constexpr int32_t kSmallTriangleStamp = 4;
+
+/// 像素块与三角形的关系
+enum class BlockCoverage : uint8_t {
+  kOutside,  //!< 完全在外：跳过
+  kPartial,  //!< 部分覆盖：逐像素测试
+  kInside,   //!< 完全在内：省去逐像素测试
+};
+
+/**
+ * @brief 三角形的定点边函数（光栅化的三角形建立）
+ *
+ * 顶点屏幕坐标吸附到 1/kSubPixelScale 像素网格后，三条边函数
+ * E_k(x, y) = a_k * x + b_k * y + c_k 以 int64 精确求值，在像素
+ * (x, y) 处采样（与各渲染器一致，采样点为整数像素坐标）：
+ * - edge[0] 为 p1->p2、edge[1] 为 p2->p0、edge[2] 为 p0->p1，
+ *   E_k / area 即顶点 k 的（屏幕空间）重心坐标；
+ * - 朝向统一为 area > 0，内侧 E_k >= 0；
+ * - 左上填充规则：E_k == 0 的像素只属于左边或上边（y 向下），
+ *   共享边上的像素恰好被一个三角形覆盖，不会重复着色，也没有缝隙。
+ *
+ * 沿 x / y 移动一个像素时 E_k 分别增加 step_x[k] / step_y[k]，
+ * 扫描时只需整数加法。
+ */
+struct TriangleSetup {
+  int64_t step_x[3];  //!< 沿 x 一个像素的增量
+  int64_t step_y[3];  //!< 沿 y 一个像素的增量
+  int64_t origin[3];  //!< 像素 (0, 0) 处的边函数值
+  int64_t bias[3];    //!< 填充规则偏置：左上边为 0，其余为 -1
+  int64_t area = 0;   //!< 两倍面积（定点，> 0）
+  float inv_area = 0.0f;
+  /// 覆盖像素的包围盒（闭区间，未裁剪到屏幕）
+  int32_t min_x = 0, min_y = 0, max_x = -1, max_y = -1;
+
+  /**
+   * @brief 由三个屏幕空间顶点建立边函数
+   * @return 退化（定点面积为 0）时返回 false
+   */
+  bool Setup(const Vector4f& p0, const Vector4f& p1, const Vector4f& p2) {
+    const auto snap = [](float v) {
+      return static_cast<int64_t>(
+          std::lrint(v * static_cast<float>(kSubPixelScale)));
+    };
+    const int64_t x[3] = {snap(p0.x), snap(p1.x), snap(p2.x)};
+    const int64_t y[3] = {snap(p0.y), snap(p1.y), snap(p2.y)};
+
+    area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+    if (area == 0) {
+      return false;
+    }
+    const int64_t sign = area > 0 ? 1 : -1;
+    area *= sign;
+    inv_area = 1.0f / static_cast<float>(area);
+
+    for (int k = 0; k < 3; ++k) {
+      const int from = (k + 1) % 3;
+      const int to = (k + 2) % 3;
+      // E(P) = (to - from) x (P - from)，按 sign 统一为内侧非负
+      const int64_t a = -(y[to] - y[from]) * sign;
+      const int64_t b = (x[to] - x[from]) * sign;
+      const int64_t c = -(a * x[from] + b * y[from]);
+      step_x[k] = a * kSubPixelScale;
+      step_y[k] = b * kSubPixelScale;
+      origin[k] = c;
+      // 内侧沿 +x（左边）或水平且内侧沿 +y（上边）
+      bias[k] = (a > 0 || (a == 0 && b > 0)) ? 0 : -1;
+    }
+
+    const auto floor_pixel = [](int64_t v) {
+      return static_cast<int32_t>(v >> kSubPixelBits);
+    };
+    const auto ceil_pixel = [](int64_t v) {
+      return static_cast<int32_t>((v + kSubPixelScale - 1) >> kSubPixelBits);
+    };
+    min_x = ceil_pixel(std::min({x[0], x[1], x[2]}));
+    min_y = ceil_pixel(std::min({y[0], y[1], y[2]}));
+    max_x = floor_pixel(std::max({x[0], x[1], x[2]}));
+    max_y = floor_pixel(std::max({y[0], y[1], y[2]}));
+    return true;
+  }
+
+  /// 包围盒内没有采样点，三角形不覆盖任何像素
+  [[nodiscard]] bool Empty() const { return min_x > max_x || min_y > max_y; }
+
+  /// 包围盒可由一个 kSmallTriangleStamp x kSmallTriangleStamp 模板覆盖
+  [[nodiscard]] bool Small() const {
+    return max_x - min_x < kSmallTriangleStamp &&
+           max_y - min_y < kSmallTriangleStamp;
+  }
+
+  /// 像素 (x, y) 处第 k 条边的边函数值
+  [[nodiscard]] int64_t Evaluate(int k, int32_t x, int32_t y) const {
+    return origin[k] + step_x[k] * x + step_y[k] * y;
+  }
+
+  /// 三条边函数值是否在三角形内（含填充规则）
+  [[nodiscard]] bool Inside(int64_t e0, int64_t e1, int64_t e2) const {
+    return ((e0 + bias[0]) | (e1 + bias[1]) | (e2 + bias[2])) >= 0;
+  }
+
+  /**
+   * @brief 按四个角的边函数值对 width x height 的像素块分类
+   *
+   * 边函数是线性的，块内极值在角上取得：某条边在四角都在外侧则整块在外，
+   * 三条边在四角都在内侧则整块在内。
+   * @param e 块左上像素处的三条边函数值
+   */
+  [[nodiscard]] BlockCoverage ClassifyBlock(const int64_t e[3], int32_t width,
+                                            int32_t height) const {
+    bool inside = true;
+    for (int k = 0; k < 3; ++k) {
+      const int64_t dx = step_x[k] * (width - 1);
+      const int64_t dy = step_y[k] * (height - 1);
+      const int64_t low = e[k] + bias[k] + std::min<int64_t>(dx, 0) +
+                          std::min<int64_t>(dy, 0);
+      const int64_t high = e[k] + bias[k] + std::max<int64_t>(dx, 0) +
+                           std::max<int64_t>(dy, 0);
+      if (high < 0) {
+        return BlockCoverage::kOutside;
+      }
+      inside = inside && low >= 0;
+    }
+    return inside ? BlockCoverage::kInside : BlockCoverage::kPartial;
+  }
+
+  /**
+   * @brief 小三角形的覆盖测试：一次测试 kSmallTriangleStamp^2 个采样点
+   *
+   * 包围盒不超过模板尺寸时，模板内的边函数值远小于 2^31，以 int32
+   * 通道一次 SIMD 比较全部采样点。
+   * @param x 模板左上采样点 x
+   * @param y 模板左上采样点 y
+   * @return 覆盖掩码，第 dy * kSmallTriangleStamp + dx 位对应 (x + dx, y + dy)
+   */
+  [[nodiscard]] uint32_t CoverStamp(int32_t x, int32_t y) const {
+    constexpr int32_t kSamples = kSmallTriangleStamp * kSmallTriangleStamp;
+    int32_t base[3], dx[3], dy[3];
+    for (int k = 0; k < 3; ++k) {
+      base[k] = static_cast<int32_t>(Evaluate(k, x, y) + bias[k]);
+      dx[k] = static_cast<int32_t>(step_x[k]);
+      dy[k] = static_cast<int32_t>(step_y[k]);
+    }
+    uint32_t mask = 0u;
+#pragma omp simd reduction(| : mask)
+    for (int32_t i = 0; i < kSamples; ++i) {
+      const int32_t sx = i % kSmallTriangleStamp, sy = i / kSmallTriangleStamp;
+      const int32_t e = (base[0] + dx[0] * sx + dy[0] * sy) |
+                        (base[1] + dx[1] * sx + dy[1] * sy) |
+                        (base[2] + dx[2] * sx + dy[2] * sy);
+      mask |= static_cast<uint32_t>(e >= 0) << i;
+    }
+    return mask;
+  }
+};
+
+}  // namespace simple_renderer
+
+#endif  // SIMPLERENDER_SRC_INCLUDE_EDGE_FUNCTION_HPP_
@@ -1,11 +1,33 @@
 #ifndef SIMPLERENDER_SRC_INCLUDE_MATERIAL_HPP_
 #define SIMPLERENDER_SRC_INCLUDE_MATERIAL_HPP_
 
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "color.h"
 #include "math.hpp"
 
 namespace simple_renderer {
 
+/**
+ * @brief 纹理过滤方式
+ */
+enum class TextureFilter : uint8_t {
+  kNearest,    //!< 第 0 级最近点采样（不使用 mipmap）
+  kBilinear,   //!< 最近的 mip 级别上双线性采样
+  kTrilinear,  //!< 相邻两个 mip 级别双线性采样后按 LOD 小数部分混合
+};
+
+/**
+ * @brief mip 级别，texel 统一为 RGBA8（每 texel 4 字节，一次读取）
+ */
+struct TextureLevel {
+  int width = 0;
+  int height = 0;
+  std::vector<uint8_t> texels;
+};
+
 /* * * * * * * * * */
 /* --- Texture --- */
 class Texture {
@@ -46,6 +68,28 @@ class Texture {
   // 从纹理获取像素
   Color GetPixel(int x, int y) const;
 
+  /**
+   * @brief 由第 0 级生成完整 mip 链（按面积加权的盒式滤波，至 1x1 为止）
+   *
+   * 偶数尺寸为 2x2 平均；奇数尺寸时每个目标 texel 按覆盖面积加权
+   * 每个方向至多 3 个源 texel，边缘 texel 不被丢弃。
+   * LoadTextureFromFile 加载后自动调用；直接填写 data 的纹理需手动调用。
+   */
+  void GenerateMipmaps();
+
+  /**
+   * @brief 按 UV 屏幕导数选择 LOD 并过滤采样（重复寻址）
+   *
+   * LOD 为 log2(max(|duv_dx|, |duv_dy|) * 纹理尺寸)，放大（LOD <= 0）时
+   * 在第 0 级双线性采样，导数非有限时取最粗级别。未生成 mip 链时退化为
+   * 第 0 级最近点采样。
+   * @param uv 纹理坐标
+   * @param duv_dx, duv_dy 纹理坐标沿屏幕 x / y 一个像素的变化量
+   * @return [0, 1] 的 RGB
+   */
+  [[nodiscard]] Vector3f Sample(const Vector2f& uv, const Vector2f& duv_dx,
+                                const Vector2f& duv_dy) const;
+
   // Texture data
   // 纹理数据
   uint8_t* data = nullptr;
@@ -58,6 +102,12 @@ class Texture {
   // Texture height
   // 纹理高度
   int height = 0;
+  // Texture filter
+  // 纹理过滤方式
+  TextureFilter filter = TextureFilter::kTrilinear;
+  // Mip chain (level 0 first), shared between copies
+  // mip 链（第 0 级在前），拷贝之间共享
+  std::shared_ptr<const std::vector<TextureLevel>> levels;
 };
 
 /* * * * * * * * * */
@@ -102,6 +152,11 @@ class Material {
   bool has_ambient_texture = false;
   bool has_diffuse_texture = false;
   bool has_specular_texture = false;
+
+  /// 是否有任一纹理（需要 UV 导数）
+  [[nodiscard]] bool HasTexture() const {
+    return has_ambient_texture || has_diffuse_texture || has_specular_texture;
+  }
 };
 }  // namespace simple_renderer
 
@@ -2,6 +2,7 @@
 #define SIMPLERENDER_SRC_INCLUDE_MATH_HPP_
 
 #include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
 
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/string_cast.hpp>
@@ -15,6 +16,7 @@ using Vector3f = glm::vec3;
 using Vector4f = glm::vec4;
 using Matrix3f = glm::mat3;
 using Matrix4f = glm::mat4;
+using Quaternion = glm::quat;
 }  // namespace simple_renderer
 
 /**
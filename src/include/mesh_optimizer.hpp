@@ -0,0 +1,63 @@
+#ifndef SIMPLERENDER_SRC_INCLUDE_MESH_OPTIMIZER_HPP_
+#define SIMPLERENDER_SRC_INCLUDE_MESH_OPTIMIZER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "math.hpp"
+#include "vertex.hpp"
+
+namespace simple_renderer {
+
+/// 顶点缓存优化假设的后变换缓存大小
+inline constexpr size_t kVertexCacheSize = 16;
+
+/**
+ * @brief 焊接完全相同的顶点（位置、法线、UV、颜色逐位相等）
+ *
+ * 原地压缩顶点数组（保持首次出现顺序），并改写索引。
+ * @param vertices 顶点数组
+ * @param indices 三角形索引（每 3 个一组）
+ * @return 焊接后的顶点数
+ */
+size_t WeldVertices(std::vector<Vertex>& vertices,
+                    std::vector<uint32_t>& indices);
+
+/**
+ * @brief 按三角形重心的 Morton 码（Z 序曲线）排序三角形
+ *
+ * 在包围盒内将重心量化为每轴 10 位，稳定排序，使空间上相邻的三角形在
+ * 索引中也相邻。
+ * @param positions 顶点位置
+ * @param indices 三角形索引，原地重排
+ */
+void SortTrianglesMorton(const std::vector<Vector3f>& positions,
+                         std::vector<uint32_t>& indices);
+
+/**
+ * @brief 后变换顶点缓存优化（Tipsify）
+ *
+ * 以顶点为中心扇形输出三角形；无可选顶点时回到输入顺序中的下一个三角形，
+ * 因此先做空间排序可保留大尺度的空间局部性。
+ * @param indices 三角形索引，原地重排
+ * @param vertex_count 顶点数
+ * @param cache_size 缓存大小
+ */
+void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertex_count,
+                         size_t cache_size = kVertexCacheSize);
+
+/**
+ * @brief 计算按首次使用顺序重排顶点的映射
+ *
+ * 未被引用的顶点排在最后。
+ * @param indices 三角形索引
+ * @param vertex_count 顶点数
+ * @return 旧索引 -> 新索引
+ */
+std::vector<uint32_t> BuildVertexFetchRemap(const std::vector<uint32_t>& indices,
+                                            size_t vertex_count);
+
+}  // namespace simple_renderer
+
+#endif  // SIMPLERENDER_SRC_INCLUDE_MESH_OPTIMIZER_HPP_
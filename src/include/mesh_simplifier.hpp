@@ -0,0 +1,32 @@
+#ifndef SIMPLERENDER_SRC_INCLUDE_MESH_SIMPLIFIER_HPP_
+#define SIMPLERENDER_SRC_INCLUDE_MESH_SIMPLIFIER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "math.hpp"
+
+namespace simple_renderer {
+
+/**
+ * @brief 基于二次误差度量（QEM）的边折叠网格简化
+ *
+ * - 只把顶点折叠到相邻的已有顶点上，不生成新顶点，法线/UV 等属性原样保留；
+ * - 开放边界上的顶点只沿边界折叠，属性接缝两侧的顶点成对沿接缝折叠，
+ *   角点与接缝交汇处锁定，避免产生裂缝；
+ * - 折叠前检查相邻三角形是否翻转。
+ * @param positions 顶点位置
+ * @param indices 三角形索引（每 3 个一组）
+ * @param target_index_count 目标索引数（三角形数 * 3），无法继续折叠时提前结束
+ * @param out_error 输出：最大折叠误差（模型空间距离），可为空
+ * @return 简化后的三角形索引
+ */
+std::vector<uint32_t> SimplifyMesh(const std::vector<Vector3f>& positions,
+                                   const std::vector<uint32_t>& indices,
+                                   size_t target_index_count,
+                                   float* out_error = nullptr);
+
+}  // namespace simple_renderer
+
+#endif  // SIMPLERENDER_SRC_INCLUDE_MESH_SIMPLIFIER_HPP_
@@ -0,0 +1,80 @@
+#ifndef SIMPLERENDER_SRC_INCLUDE_MESHLET_HPP_
+#define SIMPLERENDER_SRC_INCLUDE_MESHLET_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "face.hpp"
+#include "math.hpp"
+#include "vertex_streams.hpp"
+
+namespace simple_renderer {
+
+/// 单个 meshlet 的顶点上限
+inline constexpr size_t kMeshletMaxVertices = 64;
+/// 单个 meshlet 的三角形上限
+inline constexpr size_t kMeshletMaxTriangles = 124;
+
+/**
+ * @brief Meshlet：空间上相邻的一小簇三角形，作为剔除的基本单元
+ *
+ * - 面在模型面数组中连续存放：[face_offset, face_offset + face_count)；
+ * - 用到的顶点（全局索引）存放在 meshlet 顶点表
+ *   [vertex_offset, vertex_offset + vertex_count)；
+ * - 包围球用于视锥体剔除，法线锥用于整簇背面剔除，AABB 用于 Hi‑Z 遮挡剔除；
+ * - 所有几何量均在模型空间。
+ */
+struct Meshlet {
+  uint32_t vertex_offset = 0;
+  uint32_t vertex_count = 0;
+  uint32_t face_offset = 0;
+  uint32_t face_count = 0;
+
+  Vector3f center = Vector3f(0.0f);  //!< 包围球球心
+  float radius = 0.0f;               //!< 包围球半径
+
+  /// 法线锥轴（正面法线平均方向）
+  Vector3f cone_axis = Vector3f(0.0f, 0.0f, 1.0f);
+  /// 法线锥截止值 sin(半角)，>= 1 表示法线过于分散、不做背面剔除
+  float cone_cutoff = 1.0f;
+
+  Vector3f bounds_min = Vector3f(0.0f);
+  Vector3f bounds_max = Vector3f(0.0f);
+};
+
+/**
+ * @brief 将一段连续的面划分为 meshlet（加载时离线执行）
+ *
+ * 以邻接关系贪心生长：优先加入与当前 meshlet 共享顶点最多的三角形，
+ * 直到顶点数或三角形数达到上限。划分后原地重排该段面，使每个 meshlet
+ * 的面连续，并计算包围体与法线锥。
+ * @param vertices 模型顶点（只读，模型空间）
+ * @param faces 模型面数组，[face_offset, face_offset + face_count) 会被重排
+ * @param face_offset 待划分面的起始位置
+ * @param face_count 待划分面的数量
+ * @param meshlets 输出：追加生成的 meshlet
+ * @param meshlet_vertices 输出：追加 meshlet 顶点表（全局顶点索引）
+ */
+void BuildMeshlets(const VertexStreams& vertices, std::vector<Face>& faces,
+                   size_t face_offset, size_t face_count,
+                   std::vector<Meshlet>& meshlets,
+                   std::vector<uint32_t>& meshlet_vertices);
+
+/**
+ * @brief 根据顶点与面（重新）计算 meshlet 的包围体与法线锥
+ *
+ * 顶点形变（蒙皮、变形目标）后调用，使剔除使用当前姿态的几何。
+ * @param vertices 模型顶点（模型空间）
+ * @param faces 模型面数组
+ * @param meshlet_vertices meshlet 顶点表
+ * @param meshlet 待更新的 meshlet
+ */
+void ComputeMeshletBounds(const VertexStreams& vertices,
+                          const std::vector<Face>& faces,
+                          const std::vector<uint32_t>& meshlet_vertices,
+                          Meshlet& meshlet);
+
+}  // namespace simple_renderer
+
+#endif  // SIMPLERENDER_SRC_INCLUDE_MESHLET_HPP_
@@ -22,15 +22,57 @@
 #include <string>
 #include <vector>
 
+#include "bvh.hpp"
 #include "color.h"
 #include "config.h"
 #include "face.hpp"
 #include "log_system.h"
 #include "math.hpp"
+#include "meshlet.hpp"
+#include "skinning.hpp"
 #include "vertex.hpp"
+#include "vertex_streams.hpp"
 
 namespace simple_renderer {
 
+// Scene node: keeps the Assimp node hierarchy and transforms
+// 场景节点：保留 Assimp 节点层级与变换
+struct SceneNode {
+  std::string name;
+  // Transform relative to the parent node
+  // 相对父节点的变换
+  Matrix4f local_transform = Matrix4f(1.0f);
+  // Transform relative to the model root (baked into vertices)
+  // 相对模型根节点的变换（已烘焙进顶点）
+  Matrix4f global_transform = Matrix4f(1.0f);
+  // Parent node index, -1 for the root
+  // 父节点索引，根节点为 -1
+  int32_t parent = -1;
+  std::vector<size_t> children;
+  // Mesh instances referenced by this node
+  // 该节点引用的网格实例
+  std::vector<size_t> instances;
+};
+
+// Mesh instance: one mesh under one node, as ranges into the flat arrays
+// 网格实例：某节点下的一个网格，在扁平顶点/面数组中的范围
+struct MeshInstance {
+  size_t mesh_index = 0;
+  size_t node_index = 0;
+  size_t vertex_offset = 0;
+  size_t vertex_count = 0;
+  size_t face_offset = 0;
+  size_t face_count = 0;
+  // Range into the model meshlet array
+  // 在模型 meshlet 数组中的范围
+  size_t meshlet_offset = 0;
+  size_t meshlet_count = 0;
+  // Model-space AABB (node transform applied)
+  // 模型空间包围盒（已应用节点变换）
+  Vector3f bounds_min = Vector3f(0.0f);
+  Vector3f bounds_max = Vector3f(0.0f);
+};
+
 /* * * * * * * * * */
 /* --- Model --- */
 class Model {
@@ -63,11 +105,107 @@ class Model {
 
   // Get functions
   // 获取函数
-  const std::vector<Vertex>& GetVertices() const { return vertices_; };
+  const VertexStreams& GetVertices() const { return vertices_; };
   const std::vector<Face>& GetFaces() const { return faces_; };
   const std::string& GetModelPath() const { return directory_; };
+  // Model-space axis-aligned bounding box
+  // 模型空间轴对齐包围盒
+  const Vector3f& GetBoundsMin() const { return bounds_min_; };
+  const Vector3f& GetBoundsMax() const { return bounds_max_; };
+  // Scene hierarchy, mesh instances and the BVH built over the instances
+  // 场景层级、网格实例以及基于实例构建的 BVH
+  const std::vector<SceneNode>& GetNodes() const { return nodes_; };
+  const std::vector<MeshInstance>& GetMeshInstances() const {
+    return instances_;
+  };
+  const Bvh& GetInstanceBvh() const { return instance_bvh_; };
+  // Meshlets (culling clusters) and their global vertex index table
+  // Meshlet（剔除簇）及其全局顶点索引表
+  const std::vector<Meshlet>& GetMeshlets() const { return meshlets_; };
+  const std::vector<uint32_t>& GetMeshletVertices() const {
+    return meshlet_vertices_;
+  };
+
+  // Skeletal animation and morph targets
+  // 骨骼动画与变形目标
+  // True if the model has bones or morph targets; only such models can be
+  // posed with ApplyPose
+  // 模型含骨骼或变形目标时为 true，只有这类模型可以用 ApplyPose 设置姿态
+  bool IsDeformable() const {
+    return !bones_.empty() || !morph_targets_.empty();
+  };
+  const std::vector<Bone>& GetBones() const { return bones_; };
+  const std::vector<MorphTarget>& GetMorphTargets() const {
+    return morph_targets_;
+  };
+  const std::vector<AnimationClip>& GetAnimations() const {
+    return animations_;
+  };
+  // Pose of the loaded scene (skinning matrices of the bind pose and default
+  // morph weights)
+  // 加载场景时的姿态（绑定姿态的蒙皮矩阵与默认变形权重）
+  Pose GetBindPose() const;
+  // Sample an animation clip at `seconds` (wrapped to the clip duration)
+  // 在 seconds 时刻（按片段时长循环）采样动画片段
+  Pose SampleAnimation(size_t animation, float seconds) const;
+  // Deform the vertices (morph targets, then linear blend skinning) into the
+  // pose and refit instance/meshlet bounds. Call once per frame before the
+  // draws: every view and pass then reuses the deformed vertices, and
+  // applying the pose that is already applied does nothing. LODs are posed
+  // as well.
+  // 将顶点形变到该姿态（先变形目标，后线性混合蒙皮），并重新计算实例/meshlet
+  // 包围体。每帧在绘制前调用一次：之后所有视图与通道复用形变后的顶点，
+  // 重复应用相同姿态不会重复计算。LOD 同样被形变。
+  void ApplyPose(const Pose& pose);
+
+  // World-space positions and normals for `model_matrix`. Rebuilt only when
+  // the matrix differs from the cached one or the vertices changed since
+  // (ApplyPose, CompressVertices), so static models pay one view-projection
+  // multiply per vertex and frame. Not thread-safe: call it from the thread
+  // issuing the draws, the result stays valid until the next call.
+  // 以 model_matrix 变换后的世界空间位置与法线。仅当矩阵与缓存不同或顶点
+  // 此后发生变化（ApplyPose、CompressVertices）时重建，静态模型每帧每顶点
+  // 只需一次视图-投影矩阵乘。非线程安全：须在发起绘制的线程调用，
+  // 结果在下一次调用前有效。
+  const WorldSpaceVertices& GetWorldVertices(const Matrix4f& model_matrix) const;
+
+  // Convert vertex storage (including existing LODs) to VertexFormat::kCompact:
+  // 16-bit positions quantized per mesh instance, octahedral normals and
+  // half-float UVs. LODs generated afterwards are compressed as well.
+  // Deformable models stay in kFloat format.
+  // 将顶点存储（包括已有 LOD）转换为 VertexFormat::kCompact：按网格实例量化的
+  // 16 位位置、八面体法线与半精度 UV。之后生成的 LOD 同样被压缩。
+  // 可形变模型保持 kFloat 格式。
+  void CompressVertices();
+
+  // Build a LOD chain by quadric-error edge collapse; each level keeps about
+  // `reduction` of the previous level's triangles and is simplified from the
+  // full-detail mesh. Levels that no longer shrink are dropped.
+  // 通过二次误差边折叠构建 LOD 链；每级约保留上一级 reduction 比例的三角形，
+  // 且均由最高精度网格简化得到。无法继续减面的级别会被丢弃。
+  void GenerateLods(size_t max_levels = kDefaultLodLevels,
+                    float reduction = kDefaultLodReduction);
+  // Number of LOD levels, including level 0 (this model)
+  // LOD 级数，包含第 0 级（模型自身）
+  size_t GetLodCount() const { return lods_.size() + 1; };
+  // LOD model of the given level, level 0 is this model
+  // 指定级别的 LOD 模型，第 0 级为模型自身
+  const Model& GetLod(size_t level) const {
+    return level == 0 ? *this : lods_[level - 1];
+  };
+  // Geometric error of this LOD relative to level 0 (model-space distance)
+  // 相对第 0 级的几何误差（模型空间距离）
+  float GetLodError() const { return lod_error_; };
 
  private:
+  // Default LOD chain length and per-level triangle ratio
+  // 默认 LOD 级数与每级三角形保留比例
+  static constexpr size_t kDefaultLodLevels = 4;
+  static constexpr float kDefaultLodReduction = 0.5f;
+  // Levels smaller than this are not generated
+  // 三角形数低于此值时不再生成更粗的级别
+  static constexpr size_t kMinLodTriangles = 64;
+
   // Number of vertices per triangle face
   // 每个三角形面的顶点数
   static constexpr const uint8_t kTriangleFaceVertexCount = 3;
@@ -75,25 +213,106 @@ class Model {
   // 模型所在的目录
   std::string directory_;
 
-  // List of vertices that make up the model
-  // 构成模型的顶点列表
-  std::vector<Vertex> vertices_;
+  // Vertices that make up the model, stored as SoA streams
+  // 构成模型的顶点，以 SoA 数据流存储
+  VertexStreams vertices_;
 
   // List of faces(triangles) that make up the model
   // 构成模型的面(三角形）列表
   std::vector<Face> faces_;
 
+  // Model-space AABB, updated while loading vertices
+  // 模型空间包围盒，加载顶点时更新
+  Vector3f bounds_min_ = Vector3f(0.0f);
+  Vector3f bounds_max_ = Vector3f(0.0f);
+
+  // Scene nodes (index 0 is the root) and mesh instances
+  // 场景节点（0 号为根节点）与网格实例
+  std::vector<SceneNode> nodes_;
+  std::vector<MeshInstance> instances_;
+
+  // BVH over mesh instances, built once at load time
+  // 网格实例 BVH，加载时构建一次
+  Bvh instance_bvh_;
+
+  // Meshlets built at load time; faces of a meshlet are contiguous
+  // 加载时构建的 meshlet，每个 meshlet 的面连续存放
+  std::vector<Meshlet> meshlets_;
+  std::vector<uint32_t> meshlet_vertices_;
+
+  // Ticks per second used when the file does not specify one
+  // 文件未指定时使用的每秒 tick 数
+  static constexpr double kDefaultTicksPerSecond = 25.0;
+
+  // Bones, per-vertex influences, morph targets and animation clips
+  // 骨骼、逐顶点骨骼影响、变形目标与动画片段
+  std::vector<Bone> bones_;
+  SkinWeights skin_weights_;
+  std::vector<MorphTarget> morph_targets_;
+  std::vector<AnimationClip> animations_;
+  // Bind-pose vertices of deformable models (vertices_ holds the posed ones)
+  // and the pose currently applied
+  // 可形变模型的绑定姿态顶点（vertices_ 保存形变后的顶点）及当前已应用的姿态
+  VertexStreams bind_vertices_;
+  Pose applied_pose_;
+  bool has_applied_pose_ = false;
+
+  // World-space vertex cache, the model matrix it was built with and whether
+  // it matches the current vertices
+  // 世界空间顶点缓存、构建时使用的模型矩阵，以及缓存是否与当前顶点一致
+  mutable WorldSpaceVertices world_vertices_;
+  mutable Matrix4f world_matrix_ = Matrix4f(1.0f);
+  mutable bool world_valid_ = false;
+
+  // Coarser levels (1..N) and the error of this model as a LOD
+  // 更粗的 LOD 级别（1..N）以及本模型作为 LOD 时的误差
+  std::vector<Model> lods_;
+  float lod_error_ = 0.0f;
+
   // Load the model from the specified file path
   // 从指定的文件路径加载模型
   void LoadModel(const std::string& path);
 
   // Process a node in the model
   // 处理模型中的一个节点
-  void ProcessNode(aiNode* node, const aiScene* scene);
+  void ProcessNode(aiNode* node, const aiScene* scene, int32_t parent);
+
+  // Process a mesh referenced by a node in the model
+  // 处理模型中某个节点引用的网格
+  void ProcessMesh(aiMesh* mesh, const aiScene* scene, size_t mesh_index,
+                   size_t node_index);
+
+  // Load bones and morph targets of a mesh; `mesh_vertices` are the
+  // (unwelded) vertices with the node transform applied
+  // 加载网格的骨骼与变形目标；mesh_vertices 为已应用节点变换（未焊接）的顶点
+  void ProcessDeformation(aiMesh* mesh, const aiScene* scene,
+                          const MeshInstance& instance,
+                          const std::vector<Vertex>& mesh_vertices);
+
+  // Resolve bone nodes and load the animation clips
+  // 解析骨骼对应的节点并加载动画片段
+  void ProcessAnimations(const aiScene* scene);
+
+  // Evaluate the node hierarchy into a pose, `clip` may be null (bind pose)
+  // 求值节点层级得到姿态，clip 可为空（绑定姿态）
+  Pose EvaluatePose(const AnimationClip* clip, float seconds) const;
+
+  // Refit instance and meshlet bounds to the current vertices, then rebuild
+  // the instance BVH
+  // 按当前顶点重新计算实例与 meshlet 包围体，并重建实例 BVH
+  void RefitBounds();
+
+  // Build the instance BVH and the model bounds
+  // 构建实例 BVH 与模型包围盒
+  void BuildBounds();
+
+  // Reorder an instance's vertices by first use in its final face order
+  // 按实例最终面顺序中的首次使用重排其顶点
+  void ReorderVertexFetch(const MeshInstance& instance);
 
-  // Process a mesh in the model
-  // 处理模型中的一个网格
-  void ProcessMesh(aiMesh* mesh, const aiScene* scene);
+  // Simplify every instance of this model into a new compacted LOD model
+  // 将本模型的每个实例简化，生成顶点紧凑的新 LOD 模型
+  Model BuildLod(float ratio) const;
 
   // Process the material of the model
   // 处理模型的材质
@@ -0,0 +1,95 @@
+#ifndef SIMPLERENDER_SRC_INCLUDE_MSAA_HPP_
+#define SIMPLERENDER_SRC_INCLUDE_MSAA_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#include "edge_function.hpp"
+#include "log_system.h"
+
+namespace simple_renderer {
+
+/// 支持的最大 MSAA 样本数
+inline constexpr uint32_t kMaxMsaaSamples = 4;
+
+/**
+ * @brief MSAA 采样模式：样本相对像素采样点的偏移
+ *
+ * 偏移以 1/kSubPixelScale 像素为单位，落在定点网格上，样本处的边函数
+ * 值仍为整数（E_k + a_k * dx + b_k * dy），覆盖测试与像素一样精确且
+ * 遵守同一填充规则。所有样本都在像素采样点半个像素以内。
+ */
+struct MsaaPattern {
+  uint32_t samples = 1;
+  int32_t offset_x[kMaxMsaaSamples] = {};
+  int32_t offset_y[kMaxMsaaSamples] = {};
+};
+
+/// 是否为支持的样本数（1 / 2 / 4）
+[[nodiscard]] inline bool IsValidMsaaSamples(uint32_t samples) {
+  return samples == 1 || samples == 2 || samples == 4;
+}
+
+/**
+ * @brief 标准采样位置：2x 为对角线，4x 为旋转网格
+ * @param samples 1 / 2 / 4
+ */
+inline MsaaPattern GetMsaaPattern(uint32_t samples) {
+  // 标准位置以 1/16 像素给出
+  constexpr int32_t kUnit = kSubPixelScale / 16;
+  switch (samples) {
+    case 1:
+      return {1, {0}, {0}};
+    case 2:
+      return {2, {4 * kUnit, -4 * kUnit}, {4 * kUnit, -4 * kUnit}};
+    case 4:
+      return {4,
+              {-2 * kUnit, 6 * kUnit, -6 * kUnit, 2 * kUnit},
+              {-6 * kUnit, -2 * kUnit, 2 * kUnit, 6 * kUnit}};
+    default:
+      SPDLOG_ERROR("Unsupported MSAA sample count: {}", samples);
+      throw std::invalid_argument("Unsupported MSAA sample count");
+  }
+}
+
+/**
+ * @brief 各样本处边函数相对像素采样点的增量
+ * @param setup 三角形建立结果
+ * @param pattern 采样模式
+ * @param offsets 输出：offsets[s][k] 为样本 s 第 k 条边的增量
+ */
+inline void SampleEdgeOffsets(const TriangleSetup& setup,
+                              const MsaaPattern& pattern,
+                              int64_t offsets[kMaxMsaaSamples][3]) {
+  for (uint32_t s = 0; s < pattern.samples; ++s) {
+    for (int k = 0; k < 3; ++k) {
+      // step_x / step_y 为一个像素的增量，恰为 kSubPixelScale 的整数倍
+      offsets[s][k] = setup.step_x[k] / kSubPixelScale * pattern.offset_x[s] +
+                      setup.step_y[k] / kSubPixelScale * pattern.offset_y[s];
+    }
+  }
+}
+
+/**
+ * @brief 解析：样本颜色逐字节取平均（四舍五入）
+ * @param colors 第 0 个样本的颜色
+ * @param stride 相邻样本的间隔（样本平面大小）
+ * @param samples 样本数
+ */
+inline uint32_t ResolveSamples(const uint32_t* colors, size_t stride,
+                               uint32_t samples) {
+  uint32_t result = 0u;
+  for (uint32_t shift = 0; shift < 32; shift += 8) {
+    uint32_t sum = 0u;
+    for (uint32_t s = 0; s < samples; ++s) {
+      sum += (colors[s * stride] >> shift) & 0xFFu;
+    }
+    result |= ((sum + samples / 2) / samples) << shift;
+  }
+  return result;
+}
+
+}  // namespace simple_renderer
+
+#endif  // SIMPLERENDER_SRC_INCLUDE_MSAA_HPP_
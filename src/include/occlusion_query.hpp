@@ -0,0 +1,49 @@
+#ifndef SIMPLERENDER_SRC_INCLUDE_OCCLUSION_QUERY_HPP_
+#define SIMPLERENDER_SRC_INCLUDE_OCCLUSION_QUERY_HPP_
+
+#include <cstdint>
+
+namespace simple_renderer {
+
+/**
+ * @brief 遮挡查询对象（samples-passed 计数器）
+ *
+ * 用法与 GPU 遮挡查询一致：
+ *   renderer.BeginQuery(query);
+ *   renderer.DrawModel(...) / renderer.DrawBoundingBox(...);
+ *   renderer.EndQuery();
+ *   if (!query.AnySamplesPassed()) { 下一帧跳过该物体 }
+ *
+ * 说明：
+ * - 计数为查询期间所有绘制中通过深度测试的样本数；
+ * - 不同渲染模式对同一 draw 内 overdraw 的统计方式不同（TBDR/DEFERRED
+ *   只统计最终胜出像素），但“是否为 0”的判定在各模式下一致；
+ * - CPU 渲染为同步执行，EndQuery 之后结果立即可用。
+ */
+class OcclusionQuery {
+ public:
+  OcclusionQuery() = default;
+  OcclusionQuery(const OcclusionQuery&) = default;
+  OcclusionQuery& operator=(const OcclusionQuery&) = default;
+  ~OcclusionQuery() = default;
+
+  /// 通过深度测试的样本数
+  [[nodiscard]] uint64_t GetSamplesPassed() const { return samples_passed_; }
+  /// 是否有任意样本通过（ANY_SAMPLES_PASSED 语义）
+  [[nodiscard]] bool AnySamplesPassed() const { return samples_passed_ > 0; }
+  /// 查询是否已结束且结果可读
+  [[nodiscard]] bool IsResultAvailable() const { return result_available_; }
+  /// 查询是否处于 Begin/End 之间
+  [[nodiscard]] bool IsActive() const { return active_; }
+
+ private:
+  friend class SimpleRenderer;
+
+  uint64_t samples_passed_ = 0;
+  bool active_ = false;
+  bool result_available_ = false;
+};
+
+}  // namespace simple_renderer
+
+#endif  // SIMPLERENDER_SRC_INCLUDE_OCCLUSION_QUERY_HPP_
@@ -0,0 +1,211 @@
+#ifndef SIMPLERENDER_SRC_INCLUDE_RASTER_KERNEL_HPP_
+#define SIMPLERENDER_SRC_INCLUDE_RASTER_KERNEL_HPP_
+
+#include <cmath>
+#include <cstdint>
+
+#include "clipping.hpp"
+#include "edge_function.hpp"
+#include "math.hpp"
+
+namespace simple_renderer {
+
+/// 光栅化内核一次处理的像素数（一个块行）
+inline constexpr int32_t kRasterLanes = kRasterBlockSize;
+
+/**
+ * @brief 视口宽、高的上限（像素），渲染器构造时检查
+ *
+ * 保护带内顶点与视口内像素的定点坐标之差不超过 kMaxRasterCoordinate，
+ * 边函数（两个差的乘积之差）的绝对值不超过 kMaxEdgeFunctionMagnitude。
+ * SIMD 内核的 int64 -> double 转换只在 |v| < 2^51 时精确。
+ */
+inline constexpr size_t kMaxViewportExtent = 4096;
+
+/// 定点坐标差的上限
+inline constexpr int64_t kMaxRasterCoordinate =
+    static_cast<int64_t>(kGuardBand) *
+    static_cast<int64_t>(kMaxViewportExtent) * kSubPixelScale;
+
+/// 边函数绝对值的上限
+inline constexpr int64_t kMaxEdgeFunctionMagnitude =
+    2 * kMaxRasterCoordinate * kMaxRasterCoordinate;
+
+static_assert(kMaxEdgeFunctionMagnitude < (int64_t{1} << 51),
+              "edge functions must stay within the exact int64 -> double "
+              "range of the SIMD raster kernels");
+
+/**
+ * @brief 光栅化内核的指令集
+ */
+enum class RasterIsa : uint8_t {
+  kScalar,
+  kSse42,
+  kAvx2,
+  kAvx512,
+};
+
+/**
+ * @brief 三角形级的光栅化常量
+ *
+ * 透视校正插值使用屏幕空间平面方程，系数在建立时计算：
+ * - e_k * persp[k] 即 b_k / w_k（b_k 为屏幕空间重心坐标），三者之和为 1/w，
+ *   透视校正重心坐标为 (b_k / w_k) / (1/w)，每像素只需一次倒数；
+ * - NDC 深度在屏幕空间线性，z = Σ e_k * depth[k]。
+ * 边函数 e_k 为整数且沿 x / y 整数增量推进，平面求值没有累积误差。
+ */
+struct RasterTriangle {
+  int64_t step_x[3];  //!< 边函数沿 x 一个像素的增量
+  int64_t bias[3];    //!< 填充规则偏置
+  float persp[3];     //!< (1 / w_k) / area
+  float depth[3];     //!< z_k / area
+
+  /**
+   * @brief 像素处的透视校正重心坐标与深度（标量参考，各内核与之逐位一致）
+   * @param e 像素处的三条边函数值
+   * @param b 输出：透视校正后的重心坐标
+   * @param z 输出：深度
+   */
+  void Interpolate(const int64_t e[3], float b[3], float& z) const {
+    const float f0 = static_cast<float>(e[0]);
+    const float f1 = static_cast<float>(e[1]);
+    const float f2 = static_cast<float>(e[2]);
+    const float p0 = f0 * persp[0];
+    const float p1 = f1 * persp[1];
+    const float p2 = f2 * persp[2];
+    const float w = 1.0f / (p0 + p1 + p2);
+    b[0] = p0 * w;
+    b[1] = p1 * w;
+    b[2] = p2 * w;
+    z = f0 * depth[0] + f1 * depth[1] + f2 * depth[2];
+  }
+};
+
+/**
+ * @brief 由三角形建立结果与屏幕空间顶点构造光栅化常量
+ *
+ * 屏幕空间顶点的 w 分量已是 1 / w_clip（透视除法时保存），直接作为
+ * 透视校正的权重。
+ */
+inline RasterTriangle MakeRasterTriangle(const TriangleSetup& setup,
+                                         const Vector4f& p0,
+                                         const Vector4f& p1,
+                                         const Vector4f& p2) {
+  return {{setup.step_x[0], setup.step_x[1], setup.step_x[2]},
+          {setup.bias[0], setup.bias[1], setup.bias[2]},
+          {p0.w * setup.inv_area, p1.w * setup.inv_area,
+           p2.w * setup.inv_area},
+          {p0.z * setup.inv_area, p1.z * setup.inv_area, p2.z * setup.inv_area}};
+}
+
+/**
+ * @brief 像素所在 2x2 quad 的属性差分（粗粒度导数，quad 内四个像素共享）
+ *
+ * quad 左上像素为 (x & ~1, y & ~1)，ddx / ddy 分别为其右侧、下方像素与它的
+ * 属性之差。quad 内未被覆盖的像素作为辅助像素照常按平面方程求值，
+ * 因此结果只取决于三角形与 quad 位置，与遍历顺序、渲染器无关。
+ * @param setup 三角形建立结果
+ * @param tri 光栅化常量
+ * @param attr 三个顶点的属性
+ * @param x, y 像素坐标（非负）
+ * @param ddx, ddy 输出：沿屏幕 x / y 一个像素的属性变化量；
+ *        辅助像素外推得到非有限值时为 0
+ */
+inline void QuadDerivatives(const TriangleSetup& setup,
+                            const RasterTriangle& tri, const Vector2f attr[3],
+                            int32_t x, int32_t y, Vector2f& ddx,
+                            Vector2f& ddy) {
+  const int32_t qx = x & ~1;
+  const int32_t qy = y & ~1;
+  const int64_t e00[3] = {setup.Evaluate(0, qx, qy), setup.Evaluate(1, qx, qy),
+                          setup.Evaluate(2, qx, qy)};
+  const int64_t e10[3] = {e00[0] + setup.step_x[0], e00[1] + setup.step_x[1],
+                          e00[2] + setup.step_x[2]};
+  const int64_t e01[3] = {e00[0] + setup.step_y[0], e00[1] + setup.step_y[1],
+                          e00[2] + setup.step_y[2]};
+  const auto at = [&](const int64_t e[3]) {
+    float b[3], z;
+    tri.Interpolate(e, b, z);
+    return attr[0] * b[0] + attr[1] * b[1] + attr[2] * b[2];
+  };
+  const Vector2f a00 = at(e00);
+  ddx = at(e10) - a00;
+  ddy = at(e01) - a00;
+  if (!std::isfinite(ddx.x + ddx.y + ddy.x + ddy.y)) {
+    ddx = Vector2f(0.0f);
+    ddy = Vector2f(0.0f);
+  }
+}
+
+/**
+ * @brief 一行 kRasterLanes 个像素的输入
+ */
+struct RasterRow {
+  int64_t e[3];            //!< 第 0 个像素处的三条边函数值
+  int32_t lanes;           //!< 有效像素数（<= kRasterLanes）
+  bool test_coverage;      //!< false 表示整行在三角形内，跳过边函数测试
+  const float* depth;      //!< 第 0 个像素的深度，nullptr 表示不做深度测试
+  float depth_epsilon;     //!< 深度测试条件：z < depth - depth_epsilon
+};
+
+/**
+ * @brief 一行的结果：存活像素（覆盖且通过深度测试）按通道顺序压缩存放
+ */
+struct RasterRowResult {
+  uint32_t cover_mask;  //!< 覆盖掩码（含填充规则）
+  uint32_t count;       //!< 存活像素数
+  alignas(32) int32_t lane[kRasterLanes];
+  alignas(32) float b0[kRasterLanes];  //!< 透视校正后的重心坐标
+  alignas(32) float b1[kRasterLanes];
+  alignas(32) float b2[kRasterLanes];
+  alignas(32) float z[kRasterLanes];
+};
+
+/**
+ * @brief 行光栅化内核：边函数求值、覆盖掩码、透视校正重心坐标、
+ *        深度插值与深度测试
+ *
+ * 各指令集版本与 RasterTriangle::Interpolate 逐位一致（边函数为整数，
+ * 浮点运算顺序相同，倒数用精确除法而非近似指令，不使用 FMA），
+ * 因此渲染结果与所选内核无关。
+ */
+using RasterRowKernel = void (*)(const RasterTriangle& tri,
+                                 const RasterRow& row, RasterRowResult& out);
+
+/// 标量参考实现
+void RasterRowScalar(const RasterTriangle& tri, const RasterRow& row,
+                     RasterRowResult& out);
+
+#if defined(SIMPLE_RENDERER_X86_KERNELS)
+// 各指令集版本位于独立编译单元（src/CMakeLists.txt 中设置目标指令集）
+void RasterRowSse42(const RasterTriangle& tri, const RasterRow& row,
+                    RasterRowResult& out);
+void RasterRowAvx2(const RasterTriangle& tri, const RasterRow& row,
+                   RasterRowResult& out);
+void RasterRowAvx512(const RasterTriangle& tri, const RasterRow& row,
+                     RasterRowResult& out);
+#endif
+
+/**
+ * @brief 通过 CPUID 检测可用的最高指令集
+ *
+ * 未编译多版本内核（SIMPLE_RENDERER_X86_KERNELS 未定义）时为 kScalar。
+ */
+RasterIsa DetectRasterIsa();
+
+/**
+ * @brief 获取指定指令集的内核
+ *
+ * 当前平台未编译该版本，或本机 CPU 不支持该指令集（见 DetectRasterIsa）时
+ * 返回标量版本。
+ */
+RasterRowKernel GetRasterRowKernel(RasterIsa isa);
+
+/**
+ * @brief 获取本机可用的最快内核（首次调用时检测并缓存）
+ */
+RasterRowKernel GetRasterRowKernel();
+
+}  // namespace simple_renderer
+
+#endif  // SIMPLERENDER_SRC_INCLUDE_RASTER_KERNEL_HPP_
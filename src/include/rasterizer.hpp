@@ -1,12 +1,27 @@
 #ifndef SIMPLERENDER_SRC_INCLUDE_RASTERIZER_HPP_
 #define SIMPLERENDER_SRC_INCLUDE_RASTERIZER_HPP_
 
+#include <array>
+#include <functional>
+#include <span>
+
 #include "config.h"
 #include "shader.hpp"
 #include "vertex.hpp"
 
 namespace simple_renderer {
 
+/// 流式光栅化每批交付的最大片段数
+inline constexpr size_t kFragmentBatchSize = 32;
+
+/**
+ * @brief 片段批的接收者
+ *
+ * 在调用 Rasterize 的线程上按扫描顺序被调用，每次收到至多
+ * kFragmentBatchSize 个片段；片段只在调用期间有效，可以就地修改。
+ */
+using FragmentSink = std::function<void(std::span<Fragment>)>;
+
 class Rasterizer {
  public:
   Rasterizer() = default;
@@ -24,30 +39,34 @@ class Rasterizer {
   Rasterizer(size_t width, size_t height);
 
   /**
-   * @brief 光栅化三角形，生成片段列表
+   * @brief 光栅化三角形，片段按批交给 sink
+   * @param v0 三角形第一个顶点
+   * @param v1 三角形第二个顶点
+   * @param v2 三角形第三个顶点
+   * @param sink 片段批的接收者
+   */
+  void Rasterize(const Vertex& v0, const Vertex& v1, const Vertex& v2,
+                 const FragmentSink& sink);
+
+  /**
+   * @brief 光栅化三角形，只插值声明的 varyings，片段按批交给 sink
+   *
+   * 在调用线程上完成，不开启并行区域、不分配堆内存；片段在栈上攒满
+   * kFragmentBatchSize 个（或三角形结束）时交付一次。
    * @param v0 三角形第一个顶点
    * @param v1 三角形第二个顶点
    * @param v2 三角形第三个顶点
-   * @return 生成的片段向量
+   * @param world_positions 三个顶点的世界空间位置（kVaryingWorldPosition）
+   * @param varyings 需要插值的属性（Shader::GetVaryings()）
+   * @param sink 片段批的接收者
    */
-  std::vector<Fragment> Rasterize(const Vertex& v0, const Vertex& v1,
-                                  const Vertex& v2);
+  void Rasterize(const Vertex& v0, const Vertex& v1, const Vertex& v2,
+                 const std::array<Vector3f, 3>& world_positions,
+                 VaryingMask varyings, const FragmentSink& sink);
 
  private:
   size_t width_, height_;
 
-  // 透视矫正结果
-  struct PerspectiveCorrectionResult {
-    Vector3f corrected_barycentric;
-    float interpolated_z;
-  };
-
-  // 透视矫正helper函数
-  PerspectiveCorrectionResult PerformPerspectiveCorrection(
-      float w0, float w1, float w2,
-      float z0, float z1, float z2,
-      const Vector3f& original_barycentric) const;
-
   template <typename T>
   T Interpolate(const T& v0, const T& v1, const T& v2,
                 const Vector3f& barycentric_coord) const;
@@ -56,11 +75,6 @@ class Rasterizer {
                          const Color& color2,
                          const Vector3f& barycentric_coord) const;
 
-  std::pair<bool, Vector3f> GetBarycentricCoord(const Vector3f& p0,
-                                                const Vector3f& p1,
-                                                const Vector3f& p2,
-                                                const Vector3f& pa);
-
   // Calculate the normal vector based on the vertices
   // 根据顶点计算法向量
   Vector3f CalculateNormal(const Vector3f& v0, const Vector3f& v1,
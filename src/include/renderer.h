@@ -21,8 +21,10 @@
 #include <memory>
 #include <string>
 
+#include "depth_pyramid.hpp"
 #include "log_system.h"
 #include "model.hpp"
+#include "occlusion_query.hpp"
 #include "shader.hpp"
 #include "renderers/renderer_base.hpp"
 
@@ -63,6 +65,7 @@ class SimpleRenderer {
    * @brief 构造渲染器门面
    * @param width 画布宽度（像素）
    * @param height 画布高度（像素）
+   * @throw std::invalid_argument 宽或高超过 kMaxViewportExtent
    */
   SimpleRenderer(size_t width, size_t height);
   ~SimpleRenderer() = default;
@@ -76,6 +79,75 @@ class SimpleRenderer {
    */
   bool DrawModel(const Model &model, const Shader &shader, uint32_t *buffer);
 
+  /**
+   * @brief 开始一帧
+   *
+   * 清除帧深度缓冲。BeginFrame/EndFrame 之间的多次 DrawModel 共享深度，
+   * 且不会清除输出缓冲中已有的颜色（由调用方负责清屏）。
+   * 未调用 BeginFrame 时，每次 DrawModel 独立清除深度与颜色。
+   */
+  void BeginFrame();
+  /**
+   * @brief 结束一帧
+   */
+  void EndFrame();
+
+  /**
+   * @brief 开始遮挡查询，之后的绘制将累计通过深度测试的样本数
+   * @param query 查询对象，EndQuery 之前需保持有效
+   */
+  void BeginQuery(OcclusionQuery &query);
+  /**
+   * @brief 结束当前遮挡查询，结果立即可用
+   */
+  void EndQuery();
+
+  /**
+   * @brief 仅深度的包围盒代理绘制
+   *
+   * 不写颜色与深度，只将包围盒与当前深度缓冲比较并计入当前查询。
+   * 适合在 BeginFrame 之后、先绘制遮挡体，再用代理盒判断物体是否可见。
+   * 在 BeginFrame/EndFrame 之外调用时没有共享深度，包围盒视为可见。
+   * @param bmin 模型空间包围盒最小点
+   * @param bmax 模型空间包围盒最大点
+   * @param shader 着色器（提供 MVP）
+   * @return 通过深度测试的样本数（保守估计）
+   */
+  uint64_t DrawBoundingBox(const Vector3f &bmin, const Vector3f &bmax,
+                           const Shader &shader);
+
+  /**
+   * @brief 启用或禁用 Hi‑Z 遮挡剔除
+   *
+   * 启用后 DrawModel 在顶点阶段之前用模型包围盒测试深度金字塔，
+   * 被完全遮挡或位于视锥体外的模型直接跳过（样本数计为 0）。
+   * 仅在 BeginFrame/EndFrame 之间生效；帧外的绘制照常清除颜色与深度。
+   * 金字塔来源：
+   * - 默认在 EndFrame 时由本帧深度构建，供下一帧使用。未做重投影，
+   *   相机或物体快速运动时可能在一帧内误剔除新暴露的物体；
+   * - 也可在帧内先绘制遮挡体，再调用 UpdateOcclusionPyramid 以当前深度构建。
+   */
+  void SetOcclusionCullingEnabled(bool enabled);
+  /**
+   * @brief 用当前帧已绘制的深度重建深度金字塔（遮挡体通道之后调用）
+   * @note 仅能在 BeginFrame/EndFrame 之间调用
+   */
+  void UpdateOcclusionPyramid();
+
+  /**
+   * @brief 启用或禁用按屏幕大小选择 LOD
+   *
+   * 启用后 DrawModel 根据模型包围球的投影大小，从 Model::GenerateLods
+   * 生成的 LOD 链中选择屏幕误差不超过阈值的最粗级别。未生成 LOD 的模型
+   * 不受影响。
+   */
+  void SetLodEnabled(bool enabled);
+  /**
+   * @brief 设置 LOD 选择允许的屏幕误差
+   * @param pixels 像素数，默认 1
+   */
+  void SetLodErrorThreshold(float pixels);
+
   /**
    * @brief 设置渲染模式
    */
@@ -94,6 +166,16 @@ class SimpleRenderer {
    * @brief 设置 Tile 大小（仅 TBR 有效）
    */
   void SetTileSize(size_t tile_size);
+  /**
+   * @brief 设置 MSAA 样本数（仅 TBR / TBDR 有效）
+   *
+   * 每像素着色一次，覆盖与深度按样本测试，tile 写回时解析为像素颜色。
+   * 帧内各样本的深度与颜色由渲染器保留，跨绘制调用从样本继续；
+   * 帧深度缓冲与输出缓冲保存解析结果（深度为样本最大值），
+   * 帧内不应由调用方修改输出缓冲。
+   * @param samples 1（关闭）/ 2 / 4，其他值抛出 std::invalid_argument
+   */
+  void SetMsaaSamples(uint32_t samples);
 
  private:
   void EnsureRenderer();
@@ -108,6 +190,24 @@ class SimpleRenderer {
   // TBR 配置缓存：在创建 TileBasedRenderer 时下发
   bool tbr_early_z_ = true;
   size_t tbr_tile_size_ = 64;
+  uint32_t msaa_samples_ = 1;
+
+  // 帧深度缓冲：由门面持有，切换渲染模式后仍然有效
+  // 清除值为 NDC 远平面，与 TBR/TBDR 的 tile 深度清除值一致
+  static constexpr float kFrameDepthClear = 1.0f;
+  std::unique_ptr<float[]> frame_depth_;
+  bool frame_active_ = false;
+
+  // 当前遮挡查询（未激活时为空）
+  OcclusionQuery *active_query_ = nullptr;
+
+  // Hi‑Z 遮挡剔除：金字塔由门面持有，跨帧保留
+  bool occlusion_culling_ = false;
+  DepthPyramid pyramid_;
+
+  // 屏幕大小 LOD 选择
+  bool lod_enabled_ = false;
+  float lod_error_threshold_ = 1.0f;
 };
 }  // namespace simple_renderer
 
@@ -2,9 +2,11 @@
 #ifndef SIMPLERENDER_SRC_INCLUDE_RENDERERS_RENDERER_BASE_HPP_
 #define SIMPLERENDER_SRC_INCLUDE_RENDERERS_RENDERER_BASE_HPP_
 
+#include <array>
 #include <cstdint>
 #include <memory>
 
+#include "depth_pyramid.hpp"
 #include "rasterizer.hpp"
 #include "vertex.hpp"
 #include "model.hpp"
@@ -12,6 +14,112 @@
 
 namespace simple_renderer {
 
+/**
+ * @brief 连续索引区间 [begin, end)
+ */
+struct IndexRange {
+  size_t begin = 0;
+  size_t end = 0;
+};
+
+/**
+ * @brief 齐次空间裁剪产生的三角形
+ *
+ * indices 为 VertexSoA 中追加在模型顶点之后的顶点，face 为来源面
+ * （提供材质）。
+ */
+struct ClippedTriangle {
+  std::array<uint32_t, 3> indices;
+  uint32_t face = 0;
+};
+
+/**
+ * @brief 剔除后仍可见的几何（按偏移升序、相邻合并）
+ *
+ * - vertices 为可见网格实例的顶点区间；若 vertex_mask 非空，
+ *   区间内只有被可见 meshlet 引用的顶点需要变换；
+ * - faces 为可见 meshlet 的面区间；
+ * - triangles 为逐三角形剔除后存活、无需裁剪的面（升序），
+ *   clip_faces 为跨越近平面或保护带的面，均由 ProcessPositions 填充，
+ *   此后 vertex_mask 只标记这两类面引用的顶点；
+ * - clipped 为 clip_faces 裁剪后存活的三角形，由 ClipTriangles 填充。
+ */
+struct VisibleRanges {
+  std::vector<IndexRange> vertices;
+  std::vector<IndexRange> faces;
+  std::vector<uint32_t> triangles;
+  std::vector<uint32_t> clip_faces;
+  std::vector<ClippedTriangle> clipped;
+  std::vector<uint8_t> vertex_mask;
+  size_t vertex_count = 0;
+  size_t face_count = 0;
+
+  [[nodiscard]] bool NeedsVertex(size_t index) const {
+    return vertex_mask.empty() || vertex_mask[index] != 0;
+  }
+};
+
+/**
+ * @brief 帧模式下的 MSAA 样本缓冲
+ *
+ * 按样本主序存放 samples 个平面，第 s 个样本位于 depth/color + s * plane，
+ * 平面行跨度为画布宽度。
+ */
+struct FrameSampleBuffers {
+  float* depth = nullptr;
+  uint32_t* color = nullptr;
+  size_t plane = 0;
+};
+
+/**
+ * @brief 按声明的 varyings 从 SoA 属性流插值片段属性
+ *
+ * 只插值 varyings 中声明的属性，其余 Fragment 字段保持不变。
+ * @param soa ProcessAttributes 输出的属性流
+ * @param i0, i1, i2 三角形顶点索引
+ * @param b0, b1, b2 透视校正后的重心坐标
+ * @param varyings Shader::GetVaryings()
+ * @param frag 输出片段
+ */
+inline void InterpolateVaryings(const VertexSoA& soa, size_t i0, size_t i1,
+                                size_t i2, float b0, float b1, float b2,
+                                VaryingMask varyings, Fragment& frag) {
+  if ((varyings & kVaryingNormal) != 0) {
+    frag.normal = soa.normal[i0] * b0 + soa.normal[i1] * b1 +
+                  soa.normal[i2] * b2;
+  }
+  if ((varyings & kVaryingTexCoords) != 0) {
+    frag.uv = soa.uv[i0] * b0 + soa.uv[i1] * b1 + soa.uv[i2] * b2;
+  }
+  if ((varyings & kVaryingColor) != 0) {
+    const Color& c0 = soa.color[i0];
+    const Color& c1 = soa.color[i1];
+    const Color& c2 = soa.color[i2];
+    const auto channel = [&](uint8_t c) {
+      return FloatToUint8_t(static_cast<float>(c0[c]) * b0 +
+                            static_cast<float>(c1[c]) * b1 +
+                            static_cast<float>(c2[c]) * b2);
+    };
+    frag.color = Color(channel(Color::kColorIndexRed),
+                       channel(Color::kColorIndexGreen),
+                       channel(Color::kColorIndexBlue));
+  }
+  if ((varyings & kVaryingWorldPosition) != 0) {
+    frag.world_position = soa.world_position[i0] * b0 +
+                          soa.world_position[i1] * b1 +
+                          soa.world_position[i2] * b2;
+  }
+}
+
+/**
+ * @brief 簇（meshlet）剔除所需的每次绘制常量，均在模型空间
+ */
+struct ClusterCullContext {
+  Matrix4f mvp = Matrix4f(1.0f);
+  Vector4f planes[6];                //!< 归一化视锥体平面 (n, d)，内侧 dot(n,p)+d >= 0
+  Vector3f eye = Vector3f(0.0f);     //!< 相机位置
+  bool cone_enabled = false;         //!< 镜像变换（行列式 < 0）时关闭法线锥剔除
+};
 
 /**
  * @brief 渲染器抽象基类
@@ -23,8 +131,12 @@ namespace simple_renderer {
  */
 class RendererBase {
  public:
-  RendererBase(size_t width, size_t height)
-      : width_(width), height_(height), rasterizer_(std::make_shared<Rasterizer>(width, height)) {}
+  /**
+   * @brief 构造渲染器
+   * @param width, height 视口大小，均不超过 kMaxViewportExtent
+   * @throw std::invalid_argument 视口超过 kMaxViewportExtent
+   */
+  RendererBase(size_t width, size_t height);
   virtual ~RendererBase() = default;
 
   RendererBase(const RendererBase&) = delete;
@@ -39,6 +151,69 @@ class RendererBase {
    */
   virtual bool Render(const Model& model, const Shader& shader, uint32_t* out_color) = 0;
 
+  /**
+   * @brief 绑定帧深度缓冲
+   *
+   * - 非空：帧模式。Render 从该缓冲加载深度、从 out_color 加载颜色，
+   *   绘制之间保留深度（类似 GPU render pass 的 load/store）；
+   * - 空：独立绘制模式。每次 Render 清除深度与颜色（原有行为）。
+   * @param depth_buffer 大小为 width*height 的深度缓冲，由调用方持有
+   */
+  void SetFrameDepthBuffer(float* depth_buffer) {
+    frame_depth_ = depth_buffer;
+    frame_samples_count_ = 0;
+  }
+
+  /**
+   * @brief 上一次 Render 中通过深度测试的样本数
+   */
+  [[nodiscard]] uint64_t GetSamplesPassed() const { return samples_passed_; }
+
+  /**
+   * @brief 仅深度的包围盒遮挡测试（不写颜色与深度）
+   *
+   * 将包围盒 8 个角点变换到屏幕空间，以其屏幕矩形与最近深度作为保守代理，
+   * 与当前帧深度缓冲比较。结果为上界：返回 0 时包围盒一定被完全遮挡。
+   * 未绑定帧深度缓冲（帧外）时没有共享深度，屏幕矩形内的样本全部计为通过。
+   * @param bmin 模型空间包围盒最小点
+   * @param bmax 模型空间包围盒最大点
+   * @param shader 着色器（提供 MVP）
+   * @return 通过深度测试的样本数（保守估计）
+   */
+  uint64_t TestBoundingBox(const Vector3f& bmin, const Vector3f& bmax,
+                           const Shader& shader);
+
+  /**
+   * @brief 绑定用于遮挡剔除的深度金字塔
+   * @param pyramid 由调用方持有；为空时关闭 Hi‑Z 遮挡剔除
+   */
+  void SetOcclusionPyramid(const DepthPyramid* pyramid) { pyramid_ = pyramid; }
+
+  /**
+   * @brief 包围盒剔除：视锥体外或被 Hi‑Z 金字塔完全遮挡
+   *
+   * 在顶点阶段之前调用，只变换 8 个角点。未绑定金字塔时仅做视锥体剔除。
+   * @param bmin 模型空间包围盒最小点
+   * @param bmax 模型空间包围盒最大点
+   * @param mvp 模型-视图-投影矩阵
+   * @return true 表示可以跳过绘制
+   */
+  bool IsBoundingBoxCulled(const Vector3f& bmin, const Vector3f& bmax,
+                           const Matrix4f& mvp);
+
+  /**
+   * @brief 按投影包围球大小选择 LOD 级别
+   *
+   * 将各级的模型空间几何误差投影到包围球最近点所在深度，
+   * 返回屏幕误差不超过阈值的最粗级别。包围球跨越近平面时返回 0。
+   * @param model 第 0 级模型（持有 LOD 链）
+   * @param mvp 模型-视图-投影矩阵
+   * @param max_error_pixels 允许的屏幕误差（像素）
+   * @return LOD 级别，可直接传给 Model::GetLod
+   */
+  size_t SelectLod(const Model& model, const Matrix4f& mvp,
+                   float max_error_pixels) const;
+
  protected:
   /**
    * @brief 透视除法：裁剪空间 -> NDC
@@ -53,12 +228,129 @@ class RendererBase {
    */
   Vertex ViewportTransformation(const Vertex& vertex);
 
+  /**
+   * @brief 将模型空间包围盒投影为保守的屏幕矩形与深度范围
+   * @param bmin 模型空间包围盒最小点
+   * @param bmax 模型空间包围盒最大点
+   * @param mvp 模型-视图-投影矩阵
+   */
+  ScreenBounds ProjectBoundingBox(const Vector3f& bmin, const Vector3f& bmax,
+                                  const Matrix4f& mvp) const;
+
+  /**
+   * @brief 实例级与 meshlet 级剔除，收集可见的顶点/面区间
+   *
+   * 在顶点阶段之前调用：
+   * 1) 遍历实例 BVH，剔除视锥体外（及被 Hi‑Z 遮挡，若已绑定）的网格实例；
+   * 2) 对可见实例的每个 meshlet 依次做包围球视锥体、法线锥背面与 Hi‑Z 剔除。
+   * 被剔除的几何不做顶点变换也不参与光栅化。模型无实例信息时返回整个模型。
+   * @param model 模型
+   * @param shader 着色器（提供 MVP 与 Model-View）
+   */
+  VisibleRanges CollectVisibleRanges(const Model& model, const Shader& shader);
+
+  /**
+   * @brief 仅位置的第一遍顶点处理与逐三角形剔除
+   *
+   * 从模型的世界空间顶点缓存（Model::GetWorldVertices）出发，以
+   * TransformVertexBatch 批量计算 visible 中需要的顶点的裁剪/屏幕坐标与
+   * 裁剪码，随后对可见面做视锥体（裁剪码按位与非零）、背面与零面积剔除。
+   * 跨越近平面或保护带的面不做屏幕空间测试，记入 visible.clip_faces，
+   * 由 ClipTriangles 处理。完成后 visible.triangles 为存活面，
+   * visible.vertex_mask 收缩为存活面与待裁剪面引用的顶点，
+   * 法线/UV 等属性只需为这些顶点计算。
+   * @param model 模型
+   * @param shader 着色器（只使用模型矩阵与视图-投影矩阵）
+   * @param visible 输入可见区间，输出存活面与属性顶点掩码
+   * @param soa 输出：pos_clip、pos_screen 与 clip_code（按模型顶点索引），
+   *        屏幕坐标为 (x, y, z_ndc, 1/w)
+   */
+  void ProcessPositions(const Model& model, const Shader& shader,
+                        VisibleRanges& visible, VertexSoA& soa);
+
+  /**
+   * @brief 属性阶段：为存活三角形的顶点解码属性并执行顶点着色器
+   *
+   * 在 ProcessPositions 之后调用，只处理 visible.vertex_mask 标记的顶点。
+   * 按批以 DecodeAttributeBatch 解码 UV 与颜色（紧凑顶点格式在此解码），
+   * 法线取自世界空间顶点缓存，再逐顶点调用 Shader::WorldVertexShader，
+   * 结果写入 soa 的属性流；声明了 kVaryingWorldPosition 时同时写入世界空间位置。
+   * 着色器未声明任何 varying 时直接返回。
+   * @param model 模型
+   * @param shader 着色器
+   * @param visible ProcessPositions 处理后的可见几何
+   * @param soa 输入 pos_clip；输出 normal、uv、color 与 world_position
+   *        （按模型顶点索引）
+   */
+  void ProcessAttributes(const Model& model, Shader& shader,
+                         const VisibleRanges& visible, VertexSoA& soa);
+
+  /**
+   * @brief 在齐次空间裁剪跨越近平面或保护带的三角形
+   *
+   * 在 ProcessAttributes 之后调用。对 visible.clip_faces 中的每个面做
+   * 近平面与保护带裁剪（ClipTriangle），裁剪多边形的顶点连同插值后的属性
+   * 追加到 soa 的模型顶点之后，扇形三角化后经背面与零面积剔除写入
+   * visible.clipped。裁剪后的顶点 w > 0，屏幕坐标不会退化为全屏包围盒。
+   * @param visible 输入 clip_faces，输出 clipped
+   * @param soa 追加裁剪顶点（位置与属性流）
+   */
+  void ClipTriangles(const Model& model, VisibleRanges& visible,
+                     VertexSoA& soa);
+
+  /**
+   * @brief 构建 meshlet 剔除常量（视锥体平面、模型空间相机位置）
+   */
+  static ClusterCullContext MakeClusterCullContext(const Matrix4f& mvp,
+                                                   const Matrix4f& model_view);
+  /**
+   * @brief 判断 meshlet 是否可整体跳过
+   */
+  bool IsMeshletCulled(const Meshlet& meshlet, const ClusterCullContext& ctx);
+
+  /**
+   * @brief 获取本次绘制使用的深度缓冲
+   *
+   * 帧模式下返回帧深度缓冲（不清除）；否则返回渲染器内部缓冲并以 clear_value 清除。
+   * @param clear_value 独立绘制模式下的深度清除值
+   */
+  float* AcquireDepthBuffer(float clear_value);
+  /// 是否处于帧模式（深度/颜色在绘制之间保留）
+  [[nodiscard]] bool IsFrameActive() const { return frame_depth_ != nullptr; }
+  /**
+   * @brief 获取帧模式下的 MSAA 样本缓冲
+   *
+   * 绘制之间保留逐样本的深度与颜色：若只保留解析后的像素值，部分覆盖的
+   * 边缘像素会以样本最大深度（常为清除值）广播到全部样本，之后更远的
+   * 物体会覆盖先前绘制的边缘。帧内首次获取（或样本数变化）时以帧深度
+   * 缓冲与 color 广播初始化；帧深度缓冲与 color 仍保存解析结果。
+   * @param samples 样本数（大于 1）
+   * @param color 输出颜色缓冲（width*height）
+   * @return 样本缓冲；非帧模式下为空
+   */
+  FrameSampleBuffers AcquireFrameSamples(uint32_t samples,
+                                         const uint32_t* color);
+
  protected:
   size_t width_;
   size_t height_;
   std::shared_ptr<Rasterizer> rasterizer_;
+  /// 上一次 Render 通过深度测试的样本数（供遮挡查询使用）
+  uint64_t samples_passed_ = 0;
+
+  /// Hi‑Z 遮挡剔除使用的深度金字塔（可为空）
+  const DepthPyramid* pyramid_ = nullptr;
 
   static constexpr float kMinWValue = 1e-6f;
+
+ private:
+  float* frame_depth_ = nullptr;
+  std::unique_ptr<float[]> own_depth_;
+  /// 帧模式 MSAA 样本缓冲；样本数为 0 表示本帧尚未初始化
+  std::unique_ptr<float[]> frame_sample_depth_;
+  std::unique_ptr<uint32_t[]> frame_sample_color_;
+  uint32_t frame_samples_count_ = 0;
+  uint32_t frame_samples_capacity_ = 0;
 };
 
 }  // namespace simple_renderer
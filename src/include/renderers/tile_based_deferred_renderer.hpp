@@ -17,21 +17,23 @@ namespace simple_renderer {
  *   2) 延迟着色：仅对胜者像素执行一次片元着色，写入 tile 局部缓冲，最后整 Tile 拷贝到全局。
  *
  * 优势：显著减少overdraw场景中的无效着色（FragmentShader 调用次数近似等于胜出像素数）。
+ *
+ * MSAA：Z 决胜按样本进行（样本深度与胜者只存在于 tile 局部缓冲），
+ * 着色阶段每个像素对其样本的每个不同胜者三角形着色一次，tile 写回时解析。
  */
 class TileBasedDeferredRenderer final : public RendererBase {
  public:
-  TileBasedDeferredRenderer(size_t width, size_t height, size_t tile_size = 64)
-      : RendererBase(width, height), tile_size_(tile_size) {}
+  TileBasedDeferredRenderer(size_t width, size_t height, size_t tile_size = 64,
+                            uint32_t msaa_samples = 1)
+      : RendererBase(width, height), tile_size_(tile_size), msaa_samples_(msaa_samples) {}
 
   bool Render(const Model& model, const Shader& shader, uint32_t* out_color) override;
 
  private:
-  void TriangleTileBinning(const Model& model,
-                           const TileGridContext& grid,
+  void TriangleTileBinning(const TileGridContext& grid,
                            std::vector<std::vector<TileTriangleRef>>& tile_triangles);
 
-  void ProcessTriangleForTileBinning(size_t tri_idx, bool count_only,
-                                     const Model& model,
+  void ProcessTriangleForTileBinning(const TileTriangleRef& tri_ref, bool count_only,
                                      const TileGridContext& grid,
                                      std::vector<size_t>& tile_counts,
                                      std::vector<std::vector<TileTriangleRef>>& tile_triangles);
@@ -40,18 +42,40 @@ class TileBasedDeferredRenderer final : public RendererBase {
                              const std::vector<TileTriangleRef>& triangles,
                              const TileGridContext& grid,
                              float* tile_depth_buffer, uint32_t* tile_color_buffer,
-                             std::unique_ptr<float[]>& global_depth_buffer,
-                             std::unique_ptr<uint32_t[]>& global_color_buffer,
+                             float* global_depth_buffer,
+                             uint32_t* global_color_buffer,
                              const Shader& shader,
                              uint64_t* out_tested, uint64_t* out_covered,
                              uint64_t* out_winners, uint64_t* out_shaded);
 
+  // RasterizeTileDeferredMsaa 的按线程暂存区，由 Render 按 tile_size² * 样本数分配
+  struct MsaaTileScratch {
+    std::unique_ptr<float[]> zmin;        // 样本 zmin
+    std::unique_ptr<int32_t[]> winner;    // 样本胜者（三角形下标）
+    std::unique_ptr<float[]> pixel_zmax;  // 每像素样本 zmin 的最大值（Hi‑Z 输入）
+  };
+
+  // RasterizeTileDeferred 的 MSAA 版本：tile 缓冲为 msaa_samples_ 个样本平面，
+  // 帧模式下样本从 frame_samples 加载并写回
+  void RasterizeTileDeferredMsaa(size_t tile_id,
+                                 const std::vector<TileTriangleRef>& triangles,
+                                 const TileGridContext& grid,
+                                 float* tile_depth_buffer, uint32_t* tile_color_buffer,
+                                 const MsaaTileScratch& scratch,
+                                 float* global_depth_buffer,
+                                 uint32_t* global_color_buffer,
+                                 const FrameSampleBuffers& frame_samples,
+                                 const Shader& shader,
+                                 uint64_t* out_tested, uint64_t* out_covered,
+                                 uint64_t* out_winners, uint64_t* out_shaded);
+
  private:
   // 深度与颜色清除默认值（与 TBR 保持一致）
   static constexpr float kDepthClear = 1.0f;
   static constexpr uint32_t kColorClear = 0u;
 
   const size_t tile_size_;
+  const uint32_t msaa_samples_;
 };
 
 }  // namespace simple_renderer
@@ -1,24 +1,116 @@
 #ifndef SIMPLERENDER_SRC_INCLUDE_RENDERERS_TILE_BASED_RENDERER_HPP_
 #define SIMPLERENDER_SRC_INCLUDE_RENDERERS_TILE_BASED_RENDERER_HPP_
 
+#include "msaa.hpp"
+#include "raster_kernel.hpp"
 #include "renderers/renderer_base.hpp"
 
 namespace simple_renderer {
 
 /**
- * @brief Tile 中的三角形轻量引用（SoA 索引 + 材质指针）
+ * @brief Tile 中的三角形轻量引用（SoA 索引 + 材质指针 + 建立缓冲下标）
+ */
+/**
+ * @brief tile 三角形列表的元素：只保存三角形建立缓冲的下标与路径标记，
+ *        顶点索引与材质由 TriangleSetupBuffer::sources 提供
  */
 struct TileTriangleRef {
-  size_t i0, i1, i2;
+  uint32_t setup = 0; // 在 TriangleSetupBuffer 中的下标
+  bool small = false; // 采样点包围盒不超过 kSmallTriangleStamp，走小三角形路径
+};
+
+/**
+ * @brief 三角形的着色来源：顶点索引、材质与所属面
+ */
+struct TriangleSource {
+  uint32_t i0 = 0, i1 = 0, i2 = 0;
   const Material* material = nullptr;
-  size_t face_index = 0;
+  uint32_t face_index = 0;
 };
 
 struct TileMaskStats {
-  uint64_t tested = 0; // 遍历检测像素总数
+  uint64_t tested = 0; // 逐像素边函数测试的像素数（仅部分覆盖的块）
   uint64_t covered = 0; // 三角形内覆盖测试通过像素数（通过边函数做内点测试成功）
   uint64_t zpass = 0; // 通过early-z测试像素数（深度值小于tile局部深度缓冲）
   uint64_t shaded = 0; // 实际着色并写回像素数（同时通过early-z或late-z测试）
+  uint64_t hiz_triangles = 0; // 被 tile 级 Hi‑Z 整体拒绝的三角形数
+  uint64_t hiz_blocks = 0; // 被块级 Hi‑Z 拒绝的 8x8 块数
+  uint64_t small_triangles = 0; // 走小三角形路径的三角形数
+};
+
+/**
+ * @brief Tile 内的分层深度（Hi‑Z）：每个 8x8 块的深度范围与 tile 最大深度
+ *
+ * 随 tile 光栅化更新，块与 tile 局部深度缓冲的 8x8 网格对齐。
+ * - 三角形最近深度不小于块（tile）的最大深度：块（整个三角形）一定被遮挡；
+ * - 三角形最远深度小于块的最小深度：块内覆盖像素一定通过深度测试。
+ */
+class TileHiZ {
+ public:
+  /**
+   * @brief 由 tile 局部深度缓冲建立
+   * @param depth 局部深度缓冲
+   * @param width tile 宽度
+   * @param height tile 高度
+   * @param stride 深度缓冲的行跨度，0 表示与 width 相同
+   */
+  void Build(const float* depth, size_t width, size_t height, size_t stride = 0);
+  /// 块 (block_x, block_y) 的深度被写入后重新计算其范围
+  void UpdateBlock(const float* depth, size_t block_x, size_t block_y);
+  /// 若干 UpdateBlock 之后重新计算 tile 最大深度
+  void UpdateTile();
+
+  [[nodiscard]] float BlockMin(size_t block_x, size_t block_y) const {
+    return block_min_[block_x + block_y * blocks_x_];
+  }
+  [[nodiscard]] float BlockMax(size_t block_x, size_t block_y) const {
+    return block_max_[block_x + block_y * blocks_x_];
+  }
+  [[nodiscard]] float TileMax() const { return tile_max_; }
+
+ private:
+  size_t width_ = 0;
+  size_t height_ = 0;
+  size_t stride_ = 0;
+  size_t blocks_x_ = 0;
+  size_t blocks_y_ = 0;
+  std::vector<float> block_min_;
+  std::vector<float> block_max_;
+  float tile_max_ = 0.0f;
+};
+
+/**
+ * @brief 三角形建立缓冲：分箱前对每个三角形建立一次，所有 tile 共享
+ *
+ * 先存活的面、后裁剪产生的三角形依次编号（TileTriangleRef::setup），按用途
+ * 分为几组数组：定点边函数与覆盖包围盒（遍历与覆盖测试）、光栅化内核常量
+ * （1/area、1/w 与 z）、深度范围（Hi‑Z）、着色来源（顶点索引与材质）。跨越多个 tile 的三角形在各
+ * tile 中不再重复建立。
+ */
+struct TriangleSetupBuffer {
+  std::vector<TriangleSetup> edges;
+  std::vector<RasterTriangle> raster;
+  std::vector<float> z_min;
+  std::vector<float> z_max;
+  /// 0 表示定点面积为 0 或不覆盖任何采样点，不参与分箱
+  std::vector<uint8_t> valid;
+  /// 面三角形引用模型顶点，裁剪三角形引用追加在 SoA 末尾的顶点，
+  /// 两者都以所属面的材质着色
+  std::vector<TriangleSource> sources;
+
+  /// 三角形数（含无效的）
+  [[nodiscard]] size_t Count() const { return valid.size(); }
+
+  /**
+   * @brief 为位置阶段与裁剪阶段存活的全部三角形建立
+   * @param model 模型（提供面）
+   * @param visible 位置阶段与裁剪阶段的输出
+   * @param soa 顶点 SoA（屏幕坐标）
+   * @param msaa_samples MSAA 样本数；大于 1 时覆盖包围盒各向外扩一个像素，
+   *        包含只有偏移样本被覆盖的像素
+   */
+  void Build(const Model& model, const VisibleRanges& visible,
+             const VertexSoA& soa, uint32_t msaa_samples = 1);
 };
 
 /**
@@ -26,11 +118,59 @@ struct TileMaskStats {
  */
 struct TileGridContext {
   const VertexSoA& soa;
+  const TriangleSetupBuffer& setups;
   size_t tiles_x;
   size_t tiles_y;
   size_t tile_size;
+  /// 帧模式下每个 tile 已有深度的最大值（binning 阶段 Hi‑Z），否则为空
+  const float* tile_depth_max = nullptr;
 };
 
+/**
+ * @brief 计算深度缓冲中每个 tile 的最大深度
+ *
+ * 帧模式下在 binning 之前调用：三角形最近深度不小于 tile 最大深度时，
+ * 该三角形不会被分箱到这个 tile。
+ * @param depth 全局深度缓冲（width * height）
+ * @param width 画布宽度
+ * @param height 画布高度
+ * @param grid tile 网格
+ * @return 每个 tile 的最大深度
+ */
+std::vector<float> ComputeTileDepthMax(const float* depth, size_t width,
+                                       size_t height,
+                                       const TileGridContext& grid);
+
+/**
+ * @brief MSAA tile 缓冲的加载（帧模式）：从帧样本缓冲复制各样本
+ *
+ * tile 样本缓冲按样本主序存放 samples 个平面，每个平面与单样本的 tile
+ * 缓冲同布局（行跨度为 tile_width）。
+ * @param frame 帧样本缓冲（平面行跨度为 width）
+ * @param x0, y0 tile 左上像素
+ * @param sample_depth, sample_color 输出：tile 样本缓冲
+ */
+void LoadTileSamples(const FrameSampleBuffers& frame, size_t width, size_t x0,
+                     size_t y0, size_t tile_width, size_t tile_height,
+                     uint32_t samples, float* sample_depth,
+                     uint32_t* sample_color);
+
+/**
+ * @brief MSAA tile 缓冲的解析与写回
+ *
+ * 颜色取样本平均；深度取样本最大值（Hi‑Z 与遮挡测试以此为保守深度，
+ * 边缘像素不会被误判为遮挡）。帧模式下各样本另存回帧样本缓冲，
+ * 后续绘制从样本而非解析结果继续。
+ * @param sample_depth, sample_color tile 样本缓冲
+ * @param depth, color 输出：全局缓冲（行跨度为 width）
+ * @param frame 输出：帧样本缓冲，非帧模式为空
+ */
+void ResolveTileSamples(const float* sample_depth, const uint32_t* sample_color,
+                        size_t tile_width, size_t tile_height,
+                        uint32_t samples, size_t width, size_t x0, size_t y0,
+                        float* depth, uint32_t* color,
+                        const FrameSampleBuffers& frame);
+
 /**
  * @brief 基于 Tile 的渲染器（Tile‑Major）
  *
@@ -38,7 +178,9 @@ struct TileGridContext {
  * - SoA 顶点布局；
  * - 三角形按 tile 分箱（binning），每 tile 内局部 Early‑Z；
  * - 单份全局 framebuffer，按 tile 覆盖范围直接拷贝回写；
- * - 通过构造参数 early_z 与 tile_size 控制行为。
+ * - 通过构造参数 early_z、tile_size 与 msaa_samples 控制行为；
+ * - MSAA 时样本深度与颜色只存在于 tile 局部缓冲，每个覆盖像素着色一次，
+ *   tile 写回时解析。
  */
 class TileBasedRenderer final : public RendererBase {
  public:
@@ -48,9 +190,14 @@ class TileBasedRenderer final : public RendererBase {
    * @param height 画布高度
    * @param early_z 是否启用 Early‑Z（默认启用）
    * @param tile_size Tile 像素尺寸（默认 64）
+   * @param msaa_samples MSAA 样本数（1 / 2 / 4，默认 1）
    */
-  TileBasedRenderer(size_t width, size_t height, bool early_z = true, size_t tile_size = 64)
-      : RendererBase(width, height), early_z_(early_z), tile_size_(tile_size) {}
+  TileBasedRenderer(size_t width, size_t height, bool early_z = true, size_t tile_size = 64,
+                    uint32_t msaa_samples = 1)
+      : RendererBase(width, height),
+        early_z_(early_z),
+        tile_size_(tile_size),
+        msaa_samples_(msaa_samples) {}
   /**
    * @copydoc RendererBase::Render
    */
@@ -59,22 +206,16 @@ class TileBasedRenderer final : public RendererBase {
  private:
   /**
    * @brief 将三角形按屏幕空间包围盒映射到 tile 网格
-   * @param model 模型（提供面/材质）
-   * @param soa 经过变换后的 SoA 顶点数据
+   * @param grid tile 网格与三角形建立缓冲（按其编号遍历全部三角形）
    * @param tile_triangles 输出：每个 tile 的三角形引用列表
-   * @param tiles_x 水平 tile 数
-   * @param tiles_y 垂直 tile 数
-   * @param tile_size tile 像素尺寸
    */
-  void TriangleTileBinning(const Model& model,
-                           const TileGridContext& grid,
+  void TriangleTileBinning(const TileGridContext& grid,
                            std::vector<std::vector<TileTriangleRef>> &tile_triangles);
 
   /**
    * @brief 处理单个三角形的 tile binning 逻辑
-   * @param tri_idx 三角形索引
+   * @param tri_ref 三角形引用（SoA 顶点索引 + 材质）
    * @param count_only 是否仅进行计数（true=计数模式，false=填充模式）
-   * @param model 模型数据
    * @param soa 经过变换后的 SoA 顶点数据
    * @param tiles_x 水平 tile 数
    * @param tiles_y 垂直 tile 数
@@ -83,14 +224,32 @@ class TileBasedRenderer final : public RendererBase {
    * @param tile_triangles tile 三角形引用列表（填充模式时使用）
    */
   void ProcessTriangleForTileBinning(
-      size_t tri_idx, bool count_only,
-      const Model& model,
+      const TileTriangleRef& tri_ref, bool count_only,
       const TileGridContext& grid,
       std::vector<size_t>& tile_counts,
       std::vector<std::vector<TileTriangleRef>>& tile_triangles);
 
+  /// 单样本 tile 光栅化函数（RasterizeTile 的某个实例）
+  using RasterizeTileFn = void (TileBasedRenderer::*)(
+      size_t, const std::vector<TileTriangleRef>&, const TileGridContext&,
+      float*, uint32_t*, float*, uint32_t*, const Shader&, bool,
+      TileMaskStats*);
+
+  /**
+   * @brief 按 tile 尺寸选择 RasterizeTile 的实例
+   *
+   * 16 / 32 / 64 / 128 使用编译期特化的实例，其余尺寸使用通用实例。
+   * @param tile_size tile 像素尺寸
+   */
+  static RasterizeTileFn SelectRasterizeTile(size_t tile_size);
+
   /**
    * @brief 光栅化单个 tile，并将结果写回全局 framebuffer
+   *
+   * kTileSize 非 0 时为编译期特化的实例：tile 局部缓冲的行跨度固定为
+   * kTileSize（边缘 tile 同样按此跨度存放），下标计算与整 tile 的清除、
+   * 加载、写回使用常量跨度与长度；kTileSize 为 0 时行跨度为 tile 宽度。
+   * @tparam kTileSize 编译期 tile 尺寸，0 表示运行期尺寸
    * @param tile_id tile 序号
    * @param triangles 该 tile 覆盖的三角形引用
    * @param tiles_x 水平 tile 数
@@ -98,22 +257,45 @@ class TileBasedRenderer final : public RendererBase {
    * @param tile_size tile 像素尺寸
    * @param tile_depth_buffer tile 局部深度缓冲（由调用方提供/复用）
    * @param tile_color_buffer tile 局部颜色缓冲（由调用方提供/复用）
-   * @param global_depth_buffer 全局深度缓冲（单份）
-   * @param global_color_buffer 全局颜色缓冲（单份）
+   * @param global_depth_buffer 全局深度缓冲（单份，帧模式下为帧深度缓冲）
+   * @param global_color_buffer 全局颜色缓冲（单份，即输出缓冲）
    * @param soa 经过变换后的 SoA 顶点数据
    * @param shader 着色器
    * @param use_early_z 是否启用 Early‑Z
    */
+  template <size_t kTileSize>
   void RasterizeTile(size_t tile_id,
                      const std::vector<TileTriangleRef> &triangles,
                      const TileGridContext& grid,
                      float* tile_depth_buffer, uint32_t* tile_color_buffer,
-                     std::unique_ptr<float[]> &global_depth_buffer,
-                     std::unique_ptr<uint32_t[]> &global_color_buffer,
+                     float* global_depth_buffer,
+                     uint32_t* global_color_buffer,
                      const Shader& shader,
                      bool use_early_z,
                      TileMaskStats* out_stats);
 
+  /**
+   * @brief RasterizeTile 的 MSAA 版本
+   *
+   * tile 缓冲为 msaa_samples_ 个样本平面。每行对每个样本调用一次光栅化内核
+   * （样本处边函数 = 像素处 + SampleEdgeOffsets），得到样本的覆盖、深度与
+   * early‑z；任一样本存活的像素在像素采样点着色一次，颜色写入存活样本。
+   * 帧模式下样本从 frame_samples 加载并写回。
+   * @param pixel_depth_max 每像素样本深度最大值的暂存区（tile_size² 个，
+   *        由调用方按线程复用）
+   */
+  void RasterizeTileMsaa(size_t tile_id,
+                         const std::vector<TileTriangleRef> &triangles,
+                         const TileGridContext& grid,
+                         float* tile_depth_buffer, uint32_t* tile_color_buffer,
+                         float* pixel_depth_max,
+                         float* global_depth_buffer,
+                         uint32_t* global_color_buffer,
+                         const FrameSampleBuffers& frame_samples,
+                         const Shader& shader,
+                         bool use_early_z,
+                         TileMaskStats* out_stats);
+
  private:
   // 深度和颜色的默认值，同时用于tile级和全局级buffers的初始化
   static constexpr float kDepthClear = 1.0f; // 默认为最远值，用于Early-Z
@@ -121,6 +303,7 @@ class TileBasedRenderer final : public RendererBase {
 
   const bool early_z_;
   const size_t tile_size_;
+  const uint32_t msaa_samples_;
 };
 
 }  // namespace simple_renderer
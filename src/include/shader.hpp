@@ -48,6 +48,27 @@ class UniformBuffer {
   std::unordered_map<std::string, UniformValue> uniforms_;
 };
 
+/**
+ * @brief 顶点着色器输出、由光栅化器插值给片段着色器的属性（varyings）
+ *
+ * 着色器通过 Shader::SetVaryings 声明它使用的属性，光栅化器只从
+ * VertexSoA 的对应数据流插值这些属性，未声明的 Fragment 字段保持默认值。
+ */
+enum Varying : uint8_t {
+  kVaryingNormal = 1u << 0,         //!< 世界空间法线
+  kVaryingTexCoords = 1u << 1,      //!< 纹理坐标
+  kVaryingColor = 1u << 2,          //!< 顶点颜色
+  kVaryingWorldPosition = 1u << 3,  //!< 世界空间位置
+};
+
+/// Varying 按位或
+using VaryingMask = uint8_t;
+
+/// 内置光照片段着色器使用的全部属性
+inline constexpr VaryingMask kVaryingAll = kVaryingNormal | kVaryingTexCoords |
+                                           kVaryingColor |
+                                           kVaryingWorldPosition;
+
 /**
  * @brief Fragment 结构体
  * as input of Fragment Shader
@@ -56,26 +77,23 @@ class UniformBuffer {
 
 struct Fragment {
   std::array<int32_t, 2> screen_coord;
-  Vector3f normal;
-  Vector2f uv;
+  Vector3f normal = Vector3f(0.0f);
+  Vector2f uv = Vector2f(0.0f);
+  // 所在 2x2 quad 内 uv 沿屏幕 x / y 的差分（quad 内共享），用于选择 mip 级别
+  Vector2f uv_dx = Vector2f(0.0f);
+  Vector2f uv_dy = Vector2f(0.0f);
   Color color;
+  Vector3f world_position = Vector3f(0.0f);
   float depth;
   const Material *material;
 };
 
-/**
- * @brief Shared Variables 共享变量
- *
- */
-struct SharedDataInShader {
-  Vector3f fragPos_varying = Vector3f(0.0f);
-};
-
 struct VertexUniformCache {
   Matrix4f model = Matrix4f(1.0f);
   Matrix4f view = Matrix4f(1.0f);
   Matrix4f projection = Matrix4f(1.0f);
   Matrix4f model_view = Matrix4f(1.0f);
+  Matrix4f view_projection = Matrix4f(1.0f);
   Matrix4f mvp = Matrix4f(1.0f);
   Matrix3f normal = Matrix3f(1.0f);
   bool has_model = false;
@@ -111,7 +129,17 @@ class Shader {
   virtual ~Shader() = default;
 
   // Input Data -> Vertex Shader -> Screen Space Coordiante
+  // 世界空间位置不在返回的 Vertex 中，由渲染器从世界空间顶点缓存写入
+  // VertexSoA::world_position
   Vertex VertexShader(const Vertex &vertex);
+  // 仅位置的第一遍：Input Data -> Clip Space Position（供逐三角形剔除）
+  [[nodiscard]] Vector4f VertexPosition(const Vertex &vertex) const;
+  // 属性的第二遍：复用第一遍的裁剪坐标，只计算法线等 varyings
+  Vertex VertexShader(const Vertex &vertex, const Vector4f &clip_position);
+  // 世界空间输入的属性阶段：位置与法线已由 Model::GetWorldVertices 变换，
+  // 不再做逐顶点的模型矩阵乘
+  Vertex WorldVertexShader(const Vertex &world_vertex,
+                           const Vector4f &clip_position);
   // Input Data -> Fragment Shader -> Color
   Color FragmentShader(const Fragment &fragment) const;
 
@@ -130,13 +158,48 @@ class Shader {
 
   void PrepareUniformCaches();
 
+  /**
+   * @brief 声明片段着色器使用的 varyings（默认 kVaryingAll）
+   *
+   * 光栅化器只插值声明的属性；不含 kVaryingNormal 时内置片段着色器
+   * 不做光照，输出基础色（漫反射纹理、顶点颜色或材质漫反射色），
+   * 声明为 0 时顶点属性阶段与属性插值整体跳过（如仅深度的绘制）。
+   * 光照需要世界空间位置求视线方向，因此 kVaryingNormal 隐含
+   * kVaryingWorldPosition。
+   */
+  void SetVaryings(VaryingMask varyings) {
+    if ((varyings & kVaryingNormal) != 0) {
+      varyings |= kVaryingWorldPosition;
+    }
+    varyings_ = varyings;
+  }
+  [[nodiscard]] VaryingMask GetVaryings() const { return varyings_; }
+
+  /**
+   * @brief 获取 MVP 矩阵（projection * view * model）
+   *
+   * 缓存有效时直接返回缓存值，否则从 uniform 现算。
+   * 供包围体剔除等不经过 VertexShader 的场景使用。
+   */
+  [[nodiscard]] Matrix4f GetMVPMatrix() const;
+  /**
+   * @brief 获取 Model-View 矩阵（view * model），用于求模型空间相机位置
+   */
+  [[nodiscard]] Matrix4f GetModelViewMatrix() const;
+  /**
+   * @brief 获取模型矩阵，用于查询模型的世界空间顶点缓存
+   */
+  [[nodiscard]] Matrix4f GetModelMatrix() const;
+  /**
+   * @brief 获取视图-投影矩阵（projection * view），变换世界空间顶点
+   */
+  [[nodiscard]] Matrix4f GetViewProjectionMatrix() const;
+
  private:
   // UniformBuffer
   UniformBuffer uniformbuffer_;
 
-  // Shared Variables
-  // 共享变量
-  SharedDataInShader sharedDataInShader_;
+  VaryingMask varyings_ = kVaryingAll;
   VertexUniformCache vertex_uniform_cache_;
   FragmentUniformCache fragment_uniform_cache_;
   mutable std::unordered_map<uint32_t, SpecularLUT> specular_lut_cache_;
@@ -156,7 +219,8 @@ class Shader {
   [[nodiscard]] auto GetSpecularLUT(float shininess) const -> const SpecularLUT &;
   [[nodiscard]] auto EvaluateSpecular(float cos_theta, float shininess) const -> float;
 
-  Color SampleTexture(const Texture &texture, const Vector2f &uv) const;
+  // 按片段的 uv 与 quad 导数过滤采样，返回 [0, 1] 的 RGB
+  Vector3f SampleTexture(const Texture &texture, const Fragment &fragment) const;
   Color ClampColor(const Color color) const;
 
  public:
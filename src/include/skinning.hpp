@@ -0,0 +1,153 @@
+#ifndef SIMPLERENDER_SRC_INCLUDE_SKINNING_HPP_
+#define SIMPLERENDER_SRC_INCLUDE_SKINNING_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "aligned_allocator.hpp"
+#include "math.hpp"
+
+namespace simple_renderer {
+
+/// 每个顶点的最大骨骼影响数
+inline constexpr size_t kMaxBoneInfluences = 4;
+
+/**
+ * @brief 骨骼：驱动它的场景节点与逆绑定矩阵
+ *
+ * 蒙皮矩阵 = 节点当前全局变换 * inverse_bind。加载时节点变换已烘焙进顶点，
+ * inverse_bind 中包含网格节点绑定变换之逆，因此绑定姿态下蒙皮矩阵为单位阵。
+ */
+struct Bone {
+  std::string name;
+  /// 驱动节点，未找到同名节点时为 -1（保持绑定姿态）
+  int32_t node_index = -1;
+  Matrix4f inverse_bind = Matrix4f(1.0f);
+};
+
+/**
+ * @brief 变形目标（blend shape）：一个网格实例的逐顶点位移
+ *
+ * 位移在模型空间（已应用节点变换），按实例内顶点索引存放。
+ */
+struct MorphTarget {
+  std::string name;
+  /// 所属实例在模型顶点数组中的起始位置
+  size_t vertex_offset = 0;
+  float default_weight = 0.0f;
+  std::vector<Vector3f> position_deltas;
+  std::vector<Vector3f> normal_deltas;
+};
+
+/**
+ * @brief 逐顶点骨骼影响（SoA），每个顶点最多 kMaxBoneInfluences 个
+ *
+ * 权重已归一化；权重和不足 1 的部分保持绑定姿态，
+ * 因此未绑定骨骼的顶点（权重全为 0）不随骨骼运动。
+ */
+class SkinWeights {
+ public:
+  [[nodiscard]] size_t size() const { return weights_[0].size(); }
+
+  /// 追加一个顶点的影响（joints/weights 各 kMaxBoneInfluences 个）
+  void push_back(const uint16_t* joints, const float* weights);
+  /// 追加无骨骼影响的顶点，直到共 n 个
+  void PadTo(size_t n);
+  /// 追加 other 中第 index 个顶点的影响
+  void AppendFrom(const SkinWeights& other, size_t index);
+  /// 按 remap（旧局部索引 -> 新局部索引）重排 [base, base + remap.size())
+  void Permute(size_t base, const std::vector<uint32_t>& remap);
+
+  [[nodiscard]] const uint16_t* GetJoints(size_t influence) const {
+    return joints_[influence].data();
+  }
+  [[nodiscard]] const float* GetWeights(size_t influence) const {
+    return weights_[influence].data();
+  }
+
+ private:
+  AlignedVector<uint16_t> joints_[kMaxBoneInfluences];
+  AlignedVector<float> weights_[kMaxBoneInfluences];
+};
+
+/// 关键帧（时间单位：秒）
+template <class T>
+struct Keyframe {
+  float time = 0.0f;
+  T value;
+};
+
+/**
+ * @brief 节点动画通道：平移/旋转/缩放关键帧，采样结果替换节点局部变换
+ */
+struct NodeChannel {
+  size_t node_index = 0;
+  std::vector<Keyframe<Vector3f>> positions;
+  std::vector<Keyframe<Quaternion>> rotations;
+  std::vector<Keyframe<Vector3f>> scales;
+};
+
+/**
+ * @brief 变形目标权重通道：一个实例的全部变形目标
+ *        [target_offset, target_offset + target_count)
+ */
+struct MorphChannel {
+  size_t target_offset = 0;
+  size_t target_count = 0;
+  std::vector<float> times;
+  /// 每个关键帧 target_count 个权重
+  std::vector<std::vector<float>> weights;
+};
+
+/**
+ * @brief 动画片段
+ */
+struct AnimationClip {
+  std::string name;
+  /// 时长（秒）
+  float duration = 0.0f;
+  std::vector<NodeChannel> channels;
+  std::vector<MorphChannel> morph_channels;
+};
+
+/**
+ * @brief 姿态：Model::ApplyPose 的输入
+ *
+ * - bones：每个 Model::GetBones() 骨骼的模型空间蒙皮矩阵；
+ * - morph_weights：每个 Model::GetMorphTargets() 变形目标的权重。
+ */
+struct Pose {
+  std::vector<Matrix4f> bones;
+  std::vector<float> morph_weights;
+
+  bool operator==(const Pose& other) const {
+    return bones == other.bones && morph_weights == other.morph_weights;
+  }
+};
+
+/**
+ * @brief 采样节点动画通道，得到节点局部变换
+ *
+ * 关键帧之间平移/缩放线性插值、旋转球面插值，区间外取端点值。
+ * 缺少某类关键帧时使用 rest（节点原局部变换）中的对应分量。
+ * @param channel 动画通道
+ * @param time 时间（秒）
+ * @param rest 节点原局部变换
+ */
+Matrix4f SampleNodeChannel(const NodeChannel& channel, float time,
+                           const Matrix4f& rest);
+
+/**
+ * @brief 采样变形目标权重通道，写入 weights 的对应区间
+ * @param channel 权重通道
+ * @param time 时间（秒）
+ * @param weights 全部变形目标的权重
+ */
+void SampleMorphChannel(const MorphChannel& channel, float time,
+                        std::vector<float>& weights);
+
+}  // namespace simple_renderer
+
+#endif  // SIMPLERENDER_SRC_INCLUDE_SKINNING_HPP_
@@ -78,17 +78,31 @@ struct VertexSoA {
   std::vector<Vector4f> pos_screen;  // screen space position (x,y,z,w)
   // 裁剪空间坐标（用于视锥体剔除）：clip = MVP * pos
   std::vector<Vector4f> pos_clip;
+  // 裁剪码（ClipCode 按位或），用于逐三角形视锥体剔除
+  std::vector<uint8_t>  clip_code;
   std::vector<Vector3f> normal;
   std::vector<Vector2f> uv;
   std::vector<Color>    color;
+  // 世界空间位置（kVaryingWorldPosition）
+  std::vector<Vector3f> world_position;
 
   inline size_t size() const { return pos_screen.size(); }
   inline void resize(size_t n) {
+    resize_positions(n);
+    resize_attributes(n);
+  }
+  // 仅分配位置相关的流（位置阶段使用）
+  inline void resize_positions(size_t n) {
     pos_screen.resize(n);
     pos_clip.resize(n);
+    clip_code.resize(n);
+  }
+  // 仅分配属性流（属性阶段使用）
+  inline void resize_attributes(size_t n) {
     normal.resize(n);
     uv.resize(n);
     color.resize(n);
+    world_position.resize(n);
   }
 };
 
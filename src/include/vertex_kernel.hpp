@@ -0,0 +1,188 @@
+#ifndef SIMPLERENDER_SRC_INCLUDE_VERTEX_KERNEL_HPP_
+#define SIMPLERENDER_SRC_INCLUDE_VERTEX_KERNEL_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "aligned_allocator.hpp"
+#include "clipping.hpp"
+#include "math.hpp"
+#include "skinning.hpp"
+#include "vertex.hpp"
+#include "vertex_streams.hpp"
+
+namespace simple_renderer {
+
+/// 批处理顶点内核每批处理的顶点数（SIMD 通道数），与模型位置流的填充一致
+inline constexpr size_t kVertexBatchSize = kVertexStreamPadding;
+
+/**
+ * @brief 裁剪码：顶点位于对应裁剪平面外侧时置位
+ *
+ * 三个顶点裁剪码的视锥体位（kClipFrustum）按位与非零时，三角形整体位于
+ * 同一平面外；任一顶点含 kClipNear 或 kClipGuardBand 时三角形需要在
+ * 齐次空间裁剪（见 clipping.hpp）。
+ */
+enum ClipCode : uint8_t {
+  kClipLeft = 1u << 0,       //!< x < -w
+  kClipRight = 1u << 1,      //!< x > w
+  kClipBottom = 1u << 2,     //!< y < -w
+  kClipTop = 1u << 3,        //!< y > w
+  kClipNear = 1u << 4,       //!< z < -w
+  kClipFar = 1u << 5,        //!< z > w
+  kClipGuardBand = 1u << 6,  //!< |x| 或 |y| > kGuardBand * w
+  kClipFrustum = kClipLeft | kClipRight | kClipBottom | kClipTop | kClipNear |
+                 kClipFar,
+};
+
+/**
+ * @brief 视口与透视除法参数
+ */
+struct ViewportParams {
+  float width = 0.0f;
+  float height = 0.0f;
+  float min_w = 1e-6f;  //!< w 不大于该值的顶点映射到 NDC (0, 0, 1, 1)
+};
+
+/**
+ * @brief 构建位置内核使用的矩阵
+ *
+ * kFloat 格式返回 {mvp}；kCompact 格式为每个量化段返回一个矩阵，
+ * 其中已折叠该段的反量化（mvp * T(offset) * S(scale)），
+ * 内核因此可直接变换 16 位整数坐标。每次绘制计算一次。
+ * @param mvp 模型-视图-投影矩阵
+ * @param vertices 模型顶点流
+ */
+std::vector<Matrix4f> BuildPositionMatrices(const Matrix4f& mvp,
+                                            const VertexStreams& vertices);
+
+/**
+ * @brief 批量变换顶点位置，直接写入 SoA 位置流
+ *
+ * 一批为从 first 开始的 kVertexBatchSize 个顶点：直接从模型的对齐位置流
+ * 加载（kCompact 格式先将 16 位坐标转换为 float），逐通道完成 4x4 矩阵乘、
+ * 1/w、视口映射与裁剪码计算，只写回 [begin, end) 内的顶点。
+ * kFloat 格式的结果与 PerspectiveDivision + ViewportTransformation 逐位一致。
+ * @param matrices BuildPositionMatrices 的结果
+ * @param vertices 模型顶点流（数据流已按批宽度填充）
+ * @param first 本批第一个顶点的索引，须为 kVertexBatchSize 的倍数
+ * @param begin 写回区间起点，位于 [first, first + kVertexBatchSize)
+ * @param end 写回区间终点，不超过 first + kVertexBatchSize
+ * @param viewport 视口参数
+ * @param soa 输出：pos_clip、pos_screen 与 clip_code（按模型顶点索引）
+ */
+void TransformVertexBatch(const std::vector<Matrix4f>& matrices,
+                          const VertexStreams& vertices, size_t first,
+                          size_t begin, size_t end,
+                          const ViewportParams& viewport, VertexSoA& soa);
+
+/**
+ * @brief 批量解码顶点属性，写入 SoA 属性流
+ *
+ * kCompact 格式在此逐通道解码八面体法线与半精度 UV；kFloat 格式直接复制。
+ * 结果为模型空间属性，只写回 [begin, end) 内的顶点。
+ * @param vertices 模型顶点流
+ * @param first 本批第一个顶点的索引，须为 kVertexBatchSize 的倍数
+ * @param begin 写回区间起点
+ * @param end 写回区间终点
+ * @param soa 输出：normal、uv 与 color（按模型顶点索引）
+ */
+void DecodeAttributeBatch(const VertexStreams& vertices, size_t first,
+                          size_t begin, size_t end, VertexSoA& soa);
+
+/**
+ * @brief 批量将顶点变换到世界空间，写入世界空间顶点缓存
+ *
+ * 一批为从 first 开始的 kVertexBatchSize 个顶点（含填充通道）：
+ * 位置逐通道做仿射变换（kCompact 格式的反量化已折叠进各段矩阵），
+ * 法线（kCompact 格式先解码）乘以法线矩阵，结果与 Shader::VertexShader
+ * 中的 model * position、normal_matrix * normal 逐位一致（kFloat）。
+ * @param matrices BuildPositionMatrices(model, vertices) 的结果
+ * @param normal_matrix 法线矩阵 transpose(inverse(mat3(model)))
+ * @param vertices 模型顶点流
+ * @param first 本批第一个顶点的索引，须为 kVertexBatchSize 的倍数
+ * @param out 输出：世界空间位置与法线（已按 vertices.size() 分配）
+ */
+void TransformWorldBatch(const std::vector<Matrix4f>& matrices,
+                         const Matrix3f& normal_matrix,
+                         const VertexStreams& vertices, size_t first,
+                         WorldSpaceVertices& out);
+
+/**
+ * @brief 以视图-投影矩阵批量变换世界空间位置，直接写入 SoA 位置流
+ *
+ * 与 TransformVertexBatch 相同，但输入为世界空间顶点缓存，
+ * 每帧只需一次视图-投影矩阵乘。
+ * @param view_projection 视图-投影矩阵
+ * @param world 世界空间顶点（位置流已按批宽度填充）
+ * @param first 本批第一个顶点的索引，须为 kVertexBatchSize 的倍数
+ * @param begin 写回区间起点
+ * @param end 写回区间终点
+ * @param viewport 视口参数
+ * @param soa 输出：pos_clip、pos_screen 与 clip_code（按模型顶点索引）
+ */
+void TransformVertexBatch(const Matrix4f& view_projection,
+                          const WorldSpaceVertices& world, size_t first,
+                          size_t begin, size_t end,
+                          const ViewportParams& viewport, VertexSoA& soa);
+
+/**
+ * @brief 批量解码顶点属性，法线取自世界空间顶点缓存
+ *
+ * UV 与颜色同 DecodeAttributeBatch，法线直接复制世界空间结果而不再解码。
+ * @param vertices 模型顶点流
+ * @param world 世界空间顶点
+ * @param first 本批第一个顶点的索引，须为 kVertexBatchSize 的倍数
+ * @param begin 写回区间起点
+ * @param end 写回区间终点
+ * @param soa 输出：normal（世界空间）、uv 与 color（按模型顶点索引）
+ */
+void DecodeAttributeBatch(const VertexStreams& vertices,
+                          const WorldSpaceVertices& world, size_t first,
+                          size_t begin, size_t end, VertexSoA& soa);
+
+/**
+ * @brief 蒙皮矩阵调色板
+ *
+ * 每个骨骼 3x4 仿射矩阵的 12 个元素（列主序）分别连续存放，
+ * 内核按通道以骨骼索引 gather。bones 为空时调色板只含一个单位阵。
+ */
+struct SkinPalette {
+  AlignedVector<float> m[12];
+
+  explicit SkinPalette(const std::vector<Matrix4f>& bones);
+};
+
+/**
+ * @brief 参与混合的变形目标及其权重
+ */
+struct MorphBlend {
+  const MorphTarget* target = nullptr;
+  float weight = 0.0f;
+};
+
+/**
+ * @brief 批量顶点形变：变形目标混合 + 线性混合蒙皮（LBS）
+ *
+ * 对 [begin, end)（不超过 kVertexBatchSize 个顶点）逐通道计算：
+ * 1) 绑定姿态位置/法线加上各变形目标位移的加权和；
+ * 2) 按 kMaxBoneInfluences 个骨骼影响混合蒙皮矩阵（权重和不足 1 的部分
+ *    为单位阵），变换位置与法线，法线重新归一化。
+ * 法线使用混合矩阵的 3x3 部分变换，假设骨骼变换不含非均匀缩放。
+ * @param bind 绑定姿态顶点（kFloat）
+ * @param skin 逐顶点骨骼影响
+ * @param palette 蒙皮矩阵调色板
+ * @param morphs 影响该区间的变形目标（权重非零）
+ * @param begin 区间起点
+ * @param end 区间终点
+ * @param out 输出：形变后的位置与法线（kFloat，按模型顶点索引）
+ */
+void DeformVertexBatch(const VertexStreams& bind, const SkinWeights& skin,
+                       const SkinPalette& palette,
+                       const std::vector<MorphBlend>& morphs, size_t begin,
+                       size_t end, VertexStreams& out);
+
+}  // namespace simple_renderer
+
+#endif  // SIMPLERENDER_SRC_INCLUDE_VERTEX_KERNEL_HPP_
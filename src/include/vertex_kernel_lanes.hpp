@@ -0,0 +1,48 @@
+#ifndef SIMPLERENDER_SRC_INCLUDE_VERTEX_KERNEL_LANES_HPP_
+#define SIMPLERENDER_SRC_INCLUDE_VERTEX_KERNEL_LANES_HPP_
+
+#include "vertex_kernel.hpp"
+
+namespace simple_renderer {
+
+/// 一批顶点的变换结果（按通道）
+struct PositionLanes {
+  alignas(32) float cx[kVertexBatchSize], cy[kVertexBatchSize];
+  alignas(32) float cz[kVertexBatchSize], cw[kVertexBatchSize];
+  alignas(32) float sx[kVertexBatchSize], sy[kVertexBatchSize];
+  alignas(32) float sz[kVertexBatchSize], sw[kVertexBatchSize];
+  alignas(32) uint32_t code[kVertexBatchSize];
+};
+
+/**
+ * @brief 位置内核：逐通道 4x4 矩阵乘（w = 1）、透视除法、视口映射与裁剪码
+ *
+ * 结果须与裁剪路径使用的 PerspectiveDivision + ViewportTransformation 逐位一致。
+ * 各指令集版本由同一份函数体（src/vertex_kernel_lanes.inc）以不同目标编译
+ * （omp simd 向量化），与光栅化内核一样关闭 FMA 收缩，因此与默认目标的
+ * 结果逐位相同。
+ */
+using TransformLanesFn = void (*)(const Matrix4f& m, const float* px,
+                                  const float* py, const float* pz,
+                                  const ViewportParams& viewport,
+                                  PositionLanes& out);
+
+/// 按默认目标编译的版本
+void TransformLanesDefault(const Matrix4f& m, const float* px, const float* py,
+                           const float* pz, const ViewportParams& viewport,
+                           PositionLanes& out);
+
+#if defined(SIMPLE_RENDERER_X86_KERNELS)
+// 各指令集版本位于独立编译单元（src/CMakeLists.txt 中设置目标指令集
+// 并定义 SIMPLE_RENDERER_X86_KERNELS）
+void TransformLanesAvx2(const Matrix4f& m, const float* px, const float* py,
+                        const float* pz, const ViewportParams& viewport,
+                        PositionLanes& out);
+void TransformLanesAvx512(const Matrix4f& m, const float* px, const float* py,
+                          const float* pz, const ViewportParams& viewport,
+                          PositionLanes& out);
+#endif
+
+}  // namespace simple_renderer
+
+#endif  // SIMPLERENDER_SRC_INCLUDE_VERTEX_KERNEL_LANES_HPP_
@@ -0,0 +1,209 @@
+#ifndef SIMPLERENDER_SRC_INCLUDE_VERTEX_STREAMS_HPP_
+#define SIMPLERENDER_SRC_INCLUDE_VERTEX_STREAMS_HPP_
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "aligned_allocator.hpp"
+#include "color.h"
+#include "math.hpp"
+#include "vertex.hpp"
+
+namespace simple_renderer {
+
+// Streams are padded to this many vertices (one SIMD batch)
+// 数据流按该顶点数（一个 SIMD 批）填充
+inline constexpr size_t kVertexStreamPadding = 8;
+
+// Vertex storage format
+// 顶点存储格式
+enum class VertexFormat : uint8_t {
+  // 32-bit float positions, normals and UVs (36 bytes per vertex)
+  // 32 位浮点位置、法线与 UV（每顶点 36 字节）
+  kFloat,
+  // 16-bit quantized positions, 32-bit octahedral normals, half-float UVs
+  // (18 bytes per vertex)
+  // 16 位量化位置、32 位八面体法线、半精度 UV（每顶点 18 字节）
+  kCompact,
+};
+
+// Dequantization of one compact position segment: p = offset + scale * q
+// 紧凑格式中一段顶点位置的反量化参数：p = offset + scale * q
+struct PositionSegment {
+  size_t begin = 0;
+  size_t end = 0;
+  Vector3f offset = Vector3f(0.0f);
+  Vector3f scale = Vector3f(1.0f);
+};
+
+// Half-float (binary16) -> float, branch-free so it vectorizes
+// 半精度浮点 -> float，无分支以便向量化
+inline float HalfToFloat(uint16_t half) {
+  const uint32_t sign = static_cast<uint32_t>(half & 0x8000u) << 16;
+  const uint32_t magnitude = half & 0x7fffu;
+  // Normals and subnormals: rebias the exponent by multiplying with 2^112
+  // 规格化数与非规格化数：乘 2^112 完成指数偏移
+  const uint32_t finite =
+      std::bit_cast<uint32_t>(std::bit_cast<float>(magnitude << 13) * 0x1p112f);
+  const uint32_t special = 0x7f800000u | ((magnitude & 0x3ffu) << 13);
+  return std::bit_cast<float>((magnitude >= 0x7c00u ? special : finite) | sign);
+}
+
+// Float -> half-float, round to nearest even
+// float -> 半精度浮点，就近舍入到偶数
+uint16_t FloatToHalf(float value);
+
+// Octahedral normal encoding: two snorm16 values packed into 32 bits
+// 八面体法线编码：两个 snorm16 打包为 32 位
+uint32_t EncodeOctahedral(const Vector3f& normal);
+
+// Octahedral normal decoding, branch-free so it vectorizes
+// 八面体法线解码，无分支以便向量化
+inline Vector3f DecodeOctahedral(uint32_t encoded) {
+  float x = static_cast<float>(static_cast<int16_t>(encoded & 0xffffu)) *
+            (1.0f / 32767.0f);
+  float y = static_cast<float>(static_cast<int16_t>(encoded >> 16)) *
+            (1.0f / 32767.0f);
+  const float z = 1.0f - std::abs(x) - std::abs(y);
+  const float t = std::max(-z, 0.0f);
+  x += x >= 0.0f ? -t : t;
+  y += y >= 0.0f ? -t : t;
+  const float inv_length = 1.0f / std::sqrt(x * x + y * y + z * z);
+  return Vector3f(x * inv_length, y * inv_length, z * inv_length);
+}
+
+// Model vertex storage as SoA streams, aligned to kSimdAlignment and
+// zero-padded to kVertexStreamPadding
+// - kFloat: split x/y/z (w == 1), float normals and UVs
+// - kCompact: 16-bit x/y/z per PositionSegment, octahedral normals,
+//   half-float UVs
+// Colors are RGBA8 in both formats
+// 模型顶点的 SoA 存储，按 kSimdAlignment 对齐并以 0 填充到
+// kVertexStreamPadding 的整数倍
+// - kFloat：x/y/z 分离（w 恒为 1），浮点法线与 UV
+// - kCompact：按 PositionSegment 量化的 16 位 x/y/z、八面体法线、半精度 UV
+// 两种格式的颜色均为 RGBA8
+class VertexStreams {
+ public:
+  // Number of vertices (without padding)
+  // 顶点数（不含填充）
+  [[nodiscard]] size_t size() const { return color_.size(); }
+  [[nodiscard]] bool empty() const { return color_.empty(); }
+  [[nodiscard]] VertexFormat GetFormat() const { return format_; }
+
+  void reserve(size_t n);
+
+  // Append / overwrite a vertex, only valid in kFloat format; the position
+  // w component is dropped
+  // 追加 / 覆盖顶点，仅 kFloat 格式可用；位置的 w 分量被丢弃
+  void push_back(const Vertex& vertex);
+  void Set(size_t index, const Vertex& vertex);
+
+  // Gather (and decode) vertex `index` into an AoS Vertex
+  // 将第 index 个顶点（解码后）聚合为 AoS 的 Vertex
+  [[nodiscard]] Vertex Get(size_t index) const;
+
+  // Model-space position of vertex `index`
+  // 第 index 个顶点的模型空间位置
+  [[nodiscard]] Vector3f GetPosition(size_t index) const;
+
+  // Convert to kCompact; each segment [offsets[i], offsets[i + 1]) gets its
+  // own quantization range (one segment per mesh)
+  // 转换为 kCompact；每段 [offsets[i], offsets[i + 1]) 使用独立的量化范围
+  // （每个网格一段）
+  void Compress(const std::vector<size_t>& segment_offsets);
+
+  // Position segments (kCompact) and the segment containing `index`
+  // 位置量化段（kCompact）以及包含 index 的段
+  [[nodiscard]] const std::vector<PositionSegment>& GetSegments() const {
+    return segments_;
+  }
+  [[nodiscard]] size_t FindSegment(size_t index) const;
+
+  // Bytes held by the streams
+  // 数据流占用的字节数
+  [[nodiscard]] size_t GetMemoryBytes() const;
+
+  // kFloat streams; x/y/z hold PaddedSize(size()) elements
+  // kFloat 数据流；x/y/z 含 PaddedSize(size()) 个元素
+  [[nodiscard]] const float* GetPositionX() const { return x_.data(); }
+  [[nodiscard]] const float* GetPositionY() const { return y_.data(); }
+  [[nodiscard]] const float* GetPositionZ() const { return z_.data(); }
+  [[nodiscard]] const std::vector<Vector3f>& GetNormals() const {
+    return normal_;
+  }
+  [[nodiscard]] const std::vector<Vector2f>& GetTexCoords() const {
+    return uv_;
+  }
+  // Writable kFloat positions and normals, used by the vertex deformation
+  // stage (skinning / morph targets)
+  // 可写的 kFloat 位置与法线，供顶点形变阶段（蒙皮 / 变形目标）使用
+  [[nodiscard]] float* GetPositionX() { return x_.data(); }
+  [[nodiscard]] float* GetPositionY() { return y_.data(); }
+  [[nodiscard]] float* GetPositionZ() { return z_.data(); }
+  [[nodiscard]] std::vector<Vector3f>& GetNormals() { return normal_; }
+
+  // kCompact streams, all hold PaddedSize(size()) elements
+  // kCompact 数据流，均含 PaddedSize(size()) 个元素
+  [[nodiscard]] const uint16_t* GetQuantizedX() const { return qx_.data(); }
+  [[nodiscard]] const uint16_t* GetQuantizedY() const { return qy_.data(); }
+  [[nodiscard]] const uint16_t* GetQuantizedZ() const { return qz_.data(); }
+  [[nodiscard]] const uint32_t* GetOctNormals() const {
+    return normal_oct_.data();
+  }
+  [[nodiscard]] const uint32_t* GetHalfTexCoords() const {
+    return uv_half_.data();
+  }
+
+  [[nodiscard]] const std::vector<Color>& GetColors() const { return color_; }
+
+  static constexpr size_t PaddedSize(size_t n) {
+    return (n + kVertexStreamPadding - 1) / kVertexStreamPadding *
+           kVertexStreamPadding;
+  }
+
+ private:
+  VertexFormat format_ = VertexFormat::kFloat;
+
+  AlignedVector<float> x_;
+  AlignedVector<float> y_;
+  AlignedVector<float> z_;
+  std::vector<Vector3f> normal_;
+  std::vector<Vector2f> uv_;
+
+  AlignedVector<uint16_t> qx_;
+  AlignedVector<uint16_t> qy_;
+  AlignedVector<uint16_t> qz_;
+  AlignedVector<uint32_t> normal_oct_;
+  AlignedVector<uint32_t> uv_half_;
+  std::vector<PositionSegment> segments_;
+
+  std::vector<Color> color_;
+};
+
+// World-space positions and normals of a model: x/y/z are aligned and padded
+// like kFloat streams, normals are transformed by the normal matrix
+// 模型的世界空间位置与法线：x/y/z 与 kFloat 数据流同样对齐并填充，
+// 法线已经过法线矩阵变换
+struct WorldSpaceVertices {
+  AlignedVector<float> x;
+  AlignedVector<float> y;
+  AlignedVector<float> z;
+  std::vector<Vector3f> normal;
+
+  [[nodiscard]] size_t size() const { return normal.size(); }
+  void resize(size_t n) {
+    x.resize(VertexStreams::PaddedSize(n), 0.0f);
+    y.resize(VertexStreams::PaddedSize(n), 0.0f);
+    z.resize(VertexStreams::PaddedSize(n), 0.0f);
+    normal.resize(n);
+  }
+};
+
+}  // namespace simple_renderer
+
+#endif  // SIMPLERENDER_SRC_INCLUDE_VERTEX_STREAMS_HPP_
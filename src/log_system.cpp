@@ -53,6 +53,9 @@ LogSystem::~LogSystem() {
   logger_->flush();
   spdlog::drop_all();
   spdlog::shutdown();
+  // shutdown 会清空默认日志器；换回控制台日志器，
+  // 使之后创建的渲染器或其他代码中的 SPDLOG_* 调用仍然有效
+  spdlog::set_default_logger(spdlog::stdout_color_mt("console"));
 }
 
 }  // namespace simple_renderer
@@ -1,6 +1,10 @@
 #include "material.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <string>
+#include <vector>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "log_system.h"
@@ -17,6 +21,7 @@ Texture Texture::LoadTextureFromFile(const std::string& path) {
     texture.width = width;
     texture.height = height;
     texture.channels = channels;
+    texture.GenerateMipmaps();
   } else {
     SPDLOG_ERROR("Failed to load texture: {}", path);
     throw std::runtime_error("Failed to load texture");
@@ -50,4 +55,188 @@ Color Texture::GetPixel(int x, int y) const {
     throw std::invalid_argument("Unsupported texture channels");
   }
 }
-}  // namespace simple_renderer
\ No newline at end of file
+
+namespace {
+
+/**
+ * @brief 一维盒式滤波的抽头
+ *
+ * 目标 texel x 覆盖源区间 [x * src / dst, (x + 1) * src / dst)，每个源 texel
+ * 的权重为其与该区间的重叠长度（以 1 / dst 为单位，整数），权重和为 src。
+ * 偶数尺寸时为两个等权抽头；奇数尺寸时跨 3 个源 texel，所有源 texel 都参与。
+ */
+struct BoxTaps {
+  int first = 0;
+  int count = 0;
+  uint32_t weight[3] = {};
+};
+
+std::vector<BoxTaps> MakeBoxTaps(int src, int dst) {
+  std::vector<BoxTaps> taps(dst);
+  for (int x = 0; x < dst; ++x) {
+    const int64_t lo = int64_t{x} * src;
+    const int64_t hi = lo + src;
+    BoxTaps& tap = taps[x];
+    tap.first = static_cast<int>(lo / dst);
+    for (int64_t i = tap.first; i * dst < hi; ++i) {
+      const int64_t begin = std::max(lo, i * dst);
+      const int64_t end = std::min(hi, (i + 1) * dst);
+      tap.weight[tap.count++] = static_cast<uint32_t>(end - begin);
+    }
+  }
+  return taps;
+}
+
+}  // namespace
+
+void Texture::GenerateMipmaps() {
+  if (!data) {
+    SPDLOG_ERROR("Texture data is nullptr");
+    throw std::invalid_argument("Texture data is nullptr");
+  }
+  if (channels != 3 && channels != 4) {
+    SPDLOG_ERROR("Unsupported texture channels: {}", channels);
+    throw std::invalid_argument("Unsupported texture channels");
+  }
+
+  auto chain = std::make_shared<std::vector<TextureLevel>>();
+  // 第 0 级转换为 RGBA8
+  TextureLevel base{width, height,
+                    std::vector<uint8_t>(static_cast<size_t>(width) * height * 4)};
+  for (size_t i = 0; i < static_cast<size_t>(width) * height; ++i) {
+    for (int c = 0; c < 3; ++c) {
+      base.texels[i * 4 + c] = data[i * channels + c];
+    }
+    base.texels[i * 4 + 3] = channels == 4 ? data[i * channels + 3] : 255;
+  }
+  chain->push_back(std::move(base));
+
+  // 逐级按面积加权的盒式滤波：偶数尺寸即 2x2 平均，
+  // 奇数尺寸时每个目标 texel 覆盖 2 + 1 / (size / 2) 个源 texel，不丢弃边缘
+  while (chain->back().width > 1 || chain->back().height > 1) {
+    const TextureLevel& src = chain->back();
+    TextureLevel dst{std::max(1, src.width / 2), std::max(1, src.height / 2),
+                     {}};
+    dst.texels.resize(static_cast<size_t>(dst.width) * dst.height * 4);
+    const std::vector<BoxTaps> taps_x = MakeBoxTaps(src.width, dst.width);
+    const std::vector<BoxTaps> taps_y = MakeBoxTaps(src.height, dst.height);
+    const uint64_t denominator =
+        static_cast<uint64_t>(src.width) * static_cast<uint64_t>(src.height);
+    for (int y = 0; y < dst.height; ++y) {
+      const BoxTaps& ty = taps_y[y];
+      for (int x = 0; x < dst.width; ++x) {
+        const BoxTaps& tx = taps_x[x];
+        uint64_t sum[4] = {};
+        for (int j = 0; j < ty.count; ++j) {
+          const uint8_t* row =
+              &src.texels[static_cast<size_t>(ty.first + j) * src.width * 4];
+          for (int i = 0; i < tx.count; ++i) {
+            const uint64_t weight =
+                static_cast<uint64_t>(ty.weight[j]) * tx.weight[i];
+            const uint8_t* texel = row + static_cast<size_t>(tx.first + i) * 4;
+            for (int c = 0; c < 4; ++c) {
+              sum[c] += weight * texel[c];
+            }
+          }
+        }
+        for (int c = 0; c < 4; ++c) {
+          dst.texels[(static_cast<size_t>(y) * dst.width + x) * 4 + c] =
+              static_cast<uint8_t>((sum[c] + denominator / 2) / denominator);
+        }
+      }
+    }
+    chain->push_back(std::move(dst));
+  }
+  levels = std::move(chain);
+}
+
+namespace {
+
+/// 在一个 mip 级别上双线性采样（重复寻址），u / v 为 [0, 1) 内的坐标
+Vector3f SampleBilinear(const TextureLevel& level, float u, float v) {
+  // texel 中心位于 (i + 0.5) / size
+  const float tx = u * static_cast<float>(level.width) - 0.5f;
+  const float ty = v * static_cast<float>(level.height) - 0.5f;
+  const float fx0 = std::floor(tx);
+  const float fy0 = std::floor(ty);
+  const float ax = tx - fx0;
+  const float ay = ty - fy0;
+  const auto wrap = [](int i, int size) {
+    i %= size;
+    return i < 0 ? i + size : i;
+  };
+  const int x0 = wrap(static_cast<int>(fx0), level.width);
+  const int y0 = wrap(static_cast<int>(fy0), level.height);
+  const int x1 = x0 + 1 == level.width ? 0 : x0 + 1;
+  const int y1 = y0 + 1 == level.height ? 0 : y0 + 1;
+
+  const uint8_t* t00 =
+      &level.texels[(static_cast<size_t>(y0) * level.width + x0) * 4];
+  const uint8_t* t10 =
+      &level.texels[(static_cast<size_t>(y0) * level.width + x1) * 4];
+  const uint8_t* t01 =
+      &level.texels[(static_cast<size_t>(y1) * level.width + x0) * 4];
+  const uint8_t* t11 =
+      &level.texels[(static_cast<size_t>(y1) * level.width + x1) * 4];
+  Vector3f rgb;
+  for (int c = 0; c < 3; ++c) {
+    const float top = static_cast<float>(t00[c]) +
+                      (static_cast<float>(t10[c]) - static_cast<float>(t00[c])) * ax;
+    const float bottom =
+        static_cast<float>(t01[c]) +
+        (static_cast<float>(t11[c]) - static_cast<float>(t01[c])) * ax;
+    rgb[c] = (top + (bottom - top) * ay) * (1.0f / 255.0f);
+  }
+  return rgb;
+}
+
+}  // namespace
+
+Vector3f Texture::Sample(const Vector2f& uv, const Vector2f& duv_dx,
+                         const Vector2f& duv_dy) const {
+  // wrap u,v to [0, 1)
+  // 将 u, v 包装到 [0, 1)
+  const float u = uv.x - std::floor(uv.x);
+  const float v = uv.y - std::floor(uv.y);
+
+  if (filter == TextureFilter::kNearest || !levels) {
+    const int x = std::clamp(static_cast<int>(u * width), 0, width - 1);
+    const int y = std::clamp(static_cast<int>(v * height), 0, height - 1);
+    const Color c = GetPixel(x, y);
+    constexpr float inv255 = 1.0f / 255.0f;
+    return Vector3f(static_cast<float>(c[Color::kColorIndexRed]) * inv255,
+                    static_cast<float>(c[Color::kColorIndexGreen]) * inv255,
+                    static_cast<float>(c[Color::kColorIndexBlue]) * inv255);
+  }
+
+  // LOD：一个屏幕像素覆盖的 texel 数（两个屏幕方向取大者）的 log2
+  const auto& chain = *levels;
+  const float w = static_cast<float>(width);
+  const float h = static_cast<float>(height);
+  const float rho_x2 = duv_dx.x * duv_dx.x * w * w + duv_dx.y * duv_dx.y * h * h;
+  const float rho_y2 = duv_dy.x * duv_dy.x * w * w + duv_dy.y * duv_dy.y * h * h;
+  const float rho2 = std::max(rho_x2, rho_y2);
+  const float max_lod = static_cast<float>(chain.size() - 1);
+  // log2(sqrt(x)) = 0.5 * log2(x)；rho <= 1（含 0）时为放大，
+  // 非有限（导数平方溢出或为 NaN）时视为极度缩小，取最粗级别
+  float lod = 0.0f;
+  if (!std::isfinite(rho_x2) || !std::isfinite(rho_y2)) {
+    lod = max_lod;
+  } else if (rho2 > 1.0f) {
+    lod = std::min(0.5f * std::log2(rho2), max_lod);
+  }
+
+  if (filter == TextureFilter::kBilinear) {
+    const auto level = static_cast<size_t>(lod + 0.5f);
+    return SampleBilinear(chain[level], u, v);
+  }
+  const auto level = static_cast<size_t>(lod);
+  const float t = lod - static_cast<float>(level);
+  const Vector3f fine = SampleBilinear(chain[level], u, v);
+  if (t == 0.0f) {
+    return fine;
+  }
+  const Vector3f coarse = SampleBilinear(chain[level + 1], u, v);
+  return fine + (coarse - fine) * t;
+}
+}  // namespace simple_renderer
@@ -0,0 +1,227 @@
+#include "mesh_optimizer.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+
+namespace simple_renderer {
+
+namespace {
+
+inline constexpr uint32_t kNoVertex = UINT32_MAX;
+
+/// 顶点的逐位键：位置、法线、UV 与颜色
+struct VertexKey {
+  uint32_t bits[10];
+
+  explicit VertexKey(const Vertex &v) {
+    const Vector4f p = v.GetPosition();
+    const Vector3f n = v.GetNormal();
+    const Vector2f uv = v.GetTexCoords();
+    const float values[9] = {p.x, p.y, p.z, p.w, n.x, n.y, n.z, uv.x, uv.y};
+    for (int i = 0; i < 9; ++i) {
+      bits[i] = std::bit_cast<uint32_t>(values[i]);
+    }
+    bits[9] = static_cast<uint32_t>(v.GetColor());
+  }
+
+  bool operator==(const VertexKey &other) const {
+    return std::memcmp(bits, other.bits, sizeof(bits)) == 0;
+  }
+};
+
+struct VertexKeyHash {
+  size_t operator()(const VertexKey &key) const {
+    uint64_t h = 1469598103934665603ull;  // FNV-1a
+    for (const uint32_t b : key.bits) {
+      h = (h ^ b) * 1099511628211ull;
+    }
+    return static_cast<size_t>(h);
+  }
+};
+
+/// 将 10 位整数的各位间隔两位展开
+inline uint32_t ExpandBits(uint32_t v) {
+  v = (v * 0x00010001u) & 0xFF0000FFu;
+  v = (v * 0x00000101u) & 0x0F00F00Fu;
+  v = (v * 0x00000011u) & 0xC30C30C3u;
+  v = (v * 0x00000005u) & 0x49249249u;
+  return v;
+}
+
+}  // namespace
+
+size_t WeldVertices(std::vector<Vertex> &vertices,
+                    std::vector<uint32_t> &indices) {
+  std::unordered_map<VertexKey, uint32_t, VertexKeyHash> unique;
+  unique.reserve(vertices.size());
+  std::vector<uint32_t> remap(vertices.size());
+  size_t count = 0;
+  for (size_t i = 0; i < vertices.size(); ++i) {
+    const auto [it, inserted] =
+        unique.try_emplace(VertexKey(vertices[i]), static_cast<uint32_t>(count));
+    if (inserted) {
+      vertices[count++] = vertices[i];
+    }
+    remap[i] = it->second;
+  }
+  vertices.resize(count);
+  for (auto &index : indices) {
+    index = remap[index];
+  }
+  return count;
+}
+
+void SortTrianglesMorton(const std::vector<Vector3f> &positions,
+                         std::vector<uint32_t> &indices) {
+  const size_t triangle_count = indices.size() / 3;
+  if (triangle_count < 2) {
+    return;
+  }
+
+  std::vector<Vector3f> centroids(triangle_count);
+  Vector3f bmin(std::numeric_limits<float>::max());
+  Vector3f bmax(std::numeric_limits<float>::lowest());
+  for (size_t t = 0; t < triangle_count; ++t) {
+    centroids[t] = (positions[indices[t * 3]] + positions[indices[t * 3 + 1]] +
+                    positions[indices[t * 3 + 2]]) /
+                   3.0f;
+    bmin = glm::min(bmin, centroids[t]);
+    bmax = glm::max(bmax, centroids[t]);
+  }
+  const Vector3f extent = bmax - bmin;
+  const float scale =
+      1023.0f / std::max({extent.x, extent.y, extent.z, 1e-20f});
+
+  std::vector<uint32_t> codes(triangle_count);
+  for (size_t t = 0; t < triangle_count; ++t) {
+    const Vector3f q = (centroids[t] - bmin) * scale;
+    codes[t] = (ExpandBits(static_cast<uint32_t>(q.x)) << 2) |
+               (ExpandBits(static_cast<uint32_t>(q.y)) << 1) |
+               ExpandBits(static_cast<uint32_t>(q.z));
+  }
+
+  std::vector<uint32_t> order(triangle_count);
+  std::iota(order.begin(), order.end(), 0u);
+  std::stable_sort(order.begin(), order.end(),
+                   [&codes](uint32_t a, uint32_t b) {
+                     return codes[a] < codes[b];
+                   });
+
+  std::vector<uint32_t> sorted(indices.size());
+  for (size_t t = 0; t < triangle_count; ++t) {
+    std::copy_n(indices.begin() + order[t] * 3, 3, sorted.begin() + t * 3);
+  }
+  indices.swap(sorted);
+}
+
+void OptimizeVertexCache(std::vector<uint32_t> &indices, size_t vertex_count,
+                         size_t cache_size) {
+  const size_t triangle_count = indices.size() / 3;
+  if (triangle_count == 0) {
+    return;
+  }
+
+  // 顶点 -> 三角形邻接（CSR），live 为尚未输出的相邻三角形数
+  std::vector<uint32_t> live(vertex_count, 0);
+  for (const uint32_t v : indices) live[v]++;
+  std::vector<uint32_t> adjacency_offset(vertex_count + 1, 0);
+  for (size_t v = 0; v < vertex_count; ++v) {
+    adjacency_offset[v + 1] = adjacency_offset[v] + live[v];
+  }
+  std::vector<uint32_t> adjacency(indices.size());
+  {
+    std::vector<uint32_t> cursor(adjacency_offset.begin(),
+                                 adjacency_offset.end() - 1);
+    for (size_t i = 0; i < indices.size(); ++i) {
+      adjacency[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+  }
+
+  std::vector<uint32_t> cache_time(vertex_count, 0);
+  std::vector<uint8_t> emitted(triangle_count, 0);
+  std::vector<uint32_t> dead_end;
+  std::vector<uint32_t> candidates;
+  std::vector<uint32_t> result;
+  result.reserve(indices.size());
+
+  auto time_stamp = static_cast<uint32_t>(cache_size + 1);
+  size_t input_cursor = 0;
+  uint32_t fanning = indices[0];
+  while (fanning != kNoVertex) {
+    // 输出 fanning 顶点的全部剩余三角形
+    candidates.clear();
+    for (uint32_t a = adjacency_offset[fanning];
+         a < adjacency_offset[fanning + 1]; ++a) {
+      const uint32_t t = adjacency[a];
+      if (emitted[t]) continue;
+      emitted[t] = 1;
+      for (int k = 0; k < 3; ++k) {
+        const uint32_t v = indices[t * 3 + k];
+        result.push_back(v);
+        dead_end.push_back(v);
+        candidates.push_back(v);
+        live[v]--;
+        if (time_stamp - cache_time[v] > cache_size) {
+          cache_time[v] = time_stamp++;
+        }
+      }
+    }
+
+    // 选择仍在缓存中且在下一轮输出后不会被挤出的顶点，越老越优先
+    fanning = kNoVertex;
+    int64_t best_priority = -1;
+    for (const uint32_t v : candidates) {
+      if (live[v] == 0) continue;
+      int64_t priority = 0;
+      if (time_stamp - cache_time[v] + 2 * live[v] <= cache_size) {
+        priority = time_stamp - cache_time[v];
+      }
+      if (priority > best_priority) {
+        best_priority = priority;
+        fanning = v;
+      }
+    }
+    if (fanning != kNoVertex) continue;
+
+    // 死路：先回溯最近输出的顶点，再按输入顺序取下一个未输出的三角形
+    while (!dead_end.empty()) {
+      const uint32_t v = dead_end.back();
+      dead_end.pop_back();
+      if (live[v] > 0) {
+        fanning = v;
+        break;
+      }
+    }
+    if (fanning != kNoVertex) continue;
+    while (input_cursor < triangle_count && emitted[input_cursor]) {
+      ++input_cursor;
+    }
+    if (input_cursor < triangle_count) {
+      fanning = indices[input_cursor * 3];
+    }
+  }
+  indices.swap(result);
+}
+
+std::vector<uint32_t> BuildVertexFetchRemap(const std::vector<uint32_t> &indices,
+                                            size_t vertex_count) {
+  std::vector<uint32_t> remap(vertex_count, kNoVertex);
+  uint32_t next = 0;
+  for (const uint32_t v : indices) {
+    if (remap[v] == kNoVertex) {
+      remap[v] = next++;
+    }
+  }
+  for (auto &r : remap) {
+    if (r == kNoVertex) {
+      r = next++;
+    }
+  }
+  return remap;
+}
+
+}  // namespace simple_renderer
@@ -0,0 +1,386 @@
+#include "mesh_simplifier.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <unordered_map>
+#include <utility>
+
+namespace simple_renderer {
+
+namespace {
+
+/// 对称 4x4 二次型（平面距离平方和），w 为累计权重
+struct Quadric {
+  double a00 = 0, a11 = 0, a22 = 0, a01 = 0, a02 = 0, a12 = 0;
+  double b0 = 0, b1 = 0, b2 = 0;
+  double c = 0;
+  double w = 0;
+
+  void AddPlane(double nx, double ny, double nz, double d, double weight) {
+    a00 += weight * nx * nx;
+    a11 += weight * ny * ny;
+    a22 += weight * nz * nz;
+    a01 += weight * nx * ny;
+    a02 += weight * nx * nz;
+    a12 += weight * ny * nz;
+    b0 += weight * nx * d;
+    b1 += weight * ny * d;
+    b2 += weight * nz * d;
+    c += weight * d * d;
+    w += weight;
+  }
+
+  void Add(const Quadric &q) {
+    a00 += q.a00; a11 += q.a11; a22 += q.a22;
+    a01 += q.a01; a02 += q.a02; a12 += q.a12;
+    b0 += q.b0; b1 += q.b1; b2 += q.b2;
+    c += q.c;
+    w += q.w;
+  }
+
+  /// 点到各平面的加权平均距离平方
+  [[nodiscard]] double Evaluate(const Vector3f &p) const {
+    const double x = p.x, y = p.y, z = p.z;
+    const double e = a00 * x * x + a11 * y * y + a22 * z * z +
+                     2.0 * (a01 * x * y + a02 * x * z + a12 * y * z) +
+                     2.0 * (b0 * x + b1 * y + b2 * z) + c;
+    return w > 0.0 ? std::max(0.0, e) / w : 0.0;
+  }
+};
+
+/// 顶点类别：决定可以沿哪些边折叠
+enum class VertexKind : uint8_t {
+  kManifold,  //!< 内部顶点，可向任意相邻顶点折叠
+  kBorder,    //!< 开放边界上的顶点，只能沿边界边折叠
+  kSeam,      //!< 属性接缝上的顶点（同位置恰有两个顶点），与对侧一起沿接缝折叠
+  kLocked,    //!< 角点、接缝交汇等复杂情况，不可移动
+};
+
+/// 折叠候选：source 顶点并入 target 顶点；接缝折叠时对侧顶点同时折叠
+struct Collapse {
+  uint32_t source;
+  uint32_t target;
+  uint32_t sibling_source;
+  uint32_t sibling_target;
+  double cost;
+};
+
+inline constexpr uint32_t kNoVertex = UINT32_MAX;
+/// 边界边约束平面的权重（相对三角形平面）
+inline constexpr double kBorderWeight = 10.0;
+
+inline uint64_t EdgeKey(uint32_t a, uint32_t b) {
+  if (a > b) std::swap(a, b);
+  return (static_cast<uint64_t>(a) << 32) | b;
+}
+
+/// 将完全相同的位置映射到同一代表顶点
+std::vector<uint32_t> BuildPositionRemap(const std::vector<Vector3f> &positions) {
+  struct PositionHash {
+    size_t operator()(const Vector3f &p) const {
+      const auto hx = std::bit_cast<uint32_t>(p.x);
+      const auto hy = std::bit_cast<uint32_t>(p.y);
+      const auto hz = std::bit_cast<uint32_t>(p.z);
+      return (hx * 73856093u) ^ (hy * 19349663u) ^ (hz * 83492791u);
+    }
+  };
+  std::unordered_map<Vector3f, uint32_t, PositionHash> first_index;
+  first_index.reserve(positions.size());
+  std::vector<uint32_t> remap(positions.size());
+  for (uint32_t i = 0; i < positions.size(); ++i) {
+    remap[i] = first_index.try_emplace(positions[i], i).first->second;
+  }
+  return remap;
+}
+
+}  // namespace
+
+std::vector<uint32_t> SimplifyMesh(const std::vector<Vector3f> &positions,
+                                   const std::vector<uint32_t> &indices,
+                                   size_t target_index_count,
+                                   float *out_error) {
+  std::vector<uint32_t> result = indices;
+  double max_error = 0.0;
+  const size_t vertex_count = positions.size();
+  if (result.size() <= target_index_count || vertex_count == 0) {
+    if (out_error) *out_error = 0.0f;
+    return result;
+  }
+
+  // 同位置顶点组成环形链表（wedge），用于查找接缝对侧顶点
+  const std::vector<uint32_t> position_remap = BuildPositionRemap(positions);
+  std::vector<uint32_t> wedge(vertex_count);
+  for (uint32_t i = 0; i < vertex_count; ++i) wedge[i] = i;
+  for (uint32_t i = 0; i < vertex_count; ++i) {
+    const uint32_t r = position_remap[i];
+    if (r != i) {
+      wedge[i] = wedge[r];
+      wedge[r] = i;
+    }
+  }
+
+  const auto position_edge_key = [&position_remap](uint32_t a, uint32_t b) {
+    return EdgeKey(position_remap[a], position_remap[b]);
+  };
+  std::unordered_map<uint64_t, uint32_t> index_edges;
+  std::unordered_map<uint64_t, uint32_t> position_edges;
+  const auto count_edges = [&]() {
+    index_edges.clear();
+    position_edges.clear();
+    for (size_t t = 0; t + 2 < result.size(); t += 3) {
+      for (int e = 0; e < 3; ++e) {
+        const uint32_t a = result[t + e], b = result[t + (e + 1) % 3];
+        index_edges[EdgeKey(a, b)]++;
+        position_edges[position_edge_key(a, b)]++;
+      }
+    }
+  };
+
+  // 初始二次型：三角形平面按面积加权；开放边界边额外加入垂直于三角形的约束平面
+  std::vector<Quadric> quadrics(vertex_count);
+  count_edges();
+  for (size_t t = 0; t + 2 < result.size(); t += 3) {
+    const Vector3f &p0 = positions[result[t]];
+    const Vector3f &p1 = positions[result[t + 1]];
+    const Vector3f &p2 = positions[result[t + 2]];
+    const Vector3f n = glm::cross(p1 - p0, p2 - p0);
+    const double len = glm::length(n);
+    if (len <= 0.0) continue;
+    const double nx = n.x / len, ny = n.y / len, nz = n.z / len;
+    const double d = -(nx * p0.x + ny * p0.y + nz * p0.z);
+    const double area = 0.5 * len;
+    for (int k = 0; k < 3; ++k) {
+      quadrics[result[t + k]].AddPlane(nx, ny, nz, d, area);
+    }
+    for (int e = 0; e < 3; ++e) {
+      const uint32_t a = result[t + e], b = result[t + (e + 1) % 3];
+      if (position_edges[position_edge_key(a, b)] != 1) continue;
+      const Vector3f edge = positions[b] - positions[a];
+      const Vector3f bn = glm::cross(edge, n);
+      const double bl = glm::length(bn);
+      if (bl <= 0.0) continue;
+      const double bx = bn.x / bl, by = bn.y / bl, bz = bn.z / bl;
+      const double bd = -(bx * positions[a].x + by * positions[a].y +
+                          bz * positions[a].z);
+      const double weight = kBorderWeight * glm::dot(edge, edge);
+      quadrics[a].AddPlane(bx, by, bz, bd, weight);
+      quadrics[b].AddPlane(bx, by, bz, bd, weight);
+    }
+  }
+
+  std::vector<uint32_t> remap(vertex_count);
+  std::vector<uint8_t> pass_locked(vertex_count);
+  std::vector<uint32_t> adjacency_offset(vertex_count + 1);
+  std::vector<uint32_t> adjacency;
+  std::vector<uint8_t> live(vertex_count);
+  std::vector<uint8_t> open_edges(vertex_count);
+  std::vector<uint8_t> on_border(vertex_count);
+  std::vector<VertexKind> kinds(vertex_count);
+  std::vector<Collapse> collapses;
+
+  // 折叠后 source 的其余三角形法线不得反转；同时统计将退化删除的三角形数
+  const auto is_valid_collapse = [&](uint32_t source, uint32_t target,
+                                     size_t &degenerate) {
+    const Vector3f &target_pos = positions[target];
+    for (uint32_t a = adjacency_offset[source];
+         a < adjacency_offset[source + 1]; ++a) {
+      const size_t t = adjacency[a];
+      const uint32_t tri[3] = {remap[result[t * 3]], remap[result[t * 3 + 1]],
+                               remap[result[t * 3 + 2]]};
+      if (tri[0] == target || tri[1] == target || tri[2] == target) {
+        ++degenerate;
+        continue;
+      }
+      const Vector3f p0 = positions[tri[0]];
+      const Vector3f p1 = positions[tri[1]];
+      const Vector3f p2 = positions[tri[2]];
+      const Vector3f n_old = glm::cross(p1 - p0, p2 - p0);
+      const Vector3f q0 = tri[0] == source ? target_pos : p0;
+      const Vector3f q1 = tri[1] == source ? target_pos : p1;
+      const Vector3f q2 = tri[2] == source ? target_pos : p2;
+      const Vector3f n_new = glm::cross(q1 - q0, q2 - q0);
+      if (glm::dot(n_old, n_new) <= 0.0f) {
+        return false;
+      }
+    }
+    return true;
+  };
+  const auto collapse_cost = [&quadrics, &positions](uint32_t source,
+                                                     uint32_t target) {
+    Quadric q = quadrics[source];
+    q.Add(quadrics[target]);
+    return q.Evaluate(positions[target]);
+  };
+
+  // 逐轮折叠：每轮按代价升序折叠互不相邻的边，然后重写索引
+  while (result.size() > target_index_count) {
+    const size_t triangle_count = result.size() / 3;
+    const size_t target_triangles = target_index_count / 3;
+
+    // 顶点 -> 三角形邻接（CSR）
+    std::fill(adjacency_offset.begin(), adjacency_offset.end(), 0u);
+    for (const uint32_t v : result) adjacency_offset[v + 1]++;
+    for (size_t v = 0; v < vertex_count; ++v) {
+      adjacency_offset[v + 1] += adjacency_offset[v];
+    }
+    adjacency.resize(result.size());
+    {
+      std::vector<uint32_t> cursor(adjacency_offset.begin(),
+                                   adjacency_offset.end() - 1);
+      for (size_t i = 0; i < result.size(); ++i) {
+        adjacency[cursor[result[i]]++] = static_cast<uint32_t>(i / 3);
+      }
+    }
+
+    // 顶点分类：按索引统计开放边（接缝与边界），按位置区分真正的几何边界
+    count_edges();
+    std::fill(live.begin(), live.end(), uint8_t{0});
+    std::fill(open_edges.begin(), open_edges.end(), uint8_t{0});
+    std::fill(on_border.begin(), on_border.end(), uint8_t{0});
+    for (const uint32_t v : result) live[v] = 1;
+    for (const auto &[key, count] : index_edges) {
+      if (count != 1) continue;
+      const auto a = static_cast<uint32_t>(key >> 32);
+      const auto b = static_cast<uint32_t>(key);
+      open_edges[a] = static_cast<uint8_t>(std::min(open_edges[a] + 1, 255));
+      open_edges[b] = static_cast<uint8_t>(std::min(open_edges[b] + 1, 255));
+      if (position_edges[position_edge_key(a, b)] == 1) {
+        on_border[a] = 1;
+        on_border[b] = 1;
+      }
+    }
+    for (uint32_t v = 0; v < vertex_count; ++v) {
+      uint32_t wedge_count = 0;
+      for (uint32_t w = wedge[v];; w = wedge[w]) {
+        wedge_count += live[w];
+        if (w == v) break;
+      }
+      if (!live[v]) {
+        kinds[v] = VertexKind::kLocked;
+      } else if (wedge_count == 1 && open_edges[v] == 0) {
+        kinds[v] = VertexKind::kManifold;
+      } else if (wedge_count == 1 && open_edges[v] == 2 && on_border[v]) {
+        kinds[v] = VertexKind::kBorder;
+      } else if (wedge_count == 2 && open_edges[v] == 2 && !on_border[v]) {
+        kinds[v] = VertexKind::kSeam;
+      } else {
+        kinds[v] = VertexKind::kLocked;
+      }
+    }
+    const auto is_open_edge = [&index_edges](uint32_t a, uint32_t b) {
+      const auto it = index_edges.find(EdgeKey(a, b));
+      return it != index_edges.end() && it->second == 1;
+    };
+    const auto live_sibling = [&](uint32_t v) {
+      for (uint32_t w = wedge[v]; w != v; w = wedge[w]) {
+        if (live[w]) return w;
+      }
+      return kNoVertex;
+    };
+
+    // 候选边：每条有向边 source -> target，按 source 类别约束折叠方向
+    collapses.clear();
+    for (size_t t = 0; t < triangle_count; ++t) {
+      for (int e = 0; e < 3; ++e) {
+        const uint32_t a = result[t * 3 + e];
+        const uint32_t b = result[t * 3 + (e + 1) % 3];
+        for (const auto &[src, dst] : {std::pair{a, b}, std::pair{b, a}}) {
+          switch (kinds[src]) {
+            case VertexKind::kManifold:
+              collapses.push_back(
+                  {src, dst, kNoVertex, kNoVertex, collapse_cost(src, dst)});
+              break;
+            case VertexKind::kBorder:
+              if (is_open_edge(src, dst)) {
+                collapses.push_back(
+                    {src, dst, kNoVertex, kNoVertex, collapse_cost(src, dst)});
+              }
+              break;
+            case VertexKind::kSeam: {
+              if (!is_open_edge(src, dst)) break;
+              // 对侧：与 src 同位置的顶点，须沿对应的接缝边折叠到 dst 的同位置顶点
+              const uint32_t src_sibling = live_sibling(src);
+              uint32_t dst_sibling = kNoVertex;
+              for (uint32_t w = wedge[dst]; w != dst; w = wedge[w]) {
+                if (live[w] && is_open_edge(src_sibling, w)) {
+                  dst_sibling = w;
+                  break;
+                }
+              }
+              if (dst_sibling == kNoVertex) break;
+              collapses.push_back({src, dst, src_sibling, dst_sibling,
+                                   collapse_cost(src, dst) +
+                                       collapse_cost(src_sibling, dst_sibling)});
+              break;
+            }
+            case VertexKind::kLocked:
+              break;
+          }
+        }
+      }
+    }
+    if (collapses.empty()) break;
+    std::sort(collapses.begin(), collapses.end(),
+              [](const Collapse &x, const Collapse &y) {
+                return x.cost < y.cost;
+              });
+
+    for (uint32_t v = 0; v < vertex_count; ++v) remap[v] = v;
+    std::fill(pass_locked.begin(), pass_locked.end(), uint8_t{0});
+
+    size_t removed = 0;
+    size_t applied = 0;
+    for (const auto &c : collapses) {
+      if (triangle_count - removed <= target_triangles) break;
+      const bool seam = c.sibling_source != kNoVertex;
+      if (pass_locked[c.source] || pass_locked[c.target] ||
+          (seam && (pass_locked[c.sibling_source] ||
+                    pass_locked[c.sibling_target]))) {
+        continue;
+      }
+      size_t degenerate = 0;
+      if (!is_valid_collapse(c.source, c.target, degenerate) ||
+          (seam &&
+           !is_valid_collapse(c.sibling_source, c.sibling_target, degenerate))) {
+        continue;
+      }
+
+      remap[c.source] = c.target;
+      quadrics[c.target].Add(quadrics[c.source]);
+      pass_locked[c.source] = 1;
+      pass_locked[c.target] = 1;
+      if (seam) {
+        remap[c.sibling_source] = c.sibling_target;
+        quadrics[c.sibling_target].Add(quadrics[c.sibling_source]);
+        pass_locked[c.sibling_source] = 1;
+        pass_locked[c.sibling_target] = 1;
+      }
+      // 接缝代价为两侧之和，误差取其一侧的量级
+      max_error = std::max(max_error, seam ? c.cost * 0.5 : c.cost);
+      removed += degenerate;
+      ++applied;
+    }
+    if (applied == 0) break;
+
+    // 重写索引并删除退化三角形
+    size_t write = 0;
+    for (size_t t = 0; t < triangle_count; ++t) {
+      const uint32_t a = remap[result[t * 3]];
+      const uint32_t b = remap[result[t * 3 + 1]];
+      const uint32_t c = remap[result[t * 3 + 2]];
+      if (a == b || b == c || a == c) continue;
+      result[write++] = a;
+      result[write++] = b;
+      result[write++] = c;
+    }
+    result.resize(write);
+  }
+
+  if (out_error) {
+    *out_error = static_cast<float>(std::sqrt(max_error));
+  }
+  return result;
+}
+
+}  // namespace simple_renderer
@@ -0,0 +1,198 @@
+#include "meshlet.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace simple_renderer {
+
+void ComputeMeshletBounds(const VertexStreams &vertices,
+                          const std::vector<Face> &faces,
+                          const std::vector<uint32_t> &meshlet_vertices,
+                          Meshlet &meshlet) {
+  // AABB 与包围球（以 AABB 中心为球心）
+  const auto position = [&vertices](size_t index) {
+    return vertices.GetPosition(index);
+  };
+  Vector3f bmin = position(meshlet_vertices[meshlet.vertex_offset]);
+  Vector3f bmax = bmin;
+  for (uint32_t i = 1; i < meshlet.vertex_count; ++i) {
+    const Vector3f p = position(meshlet_vertices[meshlet.vertex_offset + i]);
+    bmin = glm::min(bmin, p);
+    bmax = glm::max(bmax, p);
+  }
+  meshlet.bounds_min = bmin;
+  meshlet.bounds_max = bmax;
+  meshlet.center = (bmin + bmax) * 0.5f;
+  float radius2 = 0.0f;
+  for (uint32_t i = 0; i < meshlet.vertex_count; ++i) {
+    const Vector3f d =
+        position(meshlet_vertices[meshlet.vertex_offset + i]) - meshlet.center;
+    radius2 = std::max(radius2, glm::dot(d, d));
+  }
+  meshlet.radius = std::sqrt(radius2);
+
+  // 法线锥：几何法线（与光栅化背面剔除的绕序一致）的平均方向与最大偏角
+  meshlet.cone_axis = Vector3f(0.0f, 0.0f, 1.0f);
+  meshlet.cone_cutoff = 1.0f;
+  std::vector<Vector3f> normals;
+  normals.reserve(meshlet.face_count);
+  Vector3f axis(0.0f);
+  for (uint32_t f = 0; f < meshlet.face_count; ++f) {
+    const Face &face = faces[meshlet.face_offset + f];
+    const Vector3f p0 = position(face.GetIndex(0));
+    const Vector3f n =
+        glm::cross(position(face.GetIndex(1)) - p0, position(face.GetIndex(2)) - p0);
+    const float len = glm::length(n);
+    if (len <= std::numeric_limits<float>::epsilon()) {
+      continue;  // 退化三角形不参与
+    }
+    normals.push_back(n / len);
+    axis += normals.back();
+  }
+  const float axis_len = glm::length(axis);
+  if (normals.empty() || axis_len <= std::numeric_limits<float>::epsilon()) {
+    return;  // 保持 cone_cutoff = 1，不做背面剔除
+  }
+  axis /= axis_len;
+  float min_dot = 1.0f;
+  for (const auto &n : normals) {
+    min_dot = std::min(min_dot, glm::dot(axis, n));
+  }
+  meshlet.cone_axis = axis;
+  // 偏角超过 90 度时任何视点都能看到部分正面
+  meshlet.cone_cutoff =
+      min_dot <= 0.0f ? 1.0f : std::sqrt(1.0f - min_dot * min_dot);
+}
+
+void BuildMeshlets(const VertexStreams &vertices, std::vector<Face> &faces,
+                   size_t face_offset, size_t face_count,
+                   std::vector<Meshlet> &meshlets,
+                   std::vector<uint32_t> &meshlet_vertices) {
+  if (face_count == 0) {
+    return;
+  }
+
+  // 该段面引用的顶点范围，用于建立局部邻接表
+  size_t vmin = std::numeric_limits<size_t>::max();
+  size_t vmax = 0;
+  for (size_t f = face_offset; f < face_offset + face_count; ++f) {
+    for (const size_t v : faces[f].GetIndices()) {
+      vmin = std::min(vmin, v);
+      vmax = std::max(vmax, v);
+    }
+  }
+  const size_t local_vertex_count = vmax - vmin + 1;
+
+  // 顶点 -> 三角形邻接（CSR）
+  std::vector<uint32_t> adjacency_offset(local_vertex_count + 1, 0);
+  for (size_t f = face_offset; f < face_offset + face_count; ++f) {
+    for (const size_t v : faces[f].GetIndices()) {
+      adjacency_offset[v - vmin + 1]++;
+    }
+  }
+  for (size_t v = 0; v < local_vertex_count; ++v) {
+    adjacency_offset[v + 1] += adjacency_offset[v];
+  }
+  std::vector<uint32_t> adjacency(adjacency_offset.back());
+  {
+    std::vector<uint32_t> cursor(adjacency_offset.begin(),
+                                 adjacency_offset.end() - 1);
+    for (size_t t = 0; t < face_count; ++t) {
+      for (const size_t v : faces[face_offset + t].GetIndices()) {
+        adjacency[cursor[v - vmin]++] = static_cast<uint32_t>(t);
+      }
+    }
+  }
+
+  const size_t first_meshlet = meshlets.size();
+  std::vector<uint8_t> assigned(face_count, 0);
+  // 顶点在当前 meshlet 中是否已存在（按 meshlet 序号标记，避免每次清零）
+  std::vector<uint32_t> vertex_tag(local_vertex_count,
+                                   std::numeric_limits<uint32_t>::max());
+  std::vector<uint32_t> order;  // 重排后的三角形顺序（局部序号）
+  order.reserve(face_count);
+
+  size_t seed_cursor = 0;
+  uint32_t tag = 0;
+  while (order.size() < face_count) {
+    while (assigned[seed_cursor]) {
+      ++seed_cursor;
+    }
+
+    Meshlet meshlet;
+    meshlet.vertex_offset = static_cast<uint32_t>(meshlet_vertices.size());
+    meshlet.face_offset = static_cast<uint32_t>(face_offset + order.size());
+
+    // 三角形中尚未进入当前 meshlet 的顶点数
+    auto new_vertex_count = [&](size_t t) {
+      uint32_t count = 0;
+      for (const size_t v : faces[face_offset + t].GetIndices()) {
+        count += vertex_tag[v - vmin] != tag ? 1u : 0u;
+      }
+      return count;
+    };
+    auto append = [&](size_t t) {
+      assigned[t] = 1;
+      order.push_back(static_cast<uint32_t>(t));
+      meshlet.face_count++;
+      for (const size_t v : faces[face_offset + t].GetIndices()) {
+        if (vertex_tag[v - vmin] != tag) {
+          vertex_tag[v - vmin] = tag;
+          meshlet_vertices.push_back(static_cast<uint32_t>(v));
+          meshlet.vertex_count++;
+        }
+      }
+    };
+
+    append(seed_cursor);
+    while (meshlet.face_count < kMeshletMaxTriangles) {
+      // 在当前 meshlet 顶点的邻接三角形中挑选新增顶点最少者
+      size_t best = face_count;
+      uint32_t best_new = 4;
+      for (uint32_t i = 0; i < meshlet.vertex_count && best_new > 0; ++i) {
+        const size_t v = meshlet_vertices[meshlet.vertex_offset + i] - vmin;
+        for (uint32_t a = adjacency_offset[v]; a < adjacency_offset[v + 1];
+             ++a) {
+          const uint32_t t = adjacency[a];
+          if (assigned[t]) continue;
+          const uint32_t n = new_vertex_count(t);
+          if (n < best_new) {
+            best_new = n;
+            best = t;
+            if (n == 0) break;
+          }
+        }
+      }
+      // 无相邻三角形时按原顺序取下一个，保证小碎片也能被合并
+      if (best == face_count) {
+        while (seed_cursor < face_count && assigned[seed_cursor]) {
+          ++seed_cursor;
+        }
+        if (seed_cursor == face_count) break;
+        best = seed_cursor;
+        best_new = new_vertex_count(best);
+      }
+      if (meshlet.vertex_count + best_new > kMeshletMaxVertices) break;
+      append(best);
+    }
+
+    meshlets.push_back(meshlet);
+    ++tag;
+  }
+
+  // 按 meshlet 顺序原地重排面
+  std::vector<Face> reordered;
+  reordered.reserve(face_count);
+  for (const uint32_t t : order) {
+    reordered.push_back(std::move(faces[face_offset + t]));
+  }
+  std::move(reordered.begin(), reordered.end(), faces.begin() + face_offset);
+
+  for (size_t m = first_meshlet; m < meshlets.size(); ++m) {
+    ComputeMeshletBounds(vertices, faces, meshlet_vertices, meshlets[m]);
+  }
+}
+
+}  // namespace simple_renderer
@@ -20,13 +20,31 @@
 
 #include <assimp/Importer.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <string>
+#include <unordered_map>
 #include <utility>
 
 #include "log_system.h"
+#include "mesh_optimizer.hpp"
+#include "mesh_simplifier.hpp"
+#include "vertex_kernel.hpp"
 
 namespace simple_renderer {
 
+namespace {
+
+// aiMatrix4x4 is row-major, glm is column-major
+// aiMatrix4x4 为行主序，glm 为列主序
+Matrix4f ToMatrix4f(const aiMatrix4x4& t) {
+  return Matrix4f(t.a1, t.b1, t.c1, t.d1, t.a2, t.b2, t.c2, t.d2, t.a3, t.b3,
+                  t.c3, t.d3, t.a4, t.b4, t.c4, t.d4);
+}
+
+}  // namespace
+
 // Constructor that loads a model from a file path
 // 构造函数从文件路径加载模型
 Model::Model(const std::string& model_path) { LoadModel(model_path); }
@@ -52,42 +70,96 @@ void Model::LoadModel(const std::string& path) {
 
   // Process the root node recursively
   // 递归处理根节点
-  ProcessNode(scene->mRootNode, scene);
+  ProcessNode(scene->mRootNode, scene, -1);
+  ProcessAnimations(scene);
+  if (IsDeformable()) {
+    // Vertices of meshes without bones keep the bind pose
+    // 无骨骼网格的顶点保持绑定姿态
+    skin_weights_.PadTo(vertices_.size());
+    bind_vertices_ = vertices_;
+  }
+  BuildBounds();
 
   SPDLOG_INFO(
       "Loaded model path: {},  with vertices: {}, triangles: {}, "
-      "meshes: {}, materials: {}",
+      "meshes: {}, materials: {}, nodes: {}, instances: {}, meshlets: {}",
       path, static_cast<int>(vertices_.size()), static_cast<int>(faces_.size()),
-      scene->mNumMeshes, scene->mNumMaterials);
+      scene->mNumMeshes, scene->mNumMaterials, nodes_.size(),
+      instances_.size(), meshlets_.size());
+  if (IsDeformable()) {
+    SPDLOG_INFO("bones: {}, morph targets: {}, animations: {}", bones_.size(),
+                morph_targets_.size(), animations_.size());
+  }
 }
 
-// Recursively process nodes in the model
-// 递归处理模型中的节点
-void Model::ProcessNode(aiNode* node, const aiScene* scene) {
+// Recursively process nodes in the model, keeping the hierarchy
+// 递归处理模型中的节点，保留层级关系
+void Model::ProcessNode(aiNode* node, const aiScene* scene, int32_t parent) {
+  SceneNode scene_node;
+  scene_node.name = node->mName.C_Str();
+  scene_node.local_transform = ToMatrix4f(node->mTransformation);
+  scene_node.parent = parent;
+  scene_node.global_transform =
+      parent < 0 ? scene_node.local_transform
+                 : nodes_[parent].global_transform * scene_node.local_transform;
+
+  const size_t node_index = nodes_.size();
+  nodes_.push_back(std::move(scene_node));
+  if (parent >= 0) {
+    nodes_[parent].children.push_back(node_index);
+  }
+
   // Process each mesh in the node
   // 处理节点中的每个网格
   for (unsigned int i = 0; i < node->mNumMeshes; i++) {
     aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-    ProcessMesh(mesh, scene);
+    ProcessMesh(mesh, scene, node->mMeshes[i], node_index);
   }
 
   // Recursively process each child node
   // 递归处理每个子节点
   for (unsigned int i = 0; i < node->mNumChildren; i++) {
-    ProcessNode(node->mChildren[i], scene);
+    ProcessNode(node->mChildren[i], scene, static_cast<int32_t>(node_index));
   }
 }
 
 // Process a single mesh and extract vertices, normals, and faces
 // 处理单个网格并提取顶点、法线和面
-void Model::ProcessMesh(aiMesh* mesh, const aiScene* scene) {
+void Model::ProcessMesh(aiMesh* mesh, const aiScene* scene, size_t mesh_index,
+                        size_t node_index) {
+  MeshInstance instance;
+  instance.mesh_index = mesh_index;
+  instance.node_index = node_index;
+  instance.vertex_offset = vertices_.size();
+  instance.vertex_count = mesh->mNumVertices;
+  instance.face_offset = faces_.size();
+
+  // The node transform is baked into the vertices, so renderers keep working
+  // in model space; identity transforms leave the data untouched
+  // 节点变换烘焙进顶点，渲染器仍在模型空间工作；单位变换时保持原始数据
+  const Matrix4f& transform = nodes_[node_index].global_transform;
+  const bool has_transform = transform != Matrix4f(1.0f);
+  const Matrix3f normal_matrix =
+      glm::transpose(glm::inverse(Matrix3f(transform)));
+  // Bone weights and morph targets are indexed like the Assimp vertices;
+  // meshes of animated scenes are deformable even without bones
+  // 骨骼权重与变形目标按 Assimp 顶点索引；动画场景中的网格即使无骨骼也可形变
+  const bool deformable = mesh->mNumBones > 0 || mesh->mNumAnimMeshes > 0 ||
+                          scene->mNumAnimations > 0;
+
   // Process vertices
   // 处理顶点
+  std::vector<Vertex> mesh_vertices;
+  mesh_vertices.reserve(mesh->mNumVertices);
   for (unsigned int i = 0; i < mesh->mNumVertices; ++i) {
     Vector3f position(mesh->mVertices[i].x, mesh->mVertices[i].y,
                       mesh->mVertices[i].z);
     Vector3f normal(mesh->mNormals[i].x, mesh->mNormals[i].y,
                     mesh->mNormals[i].z);
+    if (has_transform) {
+      position = Vector3f(transform * Vector4f(position, 1.0f));
+      normal = glm::normalize(normal_matrix * normal);
+    }
     Vector2f texCoords(0.0f, 0.0f);
     // Check if the mesh has texture coordinates
     // 检查网格是否有纹理坐标
@@ -99,29 +171,752 @@ void Model::ProcessMesh(aiMesh* mesh, const aiScene* scene) {
     Color color(255.f, 255.f, 255.f, 255.f);  // Default color (white)
                                               // 默认颜色（白色）
 
-    vertices_.emplace_back(Vector4f(position, 1.0f), normal, texCoords, color);
+    // Expand the instance bounding box (the first vertex initializes it)
+    // 扩展实例包围盒（首个顶点用于初始化）
+    if (i == 0) {
+      instance.bounds_min = instance.bounds_max = position;
+    } else {
+      instance.bounds_min = glm::min(instance.bounds_min, position);
+      instance.bounds_max = glm::max(instance.bounds_max, position);
+    }
+
+    mesh_vertices.emplace_back(Vector4f(position, 1.0f), normal, texCoords,
+                               color);
   }
 
   // Process faces (assuming triangulation, so each face has 3 vertices)
+  // A mirroring transform flips the winding, so restore it by swapping i1/i2
   // 处理面（假设三角化，因此每个面有3个顶点）
+  // 镜像变换会翻转环绕方向，交换 i1/i2 以恢复
+  const bool mirrored = glm::determinant(transform) < 0.0f;
+  std::vector<uint32_t> indices;
+  indices.reserve(mesh->mNumFaces * kTriangleFaceVertexCount);
   for (unsigned int i = 0; i < mesh->mNumFaces; ++i) {
-    aiFace face = mesh->mFaces[i];
+    const aiFace& face = mesh->mFaces[i];
     if (face.mNumIndices == 3) {  // Triangle, 三角形
-      size_t v0 = face.mIndices[0];
-      size_t v1 = face.mIndices[1];
-      size_t v2 = face.mIndices[2];
+      indices.push_back(face.mIndices[0]);
+      indices.push_back(face.mIndices[mirrored ? 2 : 1]);
+      indices.push_back(face.mIndices[mirrored ? 1 : 2]);
+    }
+  }
+
+  // Load-time optimization: weld identical vertices, sort triangles along a
+  // Morton curve, then reorder them for the post-transform vertex cache
+  // 加载时优化：焊接相同顶点，按 Morton 曲线排序三角形，再按后变换顶点缓存重排
+  // Deformable meshes are not welded so vertex indices stay those of Assimp
+  // 可形变网格不焊接，顶点索引保持与 Assimp 一致
+  if (!deformable) {
+    WeldVertices(mesh_vertices, indices);
+  }
+  {
+    std::vector<Vector3f> positions;
+    positions.reserve(mesh_vertices.size());
+    for (const auto& vertex : mesh_vertices) {
+      positions.emplace_back(vertex.GetPosition());
+    }
+    SortTrianglesMorton(positions, indices);
+  }
+  OptimizeVertexCache(indices, mesh_vertices.size());
+  instance.vertex_count = mesh_vertices.size();
+  vertices_.reserve(vertices_.size() + mesh_vertices.size());
+  for (const auto& vertex : mesh_vertices) {
+    vertices_.push_back(vertex);
+  }
+  if (deformable && instance.vertex_count > 0) {
+    ProcessDeformation(mesh, scene, instance, mesh_vertices);
+  }
+
+  // Process the material associated with this mesh
+  // Mesh-local indices are offset into the flat vertex array
+  // 处理与此网格关联的材质
+  // 网格内索引需加上该实例在扁平顶点数组中的偏移
+  const Material material =
+      ProcessMaterial(scene->mMaterials[mesh->mMaterialIndex]);
+  for (size_t i = 0; i < indices.size(); i += kTriangleFaceVertexCount) {
+    faces_.emplace_back(instance.vertex_offset + indices[i],
+                        instance.vertex_offset + indices[i + 1],
+                        instance.vertex_offset + indices[i + 2], material);
+  }
+  instance.face_count = faces_.size() - instance.face_offset;
+
+  // Split the mesh into meshlets (reorders this instance's faces)
+  // 将网格划分为 meshlet（会重排该实例的面）
+  instance.meshlet_offset = meshlets_.size();
+  BuildMeshlets(vertices_, faces_, instance.face_offset, instance.face_count,
+                meshlets_, meshlet_vertices_);
+  instance.meshlet_count = meshlets_.size() - instance.meshlet_offset;
+  ReorderVertexFetch(instance);
+
+  if (instance.vertex_count > 0) {
+    nodes_[node_index].instances.push_back(instances_.size());
+    instances_.push_back(instance);
+  }
+}
+
+// Merge instance bounds into the model bounds and build the instance BVH
+// 合并实例包围盒得到模型包围盒，并构建实例 BVH
+void Model::BuildBounds() {
+  std::vector<Vector3f> instance_min;
+  std::vector<Vector3f> instance_max;
+  instance_min.reserve(instances_.size());
+  instance_max.reserve(instances_.size());
+  for (const auto& instance : instances_) {
+    if (instance_min.empty()) {
+      bounds_min_ = instance.bounds_min;
+      bounds_max_ = instance.bounds_max;
+    } else {
+      bounds_min_ = glm::min(bounds_min_, instance.bounds_min);
+      bounds_max_ = glm::max(bounds_max_, instance.bounds_max);
+    }
+    instance_min.push_back(instance.bounds_min);
+    instance_max.push_back(instance.bounds_max);
+  }
+  instance_bvh_.Build(instance_min, instance_max);
+}
+
+// Renumber an instance's vertices in the order its (final) faces use them
+// 按实例（最终）面顺序中的首次使用重新编号顶点
+void Model::ReorderVertexFetch(const MeshInstance& instance) {
+  const size_t base = instance.vertex_offset;
+  std::vector<uint32_t> indices;
+  indices.reserve(instance.face_count * kTriangleFaceVertexCount);
+  for (size_t f = 0; f < instance.face_count; ++f) {
+    for (const size_t v : faces_[instance.face_offset + f].GetIndices()) {
+      indices.push_back(static_cast<uint32_t>(v - base));
+    }
+  }
+  const std::vector<uint32_t> remap =
+      BuildVertexFetchRemap(indices, instance.vertex_count);
+
+  std::vector<Vertex> reordered(instance.vertex_count);
+  for (size_t v = 0; v < instance.vertex_count; ++v) {
+    reordered[remap[v]] = vertices_.Get(base + v);
+  }
+  for (size_t v = 0; v < instance.vertex_count; ++v) {
+    vertices_.Set(base + v, reordered[v]);
+  }
+  // Skin weights and morph targets follow their vertices
+  // 骨骼权重与变形目标随顶点重排
+  if (skin_weights_.size() >= base + instance.vertex_count) {
+    skin_weights_.Permute(base, remap);
+  }
+  for (auto& target : morph_targets_) {
+    if (target.vertex_offset != base || target.position_deltas.empty()) {
+      continue;
+    }
+    std::vector<Vector3f> position_deltas(instance.vertex_count);
+    std::vector<Vector3f> normal_deltas(instance.vertex_count);
+    for (size_t v = 0; v < instance.vertex_count; ++v) {
+      position_deltas[remap[v]] = target.position_deltas[v];
+      normal_deltas[remap[v]] = target.normal_deltas[v];
+    }
+    target.position_deltas = std::move(position_deltas);
+    target.normal_deltas = std::move(normal_deltas);
+  }
 
-      // Process the material associated with this mesh
-      // 处理与此网格关联的材质
-      Material material =
-          ProcessMaterial(scene->mMaterials[mesh->mMaterialIndex]);
+  for (size_t f = 0; f < instance.face_count; ++f) {
+    Face& face = faces_[instance.face_offset + f];
+    face = Face(base + remap[face.GetIndex(0) - base],
+                base + remap[face.GetIndex(1) - base],
+                base + remap[face.GetIndex(2) - base], face.GetMaterial());
+  }
+  for (size_t m = 0; m < instance.meshlet_count; ++m) {
+    const Meshlet& meshlet = meshlets_[instance.meshlet_offset + m];
+    for (uint32_t i = 0; i < meshlet.vertex_count; ++i) {
+      uint32_t& v = meshlet_vertices_[meshlet.vertex_offset + i];
+      v = static_cast<uint32_t>(base + remap[v - base]);
+    }
+  }
+}
+
+// Keep the kMaxBoneInfluences largest weights per vertex and renormalize;
+// meshes without bones in an animated scene follow their node as a single
+// implicit bone
+// 每个顶点保留最大的 kMaxBoneInfluences 个权重并重新归一化；动画场景中
+// 无骨骼的网格作为单个隐式骨骼跟随其节点
+void Model::ProcessDeformation(aiMesh* mesh, const aiScene* scene,
+                               const MeshInstance& instance,
+                               const std::vector<Vertex>& mesh_vertices) {
+  const Matrix4f& transform = nodes_[instance.node_index].global_transform;
+  const Matrix4f inverse_transform = glm::inverse(transform);
+  const size_t count = mesh_vertices.size();
+
+  const auto add_bone = [this](Bone bone) {
+    if (bones_.size() > UINT16_MAX) {
+      SPDLOG_ERROR("Too many bones in model {}", directory_);
+      throw std::runtime_error("Too many bones in model " + directory_);
+    }
+    bones_.push_back(std::move(bone));
+    return static_cast<uint16_t>(bones_.size() - 1);
+  };
+
+  std::vector<uint16_t> joints(count * kMaxBoneInfluences, 0);
+  std::vector<float> weights(count * kMaxBoneInfluences, 0.0f);
+  if (mesh->mNumBones > 0) {
+    for (unsigned int b = 0; b < mesh->mNumBones; ++b) {
+      const aiBone* ai_bone = mesh->mBones[b];
+      Bone bone;
+      bone.name = ai_bone->mName.C_Str();
+      // The offset matrix maps mesh space to bone space, while the vertices
+      // are already in model space
+      // 偏移矩阵将网格空间映射到骨骼空间，而顶点已变换到模型空间
+      bone.inverse_bind = ToMatrix4f(ai_bone->mOffsetMatrix) * inverse_transform;
+      const uint16_t joint = add_bone(std::move(bone));
+      for (unsigned int w = 0; w < ai_bone->mNumWeights; ++w) {
+        const aiVertexWeight& vertex_weight = ai_bone->mWeights[w];
+        if (vertex_weight.mVertexId >= count || vertex_weight.mWeight <= 0.0f) {
+          continue;
+        }
+        // Replace the smallest influence
+        // 替换最小的影响
+        const size_t first = vertex_weight.mVertexId * kMaxBoneInfluences;
+        const size_t slot = static_cast<size_t>(
+            std::min_element(weights.begin() + first,
+                             weights.begin() + first + kMaxBoneInfluences) -
+            weights.begin());
+        if (vertex_weight.mWeight > weights[slot]) {
+          weights[slot] = vertex_weight.mWeight;
+          joints[slot] = joint;
+        }
+      }
+    }
+    for (size_t v = 0; v < count; ++v) {
+      float sum = 0.0f;
+      for (size_t k = 0; k < kMaxBoneInfluences; ++k) {
+        sum += weights[v * kMaxBoneInfluences + k];
+      }
+      if (sum > 0.0f) {
+        for (size_t k = 0; k < kMaxBoneInfluences; ++k) {
+          weights[v * kMaxBoneInfluences + k] /= sum;
+        }
+      }
+    }
+  } else if (scene->mNumAnimations > 0) {
+    Bone bone;
+    bone.name = nodes_[instance.node_index].name;
+    bone.node_index = static_cast<int32_t>(instance.node_index);
+    bone.inverse_bind = inverse_transform;
+    const uint16_t joint = add_bone(std::move(bone));
+    for (size_t v = 0; v < count; ++v) {
+      joints[v * kMaxBoneInfluences] = joint;
+      weights[v * kMaxBoneInfluences] = 1.0f;
+    }
+  }
+  skin_weights_.PadTo(instance.vertex_offset);
+  for (size_t v = 0; v < count; ++v) {
+    skin_weights_.push_back(&joints[v * kMaxBoneInfluences],
+                            &weights[v * kMaxBoneInfluences]);
+  }
+
+  // Morph targets store absolute positions/normals, converted to model-space
+  // deltas; mismatching targets are kept with zero deltas so the animation
+  // channel indices stay valid
+  // 变形目标存储绝对位置/法线，转换为模型空间位移；顶点数不匹配的目标保留为
+  // 零位移，以保持动画通道中的目标索引有效
+  const bool has_transform = transform != Matrix4f(1.0f);
+  const Matrix3f linear(transform);
+  const Matrix3f normal_matrix = glm::transpose(glm::inverse(linear));
+  for (unsigned int k = 0; k < mesh->mNumAnimMeshes; ++k) {
+    const aiAnimMesh* anim_mesh = mesh->mAnimMeshes[k];
+    MorphTarget target;
+    target.name = anim_mesh->mName.C_Str();
+    target.vertex_offset = instance.vertex_offset;
+    target.default_weight = anim_mesh->mWeight;
+    target.position_deltas.assign(count, Vector3f(0.0f));
+    target.normal_deltas.assign(count, Vector3f(0.0f));
+    if (anim_mesh->mNumVertices != mesh->mNumVertices) {
+      SPDLOG_WARN("morph target {} of {} has {} vertices, expected {}",
+                  target.name, directory_, anim_mesh->mNumVertices,
+                  mesh->mNumVertices);
+      morph_targets_.push_back(std::move(target));
+      continue;
+    }
+    for (size_t v = 0; v < count; ++v) {
+      if (anim_mesh->mVertices != nullptr) {
+        const aiVector3D& p = anim_mesh->mVertices[v];
+        const aiVector3D& base = mesh->mVertices[v];
+        target.position_deltas[v] =
+            linear * Vector3f(p.x - base.x, p.y - base.y, p.z - base.z);
+      }
+      if (anim_mesh->mNormals != nullptr) {
+        Vector3f normal(anim_mesh->mNormals[v].x, anim_mesh->mNormals[v].y,
+                        anim_mesh->mNormals[v].z);
+        if (has_transform) {
+          normal = glm::normalize(normal_matrix * normal);
+        }
+        target.normal_deltas[v] = normal - mesh_vertices[v].GetNormal();
+      }
+    }
+    morph_targets_.push_back(std::move(target));
+  }
+}
+
+// Bones and animation channels refer to nodes by name
+// 骨骼与动画通道按名称引用节点
+void Model::ProcessAnimations(const aiScene* scene) {
+  std::unordered_map<std::string, size_t> node_by_name;
+  for (size_t i = 0; i < nodes_.size(); ++i) {
+    node_by_name.emplace(nodes_[i].name, i);
+  }
+  for (auto& bone : bones_) {
+    if (bone.node_index >= 0) {
+      continue;
+    }
+    const auto it = node_by_name.find(bone.name);
+    if (it == node_by_name.end()) {
+      SPDLOG_WARN("bone {} of {} has no node, it keeps the bind pose",
+                  bone.name, directory_);
+      continue;
+    }
+    bone.node_index = static_cast<int32_t>(it->second);
+  }
+
+  for (unsigned int a = 0; a < scene->mNumAnimations; ++a) {
+    const aiAnimation* animation = scene->mAnimations[a];
+    const double ticks_per_second = animation->mTicksPerSecond > 0.0
+                                        ? animation->mTicksPerSecond
+                                        : kDefaultTicksPerSecond;
+    const auto seconds = [ticks_per_second](double ticks) {
+      return static_cast<float>(ticks / ticks_per_second);
+    };
+    AnimationClip clip;
+    clip.name = animation->mName.C_Str();
+    clip.duration = seconds(animation->mDuration);
+
+    for (unsigned int c = 0; c < animation->mNumChannels; ++c) {
+      const aiNodeAnim* ai_channel = animation->mChannels[c];
+      const auto it = node_by_name.find(ai_channel->mNodeName.C_Str());
+      if (it == node_by_name.end()) {
+        SPDLOG_WARN("animation {} targets unknown node {}", clip.name,
+                    ai_channel->mNodeName.C_Str());
+        continue;
+      }
+      NodeChannel channel;
+      channel.node_index = it->second;
+      for (unsigned int k = 0; k < ai_channel->mNumPositionKeys; ++k) {
+        const aiVectorKey& key = ai_channel->mPositionKeys[k];
+        channel.positions.push_back(
+            {seconds(key.mTime),
+             Vector3f(key.mValue.x, key.mValue.y, key.mValue.z)});
+      }
+      for (unsigned int k = 0; k < ai_channel->mNumRotationKeys; ++k) {
+        const aiQuatKey& key = ai_channel->mRotationKeys[k];
+        channel.rotations.push_back(
+            {seconds(key.mTime), Quaternion(key.mValue.w, key.mValue.x,
+                                            key.mValue.y, key.mValue.z)});
+      }
+      for (unsigned int k = 0; k < ai_channel->mNumScalingKeys; ++k) {
+        const aiVectorKey& key = ai_channel->mScalingKeys[k];
+        channel.scales.push_back(
+            {seconds(key.mTime),
+             Vector3f(key.mValue.x, key.mValue.y, key.mValue.z)});
+      }
+      clip.channels.push_back(std::move(channel));
+    }
 
-      // Create a Face object and store it
-      // 创建一个 Face 对象并存储它
-      Face face(v0, v1, v2, std::move(material));
-      faces_.emplace_back(face);
+    // Morph channels name the node holding the morphed mesh(es)
+    // 变形通道以网格所在节点命名
+    for (unsigned int c = 0; c < animation->mNumMorphMeshChannels; ++c) {
+      const aiMeshMorphAnim* ai_channel = animation->mMorphMeshChannels[c];
+      const auto it = node_by_name.find(ai_channel->mName.C_Str());
+      if (it == node_by_name.end()) {
+        SPDLOG_WARN("animation {} morphs unknown node {}", clip.name,
+                    ai_channel->mName.C_Str());
+        continue;
+      }
+      for (const size_t instance_index : nodes_[it->second].instances) {
+        const size_t vertex_offset = instances_[instance_index].vertex_offset;
+        MorphChannel channel;
+        channel.target_offset = morph_targets_.size();
+        for (size_t t = 0; t < morph_targets_.size(); ++t) {
+          if (morph_targets_[t].vertex_offset != vertex_offset) continue;
+          channel.target_offset = std::min(channel.target_offset, t);
+          ++channel.target_count;
+        }
+        if (channel.target_count == 0) {
+          continue;
+        }
+        for (unsigned int k = 0; k < ai_channel->mNumKeys; ++k) {
+          const aiMeshMorphKey& key = ai_channel->mKeys[k];
+          std::vector<float> key_weights(channel.target_count, 0.0f);
+          for (unsigned int v = 0; v < key.mNumValuesAndWeights; ++v) {
+            if (key.mValues[v] < channel.target_count) {
+              key_weights[key.mValues[v]] = static_cast<float>(key.mWeights[v]);
+            }
+          }
+          channel.times.push_back(seconds(key.mTime));
+          channel.weights.push_back(std::move(key_weights));
+        }
+        clip.morph_channels.push_back(std::move(channel));
+      }
     }
+    animations_.push_back(std::move(clip));
+  }
+}
+
+Pose Model::GetBindPose() const { return EvaluatePose(nullptr, 0.0f); }
+
+Pose Model::SampleAnimation(size_t animation, float seconds) const {
+  if (animation >= animations_.size()) {
+    SPDLOG_ERROR("animation {} out of range, model {} has {}", animation,
+                 directory_, animations_.size());
+    throw std::runtime_error("Animation index out of range");
+  }
+  return EvaluatePose(&animations_[animation], seconds);
+}
+
+// Parents precede their children in nodes_, so one forward pass computes the
+// global transforms
+// nodes_ 中父节点总在子节点之前，一次顺序遍历即可求得全局变换
+Pose Model::EvaluatePose(const AnimationClip* clip, float seconds) const {
+  Pose pose;
+  pose.morph_weights.reserve(morph_targets_.size());
+  for (const auto& target : morph_targets_) {
+    pose.morph_weights.push_back(target.default_weight);
+  }
+
+  std::vector<Matrix4f> local(nodes_.size());
+  for (size_t i = 0; i < nodes_.size(); ++i) {
+    local[i] = nodes_[i].local_transform;
+  }
+  if (clip != nullptr) {
+    float time = 0.0f;
+    if (clip->duration > 0.0f) {
+      time = std::fmod(seconds, clip->duration);
+      if (time < 0.0f) {
+        time += clip->duration;
+      }
+    }
+    for (const auto& channel : clip->channels) {
+      local[channel.node_index] = SampleNodeChannel(
+          channel, time, nodes_[channel.node_index].local_transform);
+    }
+    for (const auto& channel : clip->morph_channels) {
+      SampleMorphChannel(channel, time, pose.morph_weights);
+    }
+  }
+
+  std::vector<Matrix4f> global(nodes_.size());
+  for (size_t i = 0; i < nodes_.size(); ++i) {
+    global[i] = nodes_[i].parent < 0 ? local[i]
+                                     : global[nodes_[i].parent] * local[i];
+  }
+  pose.bones.reserve(bones_.size());
+  for (const auto& bone : bones_) {
+    pose.bones.push_back(bone.node_index < 0
+                             ? Matrix4f(1.0f)
+                             : global[bone.node_index] * bone.inverse_bind);
+  }
+  return pose;
+}
+
+// Deform per mesh instance in SIMD batches, then refit the culling bounds
+// 按网格实例分批（SIMD）形变，然后重新计算剔除包围体
+void Model::ApplyPose(const Pose& pose) {
+  if (!IsDeformable()) {
+    return;
+  }
+  if (pose.bones.size() != bones_.size() ||
+      pose.morph_weights.size() != morph_targets_.size()) {
+    SPDLOG_ERROR(
+        "pose does not match model {}: bones {}/{}, morph weights {}/{}",
+        directory_, pose.bones.size(), bones_.size(), pose.morph_weights.size(),
+        morph_targets_.size());
+    throw std::runtime_error("Pose does not match model " + directory_);
+  }
+
+  if (!has_applied_pose_ || !(pose == applied_pose_)) {
+    const SkinPalette palette(pose.bones);
+    // Morph targets with a non-zero weight, per instance
+    // 每个实例权重非零的变形目标
+    std::vector<std::vector<MorphBlend>> morphs(instances_.size());
+    for (size_t t = 0; t < morph_targets_.size(); ++t) {
+      const MorphTarget& target = morph_targets_[t];
+      if (pose.morph_weights[t] == 0.0f || target.position_deltas.empty()) {
+        continue;
+      }
+      for (size_t i = 0; i < instances_.size(); ++i) {
+        if (instances_[i].vertex_count > 0 &&
+            instances_[i].vertex_offset == target.vertex_offset) {
+          morphs[i].push_back({&target, pose.morph_weights[t]});
+          break;
+        }
+      }
+    }
+
+#pragma omp parallel num_threads(kNProc) shared(palette, morphs)
+    for (size_t i = 0; i < instances_.size(); ++i) {
+      const MeshInstance& instance = instances_[i];
+      const size_t end = instance.vertex_offset + instance.vertex_count;
+      const size_t batches =
+          (instance.vertex_count + kVertexBatchSize - 1) / kVertexBatchSize;
+#pragma omp for schedule(static) nowait
+      for (size_t b = 0; b < batches; ++b) {
+        const size_t begin = instance.vertex_offset + b * kVertexBatchSize;
+        DeformVertexBatch(bind_vertices_, skin_weights_, palette, morphs[i],
+                          begin, std::min(begin + kVertexBatchSize, end),
+                          vertices_);
+      }
+    }
+    RefitBounds();
+    world_valid_ = false;
+    applied_pose_ = pose;
+    has_applied_pose_ = true;
+  }
+  for (auto& lod : lods_) {
+    lod.ApplyPose(pose);
+  }
+}
+
+void Model::RefitBounds() {
+#pragma omp parallel for num_threads(kNProc) schedule(dynamic)
+  for (size_t i = 0; i < instances_.size(); ++i) {
+    MeshInstance& instance = instances_[i];
+    for (size_t v = 0; v < instance.vertex_count; ++v) {
+      const Vector3f p = vertices_.GetPosition(instance.vertex_offset + v);
+      if (v == 0) {
+        instance.bounds_min = instance.bounds_max = p;
+      } else {
+        instance.bounds_min = glm::min(instance.bounds_min, p);
+        instance.bounds_max = glm::max(instance.bounds_max, p);
+      }
+    }
+  }
+#pragma omp parallel for num_threads(kNProc) schedule(dynamic, 16)
+  for (size_t m = 0; m < meshlets_.size(); ++m) {
+    ComputeMeshletBounds(vertices_, faces_, meshlet_vertices_, meshlets_[m]);
+  }
+  BuildBounds();
+}
+
+// Transform every vertex once in SIMD batches; a cache hit costs one matrix
+// compare
+// 以 SIMD 批一次性变换全部顶点；命中缓存时只需比较一次矩阵
+const WorldSpaceVertices& Model::GetWorldVertices(
+    const Matrix4f& model_matrix) const {
+  if (world_valid_ && world_matrix_ == model_matrix) {
+    return world_vertices_;
+  }
+  world_vertices_.resize(vertices_.size());
+  const std::vector<Matrix4f> matrices =
+      BuildPositionMatrices(model_matrix, vertices_);
+  const Matrix3f normal_matrix =
+      glm::transpose(glm::inverse(Matrix3f(model_matrix)));
+  const size_t batches =
+      (vertices_.size() + kVertexBatchSize - 1) / kVertexBatchSize;
+#pragma omp parallel for num_threads(kNProc) schedule(static) \
+    shared(matrices, normal_matrix)
+  for (size_t b = 0; b < batches; ++b) {
+    TransformWorldBatch(matrices, normal_matrix, vertices_,
+                        b * kVertexBatchSize, world_vertices_);
+  }
+  world_matrix_ = model_matrix;
+  world_valid_ = true;
+  SPDLOG_DEBUG("world-space vertices of {} rebuilt: {}", directory_,
+               vertices_.size());
+  return world_vertices_;
+}
+
+// Quantize each instance with its own range; meshlet bounds grow by half a
+// quantization step so culling stays conservative
+// 每个实例使用独立的量化范围；meshlet 包围体扩大半个量化步长以保持剔除保守
+void Model::CompressVertices() {
+  if (IsDeformable()) {
+    SPDLOG_WARN("{} is deformable, its vertices stay in float format",
+                directory_);
+    return;
+  }
+  if (vertices_.GetFormat() != VertexFormat::kCompact) {
+    const size_t bytes_before = vertices_.GetMemoryBytes();
+    std::vector<size_t> segment_offsets;
+    segment_offsets.reserve(instances_.size());
+    for (const auto& instance : instances_) {
+      segment_offsets.push_back(instance.vertex_offset);
+    }
+    vertices_.Compress(segment_offsets);
+    world_valid_ = false;
+
+    for (const auto& instance : instances_) {
+      if (instance.vertex_count == 0) continue;
+      const auto& segment =
+          vertices_.GetSegments()[vertices_.FindSegment(instance.vertex_offset)];
+      const Vector3f half_step = segment.scale * 0.5f;
+      for (size_t m = 0; m < instance.meshlet_count; ++m) {
+        Meshlet& meshlet = meshlets_[instance.meshlet_offset + m];
+        meshlet.radius += glm::length(half_step);
+        meshlet.bounds_min -= half_step;
+        meshlet.bounds_max += half_step;
+      }
+    }
+    SPDLOG_INFO("compressed vertices of {}: {} -> {} bytes", directory_,
+                bytes_before, vertices_.GetMemoryBytes());
+  }
+  for (auto& lod : lods_) {
+    lod.CompressVertices();
+  }
+}
+
+// Build the LOD chain; every level is simplified from this (level 0) model
+// 构建 LOD 链；每一级都由本模型（第 0 级）简化得到
+void Model::GenerateLods(size_t max_levels, float reduction) {
+  lods_.clear();
+  size_t previous_faces = faces_.size();
+  float ratio = 1.0f;
+  for (size_t level = 1; level <= max_levels; ++level) {
+    ratio *= reduction;
+    if (faces_.size() * ratio < kMinLodTriangles) {
+      break;
+    }
+    Model lod = BuildLod(ratio);
+    // Stop when simplification is blocked (locked seams/borders)
+    // 简化受阻（接缝/边界被锁定）时停止
+    if (lod.faces_.size() * 10 > previous_faces * 9) {
+      break;
+    }
+    previous_faces = lod.faces_.size();
+    SPDLOG_INFO("LOD {} of {}: triangles: {}, vertices: {}, error: {}", level,
+                directory_, lod.faces_.size(), lod.vertices_.size(),
+                lod.lod_error_);
+    if (has_applied_pose_) {
+      lod.ApplyPose(applied_pose_);
+    }
+    lods_.push_back(std::move(lod));
+  }
+}
+
+// Simplify each instance and gather the used vertices into a compact array
+// 逐实例简化，并将用到的顶点收集为紧凑数组
+Model Model::BuildLod(float ratio) const {
+  Model lod;
+  lod.directory_ = directory_;
+  lod.nodes_ = nodes_;
+
+  // Deformable models are simplified in the bind pose; LOD vertices keep
+  // their skin weights and morph deltas
+  // 可形变模型在绑定姿态下简化；LOD 顶点保留骨骼权重与变形位移
+  const bool deformable = IsDeformable();
+  const VertexStreams& source = deformable ? bind_vertices_ : vertices_;
+  lod.bones_ = bones_;
+  lod.morph_targets_.reserve(morph_targets_.size());
+  for (const auto& target : morph_targets_) {
+    MorphTarget lod_target;
+    lod_target.name = target.name;
+    lod_target.vertex_offset = SIZE_MAX;
+    lod_target.default_weight = target.default_weight;
+    lod.morph_targets_.push_back(std::move(lod_target));
+  }
+  std::vector<uint32_t> lod_source;
+
+  std::vector<Vector3f> positions;
+  std::vector<uint32_t> indices;
+  std::vector<uint32_t> new_index(vertices_.size(), UINT32_MAX);
+  for (const auto& instance : instances_) {
+    MeshInstance lod_instance = instance;
+    lod_instance.vertex_offset = lod.vertices_.size();
+    lod_instance.face_offset = lod.faces_.size();
+    lod_instance.meshlet_offset = lod.meshlets_.size();
+    if (instance.face_count == 0) {
+      lod_instance.vertex_count = 0;
+      lod_instance.meshlet_count = 0;
+      lod.instances_.push_back(lod_instance);
+      continue;
+    }
+
+    // Instance-local positions and indices
+    // 实例局部的位置与索引
+    positions.resize(instance.vertex_count);
+    for (size_t v = 0; v < instance.vertex_count; ++v) {
+      positions[v] = source.GetPosition(instance.vertex_offset + v);
+    }
+    indices.clear();
+    for (size_t f = 0; f < instance.face_count; ++f) {
+      for (const size_t v : faces_[instance.face_offset + f].GetIndices()) {
+        indices.push_back(static_cast<uint32_t>(v - instance.vertex_offset));
+      }
+    }
+
+    float error = 0.0f;
+    const size_t target =
+        static_cast<size_t>(indices.size() / 3 * ratio) * 3;
+    std::vector<uint32_t> simplified =
+        SimplifyMesh(positions, indices, target, &error);
+    OptimizeVertexCache(simplified, positions.size());
+    lod.lod_error_ = std::max(lod.lod_error_, error);
+
+    // All faces of an instance share the mesh material
+    // 同一实例的所有面共享网格材质
+    const Material& material = faces_[instance.face_offset].GetMaterial();
+    for (size_t i = 0; i + 2 < simplified.size(); i += 3) {
+      size_t face_indices[kTriangleFaceVertexCount];
+      for (size_t k = 0; k < kTriangleFaceVertexCount; ++k) {
+        const uint32_t local = simplified[i + k];
+        if (new_index[instance.vertex_offset + local] == UINT32_MAX) {
+          new_index[instance.vertex_offset + local] =
+              static_cast<uint32_t>(lod.vertices_.size());
+          lod.vertices_.push_back(source.Get(instance.vertex_offset + local));
+          lod_source.push_back(
+              static_cast<uint32_t>(instance.vertex_offset + local));
+        }
+        face_indices[k] = new_index[instance.vertex_offset + local];
+      }
+      lod.faces_.emplace_back(face_indices[0], face_indices[1],
+                              face_indices[2], material);
+    }
+    lod_instance.vertex_count =
+        lod.vertices_.size() - lod_instance.vertex_offset;
+    lod_instance.face_count = lod.faces_.size() - lod_instance.face_offset;
+
+    if (deformable) {
+      for (size_t v = lod_instance.vertex_offset; v < lod.vertices_.size();
+           ++v) {
+        lod.skin_weights_.AppendFrom(skin_weights_, lod_source[v]);
+      }
+      for (size_t t = 0; t < morph_targets_.size(); ++t) {
+        const MorphTarget& target = morph_targets_[t];
+        if (target.vertex_offset != instance.vertex_offset ||
+            target.position_deltas.empty()) {
+          continue;
+        }
+        MorphTarget& lod_target = lod.morph_targets_[t];
+        lod_target.vertex_offset = lod_instance.vertex_offset;
+        for (size_t v = lod_instance.vertex_offset; v < lod.vertices_.size();
+             ++v) {
+          const size_t local = lod_source[v] - instance.vertex_offset;
+          lod_target.position_deltas.push_back(target.position_deltas[local]);
+          lod_target.normal_deltas.push_back(target.normal_deltas[local]);
+        }
+      }
+    }
+
+    // Instance bounds shrink to the remaining vertices
+    // 实例包围盒收缩到剩余顶点
+    for (size_t v = 0; v < lod_instance.vertex_count; ++v) {
+      const Vector3f p =
+          lod.vertices_.GetPosition(lod_instance.vertex_offset + v);
+      if (v == 0) {
+        lod_instance.bounds_min = lod_instance.bounds_max = p;
+      } else {
+        lod_instance.bounds_min = glm::min(lod_instance.bounds_min, p);
+        lod_instance.bounds_max = glm::max(lod_instance.bounds_max, p);
+      }
+    }
+
+    BuildMeshlets(lod.vertices_, lod.faces_, lod_instance.face_offset,
+                  lod_instance.face_count, lod.meshlets_,
+                  lod.meshlet_vertices_);
+    lod_instance.meshlet_count =
+        lod.meshlets_.size() - lod_instance.meshlet_offset;
+    lod.ReorderVertexFetch(lod_instance);
+    lod.instances_.push_back(lod_instance);
+  }
+  if (deformable) {
+    lod.bind_vertices_ = lod.vertices_;
+  }
+  lod.BuildBounds();
+  if (vertices_.GetFormat() == VertexFormat::kCompact) {
+    lod.CompressVertices();
   }
+  return lod;
 }
 
 // Extract material properties from the Assimp material structure
@@ -0,0 +1,87 @@
+#include "raster_kernel.hpp"
+
+#include "log_system.h"
+
+namespace simple_renderer {
+
+void RasterRowScalar(const RasterTriangle& tri, const RasterRow& row,
+                     RasterRowResult& out) {
+  out.cover_mask = 0u;
+  out.count = 0u;
+  for (int32_t j = 0; j < row.lanes; ++j) {
+    const int64_t e[3] = {row.e[0] + tri.step_x[0] * j,
+                          row.e[1] + tri.step_x[1] * j,
+                          row.e[2] + tri.step_x[2] * j};
+    if (row.test_coverage && ((e[0] + tri.bias[0]) | (e[1] + tri.bias[1]) |
+                              (e[2] + tri.bias[2])) < 0) {
+      continue;
+    }
+    out.cover_mask |= 1u << j;
+
+    float b[3], z;
+    tri.Interpolate(e, b, z);
+    if (row.depth != nullptr && !(z < row.depth[j] - row.depth_epsilon)) {
+      continue;
+    }
+
+    const uint32_t n = out.count++;
+    out.lane[n] = j;
+    out.b0[n] = b[0];
+    out.b1[n] = b[1];
+    out.b2[n] = b[2];
+    out.z[n] = z;
+  }
+}
+
+RasterIsa DetectRasterIsa() {
+#if defined(SIMPLE_RENDERER_X86_KERNELS)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vl") &&
+      __builtin_cpu_supports("avx512dq")) {
+    return RasterIsa::kAvx512;
+  }
+  if (__builtin_cpu_supports("avx2")) {
+    return RasterIsa::kAvx2;
+  }
+  if (__builtin_cpu_supports("sse4.2")) {
+    return RasterIsa::kSse42;
+  }
+#endif
+  return RasterIsa::kScalar;
+}
+
+RasterRowKernel GetRasterRowKernel(RasterIsa isa) {
+#if defined(SIMPLE_RENDERER_X86_KERNELS)
+  // 本机不支持的指令集回退到标量版本，避免执行非法指令
+  static const RasterIsa kSupported = DetectRasterIsa();
+  if (static_cast<uint8_t>(isa) > static_cast<uint8_t>(kSupported)) {
+    return RasterRowScalar;
+  }
+  switch (isa) {
+    case RasterIsa::kAvx512:
+      return RasterRowAvx512;
+    case RasterIsa::kAvx2:
+      return RasterRowAvx2;
+    case RasterIsa::kSse42:
+      return RasterRowSse42;
+    case RasterIsa::kScalar:
+      break;
+  }
+#else
+  (void)isa;
+#endif
+  return RasterRowScalar;
+}
+
+RasterRowKernel GetRasterRowKernel() {
+  static const RasterRowKernel kernel = [] {
+    const RasterIsa isa = DetectRasterIsa();
+    static constexpr const char* kNames[] = {"scalar", "sse4.2", "avx2",
+                                             "avx512"};
+    SPDLOG_INFO("raster kernel: {}", kNames[static_cast<size_t>(isa)]);
+    return GetRasterRowKernel(isa);
+  }();
+  return kernel;
+}
+
+}  // namespace simple_renderer
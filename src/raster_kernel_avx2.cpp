@@ -0,0 +1,129 @@
+#if defined(SIMPLE_RENDERER_X86_KERNELS)
+
+#include <immintrin.h>
+
+#include <array>
+
+#include "raster_kernel.hpp"
+
+namespace simple_renderer {
+
+namespace {
+
+/// 8 位掩码 -> 把置位通道依次移到前面的置换下标（压缩存放）
+constexpr std::array<std::array<int32_t, 8>, 256> kCompressPermutation = [] {
+  std::array<std::array<int32_t, 8>, 256> table{};
+  for (uint32_t mask = 0; mask < 256; ++mask) {
+    int32_t n = 0;
+    for (int32_t j = 0; j < 8; ++j) {
+      if ((mask >> j) & 1u) {
+        table[mask][n++] = j;
+      }
+    }
+  }
+  return table;
+}();
+
+/**
+ * @brief 四个 int64 -> double，|v| < 2^51 时精确
+ *
+ * AVX2 没有 int64 -> 浮点的转换指令；边函数值不超过
+ * kMaxEdgeFunctionMagnitude（视口由 kMaxViewportExtent 限制），
+ * double 再舍入到 float 与 int64 直接转 float 的结果一致。
+ */
+inline __m256d Int64ToDouble(__m256i v) {
+  const __m256i magic_i = _mm256_set1_epi64x(0x4338000000000000);
+  const __m256d magic_d = _mm256_castsi256_pd(magic_i);
+  return _mm256_sub_pd(_mm256_castsi256_pd(_mm256_add_epi64(v, magic_i)),
+                       magic_d);
+}
+
+static_assert(kMaxEdgeFunctionMagnitude < (int64_t{1} << 51));
+
+/// 八个 int64（两个寄存器）-> float
+inline __m256 Int64ToFloat(__m256i lo, __m256i hi) {
+  return _mm256_set_m128(_mm256_cvtpd_ps(Int64ToDouble(hi)),
+                         _mm256_cvtpd_ps(Int64ToDouble(lo)));
+}
+
+}  // namespace
+
+void RasterRowAvx2(const RasterTriangle& tri, const RasterRow& row,
+                   RasterRowResult& out) {
+  const uint32_t lane_mask = (1u << row.lanes) - 1u;
+  // e[k][0] 为第 0~3 个像素、e[k][1] 为第 4~7 个像素处的边函数值
+  __m256i e[3][2];
+  for (int k = 0; k < 3; ++k) {
+    const int64_t step = tri.step_x[k];
+    const int64_t base = row.e[k];
+    e[k][0] = _mm256_set_epi64x(base + 3 * step, base + 2 * step, base + step,
+                                base);
+    e[k][1] = _mm256_add_epi64(e[k][0], _mm256_set1_epi64x(4 * step));
+  }
+  uint32_t cover_mask = lane_mask;
+  if (row.test_coverage) {
+    uint32_t inside = 0u;
+    const __m256i bias0 = _mm256_set1_epi64x(tri.bias[0]);
+    const __m256i bias1 = _mm256_set1_epi64x(tri.bias[1]);
+    const __m256i bias2 = _mm256_set1_epi64x(tri.bias[2]);
+    for (int i = 0; i < 2; ++i) {
+      // 三条边（加偏置后）任一为负即在外：取或后看符号位
+      const __m256i any = _mm256_or_si256(
+          _mm256_or_si256(_mm256_add_epi64(e[0][i], bias0),
+                          _mm256_add_epi64(e[1][i], bias1)),
+          _mm256_add_epi64(e[2][i], bias2));
+      const uint32_t outside =
+          static_cast<uint32_t>(_mm256_movemask_pd(_mm256_castsi256_pd(any)));
+      inside |= (~outside & 0xFu) << (4 * i);
+    }
+    cover_mask &= inside;
+  }
+  out.cover_mask = cover_mask;
+  out.count = 0u;
+  if (cover_mask == 0u) {
+    return;
+  }
+
+  const __m256 f0 = Int64ToFloat(e[0][0], e[0][1]);
+  const __m256 f1 = Int64ToFloat(e[1][0], e[1][1]);
+  const __m256 f2 = Int64ToFloat(e[2][0], e[2][1]);
+  // 平面方程：b_k / w_k 与 z，每像素一次倒数
+  const __m256 p0 = _mm256_mul_ps(f0, _mm256_set1_ps(tri.persp[0]));
+  const __m256 p1 = _mm256_mul_ps(f1, _mm256_set1_ps(tri.persp[1]));
+  const __m256 p2 = _mm256_mul_ps(f2, _mm256_set1_ps(tri.persp[2]));
+  const __m256 w = _mm256_div_ps(_mm256_set1_ps(1.0f),
+                                 _mm256_add_ps(_mm256_add_ps(p0, p1), p2));
+  const __m256 c0 = _mm256_mul_ps(p0, w);
+  const __m256 c1 = _mm256_mul_ps(p1, w);
+  const __m256 c2 = _mm256_mul_ps(p2, w);
+  const __m256 z = _mm256_add_ps(
+      _mm256_add_ps(_mm256_mul_ps(f0, _mm256_set1_ps(tri.depth[0])),
+                    _mm256_mul_ps(f1, _mm256_set1_ps(tri.depth[1]))),
+      _mm256_mul_ps(f2, _mm256_set1_ps(tri.depth[2])));
+
+  uint32_t pass_mask = cover_mask;
+  if (row.depth != nullptr) {
+    // 行尾不足 8 个像素时只读有效部分
+    const __m256i load_mask = _mm256_cmpgt_epi32(
+        _mm256_set1_epi32(row.lanes), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    const __m256 depth = _mm256_maskload_ps(row.depth, load_mask);
+    const __m256 pass = _mm256_cmp_ps(
+        z, _mm256_sub_ps(depth, _mm256_set1_ps(row.depth_epsilon)),
+        _CMP_LT_OQ);
+    pass_mask &= static_cast<uint32_t>(_mm256_movemask_ps(pass));
+  }
+
+  // 按掩码置换后整体写出，前 count 个即存活像素
+  const __m256i permutation = _mm256_loadu_si256(
+      reinterpret_cast<const __m256i*>(kCompressPermutation[pass_mask].data()));
+  _mm256_store_si256(reinterpret_cast<__m256i*>(out.lane), permutation);
+  _mm256_store_ps(out.b0, _mm256_permutevar8x32_ps(c0, permutation));
+  _mm256_store_ps(out.b1, _mm256_permutevar8x32_ps(c1, permutation));
+  _mm256_store_ps(out.b2, _mm256_permutevar8x32_ps(c2, permutation));
+  _mm256_store_ps(out.z, _mm256_permutevar8x32_ps(z, permutation));
+  out.count = static_cast<uint32_t>(__builtin_popcount(pass_mask));
+}
+
+}  // namespace simple_renderer
+
+#endif  // defined(SIMPLE_RENDERER_X86_KERNELS)
@@ -0,0 +1,79 @@
+#if defined(SIMPLE_RENDERER_X86_KERNELS)
+
+#include <immintrin.h>
+
+#include "raster_kernel.hpp"
+
+namespace simple_renderer {
+
+void RasterRowAvx512(const RasterTriangle& tri, const RasterRow& row,
+                     RasterRowResult& out) {
+  const __mmask8 lane_mask = static_cast<__mmask8>((1u << row.lanes) - 1u);
+  const __m512i lane_index = _mm512_setr_epi64(0, 1, 2, 3, 4, 5, 6, 7);
+  // 一个寄存器容纳一行 8 个像素的 int64 边函数值
+  __m512i e[3];
+  for (int k = 0; k < 3; ++k) {
+    e[k] = _mm512_add_epi64(
+        _mm512_set1_epi64(row.e[k]),
+        _mm512_mullo_epi64(lane_index, _mm512_set1_epi64(tri.step_x[k])));
+  }
+  __mmask8 cover_mask = lane_mask;
+  if (row.test_coverage) {
+    const __m512i any = _mm512_or_si512(
+        _mm512_or_si512(
+            _mm512_add_epi64(e[0], _mm512_set1_epi64(tri.bias[0])),
+            _mm512_add_epi64(e[1], _mm512_set1_epi64(tri.bias[1]))),
+        _mm512_add_epi64(e[2], _mm512_set1_epi64(tri.bias[2])));
+    cover_mask = _mm512_mask_cmpge_epi64_mask(cover_mask, any,
+                                              _mm512_setzero_si512());
+  }
+  out.cover_mask = cover_mask;
+  out.count = 0u;
+  if (cover_mask == 0u) {
+    return;
+  }
+
+  // |e| < 2^53 时 int64 -> double 精确，double -> float 与直接转换一致
+  //（全掩码的 maskz 形式，避免 GCC 对未定义源操作数的误报）
+  const auto to_float = [](__m512i v) {
+    return _mm512_maskz_cvtpd_ps(0xFF, _mm512_cvtepi64_pd(v));
+  };
+  const __m256 f0 = to_float(e[0]);
+  const __m256 f1 = to_float(e[1]);
+  const __m256 f2 = to_float(e[2]);
+  // 平面方程：b_k / w_k 与 z，每像素一次倒数
+  const __m256 p0 = _mm256_mul_ps(f0, _mm256_set1_ps(tri.persp[0]));
+  const __m256 p1 = _mm256_mul_ps(f1, _mm256_set1_ps(tri.persp[1]));
+  const __m256 p2 = _mm256_mul_ps(f2, _mm256_set1_ps(tri.persp[2]));
+  const __m256 w = _mm256_div_ps(_mm256_set1_ps(1.0f),
+                                 _mm256_add_ps(_mm256_add_ps(p0, p1), p2));
+  const __m256 c0 = _mm256_mul_ps(p0, w);
+  const __m256 c1 = _mm256_mul_ps(p1, w);
+  const __m256 c2 = _mm256_mul_ps(p2, w);
+  const __m256 z = _mm256_add_ps(
+      _mm256_add_ps(_mm256_mul_ps(f0, _mm256_set1_ps(tri.depth[0])),
+                    _mm256_mul_ps(f1, _mm256_set1_ps(tri.depth[1]))),
+      _mm256_mul_ps(f2, _mm256_set1_ps(tri.depth[2])));
+
+  __mmask8 pass_mask = cover_mask;
+  if (row.depth != nullptr) {
+    // 掩码加载：行尾不足 8 个像素时不越界
+    const __m256 depth = _mm256_maskz_loadu_ps(lane_mask, row.depth);
+    pass_mask = _mm256_mask_cmp_ps_mask(
+        pass_mask, z, _mm256_sub_ps(depth, _mm256_set1_ps(row.depth_epsilon)),
+        _CMP_LT_OQ);
+  }
+
+  // 压缩存放存活像素
+  _mm256_mask_compressstoreu_epi32(
+      out.lane, pass_mask, _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+  _mm256_mask_compressstoreu_ps(out.b0, pass_mask, c0);
+  _mm256_mask_compressstoreu_ps(out.b1, pass_mask, c1);
+  _mm256_mask_compressstoreu_ps(out.b2, pass_mask, c2);
+  _mm256_mask_compressstoreu_ps(out.z, pass_mask, z);
+  out.count = static_cast<uint32_t>(__builtin_popcount(pass_mask));
+}
+
+}  // namespace simple_renderer
+
+#endif  // defined(SIMPLE_RENDERER_X86_KERNELS)
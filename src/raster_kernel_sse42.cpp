@@ -0,0 +1,132 @@
+#if defined(SIMPLE_RENDERER_X86_KERNELS)
+
+#include <nmmintrin.h>
+
+#include "raster_kernel.hpp"
+
+namespace simple_renderer {
+
+namespace {
+
+/**
+ * @brief 两个 int64 -> double，|v| < 2^51 时精确
+ *
+ * 边函数值不超过 kMaxEdgeFunctionMagnitude（视口由 kMaxViewportExtent
+ * 限制），double 再舍入到 float 与 int64 直接转 float 的结果一致。
+ */
+inline __m128d Int64ToDouble(__m128i v) {
+  const __m128i magic_i = _mm_set1_epi64x(0x4338000000000000);
+  const __m128d magic_d = _mm_castsi128_pd(magic_i);
+  return _mm_sub_pd(_mm_castsi128_pd(_mm_add_epi64(v, magic_i)), magic_d);
+}
+
+static_assert(kMaxEdgeFunctionMagnitude < (int64_t{1} << 51));
+
+/// 四个 int64（两个寄存器）-> float
+inline __m128 Int64ToFloat(__m128i lo, __m128i hi) {
+  return _mm_movelh_ps(_mm_cvtpd_ps(Int64ToDouble(lo)),
+                       _mm_cvtpd_ps(Int64ToDouble(hi)));
+}
+
+}  // namespace
+
+void RasterRowSse42(const RasterTriangle& tri, const RasterRow& row,
+                    RasterRowResult& out) {
+  const uint32_t lane_mask = (1u << row.lanes) - 1u;
+  // e[k][i] 为第 2i、2i+1 个像素处的边函数值
+  __m128i e[3][4];
+  for (int k = 0; k < 3; ++k) {
+    const int64_t step = tri.step_x[k];
+    for (int i = 0; i < 4; ++i) {
+      const int64_t base = row.e[k] + step * (2 * i);
+      e[k][i] = _mm_set_epi64x(base + step, base);
+    }
+  }
+  uint32_t cover_mask = lane_mask;
+  if (row.test_coverage) {
+    uint32_t inside = 0u;
+    const __m128i bias0 = _mm_set1_epi64x(tri.bias[0]);
+    const __m128i bias1 = _mm_set1_epi64x(tri.bias[1]);
+    const __m128i bias2 = _mm_set1_epi64x(tri.bias[2]);
+    for (int i = 0; i < 4; ++i) {
+      // 三条边（加偏置后）任一为负即在外：取或后看符号位
+      const __m128i any = _mm_or_si128(
+          _mm_or_si128(_mm_add_epi64(e[0][i], bias0),
+                       _mm_add_epi64(e[1][i], bias1)),
+          _mm_add_epi64(e[2][i], bias2));
+      const uint32_t outside =
+          static_cast<uint32_t>(_mm_movemask_pd(_mm_castsi128_pd(any)));
+      inside |= (~outside & 0x3u) << (2 * i);
+    }
+    cover_mask &= inside;
+  }
+  out.cover_mask = cover_mask;
+  out.count = 0u;
+  if (cover_mask == 0u) {
+    return;
+  }
+
+  const __m128 persp0 = _mm_set1_ps(tri.persp[0]);
+  const __m128 persp1 = _mm_set1_ps(tri.persp[1]);
+  const __m128 persp2 = _mm_set1_ps(tri.persp[2]);
+  const __m128 depth0 = _mm_set1_ps(tri.depth[0]);
+  const __m128 depth1 = _mm_set1_ps(tri.depth[1]);
+  const __m128 depth2 = _mm_set1_ps(tri.depth[2]);
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 epsilon = _mm_set1_ps(row.depth_epsilon);
+
+  // 深度行可能不足 kRasterLanes 个像素，先拷贝有效部分
+  alignas(16) float depth[kRasterLanes] = {};
+  if (row.depth != nullptr) {
+    for (int32_t j = 0; j < row.lanes; ++j) {
+      depth[j] = row.depth[j];
+    }
+  }
+
+  alignas(16) float b0c[kRasterLanes], b1c[kRasterLanes], b2c[kRasterLanes];
+  alignas(16) float z[kRasterLanes];
+  uint32_t pass_mask = cover_mask;
+  for (int h = 0; h < 2; ++h) {
+    const __m128 f0 = Int64ToFloat(e[0][2 * h], e[0][2 * h + 1]);
+    const __m128 f1 = Int64ToFloat(e[1][2 * h], e[1][2 * h + 1]);
+    const __m128 f2 = Int64ToFloat(e[2][2 * h], e[2][2 * h + 1]);
+    // 平面方程：b_k / w_k 与 z，每像素一次倒数
+    const __m128 p0 = _mm_mul_ps(f0, persp0);
+    const __m128 p1 = _mm_mul_ps(f1, persp1);
+    const __m128 p2 = _mm_mul_ps(f2, persp2);
+    const __m128 w = _mm_div_ps(one, _mm_add_ps(_mm_add_ps(p0, p1), p2));
+    const __m128 c0 = _mm_mul_ps(p0, w);
+    const __m128 c1 = _mm_mul_ps(p1, w);
+    const __m128 c2 = _mm_mul_ps(p2, w);
+    const __m128 zv = _mm_add_ps(
+        _mm_add_ps(_mm_mul_ps(f0, depth0), _mm_mul_ps(f1, depth1)),
+        _mm_mul_ps(f2, depth2));
+    _mm_store_ps(b0c + 4 * h, c0);
+    _mm_store_ps(b1c + 4 * h, c1);
+    _mm_store_ps(b2c + 4 * h, c2);
+    _mm_store_ps(z + 4 * h, zv);
+    if (row.depth != nullptr) {
+      const __m128 pass =
+          _mm_cmplt_ps(zv, _mm_sub_ps(_mm_load_ps(depth + 4 * h), epsilon));
+      const uint32_t bits = static_cast<uint32_t>(_mm_movemask_ps(pass));
+      pass_mask &= ~(0xFu << (4 * h)) | (bits << (4 * h));
+    }
+  }
+
+  // 压缩存放存活像素
+  uint32_t n = 0;
+  for (uint32_t bits = pass_mask; bits != 0u; bits &= bits - 1u) {
+    const int32_t j = __builtin_ctz(bits);
+    out.lane[n] = j;
+    out.b0[n] = b0c[j];
+    out.b1[n] = b1c[j];
+    out.b2[n] = b2c[j];
+    out.z[n] = z[j];
+    ++n;
+  }
+  out.count = n;
+}
+
+}  // namespace simple_renderer
+
+#endif  // defined(SIMPLE_RENDERER_X86_KERNELS)
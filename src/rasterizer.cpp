@@ -1,9 +1,11 @@
 #include "rasterizer.hpp"
 
-#include <omp.h>
 #include <algorithm>
 #include <cmath>
 
+#include "edge_function.hpp"
+#include "raster_kernel.hpp"
+
 namespace simple_renderer {
 
 Rasterizer::Rasterizer(size_t width, size_t height)
@@ -11,103 +13,97 @@ Rasterizer::Rasterizer(size_t width, size_t height)
   SPDLOG_DEBUG("Rasterizer init with {}, {}", width, height);
 }
 
-std::vector<Fragment> Rasterizer::Rasterize(const Vertex& v0, const Vertex& v1,
-                                            const Vertex& v2) {
-  std::vector<Fragment> fragments;
-
-  // 获取三角形的最小 box
-  Vector2f a = Vector2f(v0.GetPosition().x, v0.GetPosition().y);
-  Vector2f b = Vector2f(v1.GetPosition().x, v1.GetPosition().y);
-  Vector2f c = Vector2f(v2.GetPosition().x, v2.GetPosition().y);
+void Rasterizer::Rasterize(const Vertex& v0, const Vertex& v1,
+                           const Vertex& v2, const FragmentSink& sink) {
+  Rasterize(v0, v1, v2, {}, kVaryingAll & ~kVaryingWorldPosition, sink);
+}
 
-  Vector2f bboxMin =
-      Vector2f{std::min({a.x, b.x, c.x}), std::min({a.y, b.y, c.y})};
-  Vector2f bboxMax =
-      Vector2f{std::max({a.x, b.x, c.x}), std::max({a.y, b.y, c.y})};
+void Rasterizer::Rasterize(const Vertex& v0, const Vertex& v1,
+                           const Vertex& v2,
+                           const std::array<Vector3f, 3>& world_positions,
+                           VaryingMask varyings, const FragmentSink& sink) {
+  // 定点边函数建立（左上填充规则），定点面积为 0 的退化三角形不产生片段
+  TriangleSetup setup;
+  if (!setup.Setup(v0.GetPosition(), v1.GetPosition(), v2.GetPosition())) {
+    return;
+  }
 
   // Clamp the bounding box to the screen dimensions
-  bboxMin.x = std::max(0.0f, bboxMin.x);
-  bboxMin.y = std::max(0.0f, bboxMin.y);
-  bboxMax.x = std::min(float(width_ - 1), bboxMax.x);
-  bboxMax.y = std::min(float(height_ - 1), bboxMax.y);
-
-  std::vector<std::vector<Fragment>> fragments_per_thread(kNProc);
-
-#pragma omp parallel num_threads(kNProc) default(none) shared( \
-        bboxMin, bboxMax, v0, v1, v2, fragments, width_, fragments_per_thread)
-  {
-    int thread_id = omp_get_thread_num();
-    std::vector<Fragment>& local_fragments = fragments_per_thread[thread_id];
-#pragma omp for collapse(2)
-    for (auto x = int32_t(bboxMin.x); x <= int32_t(bboxMax.x); x++) {
-      for (auto y = int32_t(bboxMin.y); y <= int32_t(bboxMax.y); y++) {
-        auto [is_inside, barycentric_coord] = GetBarycentricCoord(
-            v0.GetPosition(), v1.GetPosition(), v2.GetPosition(),
-            Vector3f(static_cast<float>(x), static_cast<float>(y), 0));
-        // 如果点在三角形内再进行下一步
-        if (!is_inside) {
-          continue;
+  const int32_t min_x = std::max(0, setup.min_x);
+  const int32_t min_y = std::max(0, setup.min_y);
+  const int32_t max_x = std::min(static_cast<int32_t>(width_) - 1, setup.max_x);
+  const int32_t max_y = std::min(static_cast<int32_t>(height_) - 1, setup.max_y);
+  if (min_x > max_x || min_y > max_y) {
+    return;
+  }
+
+  // 透视校正插值的平面方程系数（每像素一次倒数）
+  const RasterTriangle planes = MakeRasterTriangle(
+      setup, v0.GetPosition(), v1.GetPosition(), v2.GetPosition());
+  const Vector2f uvs[3] = {v0.GetTexCoords(), v1.GetTexCoords(),
+                           v2.GetTexCoords()};
+
+  // 逐行扫描包围盒，每 kRasterLanes 个像素调用一次行内核
+  //（覆盖测试、透视校正重心与深度，与 tile 渲染器逐位一致）
+  const RasterRowKernel raster_kernel = GetRasterRowKernel();
+  RasterRowResult lanes;
+  std::array<Fragment, kFragmentBatchSize> batch;
+  size_t count = 0;
+
+  int64_t row_start[3] = {setup.Evaluate(0, min_x, min_y),
+                          setup.Evaluate(1, min_x, min_y),
+                          setup.Evaluate(2, min_x, min_y)};
+  for (int32_t y = min_y; y <= max_y; ++y) {
+    int64_t e[3] = {row_start[0], row_start[1], row_start[2]};
+    for (int k = 0; k < 3; ++k) row_start[k] += setup.step_y[k];
+
+    for (int32_t x = min_x; x <= max_x; x += kRasterLanes) {
+      const int32_t lane = std::min(kRasterLanes, max_x - x + 1);
+      const RasterRow raster_row{{e[0], e[1], e[2]}, lane, true, nullptr, 0.0f};
+      raster_kernel(planes, raster_row, lanes);
+      for (int k = 0; k < 3; ++k) e[k] += setup.step_x[k] * kRasterLanes;
+
+      for (uint32_t n = 0; n < lanes.count; ++n) {
+        const int32_t px = x + lanes.lane[n];
+        const Vector3f corrected_bary(lanes.b0[n], lanes.b1[n], lanes.b2[n]);
+
+        Fragment& fragment = batch[count];
+        fragment = Fragment{};
+        fragment.screen_coord = {px, y};
+        // 只插值声明的 varyings
+        if ((varyings & kVaryingNormal) != 0) {
+          fragment.normal = Interpolate(v0.GetNormal(), v1.GetNormal(),
+                                        v2.GetNormal(), corrected_bary);
         }
+        if ((varyings & kVaryingTexCoords) != 0) {
+          fragment.uv = Interpolate(uvs[0], uvs[1], uvs[2], corrected_bary);
+          // 所在 2x2 quad 的 uv 差分，供纹理选择 mip 级别
+          QuadDerivatives(setup, planes, uvs, px, y, fragment.uv_dx,
+                          fragment.uv_dy);
+        }
+        if ((varyings & kVaryingColor) != 0) {
+          fragment.color = InterpolateColor(v0.GetColor(), v1.GetColor(),
+                                            v2.GetColor(), corrected_bary);
+        }
+        if ((varyings & kVaryingWorldPosition) != 0) {
+          fragment.world_position =
+              Interpolate(world_positions[0], world_positions[1],
+                          world_positions[2], corrected_bary);
+        }
+        fragment.depth = lanes.z[n];
 
-        // 透视矫正插值
-        auto perspective_result = PerformPerspectiveCorrection(
-            v0.GetPosition().w, v1.GetPosition().w, v2.GetPosition().w,
-            v0.GetPosition().z, v1.GetPosition().z, v2.GetPosition().z,
-            barycentric_coord);
-        
-        const Vector3f& corrected_bary = perspective_result.corrected_barycentric;
-        float z = perspective_result.interpolated_z;
-
-
-        Fragment fragment;
-        fragment.screen_coord = {x, y};
-        fragment.normal = Interpolate(v0.GetNormal(), v1.GetNormal(),
-                                      v2.GetNormal(), corrected_bary);
-        fragment.uv = Interpolate(v0.GetTexCoords(), v1.GetTexCoords(),
-                                  v2.GetTexCoords(), corrected_bary);
-        fragment.color = InterpolateColor(v0.GetColor(), v1.GetColor(),
-                                          v2.GetColor(), corrected_bary);
-        fragment.depth = z;
-
-        local_fragments.push_back(fragment);
+        if (++count == kFragmentBatchSize) {
+          sink(std::span<Fragment>(batch.data(), count));
+          count = 0;
+        }
       }
     }
   }
-
-  for (const auto& local_fragments : fragments_per_thread) {
-    fragments.insert(fragments.end(), local_fragments.begin(),
-                     local_fragments.end());
+  if (count > 0) {
+    sink(std::span<Fragment>(batch.data(), count));
   }
-  return fragments;
 }
 
-std::pair<bool, Vector3f> Rasterizer::GetBarycentricCoord(const Vector3f& p0,
-                                                          const Vector3f& p1,
-                                                          const Vector3f& p2,
-                                                          const Vector3f& pa) {
-  Vector3f v0 = Vector3f{p2.x - p0.x, p1.x - p0.x, p0.x - pa.x};
-  Vector3f v1 = Vector3f{p2.y - p0.y, p1.y - p0.y, p0.y - pa.y};
-
-  Vector3f u = glm::cross(v0, v1);
-
-  // 如果 u.z == 0 说明三角形退化
-  const float epsilon = 1e-6f;
-  if (std::abs(u.z) < epsilon) {
-    return std::pair<bool, const Vector3f>{false, Vector3f(0, 0, 0)};
-  }
-
-  auto x = 1.0f - (u.x + u.y) / u.z;
-  auto y = u.y / u.z;
-  auto z = u.x / u.z;
-
-  // 如果重心坐标不在 [0, 1] 之间则说明点在三角形外
-  if (x < 0 || y < 0 || z < 0 || x > 1 || y > 1 || z > 1) {
-    return std::pair<bool, const Vector3f>{false, Vector3f(0, 0, 0)};
-  }
-
-  return std::pair<bool, const Vector3f>{true, Vector3f(x, y, z)};
-}
- 
 template <typename T>
 T Rasterizer::Interpolate(const T& v0, const T& v1, const T& v2,
                           const Vector3f& barycentric_coord) const {
@@ -136,31 +132,6 @@ Color Rasterizer::InterpolateColor(const Color& color0, const Color& color1,
   return Color(color_r, color_g, color_b);
 }
 
-// 透视矫正helper函数：在透视投影下，1/w 在屏幕空间中是线性的// 因此需要先对 1/w 进行插值，再用结果矫正其他属性
-Rasterizer::PerspectiveCorrectionResult Rasterizer::PerformPerspectiveCorrection(
-    float w0, float w1, float w2,
-    float z0, float z1, float z2,
-    const Vector3f& original_barycentric) const {
-    
-  // 1. 插值 1/w （注意：这里传入的w0,w1,w2是原始的w值，需要先求倒数）
-  float w0_inv = 1.0f / w0;
-  float w1_inv = 1.0f / w1;
-  float w2_inv = 1.0f / w2;
-  float w_inv_interpolated = Interpolate(w0_inv, w1_inv, w2_inv, original_barycentric);
-  
-  // 2. 计算透视矫正的重心坐标
-  Vector3f corrected_barycentric(
-      original_barycentric.x * w0_inv / w_inv_interpolated,
-      original_barycentric.y * w1_inv / w_inv_interpolated,
-      original_barycentric.z * w2_inv / w_inv_interpolated
-  );
-  
-  // 3. 使用矫正的重心坐标插值深度值
-  float interpolated_z = Interpolate(z0, z1, z2, corrected_barycentric);
-  
-  return {corrected_barycentric, interpolated_z};
-}
-
 // Calculate the normal vector based on the vertices
 // 根据顶点计算法向量
 Vector3f Rasterizer::CalculateNormal(const Vector3f& v0, const Vector3f& v1,
@@ -1,8 +1,12 @@
 #include "renderer.h"
 
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
 #include <string>
 
 #include "config.h"
+#include "msaa.hpp"
 #include "renderers/per_triangle_renderer.hpp"
 #include "renderers/tile_based_renderer.hpp"
 #include "renderers/deferred_renderer.hpp"
@@ -33,7 +37,113 @@ SimpleRenderer::SimpleRenderer(size_t width, size_t height)
 bool SimpleRenderer::DrawModel(const Model &model, const Shader &shader, uint32_t *buffer) {
   EnsureRenderer(); // 确保渲染器实例存在
   SPDLOG_DEBUG("draw model: {}", model.GetModelPath());
-  return renderer_->Render(model, shader, buffer);
+  const Matrix4f mvp = shader.GetMVPMatrix();
+  const size_t lod_level =
+      lod_enabled_ ? renderer_->SelectLod(model, mvp, lod_error_threshold_) : 0;
+  const Model &lod = model.GetLod(lod_level);
+  if (lod_level > 0) {
+    SPDLOG_DEBUG("model LOD {}: triangles {} -> {}", lod_level,
+                 model.GetFaces().size(), lod.GetFaces().size());
+  }
+  // 只在帧内跳过绘制：独立绘制模式下每次 DrawModel 都须清除颜色与深度，
+  // 被剔除的模型仍交给 Render，由其清除并剔除全部几何
+  if (occlusion_culling_ && frame_active_ &&
+      renderer_->IsBoundingBoxCulled(lod.GetBoundsMin(), lod.GetBoundsMax(),
+                                     mvp)) {
+    SPDLOG_DEBUG("model culled by bounding box: {}", model.GetModelPath());
+    return true;
+  }
+  bool ret = renderer_->Render(lod, shader, buffer);
+  if (active_query_ != nullptr) {
+    active_query_->samples_passed_ += renderer_->GetSamplesPassed();
+  }
+  return ret;
+}
+
+void SimpleRenderer::BeginFrame() {
+  EnsureRenderer();
+  if (!frame_depth_) {
+    frame_depth_ = std::make_unique<float[]>(width_ * height_);
+  }
+  std::fill_n(frame_depth_.get(), width_ * height_, kFrameDepthClear);
+  frame_active_ = true;
+  renderer_->SetFrameDepthBuffer(frame_depth_.get());
+}
+
+void SimpleRenderer::EndFrame() {
+  if (active_query_ != nullptr) {
+    SPDLOG_WARN("EndFrame called with an active occlusion query");
+  }
+  // 本帧深度作为下一帧的遮挡信息
+  if (occlusion_culling_ && frame_active_) {
+    pyramid_.Build(frame_depth_.get(), width_, height_);
+  }
+  frame_active_ = false;
+  if (renderer_) {
+    renderer_->SetFrameDepthBuffer(nullptr);
+  }
+}
+
+void SimpleRenderer::SetOcclusionCullingEnabled(bool enabled) {
+  occlusion_culling_ = enabled;
+  if (!enabled) {
+    pyramid_.Reset();
+  }
+  if (renderer_) {
+    renderer_->SetOcclusionPyramid(enabled ? &pyramid_ : nullptr);
+  }
+}
+
+void SimpleRenderer::SetLodEnabled(bool enabled) { lod_enabled_ = enabled; }
+
+void SimpleRenderer::SetLodErrorThreshold(float pixels) {
+  lod_error_threshold_ = pixels;
+}
+
+void SimpleRenderer::UpdateOcclusionPyramid() {
+  if (!frame_active_) {
+    SPDLOG_ERROR("UpdateOcclusionPyramid called outside BeginFrame/EndFrame");
+    throw std::runtime_error("No active frame depth buffer");
+  }
+  auto start = std::chrono::high_resolution_clock::now();
+  pyramid_.Build(frame_depth_.get(), width_, height_);
+  auto end = std::chrono::high_resolution_clock::now();
+  auto duration =
+      std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+  SPDLOG_DEBUG("Build depth pyramid: {} levels, {} us",
+               pyramid_.GetLevelCount(), duration.count());
+}
+
+void SimpleRenderer::BeginQuery(OcclusionQuery &query) {
+  if (active_query_ != nullptr) {
+    SPDLOG_ERROR("BeginQuery called while another query is active");
+    throw std::runtime_error("Nested occlusion queries are not supported");
+  }
+  query.samples_passed_ = 0;
+  query.active_ = true;
+  query.result_available_ = false;
+  active_query_ = &query;
+}
+
+void SimpleRenderer::EndQuery() {
+  if (active_query_ == nullptr) {
+    SPDLOG_ERROR("EndQuery called without an active query");
+    throw std::runtime_error("No active occlusion query");
+  }
+  active_query_->active_ = false;
+  active_query_->result_available_ = true;
+  active_query_ = nullptr;
+}
+
+uint64_t SimpleRenderer::DrawBoundingBox(const Vector3f &bmin,
+                                         const Vector3f &bmax,
+                                         const Shader &shader) {
+  EnsureRenderer();
+  uint64_t samples = renderer_->TestBoundingBox(bmin, bmax, shader);
+  if (active_query_ != nullptr) {
+    active_query_->samples_passed_ += samples;
+  }
+  return samples;
 }
 
 void SimpleRenderer::SetRenderingMode(RenderingMode mode) {
@@ -61,6 +171,19 @@ void SimpleRenderer::SetTileSize(size_t tile_size) {
   }
 }
 
+void SimpleRenderer::SetMsaaSamples(uint32_t samples) {
+  if (!IsValidMsaaSamples(samples)) {
+    SPDLOG_ERROR("Unsupported MSAA sample count: {}", samples);
+    throw std::invalid_argument("Unsupported MSAA sample count");
+  }
+  msaa_samples_ = samples;
+  if (current_mode_ == RenderingMode::TILE_BASED ||
+      current_mode_ == RenderingMode::TILE_BASED_DEFERRED) {
+    renderer_.reset();
+    EnsureRenderer();
+  }
+}
+
 void SimpleRenderer::EnsureRenderer() {
   if (renderer_) return;
   switch (current_mode_) { // 延迟初始化，根据模式创建相应实例
@@ -70,7 +193,8 @@ void SimpleRenderer::EnsureRenderer() {
       break;
     }
     case RenderingMode::TILE_BASED: {
-      auto r = std::make_unique<TileBasedRenderer>(width_, height_, tbr_early_z_, tbr_tile_size_);
+      auto r = std::make_unique<TileBasedRenderer>(width_, height_, tbr_early_z_, tbr_tile_size_,
+                                                   msaa_samples_);
       renderer_ = std::move(r);
       break;
     }
@@ -80,11 +204,19 @@ void SimpleRenderer::EnsureRenderer() {
       break;
     }
     case RenderingMode::TILE_BASED_DEFERRED: {
-      auto r = std::make_unique<TileBasedDeferredRenderer>(width_, height_, tbr_tile_size_);
+      auto r = std::make_unique<TileBasedDeferredRenderer>(width_, height_, tbr_tile_size_,
+                                                           msaa_samples_);
       renderer_ = std::move(r);
       break;
     }
   }
+  // 重建的渲染器继续使用当前帧的深度缓冲与深度金字塔
+  if (frame_active_) {
+    renderer_->SetFrameDepthBuffer(frame_depth_.get());
+  }
+  if (occlusion_culling_) {
+    renderer_->SetOcclusionPyramid(&pyramid_);
+  }
 }
 
 }  // namespace simple_renderer
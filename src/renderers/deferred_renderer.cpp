@@ -2,9 +2,12 @@
 
 #include <omp.h>
 #include <algorithm>
+#include <array>
 #include <chrono>
 #include <cassert>
 #include <iterator>
+#include <limits>
+#include <span>
 
 #include "config.h"
 #include "log_system.h"
@@ -16,18 +19,31 @@ bool DeferredRenderer::Render(const Model& model, const Shader& shader_in, uint3
   auto shader = std::make_shared<Shader>(shader_in);
   shader->PrepareUniformCaches();
 
-  // 顶点变换（AoS）
+  // 实例 BVH + meshlet 剔除：只有可见簇进入顶点阶段与光栅化
+  VisibleRanges visible = CollectVisibleRanges(model, *shader);
+
+  // 顶点阶段分两遍：仅位置 + 逐三角形剔除，再只为存活三角形的顶点计算属性
   auto vertex_start = std::chrono::high_resolution_clock::now();
-  const auto &input_vertices = model.GetVertices();
-  std::vector<Vertex> processedVertices(input_vertices.size());
-#pragma omp parallel for num_threads(kNProc) schedule(static) \
-    shared(shader, processedVertices, input_vertices)
-  for (size_t i = 0; i < input_vertices.size(); ++i) {
-    const auto &v = input_vertices[i];
-    auto clipSpaceVertex = shader->VertexShader(v);
-    auto ndcVertex = PerspectiveDivision(clipSpaceVertex);
-    auto screenSpaceVertex = ViewportTransformation(ndcVertex);
-    processedVertices[i] = screenSpaceVertex;
+  VertexSoA soa;
+  ProcessPositions(model, *shader, visible, soa);
+  ProcessAttributes(model, *shader, visible, soa);
+  ClipTriangles(model, visible, soa);
+
+  // 光栅化器使用 AoS 顶点
+  std::vector<Vertex> processedVertices(soa.size());
+#pragma omp parallel num_threads(kNProc) shared(processedVertices, visible, soa)
+  for (const auto &range : visible.vertices) {
+#pragma omp for schedule(static) nowait
+    for (size_t i = range.begin; i < range.end; ++i) {
+      if (!visible.NeedsVertex(i)) continue;
+      processedVertices[i] =
+          Vertex(soa.pos_screen[i], soa.normal[i], soa.uv[i], soa.color[i]);
+    }
+  }
+  // 裁剪产生的顶点追加在模型顶点之后
+  for (size_t i = model.GetVertices().size(); i < soa.size(); ++i) {
+    processedVertices[i] =
+        Vertex(soa.pos_screen[i], soa.normal[i], soa.uv[i], soa.color[i]);
   }
   auto vertex_end = std::chrono::high_resolution_clock::now();
   auto vertex_ms = std::chrono::duration_cast<std::chrono::microseconds>(vertex_end - vertex_start).count() / 1000.0;
@@ -46,24 +62,19 @@ bool DeferredRenderer::Render(const Model& model, const Shader& shader_in, uint3
   auto buffer_alloc_ms = std::chrono::duration_cast<std::chrono::microseconds>(buffer_alloc_end - buffer_alloc_start).count() / 1000.0;
 
   // Rasterization: collect fragments per pixel per thread
+  // 只插值着色器声明的 varyings
   auto raster_start = std::chrono::high_resolution_clock::now();
+  const VaryingMask varyings = shader->GetVaryings();
 #pragma omp parallel num_threads(kNProc) default(none)                       \
   shared(processedVertices, fragmentsBuffer_all_thread, rasterizer_, width_, \
-               height_, material_cache, model)
+               height_, material_cache, model, visible, soa, varyings)
   {
     int thread_id = omp_get_thread_num();
     auto &fragmentsBuffer_per_thread = fragmentsBuffer_all_thread[thread_id];
 
-#pragma omp for
-    for (size_t face_idx = 0; face_idx < model.GetFaces().size(); ++face_idx) {
-      const auto &f = model.GetFaces()[face_idx];
-      auto v0 = processedVertices[f.GetIndex(0)];
-      auto v1 = processedVertices[f.GetIndex(1)];
-      auto v2 = processedVertices[f.GetIndex(2)];
-
-      const Material *material = &material_cache[face_idx]; // 使用缓存的Material
-      auto fragments = rasterizer_->Rasterize(v0, v1, v2);
-
+    // 片段批的接收者：每个线程构造一次，material 随当前三角形更新
+    const Material *material = nullptr;
+    const FragmentSink collect_fragments = [&](std::span<Fragment> fragments) {
       for (auto &fragment : fragments) {
         fragment.material = material;
         size_t x = fragment.screen_coord[0];
@@ -73,6 +84,34 @@ bool DeferredRenderer::Render(const Model& model, const Shader& shader_in, uint3
         size_t index = x + y * width_;
         fragmentsBuffer_per_thread[index].push_back(fragment);
       }
+    };
+
+    // 背面与视锥体外的三角形已在位置阶段剔除
+    // 前段为无需裁剪的面，后段为裁剪产生的三角形
+    const size_t face_triangles = visible.triangles.size();
+#pragma omp for nowait
+    for (size_t t = 0; t < face_triangles + visible.clipped.size(); ++t) {
+      std::array<size_t, 3> indices;
+      size_t face_idx = 0;
+      if (t < face_triangles) {
+        face_idx = visible.triangles[t];
+        const auto &f = model.GetFaces()[face_idx];
+        indices = {f.GetIndex(0), f.GetIndex(1), f.GetIndex(2)};
+      } else {
+        const auto &c = visible.clipped[t - face_triangles];
+        face_idx = c.face;
+        indices = {c.indices[0], c.indices[1], c.indices[2]};
+      }
+      auto v0 = processedVertices[indices[0]];
+      auto v1 = processedVertices[indices[1]];
+      auto v2 = processedVertices[indices[2]];
+
+      material = &material_cache[face_idx]; // 使用缓存的Material
+      rasterizer_->Rasterize(v0, v1, v2,
+                             {soa.world_position[indices[0]],
+                              soa.world_position[indices[1]],
+                              soa.world_position[indices[2]]},
+                             varyings, collect_fragments);
     }
   }
   auto raster_end = std::chrono::high_resolution_clock::now();
@@ -123,8 +162,11 @@ bool DeferredRenderer::Render(const Model& model, const Shader& shader_in, uint3
   auto merge_start = std::chrono::high_resolution_clock::now();
 
   // Fragment Merge阶段：深度测试选择最近片段
+  // 候选片段还需比深度缓冲中的已有深度更近（帧模式下为此前绘制的结果）
+  float *depthBuffer = AcquireDepthBuffer(std::numeric_limits<float>::infinity());
   std::vector<const Fragment*> selected_fragments(width_ * height_, nullptr);
-#pragma omp parallel for
+  uint64_t selected_count = 0;
+#pragma omp parallel for reduction(+ : selected_count)
   for (size_t i = 0; i < fragmentsBuffer.size(); i++) {
     const auto &fragments = fragmentsBuffer[i];
     if (fragments.empty()) continue;
@@ -134,8 +176,13 @@ bool DeferredRenderer::Render(const Model& model, const Shader& shader_in, uint3
         renderFragment = &fragment;
       }
     }
-    selected_fragments[i] = renderFragment;
+    if (renderFragment->depth < depthBuffer[i]) {
+      depthBuffer[i] = renderFragment->depth;
+      selected_fragments[i] = renderFragment;
+      selected_count++;
+    }
   }
+  samples_passed_ = selected_count;
   auto merge_end = std::chrono::high_resolution_clock::now();
   auto merge_ms = std::chrono::duration_cast<std::chrono::microseconds>(merge_end - merge_start).count() / 1000.0;
 
@@ -3,10 +3,12 @@
 #include <omp.h>
 
 #include <algorithm>
+#include <array>
 #include <chrono>
 #include <cstring>
 #include <limits>
 #include <memory>
+#include <span>
 
 #include "config.h"
 #include "log_system.h"
@@ -21,19 +23,31 @@ bool PerTriangleRenderer::Render(const Model &model, const Shader &shader_in,
   auto shader = std::make_shared<Shader>(shader_in);
   shader->PrepareUniformCaches();
 
-  // 顶点变换（AoS）
+  // 实例 BVH + meshlet 剔除：只有可见簇进入顶点阶段与光栅化
+  VisibleRanges visible = CollectVisibleRanges(model, *shader);
+
+  // 顶点阶段分两遍：仅位置 + 逐三角形剔除，再只为存活三角形的顶点计算属性
   auto vertex_start = std::chrono::high_resolution_clock::now();
-  const auto &input_vertices = model.GetVertices();
-  std::vector<Vertex> processedVertices(input_vertices.size());
-
-#pragma omp parallel for num_threads(kNProc) schedule(static) \
-    shared(shader, processedVertices, input_vertices)
-  for (size_t i = 0; i < input_vertices.size(); ++i) {
-    const auto &v = input_vertices[i];
-    auto clipSpaceVertex = shader->VertexShader(v);
-    auto ndcVertex = PerspectiveDivision(clipSpaceVertex);
-    auto screenSpaceVertex = ViewportTransformation(ndcVertex);
-    processedVertices[i] = screenSpaceVertex;
+  VertexSoA soa;
+  ProcessPositions(model, *shader, visible, soa);
+  ProcessAttributes(model, *shader, visible, soa);
+  ClipTriangles(model, visible, soa);
+
+  // 光栅化器使用 AoS 顶点
+  std::vector<Vertex> processedVertices(soa.size());
+#pragma omp parallel num_threads(kNProc) shared(processedVertices, visible, soa)
+  for (const auto &range : visible.vertices) {
+#pragma omp for schedule(static) nowait
+    for (size_t i = range.begin; i < range.end; ++i) {
+      if (!visible.NeedsVertex(i)) continue;
+      processedVertices[i] =
+          Vertex(soa.pos_screen[i], soa.normal[i], soa.uv[i], soa.color[i]);
+    }
+  }
+  // 裁剪产生的顶点追加在模型顶点之后
+  for (size_t i = model.GetVertices().size(); i < soa.size(); ++i) {
+    processedVertices[i] =
+        Vertex(soa.pos_screen[i], soa.normal[i], soa.uv[i], soa.color[i]);
   }
   auto vertex_end = std::chrono::high_resolution_clock::now();
   auto vertex_ms = std::chrono::duration_cast<std::chrono::microseconds>(
@@ -42,17 +56,21 @@ bool PerTriangleRenderer::Render(const Model &model, const Shader &shader_in,
                    1000.0;
 
   // 1. 为每个线程创建framebuffer
+  // 线程深度以全局深度为初值：帧模式下即为此前绘制留下的深度
   auto buffer_alloc_start = std::chrono::high_resolution_clock::now();
+  float *depthBuffer =
+      AcquireDepthBuffer(std::numeric_limits<float>::infinity());
   std::vector<std::unique_ptr<float[]>> depthBuffer_all_thread(kNProc);
   std::vector<std::unique_ptr<uint32_t[]>> colorBuffer_all_thread(kNProc);
+  std::vector<uint64_t> samples_passed_all_thread(kNProc, 0);
 
   for (size_t thread_id = 0; thread_id < kNProc; thread_id++) {
     depthBuffer_all_thread[thread_id] =
         std::make_unique<float[]>(width_ * height_);
     colorBuffer_all_thread[thread_id] =
         std::make_unique<uint32_t[]>(width_ * height_);
-    std::fill_n(depthBuffer_all_thread[thread_id].get(), width_ * height_,
-                std::numeric_limits<float>::infinity());
+    std::copy_n(depthBuffer, width_ * height_,
+                depthBuffer_all_thread[thread_id].get());
     std::fill_n(colorBuffer_all_thread[thread_id].get(), width_ * height_, 0);
   }
   auto buffer_alloc_end = std::chrono::high_resolution_clock::now();
@@ -61,41 +79,22 @@ bool PerTriangleRenderer::Render(const Model &model, const Shader &shader_in,
                              .count() /
                          1000.0;
 
-  // 2. 并行光栅化
+  // 2. 并行光栅化（只插值着色器声明的 varyings）
   auto raster_start = std::chrono::high_resolution_clock::now();
+  const VaryingMask varyings = shader->GetVaryings();
 #pragma omp parallel num_threads(kNProc) default(none)              \
     shared(processedVertices, shader, rasterizer_, width_, height_, \
-               depthBuffer_all_thread, colorBuffer_all_thread, model)
+               depthBuffer_all_thread, colorBuffer_all_thread, model,   \
+               samples_passed_all_thread, visible, soa, varyings)
   {
     int thread_id = omp_get_thread_num();
     auto &depthBuffer_per_thread = depthBuffer_all_thread[thread_id];
     auto &colorBuffer_per_thread = colorBuffer_all_thread[thread_id];
+    uint64_t &samples_passed_per_thread = samples_passed_all_thread[thread_id];
 
-#pragma omp for
-    for (const auto &f : model.GetFaces()) {
-      auto v0 = processedVertices[f.GetIndex(0)];
-      auto v1 = processedVertices[f.GetIndex(1)];
-      auto v2 = processedVertices[f.GetIndex(2)];
-
-      // 背面剔除（屏幕空间叉积）
-      Vector2f screen0(v0.GetPosition().x, v0.GetPosition().y);
-      Vector2f screen1(v1.GetPosition().x, v1.GetPosition().y);
-      Vector2f screen2(v2.GetPosition().x, v2.GetPosition().y);
-
-      // 计算屏幕空间叉积判断朝向
-      Vector2f edge1 = screen1 - screen0;
-      Vector2f edge2 = screen2 - screen0;
-
-      // 背面剔除：NDC空间中叉积为负表示顺时针，即背面。
-      // 从NDC到屏幕空间中，会发生Y轴翻转，对应叉积应为正。
-      float cross_product = edge1.x * edge2.y - edge1.y * edge2.x;
-      if (cross_product > 0.0f) {
-        continue;  // 背面
-      }
-
-      const Material *material = &f.GetMaterial();
-      auto fragments = rasterizer_->Rasterize(v0, v1, v2);
-
+    // 片段批的接收者：每个线程构造一次，material 随当前三角形更新
+    const Material *material = nullptr;
+    const FragmentSink shade_fragments = [&](std::span<Fragment> fragments) {
       for (auto &fragment : fragments) {
         fragment.material = material;
         size_t x = fragment.screen_coord[0];
@@ -108,8 +107,36 @@ bool PerTriangleRenderer::Render(const Model &model, const Shader &shader_in,
           depthBuffer_per_thread[index] = fragment.depth;
           auto color = shader->FragmentShader(fragment);
           colorBuffer_per_thread[index] = uint32_t(color);
+          samples_passed_per_thread++;
         }
       }
+    };
+
+    // 背面与视锥体外的三角形已在位置阶段剔除
+    // 前段为无需裁剪的面，后段为裁剪产生的三角形
+    const auto &faces = model.GetFaces();
+    const size_t face_triangles = visible.triangles.size();
+#pragma omp for nowait
+    for (size_t t = 0; t < face_triangles + visible.clipped.size(); ++t) {
+      std::array<size_t, 3> indices;
+      if (t < face_triangles) {
+        const auto &f = faces[visible.triangles[t]];
+        indices = {f.GetIndex(0), f.GetIndex(1), f.GetIndex(2)};
+        material = &f.GetMaterial();
+      } else {
+        const auto &c = visible.clipped[t - face_triangles];
+        indices = {c.indices[0], c.indices[1], c.indices[2]};
+        material = &faces[c.face].GetMaterial();
+      }
+      auto v0 = processedVertices[indices[0]];
+      auto v1 = processedVertices[indices[1]];
+      auto v2 = processedVertices[indices[2]];
+
+      rasterizer_->Rasterize(v0, v1, v2,
+                             {soa.world_position[indices[0]],
+                              soa.world_position[indices[1]],
+                              soa.world_position[indices[2]]},
+                             varyings, shade_fragments);
     }
   }
   auto raster_end = std::chrono::high_resolution_clock::now();
@@ -119,19 +146,14 @@ bool PerTriangleRenderer::Render(const Model &model, const Shader &shader_in,
                    1000.0;
 
   // 3. 合并结果
+  // 只有比全局深度更近的线程结果才会覆盖；帧模式下其余像素保留输出缓冲中的已有颜色
   auto merge_start = std::chrono::high_resolution_clock::now();
-  std::unique_ptr<float[]> depthBuffer =
-      std::make_unique<float[]>(width_ * height_);
-  std::unique_ptr<uint32_t[]> colorBuffer =
-      std::make_unique<uint32_t[]>(width_ * height_);
-  std::fill_n(depthBuffer.get(), width_ * height_,
-              std::numeric_limits<float>::infinity());
-  std::fill_n(colorBuffer.get(), width_ * height_, 0);
+  const bool keep_color = IsFrameActive();
 
 #pragma omp parallel for
   for (size_t i = 0; i < width_ * height_; i++) {
-    float min_depth = std::numeric_limits<float>::infinity();
-    uint32_t color = 0;
+    float min_depth = depthBuffer[i];
+    uint32_t color = keep_color ? buffer[i] : 0;
     for (size_t thread_id = 0; thread_id < kNProc; thread_id++) {
       float depth = depthBuffer_all_thread[thread_id][i];
       if (depth < min_depth) {
@@ -140,10 +162,13 @@ bool PerTriangleRenderer::Render(const Model &model, const Shader &shader_in,
       }
     }
     depthBuffer[i] = min_depth;
-    colorBuffer[i] = color;
+    buffer[i] = color;
   }
 
-  std::memcpy(buffer, colorBuffer.get(), width_ * height_ * sizeof(uint32_t));
+  samples_passed_ = 0;
+  for (const auto samples : samples_passed_all_thread) {
+    samples_passed_ += samples;
+  }
   auto merge_end = std::chrono::high_resolution_clock::now();
   auto merge_ms = std::chrono::duration_cast<std::chrono::microseconds>(
                       merge_end - merge_start)
@@ -1,9 +1,29 @@
 #include "renderers/renderer_base.hpp"
 
 #include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "config.h"
+#include "log_system.h"
+#include "raster_kernel.hpp"
+#include "vertex_kernel.hpp"
 
 namespace simple_renderer {
 
+RendererBase::RendererBase(size_t width, size_t height)
+    : width_(width),
+      height_(height),
+      rasterizer_(std::make_shared<Rasterizer>(width, height)) {
+  // 更大的视口使保护带内的边函数超出 SIMD 内核的精确转换范围
+  if (width > kMaxViewportExtent || height > kMaxViewportExtent) {
+    SPDLOG_ERROR("viewport {}x{} exceeds {}", width, height,
+                 kMaxViewportExtent);
+    throw std::invalid_argument("Viewport exceeds kMaxViewportExtent");
+  }
+}
+
 Vertex RendererBase::PerspectiveDivision(const Vertex &vertex) {
   Vector4f position = vertex.GetPosition();
 
@@ -40,5 +60,537 @@ Vertex RendererBase::ViewportTransformation(const Vertex &vertex) {
   return Vertex(screenPosition, vertex.GetNormal(), vertex.GetTexCoords(), vertex.GetColor());
 }
 
+float *RendererBase::AcquireDepthBuffer(float clear_value) {
+  if (frame_depth_ != nullptr) {
+    return frame_depth_;
+  }
+  if (!own_depth_) {
+    own_depth_ = std::make_unique<float[]>(width_ * height_);
+  }
+  std::fill_n(own_depth_.get(), width_ * height_, clear_value);
+  return own_depth_.get();
+}
+
+FrameSampleBuffers RendererBase::AcquireFrameSamples(uint32_t samples,
+                                                     const uint32_t *color) {
+  if (frame_depth_ == nullptr) {
+    return {};
+  }
+  const size_t plane = width_ * height_;
+  if (frame_samples_count_ != samples) {
+    if (frame_samples_capacity_ < samples) {
+      frame_sample_depth_ = std::make_unique<float[]>(plane * samples);
+      frame_sample_color_ = std::make_unique<uint32_t[]>(plane * samples);
+      frame_samples_capacity_ = samples;
+    }
+    for (uint32_t s = 0; s < samples; ++s) {
+      std::copy_n(frame_depth_, plane, frame_sample_depth_.get() + s * plane);
+      std::copy_n(color, plane, frame_sample_color_.get() + s * plane);
+    }
+    frame_samples_count_ = samples;
+  }
+  return {frame_sample_depth_.get(), frame_sample_color_.get(), plane};
+}
+
+ScreenBounds RendererBase::ProjectBoundingBox(const Vector3f &bmin,
+                                              const Vector3f &bmax,
+                                              const Matrix4f &mvp) const {
+  ScreenBounds bounds;
+  bounds.min_x = bounds.min_y = bounds.min_z = std::numeric_limits<float>::max();
+  bounds.max_x = bounds.max_y = bounds.max_z =
+      std::numeric_limits<float>::lowest();
+
+  // 8 个角点 -> 裁剪空间 -> 屏幕空间，累计屏幕矩形与深度范围
+  // 裁剪码：某一位在 8 个角点上全部置位，说明包围盒整体位于该平面外
+  uint32_t outside_all = 0x3Fu;
+  for (uint32_t i = 0; i < 8; ++i) {
+    const Vector4f corner((i & 1u) ? bmax.x : bmin.x,
+                          (i & 2u) ? bmax.y : bmin.y,
+                          (i & 4u) ? bmax.z : bmin.z, 1.0f);
+    const Vector4f c = mvp * corner;
+    uint32_t code = 0;
+    code |= (c.x > c.w) ? 0x01u : 0u;
+    code |= (c.x < -c.w) ? 0x02u : 0u;
+    code |= (c.y > c.w) ? 0x04u : 0u;
+    code |= (c.y < -c.w) ? 0x08u : 0u;
+    code |= (c.z > c.w) ? 0x10u : 0u;
+    code |= (c.z < -c.w) ? 0x20u : 0u;
+    outside_all &= code;
+
+    if (c.w <= kMinWValue) {
+      // 角点位于相机平面之后，投影不可靠：保守地视为整屏可见
+      bounds.crosses_near = true;
+      continue;
+    }
+    // 与 PerspectiveDivision + ViewportTransformation 一致
+    const float inv_w = 1.0f / c.w;
+    const float sx = (c.x * inv_w + 1.0f) * width_ / 2.0f;
+    const float sy = (1.0f - c.y * inv_w) * height_ / 2.0f;
+    const float sz = std::clamp(c.z * inv_w, -1.0f, 1.0f);
+    bounds.min_x = std::min(bounds.min_x, sx);
+    bounds.min_y = std::min(bounds.min_y, sy);
+    bounds.max_x = std::max(bounds.max_x, sx);
+    bounds.max_y = std::max(bounds.max_y, sy);
+    bounds.min_z = std::min(bounds.min_z, sz);
+    bounds.max_z = std::max(bounds.max_z, sz);
+  }
+  bounds.outside = outside_all != 0u;
+  if (bounds.crosses_near) {
+    bounds.min_x = bounds.min_y = 0.0f;
+    bounds.max_x = static_cast<float>(width_ - 1);
+    bounds.max_y = static_cast<float>(height_ - 1);
+    bounds.min_z = -1.0f;
+    bounds.max_z = 1.0f;
+  }
+  return bounds;
+}
+
+bool RendererBase::IsBoundingBoxCulled(const Vector3f &bmin,
+                                       const Vector3f &bmax,
+                                       const Matrix4f &mvp) {
+  const ScreenBounds bounds = ProjectBoundingBox(bmin, bmax, mvp);
+  if (bounds.outside) {
+    return true;
+  }
+  return pyramid_ != nullptr && pyramid_->GetWidth() == width_ &&
+         pyramid_->GetHeight() == height_ && pyramid_->IsOccluded(bounds);
+}
+
+void RendererBase::ProcessPositions(const Model &model, const Shader &shader,
+                                    VisibleRanges &visible, VertexSoA &soa) {
+  const auto &vertices = model.GetVertices();
+  const auto &faces = model.GetFaces();
+  soa.resize_positions(vertices.size());
+
+  // 世界空间顶点缓存：模型矩阵与顶点不变时跨帧复用，每帧只剩视图-投影变换
+  const auto &world = model.GetWorldVertices(shader.GetModelMatrix());
+  const Matrix4f view_projection = shader.GetViewProjectionMatrix();
+
+  // 第一遍：按对齐到 kVertexBatchSize 的批只变换位置，整批都不需要的顶点直接跳过
+  const ViewportParams viewport{static_cast<float>(width_),
+                                static_cast<float>(height_), kMinWValue};
+#pragma omp parallel num_threads(kNProc) \
+    shared(vertices, visible, soa, world, view_projection, viewport)
+  for (const auto &range : visible.vertices) {
+    const size_t range_first =
+        range.begin / kVertexBatchSize * kVertexBatchSize;
+    const size_t batches =
+        (range.end - range_first + kVertexBatchSize - 1) / kVertexBatchSize;
+#pragma omp for schedule(static) nowait
+    for (size_t b = 0; b < batches; ++b) {
+      const size_t first = range_first + b * kVertexBatchSize;
+      const size_t begin = std::max(first, range.begin);
+      const size_t end = std::min(first + kVertexBatchSize, range.end);
+      if (!visible.vertex_mask.empty() &&
+          std::none_of(visible.vertex_mask.begin() + begin,
+                       visible.vertex_mask.begin() + end,
+                       [](uint8_t m) { return m != 0; })) {
+        continue;
+      }
+      TransformVertexBatch(view_projection, world, first, begin, end,
+                           viewport, soa);
+    }
+  }
+
+  // 逐三角形剔除：视锥体、背面、零面积
+  // alive：0 剔除，1 存活，2 跨越近平面/保护带、待齐次裁剪
+  std::vector<uint8_t> alive(faces.size(), 0);
+#pragma omp parallel num_threads(kNProc) shared(faces, visible, soa, alive)
+  for (const auto &range : visible.faces) {
+#pragma omp for schedule(static) nowait
+    for (size_t f = range.begin; f < range.end; ++f) {
+      const auto &indices = faces[f].GetIndices();
+      const uint8_t c0 = soa.clip_code[indices[0]];
+      const uint8_t c1 = soa.clip_code[indices[1]];
+      const uint8_t c2 = soa.clip_code[indices[2]];
+      if ((c0 & c1 & c2 & kClipFrustum) != 0) {
+        continue;
+      }
+      // 屏幕坐标对这类三角形无意义，背面剔除推迟到裁剪之后
+      if (((c0 | c1 | c2) & (kClipNear | kClipGuardBand)) != 0) {
+        alive[f] = 2;
+        continue;
+      }
+
+      // 屏幕空间叉积：Y 轴翻转后背面为正；与光栅化器的退化阈值一致
+      const Vector4f &p0 = soa.pos_screen[indices[0]];
+      const Vector4f &p1 = soa.pos_screen[indices[1]];
+      const Vector4f &p2 = soa.pos_screen[indices[2]];
+      const float cross = (p1.x - p0.x) * (p2.y - p0.y) -
+                          (p1.y - p0.y) * (p2.x - p0.x);
+      if (cross > 0.0f || std::abs(cross) < 1e-6f) continue;
+      alive[f] = 1;
+    }
+  }
+
+  // 压缩存活面（保持提交顺序），并重建属性阶段的顶点掩码
+  visible.triangles.clear();
+  visible.triangles.reserve(visible.face_count);
+  visible.clip_faces.clear();
+  visible.vertex_mask.assign(vertices.size(), 0);
+  size_t attribute_vertices = 0;
+  for (const auto &range : visible.faces) {
+    for (size_t f = range.begin; f < range.end; ++f) {
+      if (!alive[f]) continue;
+      (alive[f] == 2 ? visible.clip_faces : visible.triangles)
+          .push_back(static_cast<uint32_t>(f));
+      for (const size_t v : faces[f].GetIndices()) {
+        attribute_vertices += visible.vertex_mask[v] == 0 ? 1 : 0;
+        visible.vertex_mask[v] = 1;
+      }
+    }
+  }
+  SPDLOG_DEBUG(
+      "triangle culling: faces {} -> {} (+{} to clip), attribute vertices {} "
+      "-> {}",
+      visible.face_count, visible.triangles.size(), visible.clip_faces.size(),
+      visible.vertex_count, attribute_vertices);
+  visible.vertex_count = attribute_vertices;
+}
+
+void RendererBase::ProcessAttributes(const Model &model, Shader &shader,
+                                     const VisibleRanges &visible,
+                                     VertexSoA &soa) {
+  const auto &vertices = model.GetVertices();
+  soa.resize_attributes(vertices.size());
+  // 未声明任何 varying（如仅深度的绘制）时无需计算顶点属性
+  const VaryingMask varyings = shader.GetVaryings();
+  if (varyings == 0) {
+    return;
+  }
+  // ProcessPositions 已按当前模型矩阵建立缓存，此处必然命中
+  const auto &world = model.GetWorldVertices(shader.GetModelMatrix());
+  const bool world_position = (varyings & kVaryingWorldPosition) != 0;
+
+  // 按批解码 UV 与颜色（紧凑格式在此解码），法线取自世界空间缓存，
+  // 再逐顶点执行世界空间输入的顶点着色器
+#pragma omp parallel num_threads(kNProc) \
+    shared(vertices, world, visible, soa, shader, world_position)
+  for (const auto &range : visible.vertices) {
+    const size_t range_first =
+        range.begin / kVertexBatchSize * kVertexBatchSize;
+    const size_t batches =
+        (range.end - range_first + kVertexBatchSize - 1) / kVertexBatchSize;
+#pragma omp for schedule(static) nowait
+    for (size_t b = 0; b < batches; ++b) {
+      const size_t first = range_first + b * kVertexBatchSize;
+      const size_t begin = std::max(first, range.begin);
+      const size_t end = std::min(first + kVertexBatchSize, range.end);
+      if (std::none_of(visible.vertex_mask.begin() + begin,
+                       visible.vertex_mask.begin() + end,
+                       [](uint8_t m) { return m != 0; })) {
+        continue;
+      }
+      DecodeAttributeBatch(vertices, world, first, begin, end, soa);
+      for (size_t i = begin; i < end; ++i) {
+        if (!visible.NeedsVertex(i)) continue;
+        const Vector3f position(world.x[i], world.y[i], world.z[i]);
+        const auto shaded = shader.WorldVertexShader(
+            Vertex(Vector4f(position, 1.0f), soa.normal[i], soa.uv[i],
+                   soa.color[i]),
+            soa.pos_clip[i]);
+        if (world_position) {
+          soa.world_position[i] = position;
+        }
+        soa.normal[i] = shaded.GetNormal();
+        soa.uv[i] = shaded.GetTexCoords();
+        soa.color[i] = shaded.GetColor();
+      }
+    }
+  }
+}
+
+void RendererBase::ClipTriangles(const Model &model, VisibleRanges &visible,
+                                 VertexSoA &soa) {
+  visible.clipped.clear();
+  if (visible.clip_faces.empty()) {
+    return;
+  }
+  const auto &faces = model.GetFaces();
+  // 跨越近平面/保护带的三角形很少，串行处理并直接追加到 SoA
+  for (const uint32_t f : visible.clip_faces) {
+    const auto &indices = faces[f].GetIndices();
+    const ClipPolygon polygon =
+        ClipTriangle(soa.pos_clip[indices[0]], soa.pos_clip[indices[1]],
+                     soa.pos_clip[indices[2]]);
+    if (polygon.count < 3) {
+      continue;
+    }
+
+    // 裁剪顶点的屏幕坐标，与位置阶段相同的透视除法与视口变换
+    std::array<Vector4f, kMaxClipVertices> screen;
+    for (size_t k = 0; k < polygon.count; ++k) {
+      const Vector4f &clip = polygon.vertices[k].position;
+      screen[k] = ViewportTransformation(
+                      PerspectiveDivision(Vertex(clip, Vector3f(0.0f),
+                                                 Vector2f(0.0f), Color())))
+                      .GetPosition();
+    }
+
+    // 扇形三角化，与位置阶段相同的背面与零面积剔除
+    const auto base = static_cast<uint32_t>(soa.size());
+    const size_t clipped_before = visible.clipped.size();
+    for (size_t k = 1; k + 1 < polygon.count; ++k) {
+      const Vector4f &p0 = screen[0];
+      const Vector4f &p1 = screen[k];
+      const Vector4f &p2 = screen[k + 1];
+      const float cross = (p1.x - p0.x) * (p2.y - p0.y) -
+                          (p1.y - p0.y) * (p2.x - p0.x);
+      if (cross > 0.0f || std::abs(cross) < 1e-6f) continue;
+      visible.clipped.push_back(
+          {{base, base + static_cast<uint32_t>(k),
+            base + static_cast<uint32_t>(k + 1)},
+           f});
+    }
+    if (visible.clipped.size() == clipped_before) {
+      continue;
+    }
+
+    // 追加裁剪顶点：裁剪空间中属性线性变化，按重心权重插值
+    for (size_t k = 0; k < polygon.count; ++k) {
+      const Vector3f &b = polygon.vertices[k].barycentric;
+      const auto blend = [&](const auto &stream) {
+        return stream[indices[0]] * b.x + stream[indices[1]] * b.y +
+               stream[indices[2]] * b.z;
+      };
+      // 按值复制：下面的 push_back 可能使流内引用失效
+      const Color c0 = soa.color[indices[0]];
+      const Color c1 = soa.color[indices[1]];
+      const Color c2 = soa.color[indices[2]];
+      const auto channel = [&](uint8_t c) {
+        return FloatToUint8_t(static_cast<float>(c0[c]) * b.x +
+                              static_cast<float>(c1[c]) * b.y +
+                              static_cast<float>(c2[c]) * b.z);
+      };
+      const Vector3f normal = blend(soa.normal);
+      const Vector2f uv = blend(soa.uv);
+      const Vector3f world_position = blend(soa.world_position);
+      soa.pos_clip.push_back(polygon.vertices[k].position);
+      soa.pos_screen.push_back(screen[k]);
+      soa.clip_code.push_back(0);
+      soa.normal.push_back(normal);
+      soa.uv.push_back(uv);
+      soa.color.push_back(Color(channel(Color::kColorIndexRed),
+                                channel(Color::kColorIndexGreen),
+                                channel(Color::kColorIndexBlue)));
+      soa.world_position.push_back(world_position);
+    }
+  }
+  SPDLOG_DEBUG("clipping: faces {} -> triangles {}, vertices {}",
+               visible.clip_faces.size(), visible.clipped.size(),
+               soa.size() - model.GetVertices().size());
+}
+
+size_t RendererBase::SelectLod(const Model &model, const Matrix4f &mvp,
+                               float max_error_pixels) const {
+  if (model.GetLodCount() <= 1) {
+    return 0;
+  }
+  const Vector3f center = (model.GetBoundsMin() + model.GetBoundsMax()) * 0.5f;
+  const float radius =
+      glm::length(model.GetBoundsMax() - model.GetBoundsMin()) * 0.5f;
+  const auto row = [&mvp](int r) {
+    return Vector4f(mvp[0][r], mvp[1][r], mvp[2][r], mvp[3][r]);
+  };
+  // 包围球上离相机最近点的 w（裁剪空间 w 即视空间深度）
+  const Vector4f w_row = row(3);
+  const float nearest_w = glm::dot(w_row, Vector4f(center, 1.0f)) -
+                          radius * glm::length(Vector3f(w_row));
+  if (nearest_w <= kMinWValue) {
+    return 0;
+  }
+  // 模型空间单位长度在该深度处对应的像素数
+  const float pixels_per_unit =
+      std::max(glm::length(Vector3f(row(0))) * static_cast<float>(width_),
+               glm::length(Vector3f(row(1))) * static_cast<float>(height_)) *
+      0.5f / nearest_w;
+
+  size_t level = 0;
+  for (size_t i = 1; i < model.GetLodCount(); ++i) {
+    if (model.GetLod(i).GetLodError() * pixels_per_unit > max_error_pixels) {
+      break;
+    }
+    level = i;
+  }
+  return level;
+}
+
+ClusterCullContext RendererBase::MakeClusterCullContext(
+    const Matrix4f &mvp, const Matrix4f &model_view) {
+  ClusterCullContext ctx;
+  ctx.mvp = mvp;
+  // Gribb-Hartmann：由 MVP 的行组合得到模型空间视锥体平面
+  const auto row = [&mvp](int r) {
+    return Vector4f(mvp[0][r], mvp[1][r], mvp[2][r], mvp[3][r]);
+  };
+  const Vector4f r0 = row(0), r1 = row(1), r2 = row(2), r3 = row(3);
+  const Vector4f planes[6] = {r3 + r0, r3 - r0, r3 + r1,
+                              r3 - r1, r3 + r2, r3 - r2};
+  for (int i = 0; i < 6; ++i) {
+    const float len = glm::length(Vector3f(planes[i]));
+    ctx.planes[i] = len > 0.0f ? planes[i] / len : planes[i];
+  }
+  // 视图空间原点即相机，变换回模型空间
+  ctx.eye = Vector3f(glm::inverse(model_view) * Vector4f(0.0f, 0.0f, 0.0f, 1.0f));
+  ctx.cone_enabled = glm::determinant(Matrix3f(model_view)) > 0.0f;
+  return ctx;
+}
+
+bool RendererBase::IsMeshletCulled(const Meshlet &meshlet,
+                                   const ClusterCullContext &ctx) {
+  // 包围球视锥体剔除
+  for (const auto &plane : ctx.planes) {
+    if (glm::dot(Vector3f(plane), meshlet.center) + plane.w < -meshlet.radius) {
+      return true;
+    }
+  }
+  // 法线锥背面剔除：视线与锥轴夹角足够小时，簇内所有三角形均背向相机
+  if (ctx.cone_enabled && meshlet.cone_cutoff < 1.0f) {
+    const Vector3f to_center = meshlet.center - ctx.eye;
+    if (glm::dot(to_center, meshlet.cone_axis) >=
+        meshlet.cone_cutoff * glm::length(to_center) + meshlet.radius) {
+      return true;
+    }
+  }
+  // Hi‑Z 遮挡剔除
+  if (pyramid_ != nullptr) {
+    return IsBoundingBoxCulled(meshlet.bounds_min, meshlet.bounds_max, ctx.mvp);
+  }
+  return false;
+}
+
+VisibleRanges RendererBase::CollectVisibleRanges(const Model &model,
+                                                const Shader &shader) {
+  VisibleRanges visible;
+  const auto &instances = model.GetMeshInstances();
+  if (instances.empty()) {
+    visible.vertices.push_back({0, model.GetVertices().size()});
+    visible.faces.push_back({0, model.GetFaces().size()});
+    visible.vertex_count = model.GetVertices().size();
+    visible.face_count = model.GetFaces().size();
+    return visible;
+  }
+
+  const Matrix4f mvp = shader.GetMVPMatrix();
+  std::vector<uint32_t> visible_instances;
+  visible_instances.reserve(instances.size());
+  model.GetInstanceBvh().Traverse(
+      [this, &mvp](const Vector3f &bmin, const Vector3f &bmax) {
+        return IsBoundingBoxCulled(bmin, bmax, mvp);
+      },
+      [&visible_instances](uint32_t item) { visible_instances.push_back(item); });
+
+  const auto append_range = [](std::vector<IndexRange> &ranges,
+                               IndexRange range) {
+    if (!ranges.empty() && ranges.back().end == range.begin) {
+      ranges.back().end = range.end;
+    } else {
+      ranges.push_back(range);
+    }
+  };
+
+  // 实例按加载顺序在扁平数组中连续存放：排序后合并相邻区间
+  std::sort(visible_instances.begin(), visible_instances.end());
+  const auto &meshlets = model.GetMeshlets();
+  const auto &meshlet_vertices = model.GetMeshletVertices();
+  const ClusterCullContext ctx =
+      MakeClusterCullContext(mvp, shader.GetModelViewMatrix());
+  size_t meshlets_total = 0, meshlets_visible = 0;
+  for (const uint32_t index : visible_instances) {
+    const MeshInstance &instance = instances[index];
+    append_range(visible.vertices,
+                 {instance.vertex_offset,
+                  instance.vertex_offset + instance.vertex_count});
+    if (instance.meshlet_count == 0) {
+      append_range(visible.faces,
+                   {instance.face_offset,
+                    instance.face_offset + instance.face_count});
+      visible.face_count += instance.face_count;
+      continue;
+    }
+    if (visible.vertex_mask.empty()) {
+      visible.vertex_mask.assign(model.GetVertices().size(), 0);
+    }
+    // 顶点需求由可见 meshlet 决定
+    for (size_t m = instance.meshlet_offset;
+         m < instance.meshlet_offset + instance.meshlet_count; ++m) {
+      const Meshlet &meshlet = meshlets[m];
+      ++meshlets_total;
+      if (IsMeshletCulled(meshlet, ctx)) {
+        continue;
+      }
+      ++meshlets_visible;
+      append_range(visible.faces,
+                   {meshlet.face_offset, meshlet.face_offset + meshlet.face_count});
+      visible.face_count += meshlet.face_count;
+      for (uint32_t v = 0; v < meshlet.vertex_count; ++v) {
+        visible.vertex_mask[meshlet_vertices[meshlet.vertex_offset + v]] = 1;
+      }
+    }
+  }
+  if (!visible.vertex_mask.empty()) {
+    // 无 meshlet 的实例需要全部顶点
+    for (const uint32_t index : visible_instances) {
+      const MeshInstance &instance = instances[index];
+      if (instance.meshlet_count == 0) {
+        std::fill_n(visible.vertex_mask.begin() + instance.vertex_offset,
+                    instance.vertex_count, uint8_t{1});
+      }
+    }
+    for (const auto flag : visible.vertex_mask) {
+      visible.vertex_count += flag;
+    }
+  } else {
+    for (const auto &range : visible.vertices) {
+      visible.vertex_count += range.end - range.begin;
+    }
+  }
+  SPDLOG_DEBUG(
+      "visible mesh instances: {}/{}, meshlets: {}/{}, vertices: {}/{}, "
+      "faces: {}/{}",
+      visible_instances.size(), instances.size(), meshlets_visible,
+      meshlets_total, visible.vertex_count, model.GetVertices().size(),
+      visible.face_count, model.GetFaces().size());
+  return visible;
+}
+
+uint64_t RendererBase::TestBoundingBox(const Vector3f &bmin,
+                                       const Vector3f &bmax,
+                                       const Shader &shader) {
+  const ScreenBounds bounds =
+      ProjectBoundingBox(bmin, bmax, shader.GetMVPMatrix());
+  if (bounds.outside) {
+    return 0;  // 视锥体外
+  }
+  const float min_z = bounds.min_z;
+
+  const int sx = std::max(0, static_cast<int>(std::floor(bounds.min_x)));
+  const int sy = std::max(0, static_cast<int>(std::floor(bounds.min_y)));
+  const int ex = std::min(static_cast<int>(width_) - 1,
+                          static_cast<int>(std::floor(bounds.max_x)));
+  const int ey = std::min(static_cast<int>(height_) - 1,
+                          static_cast<int>(std::floor(bounds.max_y)));
+  if (sx > ex || sy > ey) {
+    return 0;
+  }
+
+  if (!IsFrameActive()) {
+    // 帧外每次绘制独立清除深度，上一次绘制残留的深度与之后的绘制无关，
+    // 没有可比较的遮挡体：矩形内全部计为通过
+    return static_cast<uint64_t>(ex - sx + 1) * static_cast<uint64_t>(ey - sy + 1);
+  }
+  const float *depth = frame_depth_;
+
+  uint64_t passed = 0;
+#pragma omp parallel for num_threads(kNProc) schedule(static) reduction(+ : passed)
+  for (int y = sy; y <= ey; ++y) {
+    const float *row = depth + static_cast<size_t>(y) * width_;
+    for (int x = sx; x <= ex; ++x) {
+      passed += (min_z < row[x]) ? 1u : 0u;
+    }
+  }
+  return passed;
+}
+
 }  // namespace simple_renderer
 
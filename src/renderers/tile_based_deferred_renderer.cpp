@@ -15,13 +15,17 @@
 #include <omp.h>
 
 #include <algorithm>
+#include <bit>
 #include <chrono>
 #include <cmath>
 #include <cstring>
 #include <limits>
 
 #include "config.h"
+#include "edge_function.hpp"
 #include "log_system.h"
+#include "msaa.hpp"
+#include "raster_kernel.hpp"
 
 namespace simple_renderer {
 
@@ -32,24 +36,15 @@ bool TileBasedDeferredRenderer::Render(const Model& model, const Shader& shader_
   shader->PrepareUniformCaches();
 
   // 顶点阶段（SoA）
-  // - 统一进行裁剪空间->NDC->屏幕空间的变换，并将结果写入 SoA。
+  // - 先经实例 BVH 与 meshlet 剔除，只处理可见簇引用的顶点；
+  // - 仅位置的第一遍完成视锥体/背面剔除，属性只为存活三角形的顶点计算；
   // - 此阶段与 TBR 完全一致。
+  VisibleRanges visible = CollectVisibleRanges(model, *shader);
   auto vertex_start = std::chrono::high_resolution_clock::now();
-  const auto& input_vertices = model.GetVertices();
-  VertexSoA soa; soa.resize(input_vertices.size());
-
-#pragma omp parallel for num_threads(kNProc) schedule(static) shared(shader, soa, input_vertices)
-  for (size_t i = 0; i < input_vertices.size(); ++i) {
-    const auto& v = input_vertices[i];
-    auto clip = shader->VertexShader(v);
-    soa.pos_clip[i] = clip.GetPosition();
-    auto ndc = PerspectiveDivision(clip);
-    auto screen = ViewportTransformation(ndc);
-    soa.pos_screen[i] = screen.GetPosition();
-    soa.normal[i] = screen.GetNormal();
-    soa.uv[i] = screen.GetTexCoords();
-    soa.color[i] = screen.GetColor();
-  }
+  VertexSoA soa;
+  ProcessPositions(model, *shader, visible, soa);
+  ProcessAttributes(model, *shader, visible, soa);
+  ClipTriangles(model, visible, soa);
   auto vertex_end = std::chrono::high_resolution_clock::now();
   double vertex_ms = std::chrono::duration_cast<std::chrono::microseconds>(vertex_end - vertex_start).count() / 1000.0;
 
@@ -63,23 +58,34 @@ bool TileBasedDeferredRenderer::Render(const Model& model, const Shader& shader_
   const size_t tiles_y = (height_ + TILE_SIZE - 1) / TILE_SIZE;
   const size_t total_tiles = tiles_x * tiles_y;
   std::vector<std::vector<TileTriangleRef>> tile_triangles(total_tiles);
+  // 三角形建立：每个三角形只建立一次，分箱与各 tile 的决胜共享
+  TriangleSetupBuffer setups;
+  setups.Build(model, visible, soa, msaa_samples_);
   auto setup_end = std::chrono::high_resolution_clock::now();
   double setup_ms = std::chrono::duration_cast<std::chrono::microseconds>(setup_end - setup_start).count() / 1000.0;
 
   auto bin_start = std::chrono::high_resolution_clock::now();
-  TileGridContext grid_ctx{soa, tiles_x, tiles_y, TILE_SIZE};
-  TriangleTileBinning(model, grid_ctx, tile_triangles);
+  TileGridContext grid_ctx{soa, setups, tiles_x, tiles_y, TILE_SIZE};
+  // 帧模式下按 tile 已有最大深度在分箱时拒绝被遮挡的三角形（binning 阶段 Hi‑Z）
+  std::vector<float> tile_depth_max;
+  if (IsFrameActive()) {
+    tile_depth_max = ComputeTileDepthMax(AcquireDepthBuffer(kDepthClear), width_, height_, grid_ctx);
+    grid_ctx.tile_depth_max = tile_depth_max.data();
+  }
+  TriangleTileBinning(grid_ctx, tile_triangles);
   auto bin_end = std::chrono::high_resolution_clock::now();
   double bin_ms = std::chrono::duration_cast<std::chrono::microseconds>(bin_end - bin_start).count() / 1000.0;
 
   // 全局 framebuffer（单份）
   // - 每个 Tile 完成后，整行拷贝到这份全局缓冲；
   // - 不同 Tile 不重叠，省去同步/锁开销。
+  // - 深度来自帧深度缓冲（帧模式）或内部缓冲（独立绘制），颜色直接写入输出缓冲。
   auto buf_alloc_start = std::chrono::high_resolution_clock::now();
-  std::unique_ptr<float[]> depthBuffer = std::make_unique<float[]>(width_ * height_);
-  std::unique_ptr<uint32_t[]> colorBuffer = std::make_unique<uint32_t[]>(width_ * height_);
-  std::fill_n(depthBuffer.get(), width_ * height_, kDepthClear);
-  std::fill_n(colorBuffer.get(), width_ * height_, kColorClear);
+  float* depthBuffer = AcquireDepthBuffer(kDepthClear);
+  uint32_t* colorBuffer = buffer;
+  // 帧模式 MSAA：样本在绘制之间保留，深度/颜色缓冲只保存解析结果
+  const FrameSampleBuffers frame_samples =
+      msaa_samples_ > 1 ? AcquireFrameSamples(msaa_samples_, buffer) : FrameSampleBuffers{};
   auto buf_alloc_end = std::chrono::high_resolution_clock::now();
   double buf_alloc_ms = std::chrono::duration_cast<std::chrono::microseconds>(buf_alloc_end - buf_alloc_start).count() / 1000.0;
 
@@ -90,10 +96,21 @@ bool TileBasedDeferredRenderer::Render(const Model& model, const Shader& shader_
   std::vector<TileMaskStats> tile_stats(total_tiles);
 
 #pragma omp parallel num_threads(kNProc) default(none) \
-    shared(tile_triangles, grid_ctx, depthBuffer, colorBuffer, shader, total_tiles, tile_stats)
+    shared(tile_triangles, grid_ctx, depthBuffer, colorBuffer, shader, total_tiles, tile_stats, msaa_samples_, \
+               frame_samples)
   {
-    std::unique_ptr<float[]> tile_depth_buffer = std::make_unique<float[]>(grid_ctx.tile_size * grid_ctx.tile_size);
-    std::unique_ptr<uint32_t[]> tile_color_buffer = std::make_unique<uint32_t[]>(grid_ctx.tile_size * grid_ctx.tile_size);
+    // MSAA 时每个样本一个平面
+    const size_t tile_samples = grid_ctx.tile_size * grid_ctx.tile_size * msaa_samples_;
+    std::unique_ptr<float[]> tile_depth_buffer = std::make_unique<float[]>(tile_samples);
+    std::unique_ptr<uint32_t[]> tile_color_buffer = std::make_unique<uint32_t[]>(tile_samples);
+    // MSAA 决胜用的样本 zmin / 胜者与每像素 zmax，按线程分配、跨 tile 复用
+    MsaaTileScratch msaa_scratch;
+    if (msaa_samples_ > 1) {
+      msaa_scratch.zmin = std::make_unique<float[]>(tile_samples);
+      msaa_scratch.winner = std::make_unique<int32_t[]>(tile_samples);
+      msaa_scratch.pixel_zmax =
+          std::make_unique<float[]>(grid_ctx.tile_size * grid_ctx.tile_size);
+    }
 
 #pragma omp for schedule(static)
     for (size_t tile_id = 0; tile_id < total_tiles; ++tile_id) {
@@ -101,10 +118,17 @@ bool TileBasedDeferredRenderer::Render(const Model& model, const Shader& shader_
       // 2-pass 的核心逻辑在 RasterizeTileDeferred 内：
       //   A) 仅计算覆盖与深度，确定每像素胜者（三角形索引）并缓存透视矫正重心；
       //   B) 对胜者像素一次性着色写回，最后整 Tile 拷贝到全局。
-      RasterizeTileDeferred(tile_id, tile_triangles[tile_id], grid_ctx,
-                            tile_depth_buffer.get(), tile_color_buffer.get(),
-                            depthBuffer, colorBuffer, *shader,
-                            &tested, &covered, &winners, &shaded);
+      if (msaa_samples_ > 1) {
+        RasterizeTileDeferredMsaa(tile_id, tile_triangles[tile_id], grid_ctx,
+                                  tile_depth_buffer.get(), tile_color_buffer.get(),
+                                  msaa_scratch, depthBuffer, colorBuffer, frame_samples, *shader,
+                                  &tested, &covered, &winners, &shaded);
+      } else {
+        RasterizeTileDeferred(tile_id, tile_triangles[tile_id], grid_ctx,
+                              tile_depth_buffer.get(), tile_color_buffer.get(),
+                              depthBuffer, colorBuffer, *shader,
+                              &tested, &covered, &winners, &shaded);
+      }
       tile_stats[tile_id].tested = tested;
       tile_stats[tile_id].covered = covered;
       tile_stats[tile_id].zpass = winners; // 在 TBDR 中 zpass≈winner 数
@@ -127,12 +151,7 @@ bool TileBasedDeferredRenderer::Render(const Model& model, const Shader& shader_
                sum_tested, sum_covered, rate(sum_covered, sum_tested),
                sum_winners, rate(sum_winners, sum_covered),
                sum_shaded, rate(sum_shaded, sum_covered));
-
-  // 拷贝到输出
-  auto present_start = std::chrono::high_resolution_clock::now();
-  std::memcpy(buffer, colorBuffer.get(), width_ * height_ * sizeof(uint32_t));
-  auto present_end = std::chrono::high_resolution_clock::now();
-  double present_ms = std::chrono::duration_cast<std::chrono::microseconds>(present_end - present_start).count() / 1000.0;
+  samples_passed_ = sum_shaded;
 
   auto total_end_time = std::chrono::high_resolution_clock::now();
   double total_ms = std::chrono::duration_cast<std::chrono::microseconds>(total_end_time - total_start_time).count() / 1000.0;
@@ -144,29 +163,28 @@ bool TileBasedDeferredRenderer::Render(const Model& model, const Shader& shader_
   SPDLOG_DEBUG("Binning:          {:8.3f} ms", bin_ms);
   SPDLOG_DEBUG("Buffer Alloc:     {:8.3f} ms", buf_alloc_ms);
   SPDLOG_DEBUG("Tile Raster:      {:8.3f} ms", raster_ms);
-  SPDLOG_DEBUG("Copy:             {:8.3f} ms", present_ms);
-  SPDLOG_DEBUG("Total:            {:8.3f} ms", vertex_ms + (setup_ms + bin_ms + buf_alloc_ms + raster_ms + present_ms));
+  SPDLOG_DEBUG("Total:            {:8.3f} ms", vertex_ms + (setup_ms + bin_ms + buf_alloc_ms + raster_ms));
   SPDLOG_DEBUG("===============================================");
 
   return true;
 }
 
 void TileBasedDeferredRenderer::TriangleTileBinning(
-    const Model& model, const TileGridContext& grid,
+    const TileGridContext& grid,
     std::vector<std::vector<TileTriangleRef>>& tile_triangles) {
-  const size_t total_triangles = model.GetFaces().size();
-  SPDLOG_DEBUG("Starting triangle-tile binning (SoA) for {} triangles", total_triangles);
+  const uint32_t setup_count = static_cast<uint32_t>(grid.setups.Count());
+  SPDLOG_DEBUG("Starting triangle-tile binning (SoA) for {} triangles", setup_count);
   SPDLOG_DEBUG("Screen dimensions: {}x{}, Tile size: {}, Tiles: {}x{}", width_, height_, grid.tile_size, grid.tiles_x, grid.tiles_y);
 
   std::vector<size_t> tile_counts(grid.tiles_x * grid.tiles_y, 0);
-  for (size_t tri_idx = 0; tri_idx < total_triangles; ++tri_idx) {
-    ProcessTriangleForTileBinning(tri_idx, true, model, grid, tile_counts, tile_triangles);
+  for (uint32_t setup = 0; setup < setup_count; ++setup) {
+    ProcessTriangleForTileBinning(TileTriangleRef{setup}, true, grid, tile_counts, tile_triangles);
   }
   for (size_t tile_id = 0; tile_id < tile_triangles.size(); ++tile_id) {
     if (tile_counts[tile_id] > 0) tile_triangles[tile_id].reserve(tile_counts[tile_id]);
   }
-  for (size_t tri_idx = 0; tri_idx < total_triangles; ++tri_idx) {
-    ProcessTriangleForTileBinning(tri_idx, false, model, grid, tile_counts, tile_triangles);
+  for (uint32_t setup = 0; setup < setup_count; ++setup) {
+    ProcessTriangleForTileBinning(TileTriangleRef{setup}, false, grid, tile_counts, tile_triangles);
   }
 
   size_t total_refs = 0, non_empty = 0;
@@ -177,63 +195,49 @@ void TileBasedDeferredRenderer::TriangleTileBinning(
 }
 
 void TileBasedDeferredRenderer::ProcessTriangleForTileBinning(
-    size_t tri_idx, bool count_only, const Model& model, const TileGridContext& grid,
+    const TileTriangleRef& tri_ref, bool count_only, const TileGridContext& grid,
     std::vector<size_t>& tile_counts,
     std::vector<std::vector<TileTriangleRef>>& tile_triangles) {
-  const auto& f = model.GetFaces()[tri_idx];
-  size_t i0 = f.GetIndex(0), i1 = f.GetIndex(1), i2 = f.GetIndex(2);
-
-  // 视锥体裁剪（裁剪空间保守裁剪）
-  const Vector4f &c0 = grid.soa.pos_clip[i0];
-  const Vector4f &c1 = grid.soa.pos_clip[i1];
-  const Vector4f &c2 = grid.soa.pos_clip[i2];
-  bool frustum_cull =
-      (c0.x > c0.w && c1.x > c1.w && c2.x > c2.w) ||
-      (c0.x < -c0.w && c1.x < -c0.w && c2.x < -c0.w) ||
-      (c0.y > c0.w && c1.y > c1.w && c2.y > c2.w) ||
-      (c0.y < -c0.w && c1.y < -c0.w && c2.y < -c0.w) ||
-      (c0.z > c0.w && c1.z > c1.w && c2.z > c2.w) ||
-      (c0.z < -c0.w && c1.z < -c0.w && c2.z < -c0.w);
-  if (frustum_cull) return;
-
-  const Vector4f &pos0 = grid.soa.pos_screen[i0];
-  const Vector4f &pos1 = grid.soa.pos_screen[i1];
-  const Vector4f &pos2 = grid.soa.pos_screen[i2];
-
-  // 背面剔除（屏幕空间叉积）
-  Vector2f screen0(pos0.x, pos0.y), screen1(pos1.x, pos1.y), screen2(pos2.x, pos2.y);
-  Vector2f edge1 = screen1 - screen0, edge2 = screen2 - screen0;
-  float cross_product = edge1.x * edge2.y - edge1.y * edge2.x;
-  if (cross_product > 0.0f) return;
-
-  // tile 覆盖范围
-  float min_x = std::min({pos0.x, pos1.x, pos2.x});
-  float max_x = std::max({pos0.x, pos1.x, pos2.x});
-  float min_y = std::min({pos0.y, pos1.y, pos2.y});
-  float max_y = std::max({pos0.y, pos1.y, pos2.y});
-
-  int start_tile_x = std::max(0, static_cast<int>(min_x) / static_cast<int>(grid.tile_size));
-  int end_tile_x   = std::min(static_cast<int>(grid.tiles_x - 1), static_cast<int>(max_x) / static_cast<int>(grid.tile_size));
-  int start_tile_y = std::max(0, static_cast<int>(min_y) / static_cast<int>(grid.tile_size));
-  int end_tile_y   = std::min(static_cast<int>(grid.tiles_y - 1), static_cast<int>(max_y) / static_cast<int>(grid.tile_size));
+  // 视锥体外、背面与零面积三角形已在位置阶段剔除，跨越近平面/保护带的三角形已裁剪，
+  // 不覆盖任何采样点的三角形已在建立阶段剔除
+  const TriangleSetupBuffer& setups = grid.setups;
+  if (!setups.valid[tri_ref.setup]) return;
+  const TriangleSetup& setup = setups.edges[tri_ref.setup];
+
+  // tile 覆盖范围（覆盖采样点的包围盒）
+  if (setup.max_x < 0 || setup.max_y < 0) return;
+  const int tile_size = static_cast<int>(grid.tile_size);
+  int start_tile_x = std::max(0, setup.min_x) / tile_size;
+  int end_tile_x   = std::min(static_cast<int>(grid.tiles_x - 1), setup.max_x / tile_size);
+  int start_tile_y = std::max(0, setup.min_y) / tile_size;
+  int end_tile_y   = std::min(static_cast<int>(grid.tiles_y - 1), setup.max_y / tile_size);
   if (start_tile_x > end_tile_x || start_tile_y > end_tile_y) return;
 
+  // 不超过模板的标记为小三角形
+  TileTriangleRef ref = tri_ref;
+  ref.small = setup.Small();
+
+  // 分箱阶段 Hi‑Z：最近深度不小于 tile 已有最大深度时不进入该 tile
+  const float min_z = setups.z_min[tri_ref.setup];
+  const auto occluded = [&](size_t tile_id) {
+    return grid.tile_depth_max != nullptr && min_z >= grid.tile_depth_max[tile_id];
+  };
+
   if (count_only) {
     for (int ty = start_tile_y; ty <= end_tile_y; ++ty)
       for (int tx = start_tile_x; tx <= end_tile_x; ++tx)
-        tile_counts[ty * grid.tiles_x + tx]++;
+        if (!occluded(ty * grid.tiles_x + tx)) tile_counts[ty * grid.tiles_x + tx]++;
   } else {
-    TileTriangleRef tri_ref{i0, i1, i2, &f.GetMaterial(), tri_idx};
     for (int ty = start_tile_y; ty <= end_tile_y; ++ty)
       for (int tx = start_tile_x; tx <= end_tile_x; ++tx)
-        tile_triangles[ty * grid.tiles_x + tx].push_back(tri_ref);
+        if (!occluded(ty * grid.tiles_x + tx)) tile_triangles[ty * grid.tiles_x + tx].push_back(ref);
   }
 }
 
 void TileBasedDeferredRenderer::RasterizeTileDeferred(
     size_t tile_id, const std::vector<TileTriangleRef>& triangles,
     const TileGridContext& grid, float* tile_depth_buffer, uint32_t* tile_color_buffer,
-    std::unique_ptr<float[]>& global_depth_buffer, std::unique_ptr<uint32_t[]>& global_color_buffer,
+    float* global_depth_buffer, uint32_t* global_color_buffer,
     const Shader& shader, uint64_t* out_tested, uint64_t* out_covered, uint64_t* out_winners, uint64_t* out_shaded) {
   // 计算本 Tile 覆盖的屏幕区域（半开区间对齐到闭区间扫描）
   size_t tile_x = tile_id % grid.tiles_x;
@@ -246,164 +250,199 @@ void TileBasedDeferredRenderer::RasterizeTileDeferred(
   size_t tile_width = screen_x_end - screen_x_start;
   size_t tile_height = screen_y_end - screen_y_start;
 
-  // 阶段缓冲：Z 最小、胜者三角形索引、重心缓存（b0c/b1c）
+  // 阶段缓冲：Z 最小、胜者三角形索引、重心缓存（b0c/b1c/b2c）
   // - zmin：本 Tile 每像素的当前最小深度；
   // - winner：本 Tile 每像素的“胜出三角形”的局部索引（-1 表示尚未命中任何三角形）；
-  // - b0c/b1c：缓存透视矫正后的重心权重（b2c = 1 - b0c - b1c），用于阶段B避免重复计算。
+  // - b0c/b1c/b2c：缓存透视矫正后的重心权重（与逐三角形路径逐位一致，不以 1 - b0 - b1 重建），
+  //   用于阶段B避免重复计算。
   std::vector<float> zmin(tile_width * tile_height, kDepthClear);
   std::vector<int32_t> winner(tile_width * tile_height, -1);
   std::vector<float> b0c(tile_width * tile_height, 0.0f);
   std::vector<float> b1c(tile_width * tile_height, 0.0f);
+  std::vector<float> b2c(tile_width * tile_height, 0.0f);
 
   // 初始化 tile 局部 color/depth 缓冲
-  std::fill_n(tile_depth_buffer, tile_width * tile_height, kDepthClear);
-  std::fill_n(tile_color_buffer, tile_width * tile_height, kColorClear);
+  // 帧模式下从全局缓冲加载已有内容，zmin 以已有深度为起点参与决胜
+  if (IsFrameActive()) {
+    for (size_t y = 0; y < tile_height; ++y) {
+      const size_t global_row_off = (screen_y_start + y) * width_ + screen_x_start;
+      std::memcpy(tile_depth_buffer + y * tile_width, global_depth_buffer + global_row_off,
+                  tile_width * sizeof(float));
+      std::memcpy(tile_color_buffer + y * tile_width, global_color_buffer + global_row_off,
+                  tile_width * sizeof(uint32_t));
+    }
+    std::copy_n(tile_depth_buffer, tile_width * tile_height, zmin.begin());
+  } else {
+    std::fill_n(tile_depth_buffer, tile_width * tile_height, kDepthClear);
+    std::fill_n(tile_color_buffer, tile_width * tile_height, kColorClear);
+  }
 
-  constexpr int kLane = 8;
+  constexpr int kLane = kRasterBlockSize;  // 块宽
+  const RasterRowKernel raster_kernel = GetRasterRowKernel();
+  RasterRowResult lanes;
+  const VaryingMask varyings = shader.GetVaryings();
   uint64_t tested_pixels = 0, covered_pixels = 0, winner_pixels = 0, shaded_pixels = 0;
 
-  auto cross2 = [](float ax, float ay, float bx, float by) { return ax * by - ay * bx; };
+  // zmin 的分层深度（Hi‑Z），随阶段 A 的决胜逐块更新
+  TileHiZ hiz;
+  hiz.Build(zmin.data(), tile_width, tile_height);
+
+  // 决胜一行（至多 kLane 个像素）：覆盖掩码、重心、z 与决胜深度测试由 SIMD 内核完成，
+  // 存活像素压缩存放，逐个更新胜者；返回是否有像素被更新
+  const auto resolve_row = [&](const TileTriangleRef& tri, const RasterTriangle& raster_tri,
+                               const int64_t e[3], int x, int y, int lane, bool test_coverage) {
+    const size_t row_idx = static_cast<size_t>(x) - screen_x_start +
+                           (static_cast<size_t>(y) - screen_y_start) * tile_width;
+    // 用极小 epsilon 防止抖动
+    const RasterRow raster_row{{e[0], e[1], e[2]}, lane, test_coverage, zmin.data() + row_idx, 1e-8f};
+    raster_kernel(raster_tri, raster_row, lanes);
+
+    if (test_coverage) tested_pixels += static_cast<uint64_t>(lane);
+    covered_pixels += static_cast<uint64_t>(std::popcount(lanes.cover_mask));
+
+    for (uint32_t n = 0; n < lanes.count; ++n) {
+      const size_t idx = row_idx + static_cast<size_t>(lanes.lane[n]);
+      if (winner[idx] < 0) winner_pixels++;
+      zmin[idx] = lanes.z[n];
+      // 记录本 Tile 内的“局部三角形索引”，便于阶段B无需再次查找
+      winner[idx] = static_cast<int32_t>(&tri - &triangles[0]);
+      b0c[idx] = lanes.b0[n];
+      b1c[idx] = lanes.b1[n];
+      b2c[idx] = lanes.b2[n];
+    }
+    return lanes.count > 0;
+  };
 
-  // 阶段 A：Z 决胜（仅更新 zmin / winner / b0c/b1c）
-  // - 使用边函数进行半空间内点测试，行优先 + kLane 批处理，利于 cache 与自动向量化；
+  // 阶段 A：Z 决胜（仅更新 zmin / winner / b0c/b1c/b2c）
+  // - 使用定点边函数进行半空间内点测试（左上填充规则），8x8 块按四角分类后
+  //   只对部分覆盖的块逐像素测试，边函数沿 x / y 整数增量推进；
   // - 对覆盖像素进行透视矫正重心计算（先插 1/w，再还原权重），并据此插值 z；
-  // - 若 z 更小，则更新该像素的胜者信息与缓存的重心；此阶段不执行着色。
+  //   以上逐行由按 CPUID 选择的 SIMD 内核完成（raster_kernel.hpp）；
+  // - 若 z 更小，则更新该像素的胜者信息与缓存的重心；此阶段不执行着色；
+  // - 三角形最近深度不小于 tile / 块的最大 zmin 时，在边函数计算之前整体 / 整块拒绝；
+  // - 小三角形以一次模板测试代替分块遍历。
   for (const auto& tri : triangles) {
-    const size_t i0 = tri.i0, i1 = tri.i1, i2 = tri.i2;
-    const Vector4f &p0 = grid.soa.pos_screen[i0];
-    const Vector4f &p1 = grid.soa.pos_screen[i1];
-    const Vector4f &p2 = grid.soa.pos_screen[i2];
-
-    // 屏幕空间 AABB 与 tile 相交
-    const float tri_minx = std::min({p0.x, p1.x, p2.x});
-    const float tri_miny = std::min({p0.y, p1.y, p2.y});
-    const float tri_maxx = std::max({p0.x, p1.x, p2.x});
-    const float tri_maxy = std::max({p0.y, p1.y, p2.y});
-
-    int sx = std::max<int>(static_cast<int>(screen_x_start), static_cast<int>(std::floor(std::max(0.0f, tri_minx))));
-    int sy = std::max<int>(static_cast<int>(screen_y_start), static_cast<int>(std::floor(std::max(0.0f, tri_miny))));
-    int ex = std::min<int>(static_cast<int>(screen_x_end - 1), static_cast<int>(std::floor(std::min<float>(width_ - 1, tri_maxx))));
-    int ey = std::min<int>(static_cast<int>(screen_y_end - 1), static_cast<int>(std::floor(std::min<float>(height_ - 1, tri_maxy))));
+    // 建立阶段的结果（每个三角形只建立一次）
+    const TriangleSetup& setup = grid.setups.edges[tri.setup];
+    const RasterTriangle& raster_tri = grid.setups.raster[tri.setup];
+
+    // tile 级 Hi‑Z
+    const float tri_zmin = grid.setups.z_min[tri.setup];
+    if (tri_zmin >= hiz.TileMax()) continue;
+
+    // 覆盖像素的包围盒与 tile 相交
+    const int sx = std::max(static_cast<int>(screen_x_start), setup.min_x);
+    const int sy = std::max(static_cast<int>(screen_y_start), setup.min_y);
+    const int ex = std::min(static_cast<int>(screen_x_end - 1), setup.max_x);
+    const int ey = std::min(static_cast<int>(screen_y_end - 1), setup.max_y);
     if (sx > ex || sy > ey) continue;
 
-    // 边向量、面积及朝向
-    const float e01x = p1.x - p0.x, e01y = p1.y - p0.y;
-    const float e12x = p2.x - p1.x, e12y = p2.y - p1.y;
-    const float e20x = p0.x - p2.x, e20y = p0.y - p2.y;
-    // 面积 area2 = cross(p1 - p0, p2 - p0)；用于重心计算与正负朝向判别。
-    const float area2 = cross2(e01x, e01y, p2.x - p0.x, p2.y - p0.y);
-    if (std::abs(area2) < 1e-6f) continue;
-    const bool positive = (area2 > 0.0f);
-
-    // 深度与 1/w 插值准备
-    // 透视校正思路：在屏幕空间中 1/w 线性，先插值 1/w，再将各顶点属性乘以 1/w 并归一。
-    const float z0 = p0.z, z1 = p1.z, z2 = p2.z;
-    const float w0_inv = 1.0f / p0.w, w1_inv = 1.0f / p1.w, w2_inv = 1.0f / p2.w;
-
-    for (int y = sy; y <= ey; ++y) {
-      const float yf = static_cast<float>(y);
-      float E01_base = cross2(e01x, e01y, static_cast<float>(sx) - p0.x, yf - p0.y);
-      float E12_base = cross2(e12x, e12y, static_cast<float>(sx) - p1.x, yf - p1.y);
-      float E20_base = cross2(e20x, e20y, static_cast<float>(sx) - p2.x, yf - p2.y);
-      const float dE01dx = -e01y;
-      const float dE12dx = -e12y;
-      const float dE20dx = -e20y;
-
-      // 行扫描 + kLane 批处理：利于 cache 与自动向量化
-      for (int xb = sx; xb <= ex; xb += kLane) {
+    // 小三角形（分箱时标记）：一次模板测试得到全部采样点的覆盖，
+    // 不覆盖任何采样点的直接丢弃，其余只决胜有覆盖的行
+    if (tri.small) {
+      const uint32_t stamp = setup.CoverStamp(setup.min_x, setup.min_y);
+      if (stamp == 0u) continue;
+      bool written = false;
+      for (int y = sy; y <= ey; ++y) {
+        const uint32_t stamp_row = stamp >> ((y - setup.min_y) * kSmallTriangleStamp + (sx - setup.min_x));
+        if ((stamp_row & ((1u << (ex - sx + 1)) - 1u)) == 0u) continue;
+        const int64_t e[3] = {setup.Evaluate(0, sx, y), setup.Evaluate(1, sx, y), setup.Evaluate(2, sx, y)};
+        written |= resolve_row(tri, raster_tri, e, sx, y, ex - sx + 1, true);
+      }
+      // 模板至多跨 2x2 个 Hi‑Z 块
+      if (written) {
+        for (size_t hy = (static_cast<size_t>(sy) - screen_y_start) / kRasterBlockSize;
+             hy <= (static_cast<size_t>(ey) - screen_y_start) / kRasterBlockSize; ++hy)
+          for (size_t hx = (static_cast<size_t>(sx) - screen_x_start) / kRasterBlockSize;
+               hx <= (static_cast<size_t>(ex) - screen_x_start) / kRasterBlockSize; ++hx)
+            hiz.UpdateBlock(zmin.data(), hx, hy);
+        hiz.UpdateTile();
+      }
+      continue;
+    }
+
+    // 分层遍历：kRasterBlockSize x kRasterBlockSize 的块先按四角分类，
+    // 完全在外的块跳过，完全在内的块省去逐像素边函数测试；
+    // 块与 tile 内的 Hi‑Z 网格对齐，对齐引入的包围盒外像素必在三角形外
+    const int bx0 = static_cast<int>(screen_x_start) +
+                    (sx - static_cast<int>(screen_x_start)) / kRasterBlockSize * kRasterBlockSize;
+    const int by0 = static_cast<int>(screen_y_start) +
+                    (sy - static_cast<int>(screen_y_start)) / kRasterBlockSize * kRasterBlockSize;
+    int64_t block_row[3] = {setup.Evaluate(0, bx0, by0), setup.Evaluate(1, bx0, by0), setup.Evaluate(2, bx0, by0)};
+    bool hiz_dirty = false;
+    for (int yb = by0; yb <= ey; yb += kRasterBlockSize) {
+      const int block_height = std::min(kRasterBlockSize, ey - yb + 1);
+      int64_t block[3] = {block_row[0], block_row[1], block_row[2]};
+      for (int k = 0; k < 3; ++k) block_row[k] += setup.step_y[k] * kRasterBlockSize;
+
+      for (int xb = bx0; xb <= ex; xb += kLane) {
         const int lane = std::min(kLane, ex - xb + 1);
-        float E01[kLane], E12[kLane], E20[kLane];
-#pragma omp simd
-        for (int j = 0; j < lane; ++j) {
-          E01[j] = E01_base + dE01dx * static_cast<float>(xb - sx + j);
-          E12[j] = E12_base + dE12dx * static_cast<float>(xb - sx + j);
-          E20[j] = E20_base + dE20dx * static_cast<float>(xb - sx + j);
+        int64_t row[3] = {block[0], block[1], block[2]};
+        for (int k = 0; k < 3; ++k) block[k] += setup.step_x[k] * kLane;
+
+        const BlockCoverage coverage = setup.ClassifyBlock(row, lane, block_height);
+        if (coverage == BlockCoverage::kOutside) continue;
+
+        // 块级 Hi‑Z
+        const size_t hx = (static_cast<size_t>(xb) - screen_x_start) / kRasterBlockSize;
+        const size_t hy = (static_cast<size_t>(yb) - screen_y_start) / kRasterBlockSize;
+        if (tri_zmin >= hiz.BlockMax(hx, hy)) continue;
+        bool block_written = false;
+
+        for (int y = yb; y < yb + block_height; ++y) {
+          block_written |= resolve_row(tri, raster_tri, row, xb, y, lane,
+                                       coverage == BlockCoverage::kPartial);
+          for (int k = 0; k < 3; ++k) row[k] += setup.step_y[k];
         }
 
-        // 内点测试，如果三角形在像素内，则将该像素加入覆盖掩码
-        unsigned mask_cover = 0u; int cover_count = 0;
-        for (int j = 0; j < lane; ++j) {
-          bool inside = positive ? (E01[j] >= 0.0f && E12[j] >= 0.0f && E20[j] >= 0.0f)
-                                 : (E01[j] <= 0.0f && E12[j] <= 0.0f && E20[j] <= 0.0f);
-          if (inside) { mask_cover |= (1u << j); ++cover_count; }
-        }
-        tested_pixels += static_cast<uint64_t>(lane);
-        covered_pixels += static_cast<uint64_t>(cover_count);
-        if (mask_cover == 0u) continue;
-
-        for (int j = 0; j < lane; ++j) {
-          if (((mask_cover >> j) & 1u) == 0u) continue;
-          const float b0 = E12[j] / area2;
-          const float b1 = E20[j] / area2;
-          const float b2 = E01[j] / area2;
-          const float w_inv = b0 * w0_inv + b1 * w1_inv + b2 * w2_inv; // 透视校正
-          const float b0c_ = (b0 * w0_inv) / w_inv;
-          const float b1c_ = (b1 * w1_inv) / w_inv;
-          const float b2c_ = (b2 * w2_inv) / w_inv;
-          const float z = z0 * b0c_ + z1 * b1c_ + z2 * b2c_;
-
-          const int sx_pix = xb + j;
-          const int local_x = sx_pix - static_cast<int>(screen_x_start);
-          const int local_y = y - static_cast<int>(screen_y_start);
-          const size_t idx = static_cast<size_t>(local_x + local_y * static_cast<int>(tile_width));
-          // 用极小 epsilon 防止抖动
-          if (z < zmin[idx] - 1e-8f) {
-            if (winner[idx] < 0) winner_pixels++;
-            zmin[idx] = z;
-            // 记录本 Tile 内的“局部三角形索引”，便于阶段B无需再次查找
-            winner[idx] = static_cast<int32_t>(&tri - &triangles[0]);
-            b0c[idx] = b0c_;
-            b1c[idx] = b1c_;
-          }
+        if (block_written) {
+          hiz.UpdateBlock(zmin.data(), hx, hy);
+          hiz_dirty = true;
         }
       }
     }
+    if (hiz_dirty) hiz.UpdateTile();
   }
 
   // 阶段 B：仅对胜者像素着色并写入 tile 局部缓冲
-  // - 对于 winner[idx] >= 0 的像素，从 SoA 插值 normal/uv/color，构造 Fragment；
+  // - 对于 winner[idx] >= 0 的像素，从 SoA 插值着色器声明的 varyings，构造 Fragment；
+  // - 有纹理时按胜者三角形求像素所在 2x2 quad 的 uv 差分（同一 quad、同一胜者复用）；
   // - 每像素仅进行一次 FragmentShader 调用，随后写回 tile 局部 color/depth。
   for (size_t y = 0; y < tile_height; ++y) {
+    int32_t quad_win = -1;
+    size_t quad = 0;
+    Vector2f uv_dx(0.0f), uv_dy(0.0f);
     for (size_t x = 0; x < tile_width; ++x) {
       const size_t idx = x + y * tile_width;
       int32_t win = winner[idx];
       if (win < 0) continue;
 
       const auto& tri = triangles[static_cast<size_t>(win)];
-      const size_t i0 = tri.i0, i1 = tri.i1, i2 = tri.i2;
+      const TriangleSource& source = grid.setups.sources[tri.setup];
+      const size_t i0 = source.i0, i1 = source.i1, i2 = source.i2;
       const float b0c_ = b0c[idx];
       const float b1c_ = b1c[idx];
-      const float b2c_ = 1.0f - b0c_ - b1c_;
+      const float b2c_ = b2c[idx];
 
       Fragment frag;
       frag.screen_coord = {static_cast<int32_t>(screen_x_start + x), static_cast<int32_t>(screen_y_start + y)};
       frag.depth = zmin[idx];
-      frag.material = tri.material;
-
-      // 插值属性
-      const Vector3f &n0 = grid.soa.normal[i0];
-      const Vector3f &n1 = grid.soa.normal[i1];
-      const Vector3f &n2 = grid.soa.normal[i2];
-      frag.normal = n0 * b0c_ + n1 * b1c_ + n2 * b2c_;
-
-      const Vector2f &uv0 = grid.soa.uv[i0];
-      const Vector2f &uv1 = grid.soa.uv[i1];
-      const Vector2f &uv2 = grid.soa.uv[i2];
-      frag.uv = uv0 * b0c_ + uv1 * b1c_ + uv2 * b2c_;
-
-      const Color &c0 = grid.soa.color[i0];
-      const Color &c1 = grid.soa.color[i1];
-      const Color &c2 = grid.soa.color[i2];
-      auto color_r = FloatToUint8_t(static_cast<float>(c0[Color::kColorIndexRed]) * b0c_ +
-                                    static_cast<float>(c1[Color::kColorIndexRed]) * b1c_ +
-                                    static_cast<float>(c2[Color::kColorIndexRed]) * b2c_);
-      auto color_g = FloatToUint8_t(static_cast<float>(c0[Color::kColorIndexGreen]) * b0c_ +
-                                    static_cast<float>(c1[Color::kColorIndexGreen]) * b1c_ +
-                                    static_cast<float>(c2[Color::kColorIndexGreen]) * b2c_);
-      auto color_b = FloatToUint8_t(static_cast<float>(c0[Color::kColorIndexBlue]) * b0c_ +
-                                    static_cast<float>(c1[Color::kColorIndexBlue]) * b1c_ +
-                                    static_cast<float>(c2[Color::kColorIndexBlue]) * b2c_);
-      frag.color = Color(color_r, color_g, color_b);
+      frag.material = source.material;
+
+      // 只插值着色器声明的 varyings
+      InterpolateVaryings(grid.soa, i0, i1, i2, b0c_, b1c_, b2c_, varyings, frag);
+      if ((varyings & kVaryingTexCoords) != 0 && source.material->HasTexture()) {
+        const size_t px = screen_x_start + x;
+        if (win != quad_win || (px >> 1) != quad) {
+          quad_win = win;
+          quad = px >> 1;
+          const Vector2f uvs[3] = {grid.soa.uv[i0], grid.soa.uv[i1], grid.soa.uv[i2]};
+          QuadDerivatives(grid.setups.edges[tri.setup], grid.setups.raster[tri.setup], uvs,
+                          static_cast<int32_t>(px), frag.screen_coord[1], uv_dx, uv_dy);
+        }
+        frag.uv_dx = uv_dx;
+        frag.uv_dy = uv_dy;
+      }
 
       auto out_color = shader.FragmentShader(frag);
       tile_depth_buffer[idx] = frag.depth;
@@ -418,10 +457,10 @@ void TileBasedDeferredRenderer::RasterizeTileDeferred(
     const size_t tile_row_off = y * tile_width;
     const size_t global_row_off = (screen_y_start + y) * width_ + screen_x_start;
     // 将局部 tile 的 color/depth 复制到全局 framebuffer 中对应位置。
-    std::memcpy(global_color_buffer.get() + global_row_off,
+    std::memcpy(global_color_buffer + global_row_off,
                 tile_color_buffer + tile_row_off,
                 tile_width * sizeof(uint32_t));
-    std::memcpy(global_depth_buffer.get() + global_row_off,
+    std::memcpy(global_depth_buffer + global_row_off,
                 tile_depth_buffer + tile_row_off,
                 tile_width * sizeof(float));
   }
@@ -432,4 +471,196 @@ void TileBasedDeferredRenderer::RasterizeTileDeferred(
   if (out_shaded) *out_shaded = shaded_pixels;
 }
 
+void TileBasedDeferredRenderer::RasterizeTileDeferredMsaa(
+    size_t tile_id, const std::vector<TileTriangleRef>& triangles,
+    const TileGridContext& grid, float* tile_depth_buffer, uint32_t* tile_color_buffer,
+    const MsaaTileScratch& scratch, float* global_depth_buffer, uint32_t* global_color_buffer,
+    const FrameSampleBuffers& frame_samples, const Shader& shader,
+    uint64_t* out_tested, uint64_t* out_covered, uint64_t* out_winners, uint64_t* out_shaded) {
+  size_t tile_x = tile_id % grid.tiles_x;
+  size_t tile_y = tile_id / grid.tiles_x;
+  size_t screen_x_start = tile_x * grid.tile_size;
+  size_t screen_y_start = tile_y * grid.tile_size;
+  size_t screen_x_end = std::min(screen_x_start + grid.tile_size, width_);
+  size_t screen_y_end = std::min(screen_y_start + grid.tile_size, height_);
+  size_t tile_width = screen_x_end - screen_x_start;
+  size_t tile_height = screen_y_end - screen_y_start;
+
+  // 样本平面：第 s 个样本位于 tile_*_buffer / zmin / winner 的 s * plane 处
+  const MsaaPattern pattern = GetMsaaPattern(msaa_samples_);
+  const uint32_t samples = pattern.samples;
+  const size_t plane = tile_width * tile_height;
+  if (frame_samples.depth != nullptr) {
+    LoadTileSamples(frame_samples, width_, screen_x_start, screen_y_start, tile_width, tile_height,
+                    samples, tile_depth_buffer, tile_color_buffer);
+  } else {
+    std::fill_n(tile_depth_buffer, plane * samples, kDepthClear);
+    std::fill_n(tile_color_buffer, plane * samples, kColorClear);
+  }
+  float* zmin = scratch.zmin.get();
+  int32_t* winner = scratch.winner.get();
+  std::copy_n(tile_depth_buffer, plane * samples, zmin);
+  std::fill_n(winner, plane * samples, -1);
+
+  // 每像素样本 zmin 的最大值，作为 Hi‑Z 的输入
+  float* pixel_zmax = scratch.pixel_zmax.get();
+  std::copy_n(zmin, plane, pixel_zmax);
+  for (uint32_t s = 1; s < samples; ++s)
+    for (size_t i = 0; i < plane; ++i) pixel_zmax[i] = std::max(pixel_zmax[i], zmin[s * plane + i]);
+  TileHiZ hiz;
+  hiz.Build(pixel_zmax, tile_width, tile_height);
+
+  constexpr int kLane = kRasterBlockSize;
+  const RasterRowKernel raster_kernel = GetRasterRowKernel();
+  RasterRowResult lanes;
+  const VaryingMask varyings = shader.GetVaryings();
+  uint64_t tested_pixels = 0, covered_pixels = 0, winner_pixels = 0, shaded_pixels = 0;
+
+  // 决胜一行：逐样本调用内核（样本处边函数 = 像素处 + 偏移），更新样本的 zmin 与胜者；
+  // 返回是否有样本被更新
+  const auto resolve_row = [&](const TileTriangleRef& tri, const RasterTriangle& raster_tri,
+                               const int64_t offsets[kMaxMsaaSamples][3],
+                               const int64_t e[3], int x, int y, int lane, bool test_coverage) {
+    const size_t row_idx = static_cast<size_t>(x) - screen_x_start +
+                           (static_cast<size_t>(y) - screen_y_start) * tile_width;
+    uint32_t cover_any = 0u, written = 0u;
+    for (uint32_t s = 0; s < samples; ++s) {
+      const RasterRow raster_row{{e[0] + offsets[s][0], e[1] + offsets[s][1], e[2] + offsets[s][2]},
+                                 lane, test_coverage, zmin + s * plane + row_idx, 1e-8f};
+      raster_kernel(raster_tri, raster_row, lanes);
+      cover_any |= lanes.cover_mask;
+      for (uint32_t n = 0; n < lanes.count; ++n) {
+        const size_t idx = s * plane + row_idx + static_cast<size_t>(lanes.lane[n]);
+        zmin[idx] = lanes.z[n];
+        winner[idx] = static_cast<int32_t>(&tri - &triangles[0]);
+        written |= 1u << lanes.lane[n];
+      }
+    }
+    if (test_coverage) tested_pixels += static_cast<uint64_t>(lane);
+    covered_pixels += static_cast<uint64_t>(std::popcount(cover_any));
+
+    for (uint32_t bits = written; bits != 0u; bits &= bits - 1u) {
+      const size_t idx = row_idx + static_cast<size_t>(std::countr_zero(bits));
+      float zmax = zmin[idx];
+      for (uint32_t s = 1; s < samples; ++s) zmax = std::max(zmax, zmin[s * plane + idx]);
+      pixel_zmax[idx] = zmax;
+    }
+    return written != 0u;
+  };
+
+  // 阶段 A：逐样本 Z 决胜
+  // - 分层遍历同单样本路径，块按外扩一个像素分类（样本在像素采样点半个像素以内）；
+  // - 块级 Hi‑Z 只做拒绝；小三角形不走模板路径（模板只测试像素采样点）。
+  for (const auto& tri : triangles) {
+    const TriangleSetup& setup = grid.setups.edges[tri.setup];
+    const RasterTriangle& raster_tri = grid.setups.raster[tri.setup];
+
+    const float tri_zmin = grid.setups.z_min[tri.setup];
+    if (tri_zmin >= hiz.TileMax()) continue;
+
+    const int sx = std::max(static_cast<int>(screen_x_start), setup.min_x);
+    const int sy = std::max(static_cast<int>(screen_y_start), setup.min_y);
+    const int ex = std::min(static_cast<int>(screen_x_end - 1), setup.max_x);
+    const int ey = std::min(static_cast<int>(screen_y_end - 1), setup.max_y);
+    if (sx > ex || sy > ey) continue;
+
+    int64_t offsets[kMaxMsaaSamples][3];
+    SampleEdgeOffsets(setup, pattern, offsets);
+
+    const int bx0 = static_cast<int>(screen_x_start) +
+                    (sx - static_cast<int>(screen_x_start)) / kRasterBlockSize * kRasterBlockSize;
+    const int by0 = static_cast<int>(screen_y_start) +
+                    (sy - static_cast<int>(screen_y_start)) / kRasterBlockSize * kRasterBlockSize;
+    int64_t block_row[3] = {setup.Evaluate(0, bx0, by0), setup.Evaluate(1, bx0, by0), setup.Evaluate(2, bx0, by0)};
+    bool hiz_dirty = false;
+    for (int yb = by0; yb <= ey; yb += kRasterBlockSize) {
+      const int block_height = std::min(kRasterBlockSize, ey - yb + 1);
+      int64_t block[3] = {block_row[0], block_row[1], block_row[2]};
+      for (int k = 0; k < 3; ++k) block_row[k] += setup.step_y[k] * kRasterBlockSize;
+
+      for (int xb = bx0; xb <= ex; xb += kLane) {
+        const int lane = std::min(kLane, ex - xb + 1);
+        int64_t row[3] = {block[0], block[1], block[2]};
+        for (int k = 0; k < 3; ++k) block[k] += setup.step_x[k] * kLane;
+
+        const int64_t outer[3] = {row[0] - setup.step_x[0] - setup.step_y[0],
+                                  row[1] - setup.step_x[1] - setup.step_y[1],
+                                  row[2] - setup.step_x[2] - setup.step_y[2]};
+        const BlockCoverage coverage = setup.ClassifyBlock(outer, lane + 2, block_height + 2);
+        if (coverage == BlockCoverage::kOutside) continue;
+
+        const size_t hx = (static_cast<size_t>(xb) - screen_x_start) / kRasterBlockSize;
+        const size_t hy = (static_cast<size_t>(yb) - screen_y_start) / kRasterBlockSize;
+        if (tri_zmin >= hiz.BlockMax(hx, hy)) continue;
+        bool block_written = false;
+
+        for (int y = yb; y < yb + block_height; ++y) {
+          block_written |= resolve_row(tri, raster_tri, offsets, row, xb, y, lane,
+                                       coverage == BlockCoverage::kPartial);
+          for (int k = 0; k < 3; ++k) row[k] += setup.step_y[k];
+        }
+
+        if (block_written) {
+          hiz.UpdateBlock(pixel_zmax, hx, hy);
+          hiz_dirty = true;
+        }
+      }
+    }
+    if (hiz_dirty) hiz.UpdateTile();
+  }
+
+  // 阶段 B：每个像素对其样本的每个不同胜者三角形在像素采样点着色一次，
+  // 颜色写入该三角形胜出的样本；没有胜者的样本保留加载/清除的颜色
+  for (size_t y = 0; y < tile_height; ++y) {
+    for (size_t x = 0; x < tile_width; ++x) {
+      const size_t idx = x + y * tile_width;
+      const int32_t px = static_cast<int32_t>(screen_x_start + x);
+      const int32_t py = static_cast<int32_t>(screen_y_start + y);
+      int32_t shaded_win[kMaxMsaaSamples];
+      uint32_t shaded_color[kMaxMsaaSamples];
+      uint32_t shaded_count = 0;
+      for (uint32_t s = 0; s < samples; ++s) {
+        const int32_t win = winner[s * plane + idx];
+        if (win < 0) continue;
+        uint32_t n = 0;
+        while (n < shaded_count && shaded_win[n] != win) ++n;
+        if (n == shaded_count) {
+          const auto& tri = triangles[static_cast<size_t>(win)];
+          const TriangleSetup& setup = grid.setups.edges[tri.setup];
+          const RasterTriangle& raster_tri = grid.setups.raster[tri.setup];
+          const TriangleSource& source = grid.setups.sources[tri.setup];
+          const int64_t center[3] = {setup.Evaluate(0, px, py), setup.Evaluate(1, px, py),
+                                     setup.Evaluate(2, px, py)};
+          float b[3];
+          Fragment frag;
+          frag.screen_coord = {px, py};
+          frag.material = source.material;
+          raster_tri.Interpolate(center, b, frag.depth);
+          InterpolateVaryings(grid.soa, source.i0, source.i1, source.i2, b[0], b[1], b[2], varyings, frag);
+          if ((varyings & kVaryingTexCoords) != 0 && source.material->HasTexture()) {
+            const Vector2f uvs[3] = {grid.soa.uv[source.i0], grid.soa.uv[source.i1], grid.soa.uv[source.i2]};
+            QuadDerivatives(setup, raster_tri, uvs, px, py, frag.uv_dx, frag.uv_dy);
+          }
+          shaded_win[n] = win;
+          shaded_color[n] = uint32_t(shader.FragmentShader(frag));
+          ++shaded_count;
+          shaded_pixels++;
+        }
+        tile_color_buffer[s * plane + idx] = shaded_color[n];
+        tile_depth_buffer[s * plane + idx] = zmin[s * plane + idx];
+      }
+      if (shaded_count > 0) winner_pixels++;
+    }
+  }
+
+  ResolveTileSamples(tile_depth_buffer, tile_color_buffer, tile_width, tile_height, samples, width_,
+                     screen_x_start, screen_y_start, global_depth_buffer, global_color_buffer,
+                     frame_samples);
+
+  if (out_tested) *out_tested = tested_pixels;
+  if (out_covered) *out_covered = covered_pixels;
+  if (out_winners) *out_winners = winner_pixels;
+  if (out_shaded) *out_shaded = shaded_pixels;
+}
+
 }  // namespace simple_renderer
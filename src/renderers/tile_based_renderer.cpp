@@ -3,41 +3,204 @@
 #include <omp.h>
 
 #include <algorithm>
+#include <array>
+#include <bit>
 #include <chrono>
 #include <cstring>
 #include <limits>
 #include <cmath>
 
 #include "config.h"
+#include "edge_function.hpp"
 #include "log_system.h"
+#include "msaa.hpp"
+#include "raster_kernel.hpp"
 
 namespace simple_renderer {
 
+void TileHiZ::Build(const float *depth, size_t width, size_t height,
+                    size_t stride) {
+  width_ = width;
+  height_ = height;
+  stride_ = stride != 0 ? stride : width;
+  blocks_x_ = (width + kRasterBlockSize - 1) / kRasterBlockSize;
+  blocks_y_ = (height + kRasterBlockSize - 1) / kRasterBlockSize;
+  block_min_.assign(blocks_x_ * blocks_y_, 0.0f);
+  block_max_.assign(blocks_x_ * blocks_y_, 0.0f);
+  for (size_t by = 0; by < blocks_y_; ++by) {
+    for (size_t bx = 0; bx < blocks_x_; ++bx) {
+      UpdateBlock(depth, bx, by);
+    }
+  }
+  UpdateTile();
+}
+
+void TileHiZ::UpdateBlock(const float *depth, size_t block_x,
+                          size_t block_y) {
+  const size_t x0 = block_x * kRasterBlockSize;
+  const size_t y0 = block_y * kRasterBlockSize;
+  const size_t x1 = std::min(x0 + kRasterBlockSize, width_);
+  const size_t y1 = std::min(y0 + kRasterBlockSize, height_);
+  float zmin = std::numeric_limits<float>::infinity();
+  float zmax = -std::numeric_limits<float>::infinity();
+  for (size_t y = y0; y < y1; ++y) {
+    const float *row = depth + y * stride_;
+#pragma omp simd reduction(min : zmin) reduction(max : zmax)
+    for (size_t x = x0; x < x1; ++x) {
+      zmin = std::min(zmin, row[x]);
+      zmax = std::max(zmax, row[x]);
+    }
+  }
+  block_min_[block_x + block_y * blocks_x_] = zmin;
+  block_max_[block_x + block_y * blocks_x_] = zmax;
+}
+
+void TileHiZ::UpdateTile() {
+  tile_max_ = *std::max_element(block_max_.begin(), block_max_.end());
+}
+
+std::vector<float> ComputeTileDepthMax(const float *depth, size_t width,
+                                       size_t height,
+                                       const TileGridContext &grid) {
+  std::vector<float> tile_max(grid.tiles_x * grid.tiles_y);
+#pragma omp parallel for num_threads(kNProc) schedule(static)
+  for (size_t tile_id = 0; tile_id < tile_max.size(); ++tile_id) {
+    const size_t x0 = (tile_id % grid.tiles_x) * grid.tile_size;
+    const size_t y0 = (tile_id / grid.tiles_x) * grid.tile_size;
+    const size_t x1 = std::min(x0 + grid.tile_size, width);
+    const size_t y1 = std::min(y0 + grid.tile_size, height);
+    float zmax = -std::numeric_limits<float>::infinity();
+    for (size_t y = y0; y < y1; ++y) {
+      const float *row = depth + y * width;
+#pragma omp simd reduction(max : zmax)
+      for (size_t x = x0; x < x1; ++x) {
+        zmax = std::max(zmax, row[x]);
+      }
+    }
+    tile_max[tile_id] = zmax;
+  }
+  return tile_max;
+}
+
+void LoadTileSamples(const FrameSampleBuffers &frame, size_t width, size_t x0,
+                     size_t y0, size_t tile_width, size_t tile_height,
+                     uint32_t samples, float *sample_depth,
+                     uint32_t *sample_color) {
+  const size_t plane = tile_width * tile_height;
+  for (uint32_t s = 0; s < samples; ++s) {
+    for (size_t y = 0; y < tile_height; ++y) {
+      const size_t global_off = s * frame.plane + (y0 + y) * width + x0;
+      std::memcpy(sample_depth + s * plane + y * tile_width,
+                  frame.depth + global_off, tile_width * sizeof(float));
+      std::memcpy(sample_color + s * plane + y * tile_width,
+                  frame.color + global_off, tile_width * sizeof(uint32_t));
+    }
+  }
+}
+
+void ResolveTileSamples(const float *sample_depth, const uint32_t *sample_color,
+                        size_t tile_width, size_t tile_height,
+                        uint32_t samples, size_t width, size_t x0, size_t y0,
+                        float *depth, uint32_t *color,
+                        const FrameSampleBuffers &frame) {
+  const size_t plane = tile_width * tile_height;
+  for (size_t y = 0; y < tile_height; ++y) {
+    const size_t global_row_off = (y0 + y) * width + x0;
+    for (size_t x = 0; x < tile_width; ++x) {
+      const size_t idx = x + y * tile_width;
+      float zmax = sample_depth[idx];
+      for (uint32_t s = 1; s < samples; ++s) {
+        zmax = std::max(zmax, sample_depth[s * plane + idx]);
+      }
+      depth[global_row_off + x] = zmax;
+      color[global_row_off + x] =
+          ResolveSamples(sample_color + idx, plane, samples);
+    }
+  }
+  if (frame.depth == nullptr) {
+    return;
+  }
+  for (uint32_t s = 0; s < samples; ++s) {
+    for (size_t y = 0; y < tile_height; ++y) {
+      const size_t global_off = s * frame.plane + (y0 + y) * width + x0;
+      std::memcpy(frame.depth + global_off,
+                  sample_depth + s * plane + y * tile_width,
+                  tile_width * sizeof(float));
+      std::memcpy(frame.color + global_off,
+                  sample_color + s * plane + y * tile_width,
+                  tile_width * sizeof(uint32_t));
+    }
+  }
+}
+
+void TriangleSetupBuffer::Build(const Model &model,
+                                const VisibleRanges &visible,
+                                const VertexSoA &soa, uint32_t msaa_samples) {
+  const auto &faces = model.GetFaces();
+  const size_t face_triangles = visible.triangles.size();
+  const size_t count = face_triangles + visible.clipped.size();
+  edges.resize(count);
+  raster.resize(count);
+  z_min.resize(count);
+  z_max.resize(count);
+  valid.assign(count, 0);
+  sources.resize(count);
+
+#pragma omp parallel for num_threads(kNProc) schedule(static)
+  for (size_t n = 0; n < count; ++n) {
+    TriangleSource &source = sources[n];
+    if (n < face_triangles) {
+      const uint32_t face_index = visible.triangles[n];
+      const auto &f = faces[face_index];
+      source = {static_cast<uint32_t>(f.GetIndex(0)),
+                static_cast<uint32_t>(f.GetIndex(1)),
+                static_cast<uint32_t>(f.GetIndex(2)), &f.GetMaterial(),
+                face_index};
+    } else {
+      const auto &tri = visible.clipped[n - face_triangles];
+      source = {static_cast<uint32_t>(tri.indices[0]),
+                static_cast<uint32_t>(tri.indices[1]),
+                static_cast<uint32_t>(tri.indices[2]),
+                &faces[tri.face].GetMaterial(),
+                static_cast<uint32_t>(tri.face)};
+    }
+    const Vector4f &p0 = soa.pos_screen[source.i0];
+    const Vector4f &p1 = soa.pos_screen[source.i1];
+    const Vector4f &p2 = soa.pos_screen[source.i2];
+
+    // 定点面积为 0 或包围盒内没有采样点的三角形不覆盖任何像素
+    TriangleSetup &setup = edges[n];
+    if (!setup.Setup(p0, p1, p2)) continue;
+    if (msaa_samples > 1) {
+      // 样本距像素采样点不足半个像素
+      setup.min_x -= 1;
+      setup.min_y -= 1;
+      setup.max_x += 1;
+      setup.max_y += 1;
+    }
+    if (setup.Empty()) continue;
+    raster[n] = MakeRasterTriangle(setup, p0, p1, p2);
+    z_min[n] = std::min({p0.z, p1.z, p2.z});
+    z_max[n] = std::max({p0.z, p1.z, p2.z});
+    valid[n] = 1;
+  }
+}
+
 bool TileBasedRenderer::Render(const Model &model, const Shader &shader_in,
                                uint32_t *buffer) {
   auto total_start_time = std::chrono::high_resolution_clock::now();
   auto shader = std::make_shared<Shader>(shader_in);
   shader->PrepareUniformCaches();
 
-  // 顶点变换（SoA）
+  // 实例 BVH + meshlet 剔除：只有可见簇进入顶点阶段与 binning
+  VisibleRanges visible = CollectVisibleRanges(model, *shader);
+
+  // 顶点阶段（SoA）分两遍：仅位置 + 逐三角形剔除，再只为存活三角形的顶点计算属性
   auto vertex_start = std::chrono::high_resolution_clock::now();
-  const auto &input_vertices = model.GetVertices();
   VertexSoA soa;
-  soa.resize(input_vertices.size());
-
-#pragma omp parallel for num_threads(kNProc) schedule(static) \
-    shared(shader, soa, input_vertices)
-  for (size_t i = 0; i < input_vertices.size(); ++i) {
-    const auto &v = input_vertices[i];
-    auto clipSpaceVertex = shader->VertexShader(v);
-    soa.pos_clip[i] = clipSpaceVertex.GetPosition();
-    auto ndcVertex = PerspectiveDivision(clipSpaceVertex);
-    auto screenSpaceVertex = ViewportTransformation(ndcVertex);
-    soa.pos_screen[i] = screenSpaceVertex.GetPosition();
-    soa.normal[i] = screenSpaceVertex.GetNormal();
-    soa.uv[i] = screenSpaceVertex.GetTexCoords();
-    soa.color[i] = screenSpaceVertex.GetColor();
-  }
+  ProcessPositions(model, *shader, visible, soa);
+  ProcessAttributes(model, *shader, visible, soa);
+  ClipTriangles(model, visible, soa);
   auto vertex_end = std::chrono::high_resolution_clock::now();
   auto vertex_ms = std::chrono::duration_cast<std::chrono::microseconds>(
                        vertex_end - vertex_start)
@@ -53,6 +216,10 @@ bool TileBasedRenderer::Render(const Model &model, const Shader &shader_in,
 
   // 为每个tile创建三角形列表（SoA 引用）
   std::vector<std::vector<TileTriangleRef>> tile_triangles(total_tiles);
+
+  // 三角形建立：每个三角形只建立一次，分箱与各 tile 的光栅化共享
+  TriangleSetupBuffer setups;
+  setups.Build(model, visible, soa, msaa_samples_);
   auto setup_end = std::chrono::high_resolution_clock::now();
   auto setup_ms = std::chrono::duration_cast<std::chrono::microseconds>(
                       setup_end - setup_start)
@@ -61,8 +228,15 @@ bool TileBasedRenderer::Render(const Model &model, const Shader &shader_in,
 
   // 2. Binning
   auto binning_start = std::chrono::high_resolution_clock::now();
-  TileGridContext grid_ctx{soa, tiles_x, tiles_y, TILE_SIZE};
-  TriangleTileBinning(model, grid_ctx, tile_triangles);
+  TileGridContext grid_ctx{soa, setups, tiles_x, tiles_y, TILE_SIZE};
+  // 帧模式下深度缓冲保留此前绘制的结果：按 tile 最大深度在分箱时拒绝被遮挡的三角形
+  std::vector<float> tile_depth_max;
+  if (early_z_ && IsFrameActive()) {
+    tile_depth_max = ComputeTileDepthMax(AcquireDepthBuffer(kDepthClear),
+                                         width_, height_, grid_ctx);
+    grid_ctx.tile_depth_max = tile_depth_max.data();
+  }
+  TriangleTileBinning(grid_ctx, tile_triangles);
   auto binning_end = std::chrono::high_resolution_clock::now();
   auto binning_ms = std::chrono::duration_cast<std::chrono::microseconds>(
                         binning_end - binning_start)
@@ -71,16 +245,15 @@ bool TileBasedRenderer::Render(const Model &model, const Shader &shader_in,
 
   // 3. 单份全局 framebuffer
   // 直接让每个 tile 写入这份全局缓冲区，避免末端 O(W*H*kNProc) 合并开销
-
+  // 深度来自帧深度缓冲（帧模式）或内部缓冲（独立绘制，已清除）；
+  // 颜色直接写入输出缓冲，tile 回写覆盖其全部区域。
   auto buffer_alloc_start = std::chrono::high_resolution_clock::now();
-  std::unique_ptr<float[]> depthBuffer =
-      std::make_unique<float[]>(width_ * height_);
-  std::unique_ptr<uint32_t[]> colorBuffer =
-      std::make_unique<uint32_t[]>(width_ * height_);
-
-  // 深度初始化为最远值，颜色清零
-  std::fill_n(depthBuffer.get(), width_ * height_, kDepthClear);
-  std::fill_n(colorBuffer.get(), width_ * height_, kColorClear);
+  float *depthBuffer = AcquireDepthBuffer(kDepthClear);
+  uint32_t *colorBuffer = buffer;
+  // 帧模式 MSAA：样本在绘制之间保留，深度/颜色缓冲只保存解析结果
+  const FrameSampleBuffers frame_samples =
+      msaa_samples_ > 1 ? AcquireFrameSamples(msaa_samples_, buffer)
+                        : FrameSampleBuffers{};
   auto buffer_alloc_end = std::chrono::high_resolution_clock::now();
   auto buffer_alloc_ms = std::chrono::duration_cast<std::chrono::microseconds>(
                              buffer_alloc_end - buffer_alloc_start)
@@ -90,24 +263,41 @@ bool TileBasedRenderer::Render(const Model &model, const Shader &shader_in,
   // 4. 并行光栅化每个 tile（SoA + early-z）
   auto raster_start = std::chrono::high_resolution_clock::now();
   std::vector<TileMaskStats> tile_stats(total_tiles);
+  const RasterizeTileFn rasterize_tile = SelectRasterizeTile(TILE_SIZE);
 #pragma omp parallel num_threads(kNProc) default(none)                        \
     shared(tile_triangles, shader, depthBuffer, colorBuffer, total_tiles,     \
-               grid_ctx, early_z_, tile_stats)
+               grid_ctx, early_z_, msaa_samples_, tile_stats, rasterize_tile, \
+               frame_samples)
   {
-    // 为每个 tile 分配局部深度和颜色缓冲
+    // 为每个 tile 分配局部深度和颜色缓冲（MSAA 时每个样本一个平面）
+    const size_t tile_samples =
+        grid_ctx.tile_size * grid_ctx.tile_size * msaa_samples_;
     std::unique_ptr<float[]> tile_depth_buffer =
-        std::make_unique<float[]>(grid_ctx.tile_size * grid_ctx.tile_size);
+        std::make_unique<float[]>(tile_samples);
     std::unique_ptr<uint32_t[]> tile_color_buffer =
-        std::make_unique<uint32_t[]>(grid_ctx.tile_size * grid_ctx.tile_size);
+        std::make_unique<uint32_t[]>(tile_samples);
+    // MSAA 时每像素样本深度最大值（Hi‑Z 输入），同样按线程复用
+    std::unique_ptr<float[]> tile_pixel_depth_max =
+        msaa_samples_ > 1
+            ? std::make_unique<float[]>(grid_ctx.tile_size * grid_ctx.tile_size)
+            : nullptr;
 
 #pragma omp for schedule(static)
     for (size_t tile_id = 0; tile_id < total_tiles; ++tile_id) {
       // 按照 tile 进行光栅化（SoA）
       // 直接写入单份全局 framebuffer；不同 tile 不重叠，无需加锁
-      RasterizeTile(tile_id, tile_triangles[tile_id], grid_ctx,
-                    tile_depth_buffer.get(), tile_color_buffer.get(),
-                    depthBuffer, colorBuffer, *shader, early_z_,
-                    &tile_stats[tile_id]);
+      if (msaa_samples_ > 1) {
+        RasterizeTileMsaa(tile_id, tile_triangles[tile_id], grid_ctx,
+                          tile_depth_buffer.get(), tile_color_buffer.get(),
+                          tile_pixel_depth_max.get(), depthBuffer, colorBuffer,
+                          frame_samples, *shader,
+                          early_z_, &tile_stats[tile_id]);
+      } else {
+        (this->*rasterize_tile)(tile_id, tile_triangles[tile_id], grid_ctx,
+                                tile_depth_buffer.get(), tile_color_buffer.get(),
+                                depthBuffer, colorBuffer, *shader, early_z_,
+                                &tile_stats[tile_id]);
+      }
     }
   }
   auto raster_end = std::chrono::high_resolution_clock::now();
@@ -118,11 +308,15 @@ bool TileBasedRenderer::Render(const Model &model, const Shader &shader_in,
 
   // 汇总并打印掩码收益统计
   uint64_t sum_tested = 0, sum_covered = 0, sum_zpass = 0, sum_shaded = 0;
+  uint64_t sum_hiz_triangles = 0, sum_hiz_blocks = 0, sum_small_triangles = 0;
   for (const auto& s : tile_stats) {
     sum_tested += s.tested;
     sum_covered += s.covered;
     sum_zpass   += s.zpass;
     sum_shaded  += s.shaded;
+    sum_hiz_triangles += s.hiz_triangles;
+    sum_hiz_blocks += s.hiz_blocks;
+    sum_small_triangles += s.small_triangles;
   }
   auto rate = [](uint64_t num, uint64_t den) -> double {
     return (den == 0)?0.0:double(num) / double(den) * 100.0;
@@ -132,15 +326,11 @@ bool TileBasedRenderer::Render(const Model &model, const Shader &shader_in,
       sum_tested, sum_covered, rate(sum_covered, sum_tested),
       sum_zpass, rate(sum_zpass, sum_covered),
       sum_shaded, rate(sum_shaded, sum_covered));
-
-  // 5. 直接将单份全局 colorBuffer 拷贝到输出
-  auto present_start = std::chrono::high_resolution_clock::now();
-  std::memcpy(buffer, colorBuffer.get(), width_ * height_ * sizeof(uint32_t));
-  auto present_end = std::chrono::high_resolution_clock::now();
-  auto present_ms = std::chrono::duration_cast<std::chrono::microseconds>(
-                        present_end - present_start)
-                        .count() /
-                    1000.0;
+  SPDLOG_DEBUG("TBR Hi-Z: rejected triangles={}, rejected blocks={}",
+               sum_hiz_triangles, sum_hiz_blocks);
+  SPDLOG_DEBUG("TBR small triangles: {}", sum_small_triangles);
+  // 着色写回的像素均已通过深度测试（early-z 或 late-z）
+  samples_passed_ = sum_shaded;
 
   auto total_end_time = std::chrono::high_resolution_clock::now();
   double total_ms = std::chrono::duration_cast<std::chrono::microseconds>(
@@ -156,31 +346,28 @@ bool TileBasedRenderer::Render(const Model &model, const Shader &shader_in,
   SPDLOG_DEBUG("Binning:          {:8.3f} ms", binning_ms);
   SPDLOG_DEBUG("Buffer Alloc:     {:8.3f} ms", buffer_alloc_ms);
   SPDLOG_DEBUG("Rasterization:    {:8.3f} ms", raster_ms);
-  SPDLOG_DEBUG("Copy:             {:8.3f} ms", present_ms);
   SPDLOG_DEBUG("Total:            {:8.3f} ms",
-              vertex_ms + (setup_ms + binning_ms + buffer_alloc_ms + raster_ms +
-                          present_ms));
+              vertex_ms + (setup_ms + binning_ms + buffer_alloc_ms + raster_ms));
   SPDLOG_DEBUG("==========================================");
 
   return true;
 }
 
 void TileBasedRenderer::TriangleTileBinning(
-    const Model& model,
     const TileGridContext& grid,
     std::vector<std::vector<TileTriangleRef>> &tile_triangles) {
-  const size_t total_triangles = model.GetFaces().size();
+  const uint32_t setup_count = static_cast<uint32_t>(grid.setups.Count());
 
   SPDLOG_DEBUG("Starting triangle-tile binning (SoA) for {} triangles",
-              total_triangles);
+              setup_count);
   SPDLOG_DEBUG("Screen dimensions: {}x{}, Tile size: {}, Tiles: {}x{}", width_,
               height_, grid.tile_size, grid.tiles_x, grid.tiles_y);
 
   std::vector<size_t> tile_counts(grid.tiles_x * grid.tiles_y, 0);
 
   // 第一遍（count only）：计算每个tile需要容纳多少三角形
-  for (size_t tri_idx = 0; tri_idx < total_triangles; ++tri_idx) {
-    ProcessTriangleForTileBinning(tri_idx, true, model, grid,
+  for (uint32_t setup = 0; setup < setup_count; ++setup) {
+    ProcessTriangleForTileBinning(TileTriangleRef{setup}, true, grid,
                                   tile_counts, tile_triangles);
   }
 
@@ -191,8 +378,8 @@ void TileBasedRenderer::TriangleTileBinning(
   }
 
   // 第二遍（fill）：按范围填充TriangleRef
-  for (size_t tri_idx = 0; tri_idx < total_triangles; ++tri_idx) {
-    ProcessTriangleForTileBinning(tri_idx, false, model, grid,
+  for (uint32_t setup = 0; setup < setup_count; ++setup) {
+    ProcessTriangleForTileBinning(TileTriangleRef{setup}, false, grid,
                                   tile_counts, tile_triangles);
   }
 
@@ -210,211 +397,283 @@ void TileBasedRenderer::TriangleTileBinning(
                   : 0.0f);
 }
 
+TileBasedRenderer::RasterizeTileFn TileBasedRenderer::SelectRasterizeTile(
+    size_t tile_size) {
+  switch (tile_size) {
+    case 16:
+      return &TileBasedRenderer::RasterizeTile<16>;
+    case 32:
+      return &TileBasedRenderer::RasterizeTile<32>;
+    case 64:
+      return &TileBasedRenderer::RasterizeTile<64>;
+    case 128:
+      return &TileBasedRenderer::RasterizeTile<128>;
+    default:
+      return &TileBasedRenderer::RasterizeTile<0>;
+  }
+}
+
+template <size_t kTileSize>
 void TileBasedRenderer::RasterizeTile(
     size_t tile_id, const std::vector<TileTriangleRef> &triangles,
     const TileGridContext& grid, float *tile_depth_buffer,
-    uint32_t *tile_color_buffer, std::unique_ptr<float[]> &global_depth_buffer,
-    std::unique_ptr<uint32_t[]> &global_color_buffer,
+    uint32_t *tile_color_buffer, float *global_depth_buffer,
+    uint32_t *global_color_buffer,
     const Shader &shader, bool use_early_z,
     TileMaskStats* out_stats) {
   // 计算 tile 屏幕范围
+  // 特化实例的 tile 尺寸与网格一致，常量传播到下面的下标与循环
+  const size_t tile_size = kTileSize != 0 ? kTileSize : grid.tile_size;
   size_t tile_x = tile_id % grid.tiles_x;
   size_t tile_y = tile_id / grid.tiles_x;
-  size_t screen_x_start = tile_x * grid.tile_size;
-  size_t screen_y_start = tile_y * grid.tile_size;
-  size_t screen_x_end = std::min(screen_x_start + grid.tile_size, width_);
-  size_t screen_y_end = std::min(screen_y_start + grid.tile_size, height_);
+  size_t screen_x_start = tile_x * tile_size;
+  size_t screen_y_start = tile_y * tile_size;
+  size_t screen_x_end = std::min(screen_x_start + tile_size, width_);
+  size_t screen_y_end = std::min(screen_y_start + tile_size, height_);
 
   // 初始化 tile 局部缓冲
+  // 帧模式下从全局缓冲加载已有内容（load），否则清除（clear）
   size_t tile_width = screen_x_end - screen_x_start;
   size_t tile_height = screen_y_end - screen_y_start;
-  std::fill_n(tile_depth_buffer, tile_width * tile_height, kDepthClear);
-  std::fill_n(tile_color_buffer, tile_width * tile_height, kColorClear);
+  // tile 局部缓冲的行跨度：特化实例为常量 kTileSize
+  const size_t stride = kTileSize != 0 ? kTileSize : tile_width;
+  // 完整 tile（非画布边缘）的行长与行数均为编译期常量
+  const bool full_tile = kTileSize != 0 && tile_width == kTileSize &&
+                         tile_height == kTileSize;
+  const auto copy_rows = [&](auto &&copy_row) {
+    if constexpr (kTileSize != 0) {
+      if (full_tile) {
+        for (size_t y = 0; y < kTileSize; y++) copy_row(y, kTileSize);
+        return;
+      }
+    }
+    for (size_t y = 0; y < tile_height; y++) copy_row(y, tile_width);
+  };
+  if (IsFrameActive()) {
+    copy_rows([&](size_t y, size_t row_width) {
+      const size_t global_row_off =
+          (screen_y_start + y) * width_ + screen_x_start;
+      std::memcpy(tile_depth_buffer + y * stride,
+                  global_depth_buffer + global_row_off,
+                  row_width * sizeof(float));
+      std::memcpy(tile_color_buffer + y * stride,
+                  global_color_buffer + global_row_off,
+                  row_width * sizeof(uint32_t));
+    });
+  } else if (full_tile) {
+    std::fill_n(tile_depth_buffer, kTileSize * kTileSize, kDepthClear);
+    std::fill_n(tile_color_buffer, kTileSize * kTileSize, kColorClear);
+  } else {
+    std::fill_n(tile_depth_buffer, stride * tile_height, kDepthClear);
+    std::fill_n(tile_color_buffer, stride * tile_height, kColorClear);
+  }
 
   // 掩码化扫描：按三角形直接写入 tile 局部缓冲，避免中间片段向量
-  constexpr int kLane = 8;  // 横向处理的像素个数（便于编译器自动向量化）
+  constexpr int kLane = kRasterBlockSize;  // 横向处理的像素个数 = 块宽 = 内核通道数
+  const RasterRowKernel raster_kernel = GetRasterRowKernel();  // 按 CPUID 选择
+  RasterRowResult lanes;
+  const VaryingMask varyings = shader.GetVaryings();
 
   // 轻量统计：用于评估掩码收益（仅对少量tile打印DEBUG）
   uint64_t tested_pixels = 0;
   uint64_t covered_pixels = 0;
   uint64_t zpass_pixels = 0;
   uint64_t shaded_pixels = 0;
+  uint64_t hiz_triangles = 0;
+  uint64_t hiz_blocks = 0;
+  uint64_t small_triangles = 0;
+
+  // tile 内 Hi‑Z，随深度写入逐块更新（仅 early-z 时使用）
+  TileHiZ hiz;
+  if (use_early_z) {
+    hiz.Build(tile_depth_buffer, tile_width, tile_height, stride);
+  }
+
+  // 光栅化一行（至多 kLane 个像素）：覆盖掩码、重心、z 与 early-z 由 SIMD 内核完成，
+  // 存活像素压缩存放（非 early-z 或深度直接接受时为全部覆盖像素），随后逐个着色写回
+  const auto rasterize_row = [&](const TileTriangleRef &tri,
+                                 const RasterTriangle &raster_tri,
+                                 const int64_t e[3], int x, int y, int lane,
+                                 bool test_coverage, bool depth_test) {
+    const size_t row_idx =
+        static_cast<size_t>(x) - screen_x_start +
+        (static_cast<size_t>(y) - screen_y_start) * stride;
+    const RasterRow raster_row{{e[0], e[1], e[2]}, lane, test_coverage,
+                               depth_test ? tile_depth_buffer + row_idx : nullptr,
+                               0.0f};
+    raster_kernel(raster_tri, raster_row, lanes);
+
+    if (test_coverage) {
+      tested_pixels += static_cast<uint64_t>(lane);
+    }
+    covered_pixels += static_cast<uint64_t>(std::popcount(lanes.cover_mask));
+    if (use_early_z) {
+      zpass_pixels += lanes.count;
+    }
+
+    // 有纹理时按 2x2 quad 求 uv 差分（quad 内共享，存活像素按通道升序，逐 quad 缓存）
+    const TriangleSource &source = grid.setups.sources[tri.setup];
+    const bool quad_uv = (varyings & kVaryingTexCoords) != 0 &&
+                         source.material->HasTexture();
+    int quad = -1;
+    Vector2f uv_dx(0.0f), uv_dy(0.0f);
+
+    // 对存活像素着色并写回（非 early-z 时，先着色，再按 z 测试写入）
+    for (uint32_t n = 0; n < lanes.count; ++n) {
+      const int j = lanes.lane[n];
+      const size_t idx = row_idx + static_cast<size_t>(j);
+
+      Fragment frag;
+      frag.screen_coord = {x + j, y};
+      frag.depth = lanes.z[n];
+      frag.material = source.material;
+
+      // 只插值着色器声明的 varyings
+      InterpolateVaryings(grid.soa, source.i0, source.i1, source.i2, lanes.b0[n],
+                          lanes.b1[n], lanes.b2[n], varyings, frag);
+      if (quad_uv) {
+        if (((x + j) >> 1) != quad) {
+          quad = (x + j) >> 1;
+          const Vector2f uvs[3] = {grid.soa.uv[source.i0],
+                                   grid.soa.uv[source.i1],
+                                   grid.soa.uv[source.i2]};
+          QuadDerivatives(grid.setups.edges[tri.setup], raster_tri, uvs, x + j,
+                          y, uv_dx, uv_dy);
+        }
+        frag.uv_dx = uv_dx;
+        frag.uv_dy = uv_dy;
+      }
 
-  auto cross2 = [](float ax, float ay, float bx, float by) {
-    return ax * by - ay * bx;
+      if (use_early_z) { // 开启时，仅对通过early-z的像素进行着色和写回
+        auto out_color = shader.FragmentShader(frag);
+        tile_depth_buffer[idx] = frag.depth;
+        tile_color_buffer[idx] = uint32_t(out_color);
+        shaded_pixels++;
+      } else {
+        // 关闭时，先着色，再按z测试写入
+        auto out_color = shader.FragmentShader(frag);
+        if (frag.depth < tile_depth_buffer[idx]) { // late-z
+          tile_depth_buffer[idx] = frag.depth;
+          tile_color_buffer[idx] = uint32_t(out_color);
+          zpass_pixels++;
+          shaded_pixels++;
+        }
+      }
+    }
   };
 
   for (const auto &tri : triangles) {
-    const auto i0 = tri.i0, i1 = tri.i1, i2 = tri.i2;
-
-    // 顶点屏幕坐标
-    const Vector4f &p0 = grid.soa.pos_screen[i0];
-    const Vector4f &p1 = grid.soa.pos_screen[i1];
-    const Vector4f &p2 = grid.soa.pos_screen[i2];
-
-    // 三角形屏幕空间 AABB，与 tile 矩形求交
-    const float tri_minx = std::min({p0.x, p1.x, p2.x});
-    const float tri_miny = std::min({p0.y, p1.y, p2.y});
-    const float tri_maxx = std::max({p0.x, p1.x, p2.x});
-    const float tri_maxy = std::max({p0.y, p1.y, p2.y});
-
-    int sx = std::max<int>(static_cast<int>(screen_x_start),
-                           static_cast<int>(std::floor(std::max(0.0f, tri_minx))));
-    int sy = std::max<int>(static_cast<int>(screen_y_start),
-                           static_cast<int>(std::floor(std::max(0.0f, tri_miny))));
-    int ex = std::min<int>(static_cast<int>(screen_x_end - 1),
-                           static_cast<int>(std::floor(std::min<float>(width_ - 1, tri_maxx))));
-    int ey = std::min<int>(static_cast<int>(screen_y_end - 1),
-                           static_cast<int>(std::floor(std::min<float>(height_ - 1, tri_maxy))));
+    // 建立阶段的结果：边函数、内核常量与深度范围（每个三角形只建立一次）
+    const TriangleSetup &setup = grid.setups.edges[tri.setup];
+    const RasterTriangle &raster_tri = grid.setups.raster[tri.setup];
+
+    // tile 级 Hi‑Z：在任何边函数计算之前，最近深度不小于 tile 最大深度则整体拒绝
+    const float tri_zmin = grid.setups.z_min[tri.setup];
+    const float tri_zmax = grid.setups.z_max[tri.setup];
+    if (use_early_z && tri_zmin >= hiz.TileMax()) {
+      hiz_triangles++;
+      continue;
+    }
+
+    // 三角形覆盖像素的包围盒，与 tile 矩形求交
+    const int sx = std::max(static_cast<int>(screen_x_start), setup.min_x);
+    const int sy = std::max(static_cast<int>(screen_y_start), setup.min_y);
+    const int ex = std::min(static_cast<int>(screen_x_end - 1), setup.max_x);
+    const int ey = std::min(static_cast<int>(screen_y_end - 1), setup.max_y);
     if (sx > ex || sy > ey) continue;
 
-    // 边向量与有向面积
-    const float e01x = p1.x - p0.x, e01y = p1.y - p0.y;
-    const float e12x = p2.x - p1.x, e12y = p2.y - p1.y;
-    const float e20x = p0.x - p2.x, e20y = p0.y - p2.y;
-    const float area2 = cross2(e01x, e01y, p2.x - p0.x, p2.y - p0.y);
-    if (std::abs(area2) < 1e-6f) continue;  // 退化三角形
-    const bool positive = (area2 > 0.0f);
-
-    // z 与 1/w 的平面插值准备
-    const float z0 = p0.z, z1 = p1.z, z2 = p2.z;
-    const float w0_inv = 1.0f / p0.w, w1_inv = 1.0f / p1.w, w2_inv = 1.0f / p2.w;
-
-    // 行扫描
-    for (int y = sy; y <= ey; ++y) { // 行优先遍历：有利于 cache 与向量化
-      const float yf = static_cast<float>(y);
-      for (int xb = sx; xb <= ex; xb += kLane) { // 每次处理kLane个像素
-        const int lane = std::min(kLane, ex - xb + 1); // 当前需要处理的像素个数
-        const float x0f = static_cast<float>(xb); // 本块起点的x坐标
-
-        // 计算本块起点的三个边函数值与横向步长（dE/dx）
-        float E01_base = cross2(e01x, e01y, x0f - p0.x, yf - p0.y);
-        float E12_base = cross2(e12x, e12y, x0f - p1.x, yf - p1.y);
-        float E20_base = cross2(e20x, e20y, x0f - p2.x, yf - p2.y);
-        const float dE01dx = -e01y;
-        const float dE12dx = -e12y;
-        const float dE20dx = -e20y;
-
-        // ============== 构造覆盖掩码 cover mask ==============
-        unsigned mask_cover = 0u;
-        int cover_count = 0;
-        float E01[kLane], E12[kLane], E20[kLane];
-        #pragma omp simd
-        for (int j = 0; j < lane; ++j) {
-          E01[j] = E01_base + dE01dx * static_cast<float>(j);
-          E12[j] = E12_base + dE12dx * static_cast<float>(j);
-          E20[j] = E20_base + dE20dx * static_cast<float>(j);
-        }
-        for (int j = 0; j < lane; ++j) { // 内点测试，如果三角形在像素内，则将该像素加入覆盖掩码
-          bool inside = positive ? (E01[j] >= 0.0f && E12[j] >= 0.0f && E20[j] >= 0.0f)
-                                 : (E01[j] <= 0.0f && E12[j] <= 0.0f && E20[j] <= 0.0f);
-          if (inside) {
-            mask_cover |= (1u << j);
-            cover_count++;
+    // 小三角形（分箱时标记）：一次模板测试得到全部采样点的覆盖，
+    // 不覆盖任何采样点的三角形直接丢弃，其余只光栅化有覆盖的行
+    if (tri.small) {
+      small_triangles++;
+      const uint32_t stamp = setup.CoverStamp(setup.min_x, setup.min_y);
+      if (stamp == 0u) continue;
+      const uint64_t shaded_before = shaded_pixels;
+      for (int y = sy; y <= ey; ++y) {
+        const uint32_t stamp_row =
+            stamp >> ((y - setup.min_y) * kSmallTriangleStamp + (sx - setup.min_x));
+        if ((stamp_row & ((1u << (ex - sx + 1)) - 1u)) == 0u) continue;
+        const int64_t e[3] = {setup.Evaluate(0, sx, y), setup.Evaluate(1, sx, y),
+                              setup.Evaluate(2, sx, y)};
+        rasterize_row(tri, raster_tri, e, sx, y, ex - sx + 1, true, use_early_z);
+      }
+      // 模板至多跨 2x2 个 Hi‑Z 块
+      if (use_early_z && shaded_pixels != shaded_before) {
+        const size_t hx0 = (static_cast<size_t>(sx) - screen_x_start) / kRasterBlockSize;
+        const size_t hx1 = (static_cast<size_t>(ex) - screen_x_start) / kRasterBlockSize;
+        const size_t hy0 = (static_cast<size_t>(sy) - screen_y_start) / kRasterBlockSize;
+        const size_t hy1 = (static_cast<size_t>(ey) - screen_y_start) / kRasterBlockSize;
+        for (size_t hy = hy0; hy <= hy1; ++hy) {
+          for (size_t hx = hx0; hx <= hx1; ++hx) {
+            hiz.UpdateBlock(tile_depth_buffer, hx, hy);
           }
         }
-        tested_pixels += static_cast<uint64_t>(lane);
-        covered_pixels += static_cast<uint64_t>(cover_count);
-        if (mask_cover == 0u) continue;
-
-        // ============== 计算 z，进行early-z掩码 ==============
-        unsigned mask_zpass = 0u;
-        float zvals[kLane];
-        // 缓存校正后的重心坐标，避免着色阶段重复计算
-        float b0c_arr[kLane];
-        float b1c_arr[kLane];
-        float b2c_arr[kLane];
-        int zpass_count = 0;
-        for (int j = 0; j < lane; ++j) {
-          if (((mask_cover >> j) & 1u) == 0u) { continue; } // 如果该像素不在覆盖掩码内，则跳过
-          const float b0 = E12[j] / area2;
-          const float b1 = E20[j] / area2;
-          const float b2 = E01[j] / area2;
-          const float w_inv = b0 * w0_inv + b1 * w1_inv + b2 * w2_inv; // 透视矫正
-          const float b0c = (b0 * w0_inv) / w_inv;
-          const float b1c = (b1 * w1_inv) / w_inv;
-          const float b2c = (b2 * w2_inv) / w_inv;
-          b0c_arr[j] = b0c; b1c_arr[j] = b1c; b2c_arr[j] = b2c;
-          const float z = z0 * b0c + z1 * b1c + z2 * b2c;
-          zvals[j] = z;
-
-          const int sx_pix = xb + j;
-          const int local_x = sx_pix - static_cast<int>(screen_x_start);
-          const int local_y = y - static_cast<int>(screen_y_start);
-          const size_t idx = static_cast<size_t>(local_x + local_y * static_cast<int>(tile_width));
-          if (z < tile_depth_buffer[idx]) {
-            mask_zpass |= (1u << j);
-            zpass_count++;
+        hiz.UpdateTile();
+      }
+      continue;
+    }
+
+    // 块与 tile 内的 8x8 网格（Hi‑Z 的块）对齐；对齐引入的包围盒外像素必在三角形外
+    const int bx0 = static_cast<int>(screen_x_start) +
+                    (sx - static_cast<int>(screen_x_start)) / kRasterBlockSize * kRasterBlockSize;
+    const int by0 = static_cast<int>(screen_y_start) +
+                    (sy - static_cast<int>(screen_y_start)) / kRasterBlockSize * kRasterBlockSize;
+
+    // 块行起点的边函数值，逐块行按 kRasterBlockSize * step_y 增量推进
+    int64_t block_row[3] = {setup.Evaluate(0, bx0, by0),
+                            setup.Evaluate(1, bx0, by0),
+                            setup.Evaluate(2, bx0, by0)};
+    bool hiz_dirty = false;
+
+    // 分层遍历：kRasterBlockSize x kRasterBlockSize 的块先按四角分类，
+    // 完全在外的块跳过，完全在内的块省去逐像素边函数测试
+    for (int yb = by0; yb <= ey; yb += kRasterBlockSize) {
+      const int block_height = std::min(kRasterBlockSize, ey - yb + 1);
+      int64_t block[3] = {block_row[0], block_row[1], block_row[2]};
+      for (int k = 0; k < 3; ++k) block_row[k] += setup.step_y[k] * kRasterBlockSize;
+
+      for (int xb = bx0; xb <= ex; xb += kLane) { // 每块宽 kLane 个像素
+        const int lane = std::min(kLane, ex - xb + 1); // 当前需要处理的像素个数
+        int64_t row[3] = {block[0], block[1], block[2]};
+        for (int k = 0; k < 3; ++k) block[k] += setup.step_x[k] * kLane;
+
+        const BlockCoverage coverage = setup.ClassifyBlock(row, lane, block_height);
+        if (coverage == BlockCoverage::kOutside) continue;
+
+        // 块级 Hi‑Z：最近深度不小于块内最大深度则整块被遮挡；
+        // 最远深度小于块内最小深度则覆盖像素无需逐像素深度比较
+        const size_t block_x = static_cast<size_t>(xb) - screen_x_start;
+        const size_t block_y = static_cast<size_t>(yb) - screen_y_start;
+        bool depth_accept = false;
+        if (use_early_z) {
+          const size_t hx = block_x / kRasterBlockSize, hy = block_y / kRasterBlockSize;
+          if (tri_zmin >= hiz.BlockMax(hx, hy)) {
+            hiz_blocks++;
+            continue;
           }
+          depth_accept = tri_zmax < hiz.BlockMin(hx, hy);
         }
-        zpass_pixels += static_cast<uint64_t>(zpass_count);
-
-        // ============== 构造最终掩码 ==============
-        unsigned mask_final = use_early_z ? (mask_cover & mask_zpass) : mask_cover;
-        if (mask_final == 0u && use_early_z) continue;
-
-        // 对掩码内像素着色并写回（非 early-z 时，先着色，再按 z 测试写入）
-        for (int j = 0; j < lane; ++j) {
-          if (((mask_final >> j) & 1u) == 0u && use_early_z) continue;
-          const int sx_pix = xb + j;
-          const int local_x = sx_pix - static_cast<int>(screen_x_start);
-          const int local_y = y - static_cast<int>(screen_y_start);
-          const size_t idx = static_cast<size_t>(local_x + local_y * static_cast<int>(tile_width));
-
-          // 计算插值属性
-          const float b0c = b0c_arr[j];
-          const float b1c = b1c_arr[j];
-          const float b2c = b2c_arr[j];
-
-          Fragment frag;
-          frag.screen_coord = {sx_pix, y};
-          frag.depth = zvals[j];
-          frag.material = tri.material;
-
-          // 法向量插值
-          const Vector3f &n0 = grid.soa.normal[i0];
-          const Vector3f &n1 = grid.soa.normal[i1];
-          const Vector3f &n2 = grid.soa.normal[i2];
-          frag.normal = n0 * b0c + n1 * b1c + n2 * b2c;
-
-          // 纹理坐标插值
-          const Vector2f &uv0 = grid.soa.uv[i0];
-          const Vector2f &uv1 = grid.soa.uv[i1];
-          const Vector2f &uv2 = grid.soa.uv[i2];
-          frag.uv = uv0 * b0c + uv1 * b1c + uv2 * b2c;
-
-          // 颜色插值
-          const Color &c0 = grid.soa.color[i0];
-          const Color &c1 = grid.soa.color[i1];
-          const Color &c2 = grid.soa.color[i2];
-          auto color_r = FloatToUint8_t(static_cast<float>(c0[Color::kColorIndexRed]) * b0c +
-                                        static_cast<float>(c1[Color::kColorIndexRed]) * b1c +
-                                        static_cast<float>(c2[Color::kColorIndexRed]) * b2c);
-          auto color_g = FloatToUint8_t(static_cast<float>(c0[Color::kColorIndexGreen]) * b0c +
-                                        static_cast<float>(c1[Color::kColorIndexGreen]) * b1c +
-                                        static_cast<float>(c2[Color::kColorIndexGreen]) * b2c);
-          auto color_b = FloatToUint8_t(static_cast<float>(c0[Color::kColorIndexBlue]) * b0c +
-                                        static_cast<float>(c1[Color::kColorIndexBlue]) * b1c +
-                                        static_cast<float>(c2[Color::kColorIndexBlue]) * b2c);
-          frag.color = Color(color_r, color_g, color_b);
-
-          if (use_early_z) { // 开启时，仅对mask中通过early-z的像素进行着色和写回
-            auto out_color = shader.FragmentShader(frag);
-            tile_depth_buffer[idx] = frag.depth;
-            tile_color_buffer[idx] = uint32_t(out_color);
-            shaded_pixels++;
-          } else {
-            // 关闭时，先着色，再按z测试写入
-            auto out_color = shader.FragmentShader(frag);
-            if (frag.depth < tile_depth_buffer[idx]) { // late-z
-              tile_depth_buffer[idx] = frag.depth;
-              tile_color_buffer[idx] = uint32_t(out_color);
-              shaded_pixels++;
-            }
-          }
+        const uint64_t shaded_before = shaded_pixels;
+
+        // 块内逐行光栅化，完全在内的块省去边函数测试
+        for (int y = yb; y < yb + block_height; ++y) {
+          rasterize_row(tri, raster_tri, row, xb, y, lane,
+                        coverage == BlockCoverage::kPartial,
+                        use_early_z && !depth_accept);
+          for (int k = 0; k < 3; ++k) row[k] += setup.step_y[k];
+        }
+
+        // 块内深度有写入时更新其 Hi‑Z 范围
+        if (use_early_z && shaded_pixels != shaded_before) {
+          hiz.UpdateBlock(tile_depth_buffer, block_x / kRasterBlockSize,
+                          block_y / kRasterBlockSize);
+          hiz_dirty = true;
         }
       }
     }
+    if (hiz_dirty) {
+      hiz.UpdateTile();
+    }
   }
 
   if (out_stats) {
@@ -422,106 +681,323 @@ void TileBasedRenderer::RasterizeTile(
     out_stats->covered = covered_pixels;
     out_stats->zpass = zpass_pixels;
     out_stats->shaded = shaded_pixels;
+    out_stats->hiz_triangles = hiz_triangles;
+    out_stats->hiz_blocks = hiz_blocks;
+    out_stats->small_triangles = small_triangles;
   }
 
   // 写回全局缓冲
   // TBR 下不同 tile 覆盖的屏幕区域互不重叠，且在 tile 内部已通过 Early‑Z
   // 得出每个像素的最终值。因此可以直接将 tile 行数据拷贝到全局缓冲
-  for (size_t y = 0; y < tile_height; y++) {
-    const size_t tile_row_off = y * tile_width;
+  copy_rows([&](size_t y, size_t row_width) {
+    const size_t tile_row_off = y * stride;
     const size_t global_row_off =
         (screen_y_start + y) * width_ + screen_x_start;
 
     // 拷贝本行 color 到全局 color
-    std::memcpy(global_color_buffer.get() + global_row_off,
+    std::memcpy(global_color_buffer + global_row_off,
                 tile_color_buffer + tile_row_off,
-                tile_width * sizeof(uint32_t));
+                row_width * sizeof(uint32_t));
 
     // 拷贝本行 depth 到全局 depth
-    std::memcpy(global_depth_buffer.get() + global_row_off,
-                tile_depth_buffer + tile_row_off, tile_width * sizeof(float));
+    std::memcpy(global_depth_buffer + global_row_off,
+                tile_depth_buffer + tile_row_off, row_width * sizeof(float));
+  });
+}
+
+void TileBasedRenderer::RasterizeTileMsaa(
+    size_t tile_id, const std::vector<TileTriangleRef> &triangles,
+    const TileGridContext& grid, float *tile_depth_buffer,
+    uint32_t *tile_color_buffer, float *pixel_depth_max,
+    float *global_depth_buffer, uint32_t *global_color_buffer,
+    const FrameSampleBuffers &frame_samples,
+    const Shader &shader, bool use_early_z,
+    TileMaskStats* out_stats) {
+  // 计算 tile 屏幕范围
+  size_t tile_x = tile_id % grid.tiles_x;
+  size_t tile_y = tile_id / grid.tiles_x;
+  size_t screen_x_start = tile_x * grid.tile_size;
+  size_t screen_y_start = tile_y * grid.tile_size;
+  size_t screen_x_end = std::min(screen_x_start + grid.tile_size, width_);
+  size_t screen_y_end = std::min(screen_y_start + grid.tile_size, height_);
+  size_t tile_width = screen_x_end - screen_x_start;
+  size_t tile_height = screen_y_end - screen_y_start;
+
+  // 样本平面：第 s 个样本位于 tile_*_buffer + s * plane
+  const MsaaPattern pattern = GetMsaaPattern(msaa_samples_);
+  const uint32_t samples = pattern.samples;
+  const size_t plane = tile_width * tile_height;
+  if (frame_samples.depth != nullptr) {
+    LoadTileSamples(frame_samples, width_, screen_x_start, screen_y_start,
+                    tile_width, tile_height, samples, tile_depth_buffer,
+                    tile_color_buffer);
+  } else {
+    std::fill_n(tile_depth_buffer, plane * samples, kDepthClear);
+    std::fill_n(tile_color_buffer, plane * samples, kColorClear);
+  }
+
+  // 每像素样本深度的最大值：Hi‑Z 的输入，三角形比像素的全部样本都远时才能拒绝
+  std::copy_n(tile_depth_buffer, plane, pixel_depth_max);
+  for (uint32_t s = 1; s < samples; ++s) {
+    for (size_t i = 0; i < plane; ++i) {
+      pixel_depth_max[i] = std::max(pixel_depth_max[i], tile_depth_buffer[s * plane + i]);
+    }
+  }
+  TileHiZ hiz;
+  if (use_early_z) {
+    hiz.Build(pixel_depth_max, tile_width, tile_height);
+  }
+
+  constexpr int kLane = kRasterBlockSize;
+  const RasterRowKernel raster_kernel = GetRasterRowKernel();
+  RasterRowResult lanes;
+  const VaryingMask varyings = shader.GetVaryings();
+
+  uint64_t tested_pixels = 0;
+  uint64_t covered_pixels = 0;
+  uint64_t zpass_pixels = 0;
+  uint64_t shaded_pixels = 0;
+  uint64_t hiz_triangles = 0;
+  uint64_t hiz_blocks = 0;
+
+  // 光栅化一行：逐样本调用内核得到样本的覆盖、z 与 early-z（样本主序平面上的深度行），
+  // 任一样本存活的像素在像素采样点着色一次，颜色与深度写入存活样本；返回是否有写入
+  const auto rasterize_row = [&](const TileTriangleRef &tri,
+                                 const TriangleSetup &setup,
+                                 const RasterTriangle &raster_tri,
+                                 const int64_t offsets[kMaxMsaaSamples][3],
+                                 const int64_t e[3], int x, int y, int lane,
+                                 bool test_coverage) {
+    const size_t row_idx =
+        static_cast<size_t>(x) - screen_x_start +
+        (static_cast<size_t>(y) - screen_y_start) * tile_width;
+    uint32_t pass[kMaxMsaaSamples];
+    float sample_z[kMaxMsaaSamples][kRasterLanes];
+    uint32_t cover_any = 0u, pass_any = 0u;
+    for (uint32_t s = 0; s < samples; ++s) {
+      const RasterRow raster_row{
+          {e[0] + offsets[s][0], e[1] + offsets[s][1], e[2] + offsets[s][2]},
+          lane, test_coverage,
+          use_early_z ? tile_depth_buffer + s * plane + row_idx : nullptr, 0.0f};
+      raster_kernel(raster_tri, raster_row, lanes);
+      cover_any |= lanes.cover_mask;
+      pass[s] = 0u;
+      for (uint32_t n = 0; n < lanes.count; ++n) {
+        pass[s] |= 1u << lanes.lane[n];
+        sample_z[s][lanes.lane[n]] = lanes.z[n];
+      }
+      pass_any |= pass[s];
+    }
+
+    if (test_coverage) {
+      tested_pixels += static_cast<uint64_t>(lane);
+    }
+    covered_pixels += static_cast<uint64_t>(std::popcount(cover_any));
+    if (use_early_z) {
+      zpass_pixels += static_cast<uint64_t>(std::popcount(pass_any));
+    }
+
+    const TriangleSource &source = grid.setups.sources[tri.setup];
+    const bool quad_uv = (varyings & kVaryingTexCoords) != 0 &&
+                         source.material->HasTexture();
+    int quad = -1;
+    Vector2f uv_dx(0.0f), uv_dy(0.0f);
+    bool written = false;
+    for (uint32_t bits = pass_any; bits != 0u; bits &= bits - 1u) {
+      const int j = std::countr_zero(bits);
+      const size_t idx = row_idx + static_cast<size_t>(j);
+
+      // 属性在像素采样点求值（采样点不被覆盖时为外插），每像素着色一次
+      const int64_t center[3] = {e[0] + setup.step_x[0] * j,
+                                 e[1] + setup.step_x[1] * j,
+                                 e[2] + setup.step_x[2] * j};
+      float b[3];
+      Fragment frag;
+      frag.screen_coord = {x + j, y};
+      frag.material = source.material;
+      raster_tri.Interpolate(center, b, frag.depth);
+      InterpolateVaryings(grid.soa, source.i0, source.i1, source.i2, b[0], b[1],
+                          b[2], varyings, frag);
+      if (quad_uv) {
+        if (((x + j) >> 1) != quad) {
+          quad = (x + j) >> 1;
+          const Vector2f uvs[3] = {grid.soa.uv[source.i0],
+                                   grid.soa.uv[source.i1],
+                                   grid.soa.uv[source.i2]};
+          QuadDerivatives(setup, raster_tri, uvs, x + j, y, uv_dx, uv_dy);
+        }
+        frag.uv_dx = uv_dx;
+        frag.uv_dy = uv_dy;
+      }
+      const uint32_t out_color = uint32_t(shader.FragmentShader(frag));
+
+      // 非 early-z 时先着色，再逐样本按 z 测试写入（late-z）
+      bool pixel_written = false;
+      for (uint32_t s = 0; s < samples; ++s) {
+        if (((pass[s] >> j) & 1u) == 0u) continue;
+        float &depth = tile_depth_buffer[s * plane + idx];
+        if (use_early_z || sample_z[s][j] < depth) {
+          depth = sample_z[s][j];
+          tile_color_buffer[s * plane + idx] = out_color;
+          pixel_written = true;
+        }
+      }
+      if (!pixel_written) continue;
+      if (!use_early_z) {
+        zpass_pixels++;
+      }
+      shaded_pixels++;
+      written = true;
+      float zmax = tile_depth_buffer[idx];
+      for (uint32_t s = 1; s < samples; ++s) {
+        zmax = std::max(zmax, tile_depth_buffer[s * plane + idx]);
+      }
+      pixel_depth_max[idx] = zmax;
+    }
+    return written;
+  };
+
+  for (const auto &tri : triangles) {
+    const TriangleSetup &setup = grid.setups.edges[tri.setup];
+    const RasterTriangle &raster_tri = grid.setups.raster[tri.setup];
+
+    // tile 级 Hi‑Z
+    const float tri_zmin = grid.setups.z_min[tri.setup];
+    if (use_early_z && tri_zmin >= hiz.TileMax()) {
+      hiz_triangles++;
+      continue;
+    }
+
+    // 包围盒（建立时已外扩，包含只有偏移样本被覆盖的像素）与 tile 求交
+    const int sx = std::max(static_cast<int>(screen_x_start), setup.min_x);
+    const int sy = std::max(static_cast<int>(screen_y_start), setup.min_y);
+    const int ex = std::min(static_cast<int>(screen_x_end - 1), setup.max_x);
+    const int ey = std::min(static_cast<int>(screen_y_end - 1), setup.max_y);
+    if (sx > ex || sy > ey) continue;
+
+    int64_t offsets[kMaxMsaaSamples][3];
+    SampleEdgeOffsets(setup, pattern, offsets);
+
+    const int bx0 = static_cast<int>(screen_x_start) +
+                    (sx - static_cast<int>(screen_x_start)) / kRasterBlockSize * kRasterBlockSize;
+    const int by0 = static_cast<int>(screen_y_start) +
+                    (sy - static_cast<int>(screen_y_start)) / kRasterBlockSize * kRasterBlockSize;
+    int64_t block_row[3] = {setup.Evaluate(0, bx0, by0),
+                            setup.Evaluate(1, bx0, by0),
+                            setup.Evaluate(2, bx0, by0)};
+    bool hiz_dirty = false;
+
+    // 分层遍历同单样本路径；样本在像素采样点半个像素以内，
+    // 按外扩一个像素的块分类即对全部样本保守
+    for (int yb = by0; yb <= ey; yb += kRasterBlockSize) {
+      const int block_height = std::min(kRasterBlockSize, ey - yb + 1);
+      int64_t block[3] = {block_row[0], block_row[1], block_row[2]};
+      for (int k = 0; k < 3; ++k) block_row[k] += setup.step_y[k] * kRasterBlockSize;
+
+      for (int xb = bx0; xb <= ex; xb += kLane) {
+        const int lane = std::min(kLane, ex - xb + 1);
+        int64_t row[3] = {block[0], block[1], block[2]};
+        for (int k = 0; k < 3; ++k) block[k] += setup.step_x[k] * kLane;
+
+        const int64_t outer[3] = {row[0] - setup.step_x[0] - setup.step_y[0],
+                                  row[1] - setup.step_x[1] - setup.step_y[1],
+                                  row[2] - setup.step_x[2] - setup.step_y[2]};
+        const BlockCoverage coverage =
+            setup.ClassifyBlock(outer, lane + 2, block_height + 2);
+        if (coverage == BlockCoverage::kOutside) continue;
+
+        // 块级 Hi‑Z（只做拒绝：像素最大深度的块内最小值不是样本深度的下界）
+        const size_t block_x = static_cast<size_t>(xb) - screen_x_start;
+        const size_t block_y = static_cast<size_t>(yb) - screen_y_start;
+        if (use_early_z &&
+            tri_zmin >= hiz.BlockMax(block_x / kRasterBlockSize, block_y / kRasterBlockSize)) {
+          hiz_blocks++;
+          continue;
+        }
+
+        bool block_written = false;
+        for (int y = yb; y < yb + block_height; ++y) {
+          block_written |= rasterize_row(tri, setup, raster_tri, offsets, row, xb, y,
+                                         lane, coverage == BlockCoverage::kPartial);
+          for (int k = 0; k < 3; ++k) row[k] += setup.step_y[k];
+        }
+
+        if (use_early_z && block_written) {
+          hiz.UpdateBlock(pixel_depth_max, block_x / kRasterBlockSize,
+                          block_y / kRasterBlockSize);
+          hiz_dirty = true;
+        }
+      }
+    }
+    if (hiz_dirty) {
+      hiz.UpdateTile();
+    }
+  }
+
+  if (out_stats) {
+    out_stats->tested = tested_pixels;
+    out_stats->covered = covered_pixels;
+    out_stats->zpass = zpass_pixels;
+    out_stats->shaded = shaded_pixels;
+    out_stats->hiz_triangles = hiz_triangles;
+    out_stats->hiz_blocks = hiz_blocks;
   }
+
+  // 解析并写回全局缓冲
+  ResolveTileSamples(tile_depth_buffer, tile_color_buffer, tile_width,
+                     tile_height, samples, width_, screen_x_start,
+                     screen_y_start, global_depth_buffer, global_color_buffer,
+                     frame_samples);
 }
 
 void TileBasedRenderer::ProcessTriangleForTileBinning(
-    size_t tri_idx, bool count_only, const Model &model,
+    const TileTriangleRef &tri_ref, bool count_only,
     const TileGridContext &grid, std::vector<size_t> &tile_counts,
     std::vector<std::vector<TileTriangleRef>> &tile_triangles) {
-  const auto &f = model.GetFaces()[tri_idx];
-  size_t i0 = f.GetIndex(0);
-  size_t i1 = f.GetIndex(1);
-  size_t i2 = f.GetIndex(2);
-
-  // 视锥体裁剪 (裁剪空间)
-  // 保守视锥体裁剪：只有当整个三角形都在视锥体外同一侧时才裁剪
-  const Vector4f &c0 = grid.soa.pos_clip[i0];
-  const Vector4f &c1 = grid.soa.pos_clip[i1];
-  const Vector4f &c2 = grid.soa.pos_clip[i2];
-  bool frustum_cull =
-      (c0.x > c0.w && c1.x > c1.w && c2.x > c2.w) ||     // 右平面外
-      (c0.x < -c0.w && c1.x < -c0.w && c2.x < -c0.w) ||  // 左平面外
-      (c0.y > c0.w && c1.y > c1.w && c2.y > c2.w) ||     // 上平面外
-      (c0.y < -c0.w && c1.y < -c0.w && c2.y < -c0.w) ||  // 下平面外
-      (c0.z > c0.w && c1.z > c1.w && c2.z > c2.w) ||     // 远平面外
-      (c0.z < -c0.w && c1.z < -c0.w && c2.z < -c0.w);    // 近平面外
-  if (frustum_cull) {
-    return;
-  }
-
-  const Vector4f &pos0 = grid.soa.pos_screen[i0];
-  const Vector4f &pos1 = grid.soa.pos_screen[i1];
-  const Vector4f &pos2 = grid.soa.pos_screen[i2];
-
-  // 背面剔除（屏幕空间）
-  // NDC空间中叉积为负表示顺时针，即背面。
-  // 从NDC到屏幕空间中，会发生Y轴翻转，对应叉积应为正。
-  Vector2f screen0(pos0.x, pos0.y);
-  Vector2f screen1(pos1.x, pos1.y);
-  Vector2f screen2(pos2.x, pos2.y);
-  Vector2f edge1 = screen1 - screen0;
-  Vector2f edge2 = screen2 - screen0;
-  float cross_product = edge1.x * edge2.y - edge1.y * edge2.x;
-  if (cross_product > 0.0f) return;
-
-  float screen_x0 = pos0.x;
-  float screen_y0 = pos0.y;
-  float screen_x1 = pos1.x;
-  float screen_y1 = pos1.y;
-  float screen_x2 = pos2.x;
-  float screen_y2 = pos2.y;
-
-  // 计算屏幕bbox，用于后续tile划分
-  float min_x = std::min({screen_x0, screen_x1, screen_x2});
-  float max_x = std::max({screen_x0, screen_x1, screen_x2});
-  float min_y = std::min({screen_y0, screen_y1, screen_y2});
-  float max_y = std::max({screen_y0, screen_y1, screen_y2});
-
-  int start_tile_x = std::max(0, static_cast<int>(min_x) /
-                                     static_cast<int>(grid.tile_size));
+  // 视锥体外、背面与零面积三角形已在位置阶段剔除，
+  // 跨越近平面/保护带的三角形已裁剪，屏幕坐标有界；
+  // 不覆盖任何采样点的三角形已在建立阶段剔除
+  const TriangleSetupBuffer &setups = grid.setups;
+  if (!setups.valid[tri_ref.setup]) return;
+  const TriangleSetup &setup = setups.edges[tri_ref.setup];
+
+  // 覆盖采样点的包围盒，用于后续tile划分
+  if (setup.max_x < 0 || setup.max_y < 0) return;
+  const int tile_size = static_cast<int>(grid.tile_size);
+  int start_tile_x = std::max(0, setup.min_x) / tile_size;
   int end_tile_x =
-      std::min(static_cast<int>(grid.tiles_x - 1),
-               static_cast<int>(max_x) / static_cast<int>(grid.tile_size));
-  int start_tile_y = std::max(0, static_cast<int>(min_y) /
-                                     static_cast<int>(grid.tile_size));
+      std::min(static_cast<int>(grid.tiles_x - 1), setup.max_x / tile_size);
+  int start_tile_y = std::max(0, setup.min_y) / tile_size;
   int end_tile_y =
-      std::min(static_cast<int>(grid.tiles_y - 1),
-               static_cast<int>(max_y) / static_cast<int>(grid.tile_size));
+      std::min(static_cast<int>(grid.tiles_y - 1), setup.max_y / tile_size);
   if (start_tile_x > end_tile_x || start_tile_y > end_tile_y)
     return;  // 如果bbox不在任何tile内，直接返回
 
+  // 包围盒不超过模板的三角形在光栅化时走小三角形路径
+  TileTriangleRef ref = tri_ref;
+  ref.small = setup.Small();
+
+  // 分箱阶段 Hi‑Z：最近深度不小于 tile 已有最大深度时不进入该 tile
+  const float min_z = setups.z_min[tri_ref.setup];
+  const auto occluded = [&](size_t tile_id) {
+    return grid.tile_depth_max != nullptr &&
+           min_z >= grid.tile_depth_max[tile_id];
+  };
+
   if (count_only) {  // 第一遍计数，只统计tile内三角形数量
     for (int ty = start_tile_y; ty <= end_tile_y; ++ty) {
       for (int tx = start_tile_x; tx <= end_tile_x; ++tx) {
         size_t tile_id = ty * grid.tiles_x + tx;
+        if (occluded(tile_id)) continue;
         tile_counts[tile_id]++;
       }
     }
   } else {  // 第二遍填充，填充TriangleRef
-    TileTriangleRef tri_ref{i0, i1, i2, &f.GetMaterial(), tri_idx};
     for (int ty = start_tile_y; ty <= end_tile_y; ++ty) {
       for (int tx = start_tile_x; tx <= end_tile_x; ++tx) {
         size_t tile_id = ty * grid.tiles_x + tx;
-        tile_triangles[tile_id].push_back(tri_ref);
+        if (occluded(tile_id)) continue;
+        tile_triangles[tile_id].push_back(ref);
       }
     }
   }
@@ -10,7 +10,7 @@ namespace simple_renderer {
 Shader::Shader(const Shader& shader) {
   std::shared_lock lock(shader.specular_cache_mutex_);
   uniformbuffer_ = shader.uniformbuffer_;
-  sharedDataInShader_ = shader.sharedDataInShader_;
+  varyings_ = shader.varyings_;
   vertex_uniform_cache_ = shader.vertex_uniform_cache_;
   fragment_uniform_cache_ = shader.fragment_uniform_cache_;
   specular_lut_cache_ = shader.specular_lut_cache_;
@@ -19,7 +19,7 @@ Shader::Shader(const Shader& shader) {
 Shader::Shader(Shader&& shader) noexcept {
   std::unique_lock lock(shader.specular_cache_mutex_);
   uniformbuffer_ = std::move(shader.uniformbuffer_);
-  sharedDataInShader_ = shader.sharedDataInShader_;
+  varyings_ = shader.varyings_;
   vertex_uniform_cache_ = shader.vertex_uniform_cache_;
   fragment_uniform_cache_ = shader.fragment_uniform_cache_;
   specular_lut_cache_ = std::move(shader.specular_lut_cache_);
@@ -31,7 +31,7 @@ auto Shader::operator=(const Shader& shader) -> Shader& {
   }
   std::shared_lock lock(shader.specular_cache_mutex_);
   uniformbuffer_ = shader.uniformbuffer_;
-  sharedDataInShader_ = shader.sharedDataInShader_;
+  varyings_ = shader.varyings_;
   vertex_uniform_cache_ = shader.vertex_uniform_cache_;
   fragment_uniform_cache_ = shader.fragment_uniform_cache_;
   specular_lut_cache_ = shader.specular_lut_cache_;
@@ -44,7 +44,7 @@ auto Shader::operator=(Shader&& shader) noexcept -> Shader& {
   }
   std::unique_lock lock(shader.specular_cache_mutex_);
   uniformbuffer_ = std::move(shader.uniformbuffer_);
-  sharedDataInShader_ = shader.sharedDataInShader_;
+  varyings_ = shader.varyings_;
   vertex_uniform_cache_ = shader.vertex_uniform_cache_;
   fragment_uniform_cache_ = shader.fragment_uniform_cache_;
   specular_lut_cache_ = std::move(shader.specular_lut_cache_);
@@ -52,54 +52,50 @@ auto Shader::operator=(Shader&& shader) noexcept -> Shader& {
 }
 
 Vertex Shader::VertexShader(const Vertex& vertex) {
+  return VertexShader(vertex, VertexPosition(vertex));
+}
+
+Vector4f Shader::VertexPosition(const Vertex& vertex) const {
+  if (vertex_uniform_cache_.derived_valid) {
+    // 直接复用缓存矩阵，避免逐顶点哈希查询
+    return vertex_uniform_cache_.mvp * vertex.GetPosition();
+  }
+  return GetMVPMatrix() * vertex.GetPosition();
+}
+
+Vertex Shader::VertexShader(const Vertex& vertex,
+                            const Vector4f& clip_position) {
   const bool cache_ready = vertex_uniform_cache_.derived_valid;
 
-  const Matrix4f* model_ptr = nullptr;
-  const Matrix4f* mvp_ptr = nullptr;
   const Matrix3f* normal_ptr = nullptr;
-
-  Matrix4f fallback_model;
-  Matrix4f fallback_mvp;
   Matrix3f fallback_normal;
 
   if (cache_ready) { // 如果所有派生矩阵已预计算并可直接复用
     // 直接复用缓存矩阵，避免逐顶点哈希查询
-    model_ptr = &vertex_uniform_cache_.model;
-    mvp_ptr = &vertex_uniform_cache_.mvp;
     normal_ptr = &vertex_uniform_cache_.normal;
   } else { // 如果缓存尚未建立
-    fallback_model = uniformbuffer_.GetUniform<Matrix4f>("modelMatrix");
-    Matrix4f view_matrix = uniformbuffer_.GetUniform<Matrix4f>("viewMatrix");
-    Matrix4f projection_matrix =
-        uniformbuffer_.GetUniform<Matrix4f>("projectionMatrix");
-    fallback_mvp = projection_matrix * view_matrix * fallback_model;
-    fallback_normal =
-        glm::transpose(glm::inverse(Matrix3f(fallback_model)));
-    model_ptr = &fallback_model;
-    mvp_ptr = &fallback_mvp;
+    fallback_normal = glm::transpose(glm::inverse(
+        Matrix3f(uniformbuffer_.GetUniform<Matrix4f>("modelMatrix"))));
     normal_ptr = &fallback_normal;
   }
 
-  const Matrix4f& model_matrix = *model_ptr;
-  const Matrix4f& mvp_matrix = *mvp_ptr;
   const Matrix3f& normal_matrix = *normal_ptr;
 
-  const Vector4f position = vertex.GetPosition();
-  Vector4f world_position = model_matrix * position;
   Vector3f transformed_normal = normal_matrix * vertex.GetNormal();
 
-  // 将世界空间位置写入共享数据供片元阶段使用
-  sharedDataInShader_.fragPos_varying = Vector3f(world_position);
-
-  // 计算裁剪空间坐标
-  Vector4f clip_position = mvp_matrix * position;
-
   // 返回变换后的顶点（包含变换后的法向量和裁剪坐标）
   return Vertex(clip_position, transformed_normal, vertex.GetTexCoords(),
                 vertex.GetColor(),
                 clip_position);  // 同时保存裁剪空间坐标用于后续裁剪
 }
 
+Vertex Shader::WorldVertexShader(const Vertex& world_vertex,
+                                 const Vector4f& clip_position) {
+  return Vertex(clip_position, world_vertex.GetNormal(),
+                world_vertex.GetTexCoords(), world_vertex.GetColor(),
+                clip_position);
+}
+
 void Shader::UpdateMatrixCache(const std::string& name,
                                const Matrix4f& value) {
   if (name == "modelMatrix") {
@@ -127,6 +123,8 @@ void Shader::RecalculateDerivedMatrices() {
   // 预计算 Model-View、MVP 以及法线矩阵，供顶点着色器复用
   vertex_uniform_cache_.model_view =
       vertex_uniform_cache_.view * vertex_uniform_cache_.model;
+  vertex_uniform_cache_.view_projection =
+      vertex_uniform_cache_.projection * vertex_uniform_cache_.view;
   vertex_uniform_cache_.mvp = vertex_uniform_cache_.projection *
                               vertex_uniform_cache_.model_view;
   vertex_uniform_cache_.normal = glm::transpose(glm::inverse(
@@ -185,6 +183,38 @@ void Shader::PrepareUniformCaches() {
   PrepareFragmentUniformCache();
 }
 
+Matrix4f Shader::GetMVPMatrix() const {
+  if (vertex_uniform_cache_.derived_valid) {
+    return vertex_uniform_cache_.mvp;
+  }
+  return uniformbuffer_.GetUniform<Matrix4f>("projectionMatrix") *
+         uniformbuffer_.GetUniform<Matrix4f>("viewMatrix") *
+         uniformbuffer_.GetUniform<Matrix4f>("modelMatrix");
+}
+
+Matrix4f Shader::GetModelViewMatrix() const {
+  if (vertex_uniform_cache_.derived_valid) {
+    return vertex_uniform_cache_.model_view;
+  }
+  return uniformbuffer_.GetUniform<Matrix4f>("viewMatrix") *
+         uniformbuffer_.GetUniform<Matrix4f>("modelMatrix");
+}
+
+Matrix4f Shader::GetModelMatrix() const {
+  if (vertex_uniform_cache_.derived_valid) {
+    return vertex_uniform_cache_.model;
+  }
+  return uniformbuffer_.GetUniform<Matrix4f>("modelMatrix");
+}
+
+Matrix4f Shader::GetViewProjectionMatrix() const {
+  if (vertex_uniform_cache_.derived_valid) {
+    return vertex_uniform_cache_.view_projection;
+  }
+  return uniformbuffer_.GetUniform<Matrix4f>("projectionMatrix") *
+         uniformbuffer_.GetUniform<Matrix4f>("viewMatrix");
+}
+
 void Shader::PrepareVertexUniformCache() {
   if (vertex_uniform_cache_.derived_valid) {
     return;
@@ -297,8 +327,21 @@ Color Shader::FragmentShader(const Fragment& fragment) const {
 
   // 输入插值属性
   Vector3f base_color = color_to_vec(fragment.color);
+
+  // 未声明法线：不做光照，输出基础色
+  if ((varyings_ & kVaryingNormal) == 0) {
+    const Material& unlit_material = *fragment.material;
+    Vector3f unlit_rgb = unlit_material.diffuse;
+    if ((varyings_ & kVaryingTexCoords) != 0 &&
+        unlit_material.has_diffuse_texture) {
+      unlit_rgb = SampleTexture(unlit_material.diffuse_texture, fragment);
+    } else if ((varyings_ & kVaryingColor) != 0) {
+      unlit_rgb = base_color;
+    }
+    unlit_rgb = glm::clamp(unlit_rgb, 0.0f, 1.0f);
+    return Color(unlit_rgb.x, unlit_rgb.y, unlit_rgb.z, 1.0f);
+  }
   Vector3f normal = glm::normalize(fragment.normal);
-  Vector2f uv = fragment.uv;
 
   // uniform（优先缓存）
   std::vector<Light> lights;
@@ -320,19 +363,35 @@ Color Shader::FragmentShader(const Fragment& fragment) const {
     camera_pos = uniformbuffer_.GetUniform<Vector3f>("cameraPos");
   }
 
-  Material material = *fragment.material;
+  const Material& material = *fragment.material;
 
   // 视线方向
-  Vector3f view_dir = glm::normalize(sharedDataInShader_.fragPos_varying - camera_pos);
-
-  // ambient（只计算一次，使用纹理或顶点颜色）
-  Vector3f ambient_rgb;
-  if (material.has_ambient_texture) {
-    ambient_rgb = color_to_vec(SampleTexture(material.ambient_texture, uv));
-  } else {
+  Vector3f view_dir = glm::normalize(fragment.world_position - camera_pos);
+
+  // 与无光照分支相同：仅在声明 uv 时采样纹理，未声明颜色时以材质常量代替
+  // 顶点颜色（未声明的变量不插值，fragment 中为默认值）
+  const bool has_uv = (varyings_ & kVaryingTexCoords) != 0;
+  const bool has_color = (varyings_ & kVaryingColor) != 0;
+
+  // ambient（只计算一次，使用纹理、顶点颜色或材质常量）
+  Vector3f ambient_rgb = material.ambient;
+  if (has_uv && material.has_ambient_texture) {
+    ambient_rgb = SampleTexture(material.ambient_texture, fragment);
+  } else if (has_color) {
     ambient_rgb = base_color;
   }
 
+  // 漫反射 / 高光系数与光源无关，纹理每片段只采样一次
+  Vector3f kd = material.diffuse;
+  if (has_uv && material.has_diffuse_texture) {
+    kd = SampleTexture(material.diffuse_texture, fragment);
+  } else if (has_color) {
+    kd = base_color;
+  }
+  const Vector3f ks = has_uv && material.has_specular_texture
+                          ? SampleTexture(material.specular_texture, fragment)
+                          : Vector3f(1.0f);
+
   // diffuse/specular 累加（float 归一化空间，避免 8bit 溢出与截断）
   Vector3f diffuse_accum(0.0f);
   Vector3f specular_accum(0.0f);
@@ -341,18 +400,12 @@ Color Shader::FragmentShader(const Fragment& fragment) const {
     float intensity = std::max(glm::dot(normal, ldir), 0.0f);
 
     // diffuse
-    Vector3f kd = material.has_diffuse_texture
-                      ? color_to_vec(SampleTexture(material.diffuse_texture, uv))
-                      : base_color;
     diffuse_accum += kd * intensity;
 
     // specular
     Vector3f halfVector = glm::normalize(ldir + view_dir);
     float cos_theta = std::max(glm::dot(normal, halfVector), 0.0f);
     float spec = EvaluateSpecular(cos_theta, material.shininess);
-    Vector3f ks = material.has_specular_texture
-                      ? color_to_vec(SampleTexture(material.specular_texture, uv))
-                      : Vector3f(1.0f);
     specular_accum += ks * spec;
   }
 
@@ -372,26 +425,10 @@ uint8_t FloatToUint8_t(float val) {
 }
 
 // SampleTexture
-// 纹理采样
-Color Shader::SampleTexture(const Texture& texture, const Vector2f& uv) const {
-  // wrap u,v to [0. 1]
-  // 将 u, v 包装到 [0. 1]
-  auto u = uv.x - std::floor(uv.x);
-  auto v = uv.y - std::floor(uv.y);
-
-  // convert u,v to pixel space coordinates
-  // 将 u, v 转换为像素空间坐标
-  auto x = static_cast<int>(u * texture.width);
-  auto y = static_cast<int>(v * texture.height);
-
-  // Ensure x, y are within bounds
-  // 确保 x, y 在范围内
-  x = std::clamp(x, 0, texture.width - 1);
-  y = std::clamp(y, 0, texture.height - 1);
-
-  // Get pixel color
-  // 获取像素颜色
-  return texture.GetPixel(x, y);
+// 纹理采样：LOD 由片段所在 2x2 quad 的 uv 差分决定
+Vector3f Shader::SampleTexture(const Texture& texture,
+                               const Fragment& fragment) const {
+  return texture.Sample(fragment.uv, fragment.uv_dx, fragment.uv_dy);
 }
 
 Color Shader::ClampColor(const Color color) const {
@@ -0,0 +1,131 @@
+#include "skinning.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace simple_renderer {
+
+namespace {
+
+inline Vector3f Interpolate(const Vector3f &a, const Vector3f &b, float t) {
+  return glm::mix(a, b, t);
+}
+
+inline Quaternion Interpolate(const Quaternion &a, const Quaternion &b,
+                              float t) {
+  return glm::normalize(glm::slerp(a, b, t));
+}
+
+/// 在关键帧序列上插值，区间外取端点值
+template <class T>
+T SampleKeys(const std::vector<Keyframe<T>> &keys, float time,
+             const T &fallback) {
+  if (keys.empty()) {
+    return fallback;
+  }
+  if (time <= keys.front().time) {
+    return keys.front().value;
+  }
+  if (time >= keys.back().time) {
+    return keys.back().value;
+  }
+  const auto next = std::upper_bound(
+      keys.begin(), keys.end(), time,
+      [](float t, const Keyframe<T> &key) { return t < key.time; });
+  const auto prev = next - 1;
+  const float span = next->time - prev->time;
+  const float t = span > 0.0f ? (time - prev->time) / span : 0.0f;
+  return Interpolate(prev->value, next->value, t);
+}
+
+}  // namespace
+
+void SkinWeights::push_back(const uint16_t *joints, const float *weights) {
+  for (size_t k = 0; k < kMaxBoneInfluences; ++k) {
+    joints_[k].push_back(joints[k]);
+    weights_[k].push_back(weights[k]);
+  }
+}
+
+void SkinWeights::PadTo(size_t n) {
+  for (size_t k = 0; k < kMaxBoneInfluences; ++k) {
+    joints_[k].resize(std::max(n, joints_[k].size()), 0);
+    weights_[k].resize(std::max(n, weights_[k].size()), 0.0f);
+  }
+}
+
+void SkinWeights::AppendFrom(const SkinWeights &other, size_t index) {
+  for (size_t k = 0; k < kMaxBoneInfluences; ++k) {
+    joints_[k].push_back(other.joints_[k][index]);
+    weights_[k].push_back(other.weights_[k][index]);
+  }
+}
+
+void SkinWeights::Permute(size_t base, const std::vector<uint32_t> &remap) {
+  std::vector<uint16_t> joints(remap.size());
+  std::vector<float> weights(remap.size());
+  for (size_t k = 0; k < kMaxBoneInfluences; ++k) {
+    for (size_t v = 0; v < remap.size(); ++v) {
+      joints[remap[v]] = joints_[k][base + v];
+      weights[remap[v]] = weights_[k][base + v];
+    }
+    std::copy(joints.begin(), joints.end(), joints_[k].begin() + base);
+    std::copy(weights.begin(), weights.end(), weights_[k].begin() + base);
+  }
+}
+
+Matrix4f SampleNodeChannel(const NodeChannel &channel, float time,
+                           const Matrix4f &rest) {
+  // 缺少的分量取自原局部变换（假设无切变）
+  const Vector3f rest_translation(rest[3]);
+  const Vector3f rest_scale(glm::length(Vector3f(rest[0])),
+                            glm::length(Vector3f(rest[1])),
+                            glm::length(Vector3f(rest[2])));
+  Quaternion rest_rotation(1.0f, 0.0f, 0.0f, 0.0f);
+  if (channel.rotations.empty() && rest_scale.x > 0.0f &&
+      rest_scale.y > 0.0f && rest_scale.z > 0.0f) {
+    const Matrix3f basis(Vector3f(rest[0]) / rest_scale.x,
+                         Vector3f(rest[1]) / rest_scale.y,
+                         Vector3f(rest[2]) / rest_scale.z);
+    rest_rotation = glm::quat_cast(basis);
+  }
+
+  const Vector3f translation =
+      SampleKeys(channel.positions, time, rest_translation);
+  const Quaternion rotation = SampleKeys(channel.rotations, time, rest_rotation);
+  const Vector3f scale = SampleKeys(channel.scales, time, rest_scale);
+
+  // T * R * S
+  Matrix4f local = glm::mat4_cast(rotation);
+  local[0] *= scale.x;
+  local[1] *= scale.y;
+  local[2] *= scale.z;
+  local[3] = Vector4f(translation, 1.0f);
+  return local;
+}
+
+void SampleMorphChannel(const MorphChannel &channel, float time,
+                        std::vector<float> &weights) {
+  if (channel.times.empty()) {
+    return;
+  }
+  size_t prev = 0;
+  size_t next = 0;
+  float t = 0.0f;
+  if (time >= channel.times.back()) {
+    prev = next = channel.times.size() - 1;
+  } else if (time > channel.times.front()) {
+    next = static_cast<size_t>(
+        std::upper_bound(channel.times.begin(), channel.times.end(), time) -
+        channel.times.begin());
+    prev = next - 1;
+    const float span = channel.times[next] - channel.times[prev];
+    t = span > 0.0f ? (time - channel.times[prev]) / span : 0.0f;
+  }
+  for (size_t i = 0; i < channel.target_count; ++i) {
+    weights[channel.target_offset + i] =
+        glm::mix(channel.weights[prev][i], channel.weights[next][i], t);
+  }
+}
+
+}  // namespace simple_renderer
@@ -0,0 +1,383 @@
+#include "vertex_kernel.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "raster_kernel.hpp"
+#include "vertex_kernel_lanes.hpp"
+
+namespace simple_renderer {
+
+#define SIMPLE_RENDERER_TRANSFORM_LANES TransformLanesDefault
+#include "vertex_kernel_lanes.inc"
+
+namespace {
+
+constexpr size_t N = kVertexBatchSize;
+
+/// 本机可用的最快位置内核（首次调用时按 CPUID 检测并缓存）
+TransformLanesFn GetTransformLanes() {
+  static const TransformLanesFn kernel = []() -> TransformLanesFn {
+#if defined(SIMPLE_RENDERER_X86_KERNELS)
+    switch (DetectRasterIsa()) {
+      case RasterIsa::kAvx512:
+        SPDLOG_INFO("vertex kernel: avx512");
+        return TransformLanesAvx512;
+      case RasterIsa::kAvx2:
+        SPDLOG_INFO("vertex kernel: avx2");
+        return TransformLanesAvx2;
+      case RasterIsa::kSse42:
+      case RasterIsa::kScalar:
+        break;
+    }
+#endif
+    SPDLOG_INFO("vertex kernel: default");
+    return TransformLanesDefault;
+  }();
+  return kernel;
+}
+
+/// 写回 [begin, end) 内的通道
+void StoreLanes(const PositionLanes &lanes, size_t first, size_t begin,
+                size_t end, VertexSoA &soa) {
+  for (size_t i = begin; i < end; ++i) {
+    const size_t l = i - first;
+    soa.pos_clip[i] = Vector4f(lanes.cx[l], lanes.cy[l], lanes.cz[l],
+                               lanes.cw[l]);
+    soa.pos_screen[i] = Vector4f(lanes.sx[l], lanes.sy[l], lanes.sz[l],
+                                 lanes.sw[l]);
+    soa.clip_code[i] = static_cast<uint8_t>(lanes.code[l]);
+  }
+}
+
+}  // namespace
+
+std::vector<Matrix4f> BuildPositionMatrices(const Matrix4f &mvp,
+                                            const VertexStreams &vertices) {
+  if (vertices.GetFormat() == VertexFormat::kFloat) {
+    return {mvp};
+  }
+  std::vector<Matrix4f> matrices;
+  matrices.reserve(vertices.GetSegments().size());
+  for (const auto &segment : vertices.GetSegments()) {
+    Matrix4f m = mvp;
+    m[3] = mvp * Vector4f(segment.offset, 1.0f);
+    m[0] *= segment.scale.x;
+    m[1] *= segment.scale.y;
+    m[2] *= segment.scale.z;
+    matrices.push_back(m);
+  }
+  return matrices;
+}
+
+void TransformVertexBatch(const std::vector<Matrix4f> &matrices,
+                          const VertexStreams &vertices, size_t first,
+                          size_t begin, size_t end,
+                          const ViewportParams &viewport, VertexSoA &soa) {
+  PositionLanes lanes;
+  if (vertices.GetFormat() == VertexFormat::kFloat) {
+    // 位置流按批宽度对齐并填充，整批加载不会越界
+    GetTransformLanes()(matrices[0], vertices.GetPositionX() + first,
+                        vertices.GetPositionY() + first,
+                        vertices.GetPositionZ() + first, viewport, lanes);
+    StoreLanes(lanes, first, begin, end, soa);
+    return;
+  }
+
+  // kCompact：16 位坐标转换为 float，反量化已折叠进各段矩阵
+  const uint16_t *qx = vertices.GetQuantizedX() + first;
+  const uint16_t *qy = vertices.GetQuantizedY() + first;
+  const uint16_t *qz = vertices.GetQuantizedZ() + first;
+  alignas(32) float px[N], py[N], pz[N];
+#pragma omp simd aligned(qx, qy, qz : 16)
+  for (size_t l = 0; l < N; ++l) {
+    px[l] = static_cast<float>(qx[l]);
+    py[l] = static_cast<float>(qy[l]);
+    pz[l] = static_cast<float>(qz[l]);
+  }
+  // 批跨越量化段边界时按段分别变换
+  const auto &segments = vertices.GetSegments();
+  while (begin < end) {
+    const size_t s = vertices.FindSegment(begin);
+    const size_t segment_end = std::min(end, segments[s].end);
+    GetTransformLanes()(matrices[s], px, py, pz, viewport, lanes);
+    StoreLanes(lanes, first, begin, segment_end, soa);
+    begin = segment_end;
+  }
+}
+
+void DecodeAttributeBatch(const VertexStreams &vertices, size_t first,
+                          size_t begin, size_t end, VertexSoA &soa) {
+  const auto &colors = vertices.GetColors();
+  if (vertices.GetFormat() == VertexFormat::kFloat) {
+    const auto &normals = vertices.GetNormals();
+    const auto &uvs = vertices.GetTexCoords();
+    for (size_t i = begin; i < end; ++i) {
+      soa.normal[i] = normals[i];
+      soa.uv[i] = uvs[i];
+      soa.color[i] = colors[i];
+    }
+    return;
+  }
+
+  const uint32_t *oct = vertices.GetOctNormals() + first;
+  const uint32_t *half_uv = vertices.GetHalfTexCoords() + first;
+  alignas(32) float nx[N], ny[N], nz[N], u[N], v[N];
+#pragma omp simd aligned(oct, half_uv : 32)
+  for (size_t l = 0; l < N; ++l) {
+    const Vector3f n = DecodeOctahedral(oct[l]);
+    nx[l] = n.x;
+    ny[l] = n.y;
+    nz[l] = n.z;
+    u[l] = HalfToFloat(static_cast<uint16_t>(half_uv[l] & 0xffffu));
+    v[l] = HalfToFloat(static_cast<uint16_t>(half_uv[l] >> 16));
+  }
+  for (size_t i = begin; i < end; ++i) {
+    const size_t l = i - first;
+    soa.normal[i] = Vector3f(nx[l], ny[l], nz[l]);
+    soa.uv[i] = Vector2f(u[l], v[l]);
+    soa.color[i] = colors[i];
+  }
+}
+
+void TransformWorldBatch(const std::vector<Matrix4f> &matrices,
+                         const Matrix3f &normal_matrix,
+                         const VertexStreams &vertices, size_t first,
+                         WorldSpaceVertices &out) {
+  alignas(32) float px[N], py[N], pz[N], nx[N], ny[N], nz[N];
+  const size_t count = std::min(N, vertices.size() - first);
+  const bool compact = vertices.GetFormat() == VertexFormat::kCompact;
+  if (compact) {
+    const uint16_t *qx = vertices.GetQuantizedX() + first;
+    const uint16_t *qy = vertices.GetQuantizedY() + first;
+    const uint16_t *qz = vertices.GetQuantizedZ() + first;
+    const uint32_t *oct = vertices.GetOctNormals() + first;
+#pragma omp simd aligned(qx, qy, qz, oct : 16)
+    for (size_t l = 0; l < N; ++l) {
+      px[l] = static_cast<float>(qx[l]);
+      py[l] = static_cast<float>(qy[l]);
+      pz[l] = static_cast<float>(qz[l]);
+      const Vector3f n = DecodeOctahedral(oct[l]);
+      nx[l] = n.x;
+      ny[l] = n.y;
+      nz[l] = n.z;
+    }
+  } else {
+    std::copy_n(vertices.GetPositionX() + first, N, px);
+    std::copy_n(vertices.GetPositionY() + first, N, py);
+    std::copy_n(vertices.GetPositionZ() + first, N, pz);
+    const auto &normals = vertices.GetNormals();
+    for (size_t l = 0; l < N; ++l) {
+      const Vector3f n = l < count ? normals[first + l] : Vector3f(0.0f);
+      nx[l] = n.x;
+      ny[l] = n.y;
+      nz[l] = n.z;
+    }
+  }
+
+  // 位置：仿射变换，批跨越量化段边界时按段分别变换（填充通道使用最后一段）
+  float *wx = out.x.data() + first;
+  float *wy = out.y.data() + first;
+  float *wz = out.z.data() + first;
+  size_t begin = first;
+  while (begin < first + N) {
+    size_t s = 0;
+    size_t segment_end = first + N;
+    if (compact) {
+      s = vertices.FindSegment(std::min(begin, vertices.size() - 1));
+      if (s + 1 < matrices.size()) {
+        segment_end = std::min(segment_end, vertices.GetSegments()[s].end);
+      }
+    }
+    const Matrix4f &m = matrices[s];
+    const float m00 = m[0][0], m01 = m[0][1], m02 = m[0][2];
+    const float m10 = m[1][0], m11 = m[1][1], m12 = m[1][2];
+    const float m20 = m[2][0], m21 = m[2][1], m22 = m[2][2];
+    const float m30 = m[3][0], m31 = m[3][1], m32 = m[3][2];
+#pragma omp simd
+    for (size_t l = begin - first; l < segment_end - first; ++l) {
+      // 与 glm 的 mat4 * vec4 相同的加法顺序，w = 1
+      wx[l] = (m00 * px[l] + m10 * py[l]) + (m20 * pz[l] + m30);
+      wy[l] = (m01 * px[l] + m11 * py[l]) + (m21 * pz[l] + m31);
+      wz[l] = (m02 * px[l] + m12 * py[l]) + (m22 * pz[l] + m32);
+    }
+    begin = segment_end;
+  }
+
+  // 法线：与 glm 的 mat3 * vec3 相同的加法顺序
+  const float n00 = normal_matrix[0][0], n01 = normal_matrix[0][1],
+              n02 = normal_matrix[0][2];
+  const float n10 = normal_matrix[1][0], n11 = normal_matrix[1][1],
+              n12 = normal_matrix[1][2];
+  const float n20 = normal_matrix[2][0], n21 = normal_matrix[2][1],
+              n22 = normal_matrix[2][2];
+  alignas(32) float ox[N], oy[N], oz[N];
+#pragma omp simd
+  for (size_t l = 0; l < N; ++l) {
+    ox[l] = n00 * nx[l] + n10 * ny[l] + n20 * nz[l];
+    oy[l] = n01 * nx[l] + n11 * ny[l] + n21 * nz[l];
+    oz[l] = n02 * nx[l] + n12 * ny[l] + n22 * nz[l];
+  }
+  for (size_t l = 0; l < count; ++l) {
+    out.normal[first + l] = Vector3f(ox[l], oy[l], oz[l]);
+  }
+}
+
+void TransformVertexBatch(const Matrix4f &view_projection,
+                          const WorldSpaceVertices &world, size_t first,
+                          size_t begin, size_t end,
+                          const ViewportParams &viewport, VertexSoA &soa) {
+  PositionLanes lanes;
+  GetTransformLanes()(view_projection, world.x.data() + first,
+                      world.y.data() + first, world.z.data() + first,
+                      viewport, lanes);
+  StoreLanes(lanes, first, begin, end, soa);
+}
+
+void DecodeAttributeBatch(const VertexStreams &vertices,
+                          const WorldSpaceVertices &world, size_t first,
+                          size_t begin, size_t end, VertexSoA &soa) {
+  const auto &colors = vertices.GetColors();
+  if (vertices.GetFormat() == VertexFormat::kFloat) {
+    const auto &uvs = vertices.GetTexCoords();
+    for (size_t i = begin; i < end; ++i) {
+      soa.normal[i] = world.normal[i];
+      soa.uv[i] = uvs[i];
+      soa.color[i] = colors[i];
+    }
+    return;
+  }
+
+  const uint32_t *half_uv = vertices.GetHalfTexCoords() + first;
+  alignas(32) float u[N], v[N];
+#pragma omp simd aligned(half_uv : 32)
+  for (size_t l = 0; l < N; ++l) {
+    u[l] = HalfToFloat(static_cast<uint16_t>(half_uv[l] & 0xffffu));
+    v[l] = HalfToFloat(static_cast<uint16_t>(half_uv[l] >> 16));
+  }
+  for (size_t i = begin; i < end; ++i) {
+    const size_t l = i - first;
+    soa.normal[i] = world.normal[i];
+    soa.uv[i] = Vector2f(u[l], v[l]);
+    soa.color[i] = colors[i];
+  }
+}
+
+SkinPalette::SkinPalette(const std::vector<Matrix4f> &bones) {
+  // 无骨骼时（仅含变形目标的模型）以单位阵作为 0 号骨骼，
+  // 内核对权重为 0 的影响仍会读取 m[*][0]
+  if (bones.empty()) {
+    for (auto &element : m) {
+      element.assign(1, 0.0f);
+    }
+    m[0][0] = m[4][0] = m[8][0] = 1.0f;
+    return;
+  }
+  for (auto &element : m) {
+    element.resize(bones.size());
+  }
+  for (size_t b = 0; b < bones.size(); ++b) {
+    for (int c = 0; c < 4; ++c) {
+      for (int r = 0; r < 3; ++r) {
+        m[c * 3 + r][b] = bones[b][c][r];
+      }
+    }
+  }
+}
+
+void DeformVertexBatch(const VertexStreams &bind, const SkinWeights &skin,
+                       const SkinPalette &palette,
+                       const std::vector<MorphBlend> &morphs, size_t begin,
+                       size_t end, VertexStreams &out) {
+  const size_t count = end - begin;
+  alignas(32) float px[N], py[N], pz[N], nx[N], ny[N], nz[N];
+  const auto &bind_normals = bind.GetNormals();
+  for (size_t l = 0; l < count; ++l) {
+    px[l] = bind.GetPositionX()[begin + l];
+    py[l] = bind.GetPositionY()[begin + l];
+    pz[l] = bind.GetPositionZ()[begin + l];
+    nx[l] = bind_normals[begin + l].x;
+    ny[l] = bind_normals[begin + l].y;
+    nz[l] = bind_normals[begin + l].z;
+  }
+
+  // 变形目标：在绑定空间累加加权位移
+  for (const auto &morph : morphs) {
+    const size_t local = begin - morph.target->vertex_offset;
+    const Vector3f *dp = morph.target->position_deltas.data() + local;
+    const Vector3f *dn = morph.target->normal_deltas.data() + local;
+    const float w = morph.weight;
+#pragma omp simd
+    for (size_t l = 0; l < count; ++l) {
+      px[l] += w * dp[l].x;
+      py[l] += w * dp[l].y;
+      pz[l] += w * dp[l].z;
+      nx[l] += w * dn[l].x;
+      ny[l] += w * dn[l].y;
+      nz[l] += w * dn[l].z;
+    }
+  }
+
+  // 线性混合蒙皮：逐通道混合 3x4 矩阵后变换位置与法线
+  const uint16_t *joints[kMaxBoneInfluences];
+  const float *weights[kMaxBoneInfluences];
+  for (size_t k = 0; k < kMaxBoneInfluences; ++k) {
+    joints[k] = skin.GetJoints(k) + begin;
+    weights[k] = skin.GetWeights(k) + begin;
+  }
+  const float *m0 = palette.m[0].data(), *m1 = palette.m[1].data();
+  const float *m2 = palette.m[2].data(), *m3 = palette.m[3].data();
+  const float *m4 = palette.m[4].data(), *m5 = palette.m[5].data();
+  const float *m6 = palette.m[6].data(), *m7 = palette.m[7].data();
+  const float *m8 = palette.m[8].data(), *m9 = palette.m[9].data();
+  const float *m10 = palette.m[10].data(), *m11 = palette.m[11].data();
+  float *ox = out.GetPositionX() + begin;
+  float *oy = out.GetPositionY() + begin;
+  float *oz = out.GetPositionZ() + begin;
+  alignas(32) float rx[N], ry[N], rz[N];
+#pragma omp simd
+  for (size_t l = 0; l < count; ++l) {
+    // 权重和不足 1 的部分为单位阵
+    float residual = 1.0f;
+    for (size_t k = 0; k < kMaxBoneInfluences; ++k) {
+      residual -= weights[k][l];
+    }
+    float a0 = residual, a1 = 0.0f, a2 = 0.0f;
+    float a3 = 0.0f, a4 = residual, a5 = 0.0f;
+    float a6 = 0.0f, a7 = 0.0f, a8 = residual;
+    float a9 = 0.0f, a10 = 0.0f, a11 = 0.0f;
+    for (size_t k = 0; k < kMaxBoneInfluences; ++k) {
+      const uint16_t j = joints[k][l];
+      const float w = weights[k][l];
+      a0 += w * m0[j];
+      a1 += w * m1[j];
+      a2 += w * m2[j];
+      a3 += w * m3[j];
+      a4 += w * m4[j];
+      a5 += w * m5[j];
+      a6 += w * m6[j];
+      a7 += w * m7[j];
+      a8 += w * m8[j];
+      a9 += w * m9[j];
+      a10 += w * m10[j];
+      a11 += w * m11[j];
+    }
+    ox[l] = a0 * px[l] + a3 * py[l] + a6 * pz[l] + a9;
+    oy[l] = a1 * px[l] + a4 * py[l] + a7 * pz[l] + a10;
+    oz[l] = a2 * px[l] + a5 * py[l] + a8 * pz[l] + a11;
+    const float tx = a0 * nx[l] + a3 * ny[l] + a6 * nz[l];
+    const float ty = a1 * nx[l] + a4 * ny[l] + a7 * nz[l];
+    const float tz = a2 * nx[l] + a5 * ny[l] + a8 * nz[l];
+    const float length2 = tx * tx + ty * ty + tz * tz;
+    const float inv_length = length2 > 0.0f ? 1.0f / std::sqrt(length2) : 0.0f;
+    rx[l] = tx * inv_length;
+    ry[l] = ty * inv_length;
+    rz[l] = tz * inv_length;
+  }
+  auto &out_normals = out.GetNormals();
+  for (size_t l = 0; l < count; ++l) {
+    out_normals[begin + l] = Vector3f(rx[l], ry[l], rz[l]);
+  }
+}
+
+}  // namespace simple_renderer
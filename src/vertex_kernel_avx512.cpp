@@ -0,0 +1,12 @@
+#if defined(SIMPLE_RENDERER_X86_KERNELS)
+
+#include "vertex_kernel_lanes.hpp"
+
+namespace simple_renderer {
+
+#define SIMPLE_RENDERER_TRANSFORM_LANES TransformLanesAvx512
+#include "vertex_kernel_lanes.inc"
+
+}  // namespace simple_renderer
+
+#endif  // defined(SIMPLE_RENDERER_X86_KERNELS)
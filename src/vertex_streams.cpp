@@ -0,0 +1,209 @@
+#include "vertex_streams.hpp"
+
+#include <limits>
+#include <stdexcept>
+
+#include "log_system.h"
+
+namespace simple_renderer {
+
+namespace {
+
+/// 16 位量化的最大值
+inline constexpr float kQuantizedMax = 65535.0f;
+
+inline uint16_t Quantize(float value, float offset, float scale) {
+  if (scale <= 0.0f) {
+    return 0;
+  }
+  const float q = std::round((value - offset) / scale);
+  return static_cast<uint16_t>(std::clamp(q, 0.0f, kQuantizedMax));
+}
+
+inline int16_t ToSnorm16(float value) {
+  return static_cast<int16_t>(
+      std::round(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+}
+
+}  // namespace
+
+uint16_t FloatToHalf(float value) {
+  uint32_t bits = std::bit_cast<uint32_t>(value);
+  const auto sign = static_cast<uint16_t>((bits >> 16) & 0x8000u);
+  bits &= 0x7fffffffu;
+
+  // 溢出为无穷大，NaN 保持为 NaN
+  if (bits >= 0x47800000u) {
+    return static_cast<uint16_t>(sign |
+                                 (bits > 0x7f800000u ? 0x7e00u : 0x7c00u));
+  }
+  // 非规格化数：借助浮点加法完成舍入
+  if (bits < 0x38800000u) {
+    const uint32_t rounded =
+        std::bit_cast<uint32_t>(std::bit_cast<float>(bits) + 0.5f);
+    return static_cast<uint16_t>(sign | (rounded - 0x3f000000u));
+  }
+  // 规格化数：重设指数偏移并就近舍入到偶数
+  const uint32_t mantissa_odd = (bits >> 13) & 1u;
+  bits += 0xc8000fffu + mantissa_odd;
+  return static_cast<uint16_t>(sign | (bits >> 13));
+}
+
+uint32_t EncodeOctahedral(const Vector3f &normal) {
+  const float l1 = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+  if (l1 <= 0.0f) {
+    return 0;  // 退化法线编码为 +Z
+  }
+  float x = normal.x / l1;
+  float y = normal.y / l1;
+  // 下半球折叠到外侧三角形
+  if (normal.z < 0.0f) {
+    const float fx = (1.0f - std::abs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+    const float fy = (1.0f - std::abs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+    x = fx;
+    y = fy;
+  }
+  return static_cast<uint32_t>(static_cast<uint16_t>(ToSnorm16(x))) |
+         (static_cast<uint32_t>(static_cast<uint16_t>(ToSnorm16(y))) << 16);
+}
+
+void VertexStreams::reserve(size_t n) {
+  const size_t padded = PaddedSize(n);
+  x_.reserve(padded);
+  y_.reserve(padded);
+  z_.reserve(padded);
+  normal_.reserve(n);
+  uv_.reserve(n);
+  color_.reserve(n);
+}
+
+void VertexStreams::push_back(const Vertex &vertex) {
+  if (format_ != VertexFormat::kFloat) {
+    SPDLOG_ERROR("push_back on compact vertex streams");
+    throw std::runtime_error("push_back on compact vertex streams");
+  }
+  const size_t index = size();
+  normal_.push_back(vertex.GetNormal());
+  uv_.push_back(vertex.GetTexCoords());
+  color_.push_back(vertex.GetColor());
+  const size_t padded = PaddedSize(size());
+  x_.resize(padded, 0.0f);
+  y_.resize(padded, 0.0f);
+  z_.resize(padded, 0.0f);
+  Set(index, vertex);
+}
+
+void VertexStreams::Set(size_t index, const Vertex &vertex) {
+  if (format_ != VertexFormat::kFloat) {
+    SPDLOG_ERROR("Set on compact vertex streams");
+    throw std::runtime_error("Set on compact vertex streams");
+  }
+  const Vector4f position = vertex.GetPosition();
+  x_[index] = position.x;
+  y_[index] = position.y;
+  z_[index] = position.z;
+  normal_[index] = vertex.GetNormal();
+  uv_[index] = vertex.GetTexCoords();
+  color_[index] = vertex.GetColor();
+}
+
+Vertex VertexStreams::Get(size_t index) const {
+  if (format_ == VertexFormat::kFloat) {
+    return Vertex(Vector4f(GetPosition(index), 1.0f), normal_[index],
+                  uv_[index], color_[index]);
+  }
+  const uint32_t uv = uv_half_[index];
+  return Vertex(Vector4f(GetPosition(index), 1.0f),
+                DecodeOctahedral(normal_oct_[index]),
+                Vector2f(HalfToFloat(static_cast<uint16_t>(uv & 0xffffu)),
+                         HalfToFloat(static_cast<uint16_t>(uv >> 16))),
+                color_[index]);
+}
+
+Vector3f VertexStreams::GetPosition(size_t index) const {
+  if (format_ == VertexFormat::kFloat) {
+    return Vector3f(x_[index], y_[index], z_[index]);
+  }
+  const PositionSegment &segment = segments_[FindSegment(index)];
+  return segment.offset +
+         segment.scale * Vector3f(qx_[index], qy_[index], qz_[index]);
+}
+
+size_t VertexStreams::FindSegment(size_t index) const {
+  const auto it = std::upper_bound(
+      segments_.begin(), segments_.end(), index,
+      [](size_t i, const PositionSegment &s) { return i < s.end; });
+  return static_cast<size_t>(it - segments_.begin());
+}
+
+void VertexStreams::Compress(const std::vector<size_t> &segment_offsets) {
+  if (format_ == VertexFormat::kCompact) {
+    return;
+  }
+  const size_t n = size();
+  const size_t padded = PaddedSize(n);
+
+  // 量化段：按偏移升序覆盖 [0, n)，空段跳过
+  std::vector<size_t> bounds{0};
+  for (const size_t offset : segment_offsets) {
+    if (offset > bounds.back() && offset < n) {
+      bounds.push_back(offset);
+    }
+  }
+  bounds.push_back(n);
+  segments_.clear();
+  for (size_t s = 0; s + 1 < bounds.size(); ++s) {
+    if (bounds[s] == bounds[s + 1]) continue;
+    PositionSegment segment;
+    segment.begin = bounds[s];
+    segment.end = bounds[s + 1];
+    Vector3f bmin(std::numeric_limits<float>::max());
+    Vector3f bmax(std::numeric_limits<float>::lowest());
+    for (size_t i = segment.begin; i < segment.end; ++i) {
+      const Vector3f p(x_[i], y_[i], z_[i]);
+      bmin = glm::min(bmin, p);
+      bmax = glm::max(bmax, p);
+    }
+    segment.offset = bmin;
+    segment.scale = (bmax - bmin) / kQuantizedMax;
+    segments_.push_back(segment);
+  }
+
+  qx_.assign(padded, 0);
+  qy_.assign(padded, 0);
+  qz_.assign(padded, 0);
+  normal_oct_.assign(padded, 0);
+  uv_half_.assign(padded, 0);
+  for (const auto &segment : segments_) {
+    for (size_t i = segment.begin; i < segment.end; ++i) {
+      qx_[i] = Quantize(x_[i], segment.offset.x, segment.scale.x);
+      qy_[i] = Quantize(y_[i], segment.offset.y, segment.scale.y);
+      qz_[i] = Quantize(z_[i], segment.offset.z, segment.scale.z);
+    }
+  }
+  for (size_t i = 0; i < n; ++i) {
+    normal_oct_[i] = EncodeOctahedral(normal_[i]);
+    uv_half_[i] = static_cast<uint32_t>(FloatToHalf(uv_[i].x)) |
+                  (static_cast<uint32_t>(FloatToHalf(uv_[i].y)) << 16);
+  }
+
+  // 释放浮点数据流
+  AlignedVector<float>().swap(x_);
+  AlignedVector<float>().swap(y_);
+  AlignedVector<float>().swap(z_);
+  std::vector<Vector3f>().swap(normal_);
+  std::vector<Vector2f>().swap(uv_);
+  format_ = VertexFormat::kCompact;
+}
+
+size_t VertexStreams::GetMemoryBytes() const {
+  return (x_.capacity() + y_.capacity() + z_.capacity()) * sizeof(float) +
+         normal_.capacity() * sizeof(Vector3f) +
+         uv_.capacity() * sizeof(Vector2f) +
+         (qx_.capacity() + qy_.capacity() + qz_.capacity()) *
+             sizeof(uint16_t) +
+         (normal_oct_.capacity() + uv_half_.capacity()) * sizeof(uint32_t) +
+         color_.capacity() * sizeof(Color);
+}
+
+}  // namespace simple_renderer
@@ -105,9 +105,12 @@ int main(int argc, char **argv) {
                       camera.GetProjectionMatrix(60.0f, static_cast<float>(kWidth) / static_cast<float>(kHeight), 0.1f, 100.0f));
 
     buffer.ClearDrawBuffer(simple_renderer::Color::kBlack);
+    // 帧内多个模型共享深度缓冲
+    simple_renderer.BeginFrame();
     for (auto &model : models) {
       simple_renderer.DrawModel(model, shader, buffer.GetDrawBuffer());
     }
+    simple_renderer.EndFrame();
 
     buffer.SwapBuffer();
 
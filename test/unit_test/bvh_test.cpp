@@ -0,0 +1,158 @@
+
+/**
+ * @file bvh_test.cpp
+ * @brief bvh.hpp 测试
+ * @copyright MIT LICENSE
+ * https://github.com/Simple-XX/SimpleRenderer
+ */
+
+#include "bvh.hpp"
+
+#include <cstdint>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace simple_renderer {
+namespace {
+
+/// 两个 AABB 是否相交（含接触）
+bool Overlaps(const Vector3f& a_min, const Vector3f& a_max,
+              const Vector3f& b_min, const Vector3f& b_max) {
+  return a_min.x <= b_max.x && b_min.x <= a_max.x && a_min.y <= b_max.y &&
+         b_min.y <= a_max.y && a_min.z <= b_max.z && b_min.z <= a_max.z;
+}
+
+bool Contains(const Vector3f& outer_min, const Vector3f& outer_max,
+              const Vector3f& inner_min, const Vector3f& inner_max) {
+  return outer_min.x <= inner_min.x && outer_min.y <= inner_min.y &&
+         outer_min.z <= inner_min.z && inner_max.x <= outer_max.x &&
+         inner_max.y <= outer_max.y && inner_max.z <= outer_max.z;
+}
+
+class BvhTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    std::mt19937 rng(28);
+    std::uniform_real_distribution<float> center(-50.0f, 50.0f);
+    std::uniform_real_distribution<float> extent(0.1f, 4.0f);
+    for (int i = 0; i < kItemCount; ++i) {
+      const Vector3f c(center(rng), center(rng), center(rng));
+      const Vector3f e(extent(rng), extent(rng), extent(rng));
+      item_min_.push_back(c - e);
+      item_max_.push_back(c + e);
+    }
+    bvh_.Build(item_min_, item_max_);
+  }
+
+  /// 图元 -> 所在叶子节点
+  std::vector<uint32_t> ItemLeaves() const {
+    std::vector<uint32_t> leaf_of(kItemCount, UINT32_MAX);
+    const auto& nodes = bvh_.GetNodes();
+    for (uint32_t n = 0; n < nodes.size(); ++n) {
+      if (!nodes[n].IsLeaf()) continue;
+      for (uint32_t i = 0; i < nodes[n].count; ++i) {
+        leaf_of[bvh_.GetItemIndices()[nodes[n].first + i]] = n;
+      }
+    }
+    return leaf_of;
+  }
+
+  static constexpr int kItemCount = 513;
+  std::vector<Vector3f> item_min_;
+  std::vector<Vector3f> item_max_;
+  Bvh bvh_;
+};
+
+TEST_F(BvhTest, BuildCoversEveryItemOnce) {
+  ASSERT_FALSE(bvh_.IsEmpty());
+  const auto& nodes = bvh_.GetNodes();
+  const auto& items = bvh_.GetItemIndices();
+  ASSERT_EQ(items.size(), size_t(kItemCount));
+  EXPECT_EQ(std::set<uint32_t>(items.begin(), items.end()).size(),
+            size_t(kItemCount));
+
+  for (const BvhNode& node : nodes) {
+    if (node.IsLeaf()) {
+      for (uint32_t i = 0; i < node.count; ++i) {
+        const uint32_t item = items[node.first + i];
+        EXPECT_TRUE(Contains(node.bounds_min, node.bounds_max,
+                             item_min_[item], item_max_[item]));
+      }
+    } else {
+      ASSERT_LT(node.first + 1, nodes.size());
+      for (const BvhNode& child : {nodes[node.first], nodes[node.first + 1]}) {
+        EXPECT_TRUE(Contains(node.bounds_min, node.bounds_max,
+                             child.bounds_min, child.bounds_max));
+      }
+    }
+  }
+  // 每个图元恰好位于一个叶子
+  for (const uint32_t leaf : ItemLeaves()) EXPECT_NE(leaf, UINT32_MAX);
+}
+
+TEST_F(BvhTest, TraverseVisitsExactlyTheOverlappingLeaves) {
+  const auto& nodes = bvh_.GetNodes();
+  const std::vector<uint32_t> leaf_of = ItemLeaves();
+  std::mt19937 rng(280);
+  std::uniform_real_distribution<float> center(-60.0f, 60.0f);
+  std::uniform_real_distribution<float> extent(0.0f, 20.0f);
+  for (int iter = 0; iter < 200; ++iter) {
+    const Vector3f c(center(rng), center(rng), center(rng));
+    const Vector3f e(extent(rng), extent(rng), extent(rng));
+    const Vector3f q_min = c - e, q_max = c + e;
+
+    std::vector<int> visits(kItemCount, 0);
+    bvh_.Traverse(
+        [&](const Vector3f& bmin, const Vector3f& bmax) {
+          return !Overlaps(bmin, bmax, q_min, q_max);
+        },
+        [&](uint32_t item) { ++visits[item]; });
+
+    // 访问的叶子 = 包围盒与查询相交的叶子，叶子内图元各访问一次
+    std::set<uint32_t> expected_leaves;
+    for (uint32_t n = 0; n < nodes.size(); ++n) {
+      if (nodes[n].IsLeaf() &&
+          Overlaps(nodes[n].bounds_min, nodes[n].bounds_max, q_min, q_max)) {
+        expected_leaves.insert(n);
+      }
+    }
+    std::set<uint32_t> visited_leaves;
+    for (int item = 0; item < kItemCount; ++item) {
+      ASSERT_LE(visits[item], 1) << item;
+      if (visits[item] == 1) visited_leaves.insert(leaf_of[item]);
+      // 与查询相交的图元一定被访问
+      if (Overlaps(item_min_[item], item_max_[item], q_min, q_max)) {
+        EXPECT_EQ(visits[item], 1) << item;
+      }
+    }
+    EXPECT_EQ(visited_leaves, expected_leaves) << iter;
+    for (const uint32_t leaf : visited_leaves) {
+      for (uint32_t i = 0; i < nodes[leaf].count; ++i) {
+        EXPECT_EQ(visits[bvh_.GetItemIndices()[nodes[leaf].first + i]], 1);
+      }
+    }
+  }
+}
+
+TEST_F(BvhTest, CulledRootVisitsNothing) {
+  int visits = 0;
+  bvh_.Traverse([](const Vector3f&, const Vector3f&) { return true; },
+                [&](uint32_t) { ++visits; });
+  EXPECT_EQ(visits, 0);
+}
+
+TEST(BvhEmptyTest, EmptyBuildTraversesNothing) {
+  Bvh bvh;
+  bvh.Build({}, {});
+  EXPECT_TRUE(bvh.IsEmpty());
+  int visits = 0;
+  bvh.Traverse([](const Vector3f&, const Vector3f&) { return false; },
+               [&](uint32_t) { ++visits; });
+  EXPECT_EQ(visits, 0);
+}
+
+}  // namespace
+}  // namespace simple_renderer
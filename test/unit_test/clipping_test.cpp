@@ -0,0 +1,254 @@
+
+/**
+ * @file clipping_test.cpp
+ * @brief clipping.hpp 测试
+ * @copyright MIT LICENSE
+ * https://github.com/Simple-XX/SimpleRenderer
+ */
+
+#include "clipping.hpp"
+
+#include <random>
+
+#include "gtest/gtest.h"
+
+namespace simple_renderer {
+namespace {
+
+constexpr float kEpsilon = 1e-5f;
+
+/// 与 RendererBase::ClipTriangles 相同的属性混合：按重心权重加权
+template <class T>
+T Blend(const ClipVertex& vertex, const T& a0, const T& a1, const T& a2) {
+  const Vector3f& b = vertex.barycentric;
+  return a0 * b.x + a1 * b.y + a2 * b.z;
+}
+
+/// 顶点位于近平面与全部保护带平面内侧（含误差）
+void ExpectInsideClipVolume(const ClipVertex& vertex) {
+  const Vector4f& p = vertex.position;
+  const float tolerance = kEpsilon * std::max(1.0f, std::abs(p.w));
+  EXPECT_GE(p.z + p.w, -tolerance);
+  EXPECT_GE(kGuardBand * p.w + p.x, -kGuardBand * tolerance);
+  EXPECT_GE(kGuardBand * p.w - p.x, -kGuardBand * tolerance);
+  EXPECT_GE(kGuardBand * p.w + p.y, -kGuardBand * tolerance);
+  EXPECT_GE(kGuardBand * p.w - p.y, -kGuardBand * tolerance);
+}
+
+/// 输出顶点的位置等于原三角形顶点按其重心权重的混合
+void ExpectConsistentBarycentrics(const ClipPolygon& polygon,
+                                  const Vector4f& p0, const Vector4f& p1,
+                                  const Vector4f& p2) {
+  for (size_t k = 0; k < polygon.count; ++k) {
+    const ClipVertex& vertex = polygon.vertices[k];
+    const Vector3f& b = vertex.barycentric;
+    EXPECT_NEAR(b.x + b.y + b.z, 1.0f, kEpsilon);
+    EXPECT_GE(std::min({b.x, b.y, b.z}), -kEpsilon);
+    const Vector4f expected = Blend(vertex, p0, p1, p2);
+    const float scale =
+        std::max({1.0f, std::abs(expected.x), std::abs(expected.y),
+                  std::abs(expected.z), std::abs(expected.w)});
+    for (int c = 0; c < 4; ++c) {
+      EXPECT_NEAR(vertex.position[c], expected[c], kEpsilon * scale);
+    }
+  }
+}
+
+/// 透视除法后的有向面积（x, y 分量）
+float SignedArea(const Vector4f& a, const Vector4f& b, const Vector4f& c) {
+  const Vector2f pa = Vector2f(a) / a.w;
+  const Vector2f pb = Vector2f(b) / b.w;
+  const Vector2f pc = Vector2f(c) / c.w;
+  return 0.5f * ((pb.x - pa.x) * (pc.y - pa.y) - (pb.y - pa.y) * (pc.x - pa.x));
+}
+
+TEST(ClippingTest, TriangleInsideIsUnchanged) {
+  const Vector4f p0(-0.5f, -0.5f, 0.2f, 1.0f);
+  const Vector4f p1(0.5f, -0.5f, 0.3f, 2.0f);
+  const Vector4f p2(0.0f, 0.5f, 0.4f, 3.0f);
+  const ClipPolygon polygon = ClipTriangle(p0, p1, p2);
+  ASSERT_EQ(polygon.count, 3u);
+  EXPECT_EQ(polygon.vertices[0].position, p0);
+  EXPECT_EQ(polygon.vertices[1].position, p1);
+  EXPECT_EQ(polygon.vertices[2].position, p2);
+  EXPECT_EQ(polygon.vertices[0].barycentric, Vector3f(1.0f, 0.0f, 0.0f));
+  EXPECT_EQ(polygon.vertices[1].barycentric, Vector3f(0.0f, 1.0f, 0.0f));
+  EXPECT_EQ(polygon.vertices[2].barycentric, Vector3f(0.0f, 0.0f, 1.0f));
+}
+
+TEST(ClippingTest, OneVertexBehindNearPlaneBecomesQuad) {
+  // p0 在近平面后（z + w = -2），另两个顶点在前
+  const Vector4f p0(0.0f, 0.0f, -4.0f, 2.0f);
+  const Vector4f p1(1.0f, 0.0f, 0.0f, 1.0f);
+  const Vector4f p2(0.0f, 1.0f, 0.0f, 1.0f);
+  const ClipPolygon polygon = ClipTriangle(p0, p1, p2);
+  ASSERT_EQ(polygon.count, 4u);
+  for (size_t k = 0; k < polygon.count; ++k) {
+    ExpectInsideClipVolume(polygon.vertices[k]);
+    EXPECT_GT(polygon.vertices[k].position.w, 0.0f);
+  }
+  ExpectConsistentBarycentrics(polygon, p0, p1, p2);
+
+  // 两个新顶点恰在近平面上，且 p1、p2 原样保留
+  int on_near = 0;
+  bool kept_p1 = false, kept_p2 = false;
+  for (size_t k = 0; k < polygon.count; ++k) {
+    const Vector4f& p = polygon.vertices[k].position;
+    on_near += std::abs(p.z + p.w) < kEpsilon;
+    kept_p1 |= p == p1;
+    kept_p2 |= p == p2;
+  }
+  EXPECT_EQ(on_near, 2);
+  EXPECT_TRUE(kept_p1);
+  EXPECT_TRUE(kept_p2);
+}
+
+TEST(ClippingTest, TwoVerticesBehindNearPlaneStayTriangle) {
+  const Vector4f p0(0.0f, 0.0f, -3.0f, 1.0f);
+  const Vector4f p1(1.0f, 0.0f, -5.0f, 2.0f);
+  const Vector4f p2(0.0f, 1.0f, 0.5f, 1.0f);
+  const ClipPolygon polygon = ClipTriangle(p0, p1, p2);
+  ASSERT_EQ(polygon.count, 3u);
+  int on_near = 0;
+  for (size_t k = 0; k < polygon.count; ++k) {
+    ExpectInsideClipVolume(polygon.vertices[k]);
+    EXPECT_GT(polygon.vertices[k].position.w, 0.0f);
+    const Vector4f& p = polygon.vertices[k].position;
+    on_near += std::abs(p.z + p.w) < kEpsilon;
+  }
+  EXPECT_EQ(on_near, 2);
+  ExpectConsistentBarycentrics(polygon, p0, p1, p2);
+}
+
+TEST(ClippingTest, TriangleFullyOutsideIsRejected) {
+  // 全部在近平面后
+  EXPECT_LT(ClipTriangle({0.0f, 0.0f, -2.0f, 1.0f}, {1.0f, 0.0f, -3.0f, 1.0f},
+                         {0.0f, 1.0f, -4.0f, 1.0f})
+                .count,
+            3u);
+  // 全部在右侧保护带外
+  EXPECT_LT(ClipTriangle({20.0f, 0.0f, 0.0f, 1.0f}, {30.0f, 0.0f, 0.0f, 1.0f},
+                         {25.0f, 1.0f, 0.0f, 1.0f})
+                .count,
+            3u);
+}
+
+TEST(ClippingTest, TriangleSpanningGuardBandIsClippedToIt) {
+  // 两个顶点分别在左右保护带外，三角形穿过整个保护带
+  const Vector4f p0(-40.0f, 0.0f, 0.0f, 1.0f);
+  const Vector4f p1(40.0f, 0.0f, 0.0f, 1.0f);
+  const Vector4f p2(0.0f, 2.0f, 0.0f, 1.0f);
+  const ClipPolygon polygon = ClipTriangle(p0, p1, p2);
+  // 左右各切掉一个角：3 + 2
+  ASSERT_EQ(polygon.count, 5u);
+  int on_left = 0, on_right = 0;
+  for (size_t k = 0; k < polygon.count; ++k) {
+    ExpectInsideClipVolume(polygon.vertices[k]);
+    const Vector4f& p = polygon.vertices[k].position;
+    on_left += std::abs(kGuardBand * p.w + p.x) < kEpsilon * kGuardBand;
+    on_right += std::abs(kGuardBand * p.w - p.x) < kEpsilon * kGuardBand;
+  }
+  EXPECT_EQ(on_left, 2);
+  EXPECT_EQ(on_right, 2);
+  ExpectConsistentBarycentrics(polygon, p0, p1, p2);
+}
+
+TEST(ClippingTest, AttributesBlendedAtClipPoints) {
+  // 边 p1 -> p0 的近平面距离为 1 -> -2，交点参数 t = 1/3
+  const Vector4f p0(0.0f, 0.0f, -4.0f, 2.0f);
+  const Vector4f p1(1.0f, 0.0f, 0.0f, 1.0f);
+  const Vector4f p2(0.0f, 1.0f, 0.0f, 1.0f);
+  const Vector2f uv[] = {{0.0f, 1.0f}, {1.0f, 0.0f}, {0.5f, 0.5f}};
+  const Vector3f normal[] = {
+      {0.0f, 0.0f, 1.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}};
+
+  const ClipPolygon polygon = ClipTriangle(p0, p1, p2);
+  ASSERT_EQ(polygon.count, 4u);
+  bool found_p1_edge = false, found_p2_edge = false;
+  for (size_t k = 0; k < polygon.count; ++k) {
+    const ClipVertex& vertex = polygon.vertices[k];
+    const Vector4f& p = vertex.position;
+    if (std::abs(p.z + p.w) >= kEpsilon) continue;
+    const Vector2f blended_uv = Blend(vertex, uv[0], uv[1], uv[2]);
+    const Vector3f blended_normal =
+        Blend(vertex, normal[0], normal[1], normal[2]);
+    // 交点位于 p0p1 或 p0p2 上，属性等于该边上 t = 1/3 处的线性插值
+    const bool on_p1_edge = std::abs(vertex.barycentric.z) < kEpsilon;
+    const int other = on_p1_edge ? 1 : 2;
+    const Vector4f& po = on_p1_edge ? p1 : p2;
+    const Vector4f expected_position = glm::mix(po, p0, 1.0f / 3.0f);
+    const Vector2f expected_uv = glm::mix(uv[other], uv[0], 1.0f / 3.0f);
+    const Vector3f expected_normal =
+        glm::mix(normal[other], normal[0], 1.0f / 3.0f);
+    for (int c = 0; c < 4; ++c) {
+      EXPECT_NEAR(p[c], expected_position[c], kEpsilon);
+    }
+    EXPECT_NEAR(blended_uv.x, expected_uv.x, kEpsilon);
+    EXPECT_NEAR(blended_uv.y, expected_uv.y, kEpsilon);
+    for (int c = 0; c < 3; ++c) {
+      EXPECT_NEAR(blended_normal[c], expected_normal[c], kEpsilon);
+    }
+    found_p1_edge |= on_p1_edge;
+    found_p2_edge |= !on_p1_edge;
+  }
+  EXPECT_TRUE(found_p1_edge);
+  EXPECT_TRUE(found_p2_edge);
+}
+
+TEST(ClippingTest, FanTriangulationCoversPolygonWithSameWinding) {
+  // 跨越近平面与保护带平面
+  const Vector4f p0(-30.0f, 0.0f, 0.0f, 1.0f);
+  const Vector4f p1(2.0f, -1.0f, -3.0f, 1.0f);
+  const Vector4f p2(0.0f, 30.0f, 0.5f, 1.0f);
+  const ClipPolygon polygon = ClipTriangle(p0, p1, p2);
+  ASSERT_GT(polygon.count, 3u);
+  ASSERT_LE(polygon.count, kMaxClipVertices);
+
+  // 与 ClipTriangles 相同的扇形三角化：count - 2 个三角形，
+  // 朝向与原三角形一致，面积之和等于多边形面积（鞋带公式）
+  const float original = SignedArea(p0, p1, p2);
+  float fan_area = 0.0f;
+  size_t fan_triangles = 0;
+  for (size_t k = 1; k + 1 < polygon.count; ++k) {
+    const float area =
+        SignedArea(polygon.vertices[0].position, polygon.vertices[k].position,
+                   polygon.vertices[k + 1].position);
+    EXPECT_GE(area * original, 0.0f) << k;
+    fan_area += area;
+    ++fan_triangles;
+  }
+  EXPECT_EQ(fan_triangles, polygon.count - 2);
+
+  float shoelace = 0.0f;
+  for (size_t k = 0; k < polygon.count; ++k) {
+    const Vector4f& a = polygon.vertices[k].position;
+    const Vector4f& b = polygon.vertices[(k + 1) % polygon.count].position;
+    shoelace += 0.5f * (a.x / a.w * b.y / b.w - b.x / b.w * a.y / a.w);
+  }
+  EXPECT_NEAR(fan_area, shoelace, 1e-3f * std::abs(shoelace));
+}
+
+TEST(ClippingTest, RandomTrianglesSatisfyClipInvariants) {
+  std::mt19937 rng(39);
+  std::uniform_real_distribution<float> xy(-60.0f, 60.0f);
+  std::uniform_real_distribution<float> z(-4.0f, 4.0f);
+  std::uniform_real_distribution<float> w(0.1f, 3.0f);
+  int clipped = 0;
+  for (int iter = 0; iter < 5000; ++iter) {
+    Vector4f p[3];
+    for (auto& v : p) v = {xy(rng), xy(rng), z(rng), w(rng)};
+    const ClipPolygon polygon = ClipTriangle(p[0], p[1], p[2]);
+    ASSERT_LE(polygon.count, kMaxClipVertices);
+    if (polygon.count < 3) continue;
+    clipped += polygon.count != 3;
+    for (size_t k = 0; k < polygon.count; ++k) {
+      ExpectInsideClipVolume(polygon.vertices[k]);
+    }
+    ExpectConsistentBarycentrics(polygon, p[0], p[1], p[2]);
+    if (HasFailure()) return;
+  }
+  EXPECT_GT(clipped, 500);
+}
+
+}  // namespace
+}  // namespace simple_renderer
@@ -0,0 +1,151 @@
+
+/**
+ * @file depth_pyramid_test.cpp
+ * @brief depth_pyramid.hpp 测试
+ * @copyright MIT LICENSE
+ * https://github.com/Simple-XX/SimpleRenderer
+ */
+
+#include "depth_pyramid.hpp"
+
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace simple_renderer {
+namespace {
+
+/// 参考实现：像素矩形 [x0, x1] x [y0, y1] 内的深度范围
+std::pair<float, float> BruteForceRange(const std::vector<float>& depth,
+                                        size_t width, size_t x0, size_t y0,
+                                        size_t x1, size_t y1) {
+  float lo = depth[x0 + y0 * width], hi = lo;
+  for (size_t y = y0; y <= y1; ++y) {
+    for (size_t x = x0; x <= x1; ++x) {
+      lo = std::min(lo, depth[x + y * width]);
+      hi = std::max(hi, depth[x + y * width]);
+    }
+  }
+  return {lo, hi};
+}
+
+/// 指定屏幕矩形与深度范围的包围体
+ScreenBounds MakeBounds(float min_x, float min_y, float max_x, float max_y,
+                        float min_z) {
+  ScreenBounds bounds;
+  bounds.min_x = min_x;
+  bounds.min_y = min_y;
+  bounds.max_x = max_x;
+  bounds.max_y = max_y;
+  bounds.min_z = min_z;
+  bounds.max_z = min_z;
+  return bounds;
+}
+
+TEST(DepthPyramidTest, LevelCountOnOddSizes) {
+  const std::vector<float> depth(7 * 5, 0.5f);
+  DepthPyramid pyramid;
+  pyramid.Build(depth.data(), 7, 5);
+  ASSERT_TRUE(pyramid.IsValid());
+  EXPECT_EQ(pyramid.GetWidth(), 7u);
+  EXPECT_EQ(pyramid.GetHeight(), 5u);
+  // 7x5 -> 4x3 -> 2x2 -> 1x1
+  EXPECT_EQ(pyramid.GetLevelCount(), 4u);
+
+  pyramid.Build(nullptr, 7, 5);
+  EXPECT_FALSE(pyramid.IsValid());
+}
+
+TEST(DepthPyramidTest, MaxReductionKeepsLastRowAndColumnOfOddSizes) {
+  // 最远与最近的深度只出现在奇数尺寸的最后两个像素（最后一行/列）
+  for (const auto& [width, height] : std::vector<std::pair<size_t, size_t>>{
+           {5, 3}, {7, 1}, {1, 9}, {33, 17}}) {
+    std::vector<float> depth(width * height, 0.5f);
+    depth[width * height - 1] = 0.9f;
+    depth[width * height - 2] = 0.1f;
+    DepthPyramid pyramid;
+    pyramid.Build(depth.data(), width, height);
+    const float w = static_cast<float>(width);
+    const float h = static_cast<float>(height);
+    EXPECT_EQ(pyramid.QueryMaxDepth(0.0f, 0.0f, w, h), 0.9f)
+        << width << "x" << height;
+    EXPECT_EQ(pyramid.QueryMinDepth(0.0f, 0.0f, w, h), 0.1f)
+        << width << "x" << height;
+  }
+}
+
+TEST(DepthPyramidTest, QueriesAreConservativeOnRandomRects) {
+  constexpr size_t kWidth = 37;
+  constexpr size_t kHeight = 23;
+  std::mt19937 rng(27);
+  std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+  std::vector<float> depth(kWidth * kHeight);
+  for (float& d : depth) d = value(rng);
+  DepthPyramid pyramid;
+  pyramid.Build(depth.data(), kWidth, kHeight);
+
+  std::uniform_int_distribution<size_t> px(0, kWidth - 1);
+  std::uniform_int_distribution<size_t> py(0, kHeight - 1);
+  for (int iter = 0; iter < 2000; ++iter) {
+    size_t x0 = px(rng), x1 = px(rng), y0 = py(rng), y1 = py(rng);
+    if (x0 > x1) std::swap(x0, x1);
+    if (y0 > y1) std::swap(y0, y1);
+    const auto [lo, hi] = BruteForceRange(depth, kWidth, x0, y0, x1, y1);
+    const float fx0 = static_cast<float>(x0), fy0 = static_cast<float>(y0);
+    const float fx1 = static_cast<float>(x1), fy1 = static_cast<float>(y1);
+    EXPECT_GE(pyramid.QueryMaxDepth(fx0, fy0, fx1, fy1), hi);
+    EXPECT_LE(pyramid.QueryMinDepth(fx0, fy0, fx1, fy1), lo);
+  }
+  // 单个像素落在第 0 层，结果精确
+  for (size_t y = 0; y < kHeight; ++y) {
+    for (size_t x = 0; x < kWidth; ++x) {
+      const float fx = static_cast<float>(x), fy = static_cast<float>(y);
+      EXPECT_EQ(pyramid.QueryMaxDepth(fx, fy, fx, fy), depth[x + y * kWidth]);
+    }
+  }
+}
+
+TEST(DepthPyramidTest, IsOccludedBehindOccluder) {
+  constexpr size_t kWidth = 21;
+  constexpr size_t kHeight = 11;
+  std::vector<float> depth(kWidth * kHeight, 0.5f);
+  DepthPyramid pyramid;
+  pyramid.Build(depth.data(), kWidth, kHeight);
+
+  // 最近深度比矩形内最远深度还远
+  EXPECT_TRUE(pyramid.IsOccluded(MakeBounds(2.0f, 1.0f, 19.5f, 10.5f, 0.6f)));
+  // 部分超出屏幕的矩形只查询屏幕内部分
+  EXPECT_TRUE(pyramid.IsOccluded(MakeBounds(-8.0f, -3.0f, 4.0f, 4.0f, 0.6f)));
+}
+
+TEST(DepthPyramidTest, IsNotOccludedWhenVisible) {
+  constexpr size_t kWidth = 21;
+  constexpr size_t kHeight = 11;
+  std::vector<float> depth(kWidth * kHeight, 0.5f);
+  // 奇数尺寸最后一列上有一个空洞
+  depth[(kWidth - 1) + 7 * kWidth] = 1.0f;
+  DepthPyramid pyramid;
+  pyramid.Build(depth.data(), kWidth, kHeight);
+
+  // 比遮挡体近
+  EXPECT_FALSE(pyramid.IsOccluded(MakeBounds(2.0f, 1.0f, 6.0f, 4.0f, 0.4f)));
+  // 矩形覆盖空洞
+  EXPECT_FALSE(
+      pyramid.IsOccluded(MakeBounds(17.0f, 5.0f, 20.5f, 8.0f, 0.6f)));
+  // 跨越相机平面：保守视为可见
+  ScreenBounds crossing = MakeBounds(2.0f, 1.0f, 6.0f, 4.0f, 0.6f);
+  crossing.crosses_near = true;
+  EXPECT_FALSE(pyramid.IsOccluded(crossing));
+  // 完全在屏幕外：交给视锥体剔除
+  EXPECT_FALSE(
+      pyramid.IsOccluded(MakeBounds(30.0f, 1.0f, 40.0f, 4.0f, 0.6f)));
+  // 无效金字塔
+  EXPECT_FALSE(
+      DepthPyramid().IsOccluded(MakeBounds(2.0f, 1.0f, 6.0f, 4.0f, 0.6f)));
+}
+
+}  // namespace
+}  // namespace simple_renderer
@@ -0,0 +1,191 @@
+
+/**
+ * @file edge_function_test.cpp
+ * @brief edge_function.hpp 测试
+ * @copyright MIT LICENSE
+ * https://github.com/Simple-XX/SimpleRenderer
+ */
+
+#include "edge_function.hpp"
+
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace simple_renderer {
+namespace {
+
+/// 采样点 (x, y) 是否被三角形覆盖（含填充规则）
+bool Covers(const TriangleSetup& setup, int32_t x, int32_t y) {
+  return setup.Inside(setup.Evaluate(0, x, y), setup.Evaluate(1, x, y),
+                      setup.Evaluate(2, x, y));
+}
+
+Vector4f Point(float x, float y) { return {x, y, 0.5f, 1.0f}; }
+
+/// 统计每个采样点被一组三角形覆盖的次数
+std::vector<int> CoverCounts(const std::vector<std::array<Vector4f, 3>>& tris,
+                             int32_t size) {
+  std::vector<int> counts(size * size, 0);
+  for (const auto& tri : tris) {
+    TriangleSetup setup;
+    if (!setup.Setup(tri[0], tri[1], tri[2])) continue;
+    for (int32_t y = 0; y < size; ++y) {
+      for (int32_t x = 0; x < size; ++x) {
+        counts[x + y * size] += Covers(setup, x, y) ? 1 : 0;
+      }
+    }
+  }
+  return counts;
+}
+
+TEST(EdgeFunctionTest, SharedEdgeCoveredExactlyOnce) {
+  // 正方形 [2, 14]^2 沿对角线切分：对角线与四条边都穿过整数采样点
+  const std::vector<std::array<Vector4f, 3>> square = {
+      {Point(2, 2), Point(14, 2), Point(14, 14)},
+      {Point(2, 2), Point(14, 14), Point(2, 14)},
+  };
+  const auto counts = CoverCounts(square, 16);
+  for (int32_t y = 0; y < 16; ++y) {
+    for (int32_t x = 0; x < 16; ++x) {
+      // 左上填充规则：左边、上边包含，右边、下边不包含
+      const bool inside = x >= 2 && x < 14 && y >= 2 && y < 14;
+      EXPECT_EQ(counts[x + y * 16], inside ? 1 : 0) << x << ", " << y;
+    }
+  }
+}
+
+TEST(EdgeFunctionTest, FanAroundSharedVertexHasNoGapsOrOverlaps) {
+  // 以 (8.25, 7.75) 为中心的扇形铺满 [0, 16]^2，边有任意斜率与顺/逆时针朝向
+  const Vector4f center = Point(8.25f, 7.75f);
+  const Vector4f ring[] = {Point(0, 0),   Point(5.5f, 0), Point(16, 0),
+                           Point(16, 9),  Point(16, 16),  Point(7, 16),
+                           Point(0, 16),  Point(0, 3.25f)};
+  std::vector<std::array<Vector4f, 3>> fan;
+  for (size_t i = 0; i < std::size(ring); ++i) {
+    const Vector4f& a = ring[i];
+    const Vector4f& b = ring[(i + 1) % std::size(ring)];
+    // 交替顶点顺序，验证朝向不影响覆盖
+    if (i % 2 == 0) {
+      fan.push_back({center, a, b});
+    } else {
+      fan.push_back({b, a, center});
+    }
+  }
+  const auto counts = CoverCounts(fan, 17);
+  for (int32_t y = 0; y < 17; ++y) {
+    for (int32_t x = 0; x < 17; ++x) {
+      const bool inside = x < 16 && y < 16;
+      EXPECT_EQ(counts[x + y * 17], inside ? 1 : 0) << x << ", " << y;
+    }
+  }
+}
+
+TEST(EdgeFunctionTest, HorizontalTopEdgeIncludedBottomEdgeExcluded) {
+  // 上边 y = 2（水平）、下边尖角；采样点恰在上边上时被覆盖
+  TriangleSetup top;
+  ASSERT_TRUE(top.Setup(Point(2, 2), Point(12, 2), Point(7, 10)));
+  for (int32_t x = 3; x <= 11; ++x) {
+    EXPECT_TRUE(Covers(top, x, 2)) << x;
+  }
+  // 右端点 (12, 2) 在右边上，不被覆盖；左端点 (2, 2) 在左边与上边上，被覆盖
+  EXPECT_TRUE(Covers(top, 2, 2));
+  EXPECT_FALSE(Covers(top, 12, 2));
+  EXPECT_FALSE(Covers(top, 7, 1));
+
+  // 下边 y = 10（水平）：采样点恰在下边上时不被覆盖
+  TriangleSetup bottom;
+  ASSERT_TRUE(bottom.Setup(Point(7, 2), Point(12, 10), Point(2, 10)));
+  for (int32_t x = 2; x <= 12; ++x) {
+    EXPECT_FALSE(Covers(bottom, x, 10)) << x;
+  }
+  EXPECT_TRUE(Covers(bottom, 7, 9));
+}
+
+TEST(EdgeFunctionTest, VerticalLeftEdgeIncludedRightEdgeExcluded) {
+  TriangleSetup left;
+  ASSERT_TRUE(left.Setup(Point(3, 2), Point(3, 12), Point(10, 7)));
+  for (int32_t y = 3; y <= 11; ++y) {
+    EXPECT_TRUE(Covers(left, 3, y)) << y;
+  }
+  TriangleSetup right;
+  ASSERT_TRUE(right.Setup(Point(10, 2), Point(3, 7), Point(10, 12)));
+  for (int32_t y = 2; y <= 12; ++y) {
+    EXPECT_FALSE(Covers(right, 10, y)) << y;
+  }
+}
+
+TEST(EdgeFunctionTest, ZeroAreaTrianglesRejected) {
+  TriangleSetup setup;
+  // 共线
+  EXPECT_FALSE(setup.Setup(Point(1, 1), Point(5, 5), Point(9, 9)));
+  // 重合顶点
+  EXPECT_FALSE(setup.Setup(Point(3, 4), Point(3, 4), Point(8, 1)));
+  // 浮点面积非零，但吸附到 1/256 像素网格后共线
+  EXPECT_FALSE(setup.Setup(Point(1.0f, 1.0f), Point(5.0f, 1.0f + 1e-4f),
+                           Point(9.0f, 1.0f)));
+  // 最小的非退化三角形仍然接受
+  EXPECT_TRUE(setup.Setup(Point(1.0f, 1.0f), Point(1.0f + 1.0f / 256, 1.0f),
+                          Point(1.0f, 1.0f + 1.0f / 256)));
+}
+
+TEST(EdgeFunctionTest, ClassifyBlockAgreesWithPerPixelInside) {
+  std::mt19937 rng(40);
+  std::uniform_real_distribution<float> coord(-8.0f, 40.0f);
+  std::uniform_int_distribution<int32_t> origin(0, 31);
+  std::uniform_int_distribution<int32_t> extent(1, kRasterBlockSize);
+  int accepted = 0, rejected = 0;
+  for (int iter = 0; iter < 2000; ++iter) {
+    TriangleSetup setup;
+    if (!setup.Setup(Point(coord(rng), coord(rng)), Point(coord(rng), coord(rng)),
+                     Point(coord(rng), coord(rng)))) {
+      continue;
+    }
+    const int32_t bx = origin(rng), by = origin(rng);
+    const int32_t width = extent(rng), height = extent(rng);
+    const int64_t e[3] = {setup.Evaluate(0, bx, by), setup.Evaluate(1, bx, by),
+                          setup.Evaluate(2, bx, by)};
+    const BlockCoverage coverage = setup.ClassifyBlock(e, width, height);
+    for (int32_t y = by; y < by + height; ++y) {
+      for (int32_t x = bx; x < bx + width; ++x) {
+        if (coverage == BlockCoverage::kOutside) {
+          EXPECT_FALSE(Covers(setup, x, y));
+        } else if (coverage == BlockCoverage::kInside) {
+          EXPECT_TRUE(Covers(setup, x, y));
+        }
+      }
+    }
+    accepted += coverage == BlockCoverage::kInside;
+    rejected += coverage == BlockCoverage::kOutside;
+  }
+  // 随机样本确实覆盖了两种平凡情形
+  EXPECT_GT(accepted, 50);
+  EXPECT_GT(rejected, 50);
+}
+
+TEST(EdgeFunctionTest, CoverStampAgreesWithPerPixelInside) {
+  std::mt19937 rng(44);
+  std::uniform_real_distribution<float> corner(0.0f, 16.0f);
+  std::uniform_real_distribution<float> offset(-0.5f, 3.5f);
+  for (int iter = 0; iter < 2000; ++iter) {
+    const float x0 = corner(rng), y0 = corner(rng);
+    TriangleSetup setup;
+    if (!setup.Setup(Point(x0 + offset(rng), y0 + offset(rng)),
+                     Point(x0 + offset(rng), y0 + offset(rng)),
+                     Point(x0 + offset(rng), y0 + offset(rng))) ||
+        setup.Empty() || !setup.Small()) {
+      continue;
+    }
+    const uint32_t stamp = setup.CoverStamp(setup.min_x, setup.min_y);
+    for (int32_t dy = 0; dy < kSmallTriangleStamp; ++dy) {
+      for (int32_t dx = 0; dx < kSmallTriangleStamp; ++dx) {
+        const bool bit = (stamp >> (dy * kSmallTriangleStamp + dx)) & 1u;
+        EXPECT_EQ(bit, Covers(setup, setup.min_x + dx, setup.min_y + dy));
+      }
+    }
+  }
+}
+
+}  // namespace
+}  // namespace simple_renderer
@@ -0,0 +1,193 @@
+
+/**
+ * @file material_test.cpp
+ * @brief material.hpp 测试
+ * @copyright MIT LICENSE
+ * https://github.com/Simple-XX/SimpleRenderer
+ */
+
+#include "material.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace simple_renderer {
+namespace {
+
+/// 由 RGBA8 数据生成 mip 链（data 由调用者持有）
+Texture MakeTexture(std::vector<uint8_t>& data, int width, int height,
+                    int channels) {
+  Texture texture;
+  texture.data = data.data();
+  texture.width = width;
+  texture.height = height;
+  texture.channels = channels;
+  texture.GenerateMipmaps();
+  return texture;
+}
+
+/// 源 texel [i, i + 1) 与区间 [lo, hi) 的重叠长度
+double Overlap(int i, double lo, double hi) {
+  return std::max(0.0, std::min(hi, i + 1.0) - std::max(lo, double(i)));
+}
+
+/// 参考实现：目标 texel 覆盖的源矩形上的面积加权平均（不舍入）
+double BoxAverage(const TextureLevel& src, int dst_width, int dst_height, int x,
+                  int y, int c) {
+  const double sx = double(src.width) / dst_width;
+  const double sy = double(src.height) / dst_height;
+  double sum = 0.0, area = 0.0;
+  for (int j = 0; j < src.height; ++j) {
+    const double wy = Overlap(j, y * sy, (y + 1) * sy);
+    for (int i = 0; i < src.width; ++i) {
+      const double w = wy * Overlap(i, x * sx, (x + 1) * sx);
+      sum += w * src.texels[(size_t(j) * src.width + i) * 4 + c];
+      area += w;
+    }
+  }
+  return sum / area;
+}
+
+/// 某一级所有 texel 某通道的平均值
+double LevelMean(const TextureLevel& level, int c) {
+  double sum = 0.0;
+  for (size_t i = 0; i < size_t(level.width) * level.height; ++i) {
+    sum += level.texels[i * 4 + c];
+  }
+  return sum / (double(level.width) * level.height);
+}
+
+TEST(MaterialTest, MipChainDimensionsOnNonPowerOfTwo) {
+  std::vector<uint8_t> data(37 * 10 * 3, 128);
+  const Texture texture = MakeTexture(data, 37, 10, 3);
+  ASSERT_NE(texture.levels, nullptr);
+  const std::vector<std::pair<int, int>> expected = {
+      {37, 10}, {18, 5}, {9, 2}, {4, 1}, {2, 1}, {1, 1}};
+  ASSERT_EQ(texture.levels->size(), expected.size());
+  for (size_t l = 0; l < expected.size(); ++l) {
+    const TextureLevel& level = (*texture.levels)[l];
+    EXPECT_EQ(level.width, expected[l].first) << l;
+    EXPECT_EQ(level.height, expected[l].second) << l;
+    EXPECT_EQ(level.texels.size(), size_t(level.width) * level.height * 4);
+  }
+}
+
+TEST(MaterialTest, ThreeChannelTexturesGetOpaqueAlpha) {
+  std::vector<uint8_t> data = {10, 20, 30, 40, 50, 60};
+  const Texture texture = MakeTexture(data, 2, 1, 3);
+  const TextureLevel& base = (*texture.levels)[0];
+  EXPECT_EQ(base.texels,
+            (std::vector<uint8_t>{10, 20, 30, 255, 40, 50, 60, 255}));
+  const TextureLevel& top = (*texture.levels)[1];
+  EXPECT_EQ(top.texels, (std::vector<uint8_t>{25, 35, 45, 255}));
+}
+
+TEST(MaterialTest, BoxFilterAveragesEvenLevels) {
+  std::mt19937 rng(47);
+  std::uniform_int_distribution<int> texel(0, 255);
+  std::vector<uint8_t> data(16 * 6 * 4);
+  for (auto& v : data) v = static_cast<uint8_t>(texel(rng));
+  const Texture texture = MakeTexture(data, 16, 6, 4);
+  const TextureLevel& src = (*texture.levels)[0];
+  const TextureLevel& dst = (*texture.levels)[1];
+  ASSERT_EQ(dst.width, 8);
+  ASSERT_EQ(dst.height, 3);
+  for (int y = 0; y < dst.height; ++y) {
+    for (int x = 0; x < dst.width; ++x) {
+      for (int c = 0; c < 4; ++c) {
+        const auto at = [&](int sx, int sy) {
+          return src.texels[(size_t(sy) * src.width + sx) * 4 + c];
+        };
+        const int sum = at(2 * x, 2 * y) + at(2 * x + 1, 2 * y) +
+                        at(2 * x, 2 * y + 1) + at(2 * x + 1, 2 * y + 1);
+        EXPECT_EQ(dst.texels[(size_t(y) * dst.width + x) * 4 + c],
+                  (sum + 2) / 4);
+      }
+    }
+  }
+}
+
+TEST(MaterialTest, BoxFilterAveragesOddLevelsOverFullArea) {
+  std::mt19937 rng(470);
+  std::uniform_int_distribution<int> texel(0, 255);
+  std::vector<uint8_t> data(37 * 21 * 4);
+  for (auto& v : data) v = static_cast<uint8_t>(texel(rng));
+  const Texture texture = MakeTexture(data, 37, 21, 4);
+  const auto& levels = *texture.levels;
+  for (size_t l = 1; l < levels.size(); ++l) {
+    const TextureLevel& src = levels[l - 1];
+    const TextureLevel& dst = levels[l];
+    for (int y = 0; y < dst.height; ++y) {
+      for (int x = 0; x < dst.width; ++x) {
+        for (int c = 0; c < 4; ++c) {
+          const double expected =
+              BoxAverage(src, dst.width, dst.height, x, y, c);
+          EXPECT_LE(std::abs(dst.texels[(size_t(y) * dst.width + x) * 4 + c] -
+                             expected),
+                    0.5 + 1e-9)
+              << "level " << l << " texel " << x << ", " << y;
+        }
+      }
+    }
+    // 每级覆盖上一级的全部面积，平均值只受舍入影响
+    for (int c = 0; c < 4; ++c) {
+      EXPECT_NEAR(LevelMean(dst, c), LevelMean(src, c), 0.5) << l;
+    }
+  }
+}
+
+TEST(MaterialTest, BoxFilterKeepsLastRowAndColumnOfOddTextures) {
+  // 3x3 纹理只有最后一列/行为白色：第 1 级 (1x1) 必须包含它们
+  std::vector<uint8_t> data(3 * 3 * 3, 0);
+  for (int y = 0; y < 3; ++y) {
+    for (int x = 0; x < 3; ++x) {
+      if (x == 2 || y == 2) {
+        for (int c = 0; c < 3; ++c) data[(y * 3 + x) * 3 + c] = 255;
+      }
+    }
+  }
+  const Texture texture = MakeTexture(data, 3, 3, 3);
+  const TextureLevel& top = (*texture.levels)[1];
+  ASSERT_EQ(top.width, 1);
+  ASSERT_EQ(top.height, 1);
+  // 9 个 texel 中 5 个为白色
+  EXPECT_EQ(top.texels[0], (5 * 255 + 4) / 9);
+}
+
+TEST(MaterialTest, NonFiniteDerivativesSampleCoarsestLevel) {
+  // 4x4 黑色纹理，只有 (0, 0) 为白色：第 0 级在 (2, 2) 处为黑，最粗级别不为黑
+  std::vector<uint8_t> data(4 * 4 * 3, 0);
+  data[0] = data[1] = data[2] = 255;
+  Texture texture = MakeTexture(data, 4, 4, 3);
+  const TextureLevel& top = texture.levels->back();
+  ASSERT_EQ(top.width, 1);
+  ASSERT_GT(top.texels[0], 0);
+  const float coarsest = static_cast<float>(top.texels[0]) / 255.0f;
+  const Vector2f uv(0.625f, 0.625f);  // 第 0 级 texel (2, 2) 的中心
+  const float inf = std::numeric_limits<float>::infinity();
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+
+  for (const TextureFilter filter :
+       {TextureFilter::kBilinear, TextureFilter::kTrilinear}) {
+    texture.filter = filter;
+    // 放大与零导数：第 0 级
+    EXPECT_EQ(texture.Sample(uv, Vector2f(0.0f), Vector2f(0.0f)).x, 0.0f);
+    EXPECT_EQ(texture.Sample(uv, Vector2f(0.1f, 0.0f), Vector2f(0.0f)).x,
+              0.0f);
+    // 导数平方溢出、无穷大或 NaN：最粗级别
+    for (const Vector2f d : {Vector2f(1e30f, 0.0f), Vector2f(inf, 0.0f),
+                             Vector2f(nan, 0.0f)}) {
+      EXPECT_NEAR(texture.Sample(uv, d, Vector2f(0.0f)).x, coarsest, 1e-6f)
+          << static_cast<int>(filter) << " " << d.x;
+      EXPECT_NEAR(texture.Sample(uv, Vector2f(0.0f), d).x, coarsest, 1e-6f)
+          << static_cast<int>(filter) << " " << d.x;
+    }
+  }
+}
+
+}  // namespace
+}  // namespace simple_renderer
@@ -0,0 +1,198 @@
+
+/**
+ * @file mesh_optimizer_test.cpp
+ * @brief mesh_optimizer.hpp 测试
+ * @copyright MIT LICENSE
+ * https://github.com/Simple-XX/SimpleRenderer
+ */
+
+#include "mesh_optimizer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace simple_renderer {
+namespace {
+
+using Triangle = std::array<uint32_t, 3>;
+
+/// 顶点的全部属性逐一相等
+bool SameVertex(const Vertex& a, const Vertex& b) {
+  return a.GetPosition() == b.GetPosition() && a.GetNormal() == b.GetNormal() &&
+         a.GetTexCoords() == b.GetTexCoords() &&
+         static_cast<uint32_t>(a.GetColor()) ==
+             static_cast<uint32_t>(b.GetColor());
+}
+
+/// 三角形多重集（保留各三角形内的顶点顺序）
+std::vector<Triangle> TriangleMultiset(const std::vector<uint32_t>& indices) {
+  std::vector<Triangle> triangles;
+  for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+    triangles.push_back({indices[i], indices[i + 1], indices[i + 2]});
+  }
+  std::sort(triangles.begin(), triangles.end());
+  return triangles;
+}
+
+/// n x n 顶点的平面网格，三角形顺序随机打乱
+void MakeShuffledGrid(size_t n, std::vector<Vector3f>& positions,
+                      std::vector<uint32_t>& indices) {
+  positions.clear();
+  for (size_t y = 0; y < n; ++y) {
+    for (size_t x = 0; x < n; ++x) {
+      positions.emplace_back(static_cast<float>(x), static_cast<float>(y),
+                             0.0f);
+    }
+  }
+  std::vector<Triangle> triangles;
+  for (size_t y = 0; y + 1 < n; ++y) {
+    for (size_t x = 0; x + 1 < n; ++x) {
+      const auto v = static_cast<uint32_t>(x + y * n);
+      const auto up = v + static_cast<uint32_t>(n);
+      triangles.push_back({v, v + 1, up + 1});
+      triangles.push_back({v, up + 1, up});
+    }
+  }
+  std::mt19937 rng(31);
+  std::shuffle(triangles.begin(), triangles.end(), rng);
+  indices.clear();
+  for (const auto& t : triangles) {
+    indices.insert(indices.end(), t.begin(), t.end());
+  }
+}
+
+/// FIFO 后变换缓存的平均每三角形未命中数（ACMR）
+float Acmr(const std::vector<uint32_t>& indices, size_t cache_size) {
+  std::vector<uint32_t> cache;
+  size_t misses = 0;
+  for (const uint32_t v : indices) {
+    if (std::find(cache.begin(), cache.end(), v) != cache.end()) continue;
+    ++misses;
+    cache.push_back(v);
+    if (cache.size() > cache_size) cache.erase(cache.begin());
+  }
+  return static_cast<float>(misses) / static_cast<float>(indices.size() / 3);
+}
+
+TEST(MeshOptimizerTest, WeldKeepsEveryDistinctVertexAndRemapsIndices) {
+  // 互不相同的顶点：部分只在法线、UV 或颜色上不同
+  std::vector<Vertex> distinct;
+  for (int i = 0; i < 10; ++i) {
+    const Vector4f position(static_cast<float>(i), 0.5f, -1.0f, 1.0f);
+    distinct.emplace_back(position, Vector3f(0, 0, 1), Vector2f(0.25f, 0.5f),
+                          Color(0xFF102030u));
+    distinct.emplace_back(position, Vector3f(0, 1, 0), Vector2f(0.25f, 0.5f),
+                          Color(0xFF102030u));
+    distinct.emplace_back(position, Vector3f(0, 0, 1), Vector2f(0.75f, 0.5f),
+                          Color(0xFF102030u));
+    distinct.emplace_back(position, Vector3f(0, 0, 1), Vector2f(0.25f, 0.5f),
+                          Color(0xFF102031u));
+  }
+
+  // 每个顶点至少出现一次，其余为随机重复
+  std::mt19937 rng(30);
+  std::vector<uint32_t> source(distinct.size());
+  std::iota(source.begin(), source.end(), 0u);
+  std::uniform_int_distribution<uint32_t> pick(0, distinct.size() - 1);
+  for (int i = 0; i < 80; ++i) source.push_back(pick(rng));
+  std::shuffle(source.begin(), source.end(), rng);
+
+  std::vector<Vertex> vertices;
+  for (const uint32_t id : source) vertices.push_back(distinct[id]);
+  std::uniform_int_distribution<uint32_t> index(0, vertices.size() - 1);
+  std::vector<uint32_t> indices(300);
+  for (auto& i : indices) i = index(rng);
+
+  const std::vector<Vertex> original = vertices;
+  const std::vector<uint32_t> original_indices = indices;
+  const size_t count = WeldVertices(vertices, indices);
+
+  ASSERT_EQ(count, distinct.size());
+  ASSERT_EQ(vertices.size(), count);
+  // 焊接后无重复，且按首次出现顺序保留全部不同顶点
+  std::vector<uint32_t> first_seen;
+  for (const uint32_t id : source) {
+    if (std::find(first_seen.begin(), first_seen.end(), id) ==
+        first_seen.end()) {
+      first_seen.push_back(id);
+    }
+  }
+  for (size_t k = 0; k < count; ++k) {
+    EXPECT_TRUE(SameVertex(vertices[k], distinct[first_seen[k]])) << k;
+  }
+  // 每个索引指向与原顶点相同的焊接顶点
+  for (size_t i = 0; i < indices.size(); ++i) {
+    ASSERT_LT(indices[i], count);
+    EXPECT_TRUE(SameVertex(vertices[indices[i]], original[original_indices[i]]))
+        << i;
+  }
+}
+
+TEST(MeshOptimizerTest, MortonSortKeepsTriangleMultiset) {
+  std::vector<Vector3f> positions;
+  std::vector<uint32_t> indices;
+  MakeShuffledGrid(24, positions, indices);
+  const std::vector<uint32_t> original = indices;
+
+  SortTrianglesMorton(positions, indices);
+  ASSERT_EQ(indices.size(), original.size());
+  for (const uint32_t v : indices) ASSERT_LT(v, positions.size());
+  EXPECT_EQ(TriangleMultiset(indices), TriangleMultiset(original));
+  // 空间排序后缓存命中率高于随机顺序
+  EXPECT_LT(Acmr(indices, kVertexCacheSize), Acmr(original, kVertexCacheSize));
+}
+
+TEST(MeshOptimizerTest, TipsifyKeepsTriangleMultisetAndImprovesAcmr) {
+  std::vector<Vector3f> positions;
+  std::vector<uint32_t> indices;
+  MakeShuffledGrid(24, positions, indices);
+  const std::vector<uint32_t> original = indices;
+
+  OptimizeVertexCache(indices, positions.size());
+  ASSERT_EQ(indices.size(), original.size());
+  for (const uint32_t v : indices) ASSERT_LT(v, positions.size());
+  EXPECT_EQ(TriangleMultiset(indices), TriangleMultiset(original));
+  // 规则网格上 Tipsify 的 ACMR 明显低于随机顺序（约 3）
+  EXPECT_LT(Acmr(indices, kVertexCacheSize), 1.0f);
+  EXPECT_GT(Acmr(original, kVertexCacheSize), 2.0f);
+
+  // 先空间排序再做缓存优化（与加载时相同的流程）
+  std::vector<uint32_t> sorted = original;
+  SortTrianglesMorton(positions, sorted);
+  OptimizeVertexCache(sorted, positions.size());
+  EXPECT_EQ(TriangleMultiset(sorted), TriangleMultiset(original));
+}
+
+TEST(MeshOptimizerTest, VertexFetchRemapIsPermutation) {
+  // 20 个顶点中只有部分被引用
+  const size_t vertex_count = 20;
+  const std::vector<uint32_t> indices = {7, 3, 12, 3,  12, 5,
+                                         19, 7, 5, 0, 3, 19};
+  const std::vector<uint32_t> remap =
+      BuildVertexFetchRemap(indices, vertex_count);
+  ASSERT_EQ(remap.size(), vertex_count);
+
+  std::vector<uint32_t> sorted = remap;
+  std::sort(sorted.begin(), sorted.end());
+  for (uint32_t i = 0; i < vertex_count; ++i) {
+    EXPECT_EQ(sorted[i], i);
+  }
+  // 被引用的顶点按首次使用顺序编号，未引用的排在最后
+  const uint32_t first_use[] = {7, 3, 12, 5, 19, 0};
+  for (uint32_t k = 0; k < std::size(first_use); ++k) {
+    EXPECT_EQ(remap[first_use[k]], k);
+  }
+  for (uint32_t v = 0; v < vertex_count; ++v) {
+    if (std::find(indices.begin(), indices.end(), v) == indices.end()) {
+      EXPECT_GE(remap[v], std::size(first_use)) << v;
+    }
+  }
+}
+
+}  // namespace
+}  // namespace simple_renderer
@@ -0,0 +1,115 @@
+
+/**
+ * @file mesh_simplifier_test.cpp
+ * @brief mesh_simplifier.hpp 测试
+ * @copyright MIT LICENSE
+ * https://github.com/Simple-XX/SimpleRenderer
+ */
+
+#include "mesh_simplifier.hpp"
+
+#include <cmath>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace simple_renderer {
+namespace {
+
+/// n x n 顶点的起伏高度场网格（逆时针朝 +z），带开放边界
+void MakeHeightField(size_t n, std::vector<Vector3f>& positions,
+                     std::vector<uint32_t>& indices) {
+  positions.clear();
+  indices.clear();
+  for (size_t y = 0; y < n; ++y) {
+    for (size_t x = 0; x < n; ++x) {
+      const float fx = static_cast<float>(x) / static_cast<float>(n - 1);
+      const float fy = static_cast<float>(y) / static_cast<float>(n - 1);
+      positions.emplace_back(fx, fy,
+                             0.1f * std::sin(6.0f * fx) * std::cos(4.0f * fy));
+    }
+  }
+  for (size_t y = 0; y + 1 < n; ++y) {
+    for (size_t x = 0; x + 1 < n; ++x) {
+      const auto v = static_cast<uint32_t>(x + y * n);
+      const auto right = v + 1;
+      const auto up = v + static_cast<uint32_t>(n);
+      indices.insert(indices.end(), {v, right, up + 1, v, up + 1, up});
+    }
+  }
+}
+
+/// 索引有效且三角形非退化（三个不同顶点、面积非零）
+void ExpectValidTriangles(const std::vector<Vector3f>& positions,
+                          const std::vector<uint32_t>& indices) {
+  ASSERT_EQ(indices.size() % 3, 0u);
+  for (size_t i = 0; i < indices.size(); i += 3) {
+    const uint32_t a = indices[i], b = indices[i + 1], c = indices[i + 2];
+    ASSERT_LT(a, positions.size());
+    ASSERT_LT(b, positions.size());
+    ASSERT_LT(c, positions.size());
+    EXPECT_TRUE(a != b && b != c && a != c) << i / 3;
+    const Vector3f normal =
+        glm::cross(positions[b] - positions[a], positions[c] - positions[a]);
+    EXPECT_GT(glm::dot(normal, normal), 0.0f) << i / 3;
+  }
+}
+
+TEST(MeshSimplifierTest, ReachesTargetWithValidTriangles) {
+  std::vector<Vector3f> positions;
+  std::vector<uint32_t> indices;
+  MakeHeightField(33, positions, indices);
+
+  float error = -1.0f;
+  const std::vector<uint32_t> simplified =
+      SimplifyMesh(positions, indices, indices.size() / 4, &error);
+  EXPECT_LE(simplified.size(), indices.size() / 4);
+  EXPECT_GT(simplified.size(), 0u);
+  EXPECT_GT(error, 0.0f);
+  ExpectValidTriangles(positions, simplified);
+}
+
+TEST(MeshSimplifierTest, FlatMeshSimplifiesWithoutError) {
+  // 平面内部的折叠不引入几何误差
+  std::vector<Vector3f> positions;
+  std::vector<uint32_t> indices;
+  MakeHeightField(17, positions, indices);
+  for (auto& p : positions) p.z = 0.0f;
+
+  float error = -1.0f;
+  const std::vector<uint32_t> simplified =
+      SimplifyMesh(positions, indices, indices.size() / 2, &error);
+  EXPECT_LE(simplified.size(), indices.size() / 2);
+  EXPECT_NEAR(error, 0.0f, 1e-5f);
+  ExpectValidTriangles(positions, simplified);
+}
+
+TEST(MeshSimplifierTest, LodChainIsMonotonic) {
+  // 与 Model::GenerateLods 相同：每级都从原网格按 reduction^level 简化
+  std::vector<Vector3f> positions;
+  std::vector<uint32_t> indices;
+  MakeHeightField(33, positions, indices);
+
+  constexpr float kReduction = 0.5f;
+  size_t previous_triangles = indices.size() / 3;
+  float previous_error = 0.0f;
+  float ratio = 1.0f;
+  for (int level = 1; level <= 5; ++level) {
+    ratio *= kReduction;
+    const size_t target =
+        static_cast<size_t>(indices.size() / 3 * ratio) * 3;
+    float error = 0.0f;
+    const std::vector<uint32_t> lod =
+        SimplifyMesh(positions, indices, target, &error);
+    ExpectValidTriangles(positions, lod);
+    const size_t triangles = lod.size() / 3;
+    EXPECT_LE(triangles, previous_triangles) << "level " << level;
+    EXPECT_GE(error, previous_error) << "level " << level;
+    previous_triangles = triangles;
+    previous_error = error;
+  }
+  EXPECT_LT(previous_triangles, indices.size() / 3 / 8);
+}
+
+}  // namespace
+}  // namespace simple_renderer
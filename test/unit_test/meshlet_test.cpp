@@ -0,0 +1,208 @@
+
+/**
+ * @file meshlet_test.cpp
+ * @brief meshlet.hpp 测试
+ * @copyright MIT LICENSE
+ * https://github.com/Simple-XX/SimpleRenderer
+ */
+
+#include "meshlet.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace simple_renderer {
+namespace {
+
+using Triangle = std::array<size_t, 3>;
+
+void AddVertex(VertexStreams& vertices, const Vector3f& position) {
+  vertices.push_back(Vertex(Vector4f(position, 1.0f), Vector3f(0.0f, 0.0f, 1.0f),
+                            Vector2f(0.0f), Color()));
+}
+
+/// n x n 顶点的 z = 0 平面网格，逆时针环绕（几何法线 +z）
+void MakeGrid(size_t n, VertexStreams& vertices, std::vector<Face>& faces) {
+  for (size_t y = 0; y < n; ++y) {
+    for (size_t x = 0; x < n; ++x) {
+      AddVertex(vertices,
+                Vector3f(static_cast<float>(x), static_cast<float>(y), 0.0f));
+    }
+  }
+  for (size_t y = 0; y + 1 < n; ++y) {
+    for (size_t x = 0; x + 1 < n; ++x) {
+      const size_t v = x + y * n;
+      faces.emplace_back(v, v + 1, v + n + 1, Material());
+      faces.emplace_back(v, v + n + 1, v + n, Material());
+    }
+  }
+}
+
+std::vector<Triangle> SortedTriangles(const std::vector<Face>& faces) {
+  std::vector<Triangle> triangles;
+  for (const Face& face : faces) triangles.push_back(face.GetIndices());
+  std::sort(triangles.begin(), triangles.end());
+  return triangles;
+}
+
+/// 划分结果的结构性检查：上限、面连续且不丢失、面只引用所属 meshlet 的顶点
+void ExpectValidMeshlets(const std::vector<Face>& faces_before,
+                         const std::vector<Face>& faces,
+                         const std::vector<Meshlet>& meshlets,
+                         const std::vector<uint32_t>& meshlet_vertices) {
+  EXPECT_EQ(SortedTriangles(faces), SortedTriangles(faces_before));
+  uint32_t next_face = 0;
+  for (const Meshlet& meshlet : meshlets) {
+    EXPECT_GT(meshlet.face_count, 0u);
+    EXPECT_LE(meshlet.vertex_count, kMeshletMaxVertices);
+    EXPECT_LE(meshlet.face_count, kMeshletMaxTriangles);
+    EXPECT_EQ(meshlet.face_offset, next_face);
+    next_face += meshlet.face_count;
+
+    ASSERT_LE(meshlet.vertex_offset + meshlet.vertex_count,
+              meshlet_vertices.size());
+    const std::set<size_t> used(
+        meshlet_vertices.begin() + meshlet.vertex_offset,
+        meshlet_vertices.begin() + meshlet.vertex_offset + meshlet.vertex_count);
+    EXPECT_EQ(used.size(), meshlet.vertex_count);
+    for (uint32_t f = 0; f < meshlet.face_count; ++f) {
+      for (const size_t index : faces[meshlet.face_offset + f].GetIndices()) {
+        EXPECT_EQ(used.count(index), 1u) << "face " << meshlet.face_offset + f;
+      }
+    }
+  }
+  EXPECT_EQ(next_face, faces.size());
+}
+
+/// 包围球与 AABB 包含 meshlet 的全部顶点
+void ExpectBoundsContainVertices(const VertexStreams& vertices,
+                                 const std::vector<uint32_t>& meshlet_vertices,
+                                 const Meshlet& meshlet) {
+  for (uint32_t i = 0; i < meshlet.vertex_count; ++i) {
+    const Vector3f p =
+        vertices.GetPosition(meshlet_vertices[meshlet.vertex_offset + i]);
+    EXPECT_LE(glm::length(p - meshlet.center), meshlet.radius * (1.0f + 1e-6f));
+    for (int c = 0; c < 3; ++c) {
+      EXPECT_GE(p[c], meshlet.bounds_min[c]);
+      EXPECT_LE(p[c], meshlet.bounds_max[c]);
+    }
+  }
+}
+
+TEST(MeshletTest, GridRespectsLimitsAndKeepsFaces) {
+  VertexStreams vertices;
+  std::vector<Face> faces;
+  MakeGrid(24, vertices, faces);
+  const std::vector<Face> faces_before = faces;
+  std::vector<Meshlet> meshlets;
+  std::vector<uint32_t> meshlet_vertices;
+  BuildMeshlets(vertices, faces, 0, faces.size(), meshlets, meshlet_vertices);
+  ASSERT_GT(meshlets.size(), 1u);
+  ExpectValidMeshlets(faces_before, faces, meshlets, meshlet_vertices);
+}
+
+TEST(MeshletTest, TriangleSoupHitsVertexLimit) {
+  // 互不相连的三角形：每个三角形 3 个新顶点，顶点上限先到达
+  VertexStreams vertices;
+  std::vector<Face> faces;
+  std::mt19937 rng(29);
+  std::uniform_real_distribution<float> coord(-10.0f, 10.0f);
+  for (size_t t = 0; t < 200; ++t) {
+    const Vector3f base(coord(rng), coord(rng), coord(rng));
+    AddVertex(vertices, base);
+    AddVertex(vertices, base + Vector3f(0.1f, 0.0f, 0.0f));
+    AddVertex(vertices, base + Vector3f(0.0f, 0.1f, 0.0f));
+    faces.emplace_back(3 * t, 3 * t + 1, 3 * t + 2, Material());
+  }
+  const std::vector<Face> faces_before = faces;
+  std::vector<Meshlet> meshlets;
+  std::vector<uint32_t> meshlet_vertices;
+  BuildMeshlets(vertices, faces, 0, faces.size(), meshlets, meshlet_vertices);
+  ExpectValidMeshlets(faces_before, faces, meshlets, meshlet_vertices);
+  uint32_t largest = 0;
+  for (const Meshlet& meshlet : meshlets) {
+    EXPECT_LE(meshlet.face_count, kMeshletMaxVertices / 3);
+    largest = std::max(largest, meshlet.vertex_count);
+  }
+  EXPECT_GT(largest, kMeshletMaxVertices - 3);
+}
+
+TEST(MeshletTest, SharedVerticesHitTriangleLimit) {
+  // 共用 3 个顶点的重复三角形：三角形上限先到达
+  VertexStreams vertices;
+  AddVertex(vertices, Vector3f(0.0f, 0.0f, 0.0f));
+  AddVertex(vertices, Vector3f(1.0f, 0.0f, 0.0f));
+  AddVertex(vertices, Vector3f(0.0f, 1.0f, 0.0f));
+  std::vector<Face> faces(300, Face(0, 1, 2, Material()));
+  const std::vector<Face> faces_before = faces;
+  std::vector<Meshlet> meshlets;
+  std::vector<uint32_t> meshlet_vertices;
+  BuildMeshlets(vertices, faces, 0, faces.size(), meshlets, meshlet_vertices);
+  ExpectValidMeshlets(faces_before, faces, meshlets, meshlet_vertices);
+  ASSERT_EQ(meshlets.size(), 3u);
+  EXPECT_EQ(meshlets[0].face_count, kMeshletMaxTriangles);
+  EXPECT_EQ(meshlets[0].vertex_count, 3u);
+}
+
+TEST(MeshletTest, FlatPatchHasTightCone) {
+  VertexStreams vertices;
+  std::vector<Face> faces;
+  MakeGrid(24, vertices, faces);
+  std::vector<Meshlet> meshlets;
+  std::vector<uint32_t> meshlet_vertices;
+  BuildMeshlets(vertices, faces, 0, faces.size(), meshlets, meshlet_vertices);
+  for (const Meshlet& meshlet : meshlets) {
+    ExpectBoundsContainVertices(vertices, meshlet_vertices, meshlet);
+    // 所有法线相同：锥轴为平面法线，半角为 0
+    EXPECT_NEAR(meshlet.cone_axis.z, 1.0f, 1e-6f);
+    EXPECT_NEAR(meshlet.cone_cutoff, 0.0f, 1e-3f);
+    EXPECT_EQ(meshlet.bounds_min.z, 0.0f);
+    EXPECT_EQ(meshlet.bounds_max.z, 0.0f);
+  }
+}
+
+TEST(MeshletTest, BoundsFollowDeformedVertices) {
+  VertexStreams vertices;
+  std::vector<Face> faces;
+  MakeGrid(12, vertices, faces);
+  std::vector<Meshlet> meshlets;
+  std::vector<uint32_t> meshlet_vertices;
+  BuildMeshlets(vertices, faces, 0, faces.size(), meshlets, meshlet_vertices);
+
+  // 把网格绕 y 轴弯成 270 度的圆柱面：法线偏角超过 90 度，锥体失效
+  for (size_t i = 0; i < vertices.size(); ++i) {
+    Vertex v = vertices.Get(i);
+    const Vector3f p(v.GetPosition());
+    const float angle = p.x / 11.0f * 4.71238898f;
+    v = Vertex(Vector4f(5.0f * std::cos(angle), p.y, 5.0f * std::sin(angle),
+                        1.0f),
+               v.GetNormal(), v.GetTexCoords(), v.GetColor());
+    vertices.Set(i, v);
+  }
+  Meshlet whole;
+  whole.face_offset = 0;
+  whole.face_count = static_cast<uint32_t>(faces.size());
+  std::vector<uint32_t> all_vertices(vertices.size());
+  for (uint32_t i = 0; i < all_vertices.size(); ++i) all_vertices[i] = i;
+  whole.vertex_offset = 0;
+  whole.vertex_count = static_cast<uint32_t>(all_vertices.size());
+  ComputeMeshletBounds(vertices, faces, all_vertices, whole);
+  ExpectBoundsContainVertices(vertices, all_vertices, whole);
+  EXPECT_GE(whole.cone_cutoff, 1.0f);
+
+  for (Meshlet& meshlet : meshlets) {
+    ComputeMeshletBounds(vertices, faces, meshlet_vertices, meshlet);
+    ExpectBoundsContainVertices(vertices, meshlet_vertices, meshlet);
+    EXPECT_GE(meshlet.cone_cutoff, 0.0f);
+    EXPECT_LE(meshlet.cone_cutoff, 1.0f);
+  }
+}
+
+}  // namespace
+}  // namespace simple_renderer
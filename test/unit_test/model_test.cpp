@@ -16,6 +16,71 @@
 
 #include "model.hpp"
 
+#include <fstream>
+#include <string>
+
 #include "gtest/gtest.h"
 
 TEST(ttt2, todo2) { EXPECT_EQ(nullptr, nullptr); }
+
+namespace simple_renderer {
+namespace {
+
+/// 同一个逆时针三角形（法线 +z）被两个节点引用：节点 0 无变换，
+/// 节点 1 沿 x 镜像（scale -1）
+constexpr char kMirroredNodeGltf[] = R"({
+  "asset": {"version": "2.0"},
+  "scene": 0,
+  "scenes": [{"nodes": [0, 1]}],
+  "nodes": [{"mesh": 0}, {"mesh": 0, "scale": [-1, 1, 1]}],
+  "meshes": [{
+    "primitives": [{
+      "attributes": {"POSITION": 0, "NORMAL": 1},
+      "indices": 2
+    }]
+  }],
+  "buffers": [{
+    "byteLength": 78,
+    "uri": "data:application/octet-stream;base64,AAAAAAAAAAAAAAAAAACAPwAAAAAAAAAAAAAAAAAAgD8AAAAAAAAAAAAAAAAAAIA/AAAAAAAAAAAAAIA/AAAAAAAAAAAAAIA/AAABAAIA"
+  }],
+  "bufferViews": [
+    {"buffer": 0, "byteOffset": 0, "byteLength": 36},
+    {"buffer": 0, "byteOffset": 36, "byteLength": 36},
+    {"buffer": 0, "byteOffset": 72, "byteLength": 6}
+  ],
+  "accessors": [
+    {"bufferView": 0, "componentType": 5126, "count": 3, "type": "VEC3",
+     "min": [0, 0, 0], "max": [1, 1, 0]},
+    {"bufferView": 1, "componentType": 5126, "count": 3, "type": "VEC3"},
+    {"bufferView": 2, "componentType": 5123, "count": 3, "type": "SCALAR"}
+  ]
+})";
+
+TEST(ModelTest, MirroredNodeKeepsFrontFaceWinding) {
+  const std::string path = ::testing::TempDir() + "mirrored_node.gltf";
+  std::ofstream(path) << kMirroredNodeGltf;
+  const Model model(path);
+  ASSERT_EQ(model.GetMeshInstances().size(), 2u);
+  ASSERT_EQ(model.GetFaces().size(), 2u);
+
+  const VertexStreams& vertices = model.GetVertices();
+  bool saw_mirrored = false;
+  for (const Face& face : model.GetFaces()) {
+    const auto& idx = face.GetIndices();
+    const Vector3f p0 = vertices.GetPosition(idx[0]);
+    const Vector3f p1 = vertices.GetPosition(idx[1]);
+    const Vector3f p2 = vertices.GetPosition(idx[2]);
+    saw_mirrored |= p0.x + p1.x + p2.x < 0.0f;
+    // 几何法线（由环绕方向决定）与顶点法线同向
+    const Vector3f geometric = glm::cross(p1 - p0, p2 - p0);
+    for (const size_t i : idx) {
+      EXPECT_GT(glm::dot(geometric, vertices.Get(i).GetNormal()), 0.0f)
+          << "face with vertices at x = " << p0.x << ", " << p1.x << ", "
+          << p2.x;
+    }
+  }
+  EXPECT_TRUE(saw_mirrored);
+}
+
+}  // namespace
+}  // namespace simple_renderer
@@ -0,0 +1,234 @@
+
+/**
+ * @file msaa_test.cpp
+ * @brief msaa.hpp 测试
+ * @copyright MIT LICENSE
+ * https://github.com/Simple-XX/SimpleRenderer
+ */
+
+#include "msaa.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "renderers/tile_based_renderer.hpp"
+
+namespace simple_renderer {
+namespace {
+
+TEST(MsaaTest, SampleCountsValidated) {
+  EXPECT_TRUE(IsValidMsaaSamples(1));
+  EXPECT_TRUE(IsValidMsaaSamples(2));
+  EXPECT_TRUE(IsValidMsaaSamples(4));
+  EXPECT_FALSE(IsValidMsaaSamples(0));
+  EXPECT_FALSE(IsValidMsaaSamples(3));
+  EXPECT_FALSE(IsValidMsaaSamples(8));
+  EXPECT_THROW(GetMsaaPattern(3), std::invalid_argument);
+}
+
+TEST(MsaaTest, SampleOffsetsLieInsidePixel) {
+  for (const uint32_t samples : {1u, 2u, 4u}) {
+    const MsaaPattern pattern = GetMsaaPattern(samples);
+    ASSERT_EQ(pattern.samples, samples);
+    std::set<std::pair<int32_t, int32_t>> positions;
+    int32_t sum_x = 0, sum_y = 0;
+    for (uint32_t s = 0; s < samples; ++s) {
+      // 采样点位于像素中心，样本须落在 (-1/2, 1/2) 像素内
+      EXPECT_LT(std::abs(pattern.offset_x[s]), kSubPixelScale / 2) << samples;
+      EXPECT_LT(std::abs(pattern.offset_y[s]), kSubPixelScale / 2) << samples;
+      positions.insert({pattern.offset_x[s], pattern.offset_y[s]});
+      sum_x += pattern.offset_x[s];
+      sum_y += pattern.offset_y[s];
+    }
+    EXPECT_EQ(positions.size(), samples) << samples;
+    // 样本以采样点为中心分布
+    EXPECT_EQ(sum_x, 0) << samples;
+    EXPECT_EQ(sum_y, 0) << samples;
+  }
+  // 4x 旋转网格：水平与竖直方向上 4 个样本的坐标互不相同
+  const MsaaPattern pattern = GetMsaaPattern(4);
+  const std::set<int32_t> xs(pattern.offset_x, pattern.offset_x + 4);
+  const std::set<int32_t> ys(pattern.offset_y, pattern.offset_y + 4);
+  EXPECT_EQ(xs.size(), 4u);
+  EXPECT_EQ(ys.size(), 4u);
+}
+
+TEST(MsaaTest, SampleEdgeOffsetsMatchShiftedTriangle) {
+  // 样本 s 处的覆盖等于将三角形平移 -offset 后在像素采样点的覆盖
+  std::mt19937 rng(48);
+  std::uniform_real_distribution<float> coord(0.0f, 32.0f);
+  for (const uint32_t samples : {2u, 4u}) {
+    const MsaaPattern pattern = GetMsaaPattern(samples);
+    for (int iter = 0; iter < 200; ++iter) {
+      const Vector4f p[3] = {{coord(rng), coord(rng), 0.5f, 1.0f},
+                             {coord(rng), coord(rng), 0.5f, 1.0f},
+                             {coord(rng), coord(rng), 0.5f, 1.0f}};
+      TriangleSetup setup;
+      if (!setup.Setup(p[0], p[1], p[2])) continue;
+      int64_t offsets[kMaxMsaaSamples][3];
+      SampleEdgeOffsets(setup, pattern, offsets);
+      for (uint32_t s = 0; s < samples; ++s) {
+        // 先吸附再平移，保证两者在同一定点网格上
+        const float dx =
+            static_cast<float>(pattern.offset_x[s]) / kSubPixelScale;
+        const float dy =
+            static_cast<float>(pattern.offset_y[s]) / kSubPixelScale;
+        Vector4f q[3];
+        for (int v = 0; v < 3; ++v) {
+          q[v] = {std::round(p[v].x * kSubPixelScale) / kSubPixelScale - dx,
+                  std::round(p[v].y * kSubPixelScale) / kSubPixelScale - dy,
+                  0.5f, 1.0f};
+        }
+        TriangleSetup shifted;
+        ASSERT_TRUE(shifted.Setup(q[0], q[1], q[2]));
+        for (int32_t y = 0; y <= 32; ++y) {
+          for (int32_t x = 0; x <= 32; ++x) {
+            int64_t e[3], f[3];
+            for (int k = 0; k < 3; ++k) {
+              e[k] = setup.Evaluate(k, x, y) + offsets[s][k];
+              f[k] = shifted.Evaluate(k, x, y);
+            }
+            ASSERT_EQ(e[0], f[0]);
+            ASSERT_EQ(e[1], f[1]);
+            ASSERT_EQ(e[2], f[2]);
+            ASSERT_EQ(setup.Inside(e[0], e[1], e[2]),
+                      shifted.Inside(f[0], f[1], f[2]));
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(MsaaTest, ResolveRoundsEachChannelToNearest) {
+  // 样本平面间隔 stride，其余位置不应被读取
+  constexpr size_t kStride = 3;
+  const auto resolve = [](std::initializer_list<uint32_t> samples) {
+    uint32_t planes[kMaxMsaaSamples * kStride];
+    std::fill(std::begin(planes), std::end(planes), 0xDEADBEEFu);
+    size_t s = 0;
+    for (const uint32_t color : samples) planes[s++ * kStride] = color;
+    return ResolveSamples(planes, kStride, static_cast<uint32_t>(s));
+  };
+  EXPECT_EQ(resolve({0x12345678u}), 0x12345678u);
+  // 2x：平局向上取整
+  EXPECT_EQ(resolve({0x00000001u, 0x00000002u}), 0x00000002u);
+  EXPECT_EQ(resolve({0x01020304u, 0x01020304u}), 0x01020304u);
+  // 4x：余数 1 向下、余数 2 向上
+  EXPECT_EQ(resolve({0u, 0u, 0u, 0x01010101u}), 0x00000000u);
+  EXPECT_EQ(resolve({0u, 0u, 0x01010101u, 0x01010101u}), 0x01010101u);
+  EXPECT_EQ(resolve({0u, 0x03030303u, 0x03030303u, 0x03030303u}),
+            0x02020202u);
+  // 各字节独立，不向相邻通道进位
+  EXPECT_EQ(resolve({0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu}),
+            0xFFFFFFFFu);
+  EXPECT_EQ(resolve({0xFF00FF00u, 0x00FF00FFu}), 0x80808080u);
+  EXPECT_EQ(resolve({0xFF000000u, 0u, 0u, 0u}), 0x40000000u);
+}
+
+TEST(MsaaTest, ResolveMatchesPerChannelAverage) {
+  std::mt19937 rng(480);
+  for (const uint32_t samples : {1u, 2u, 4u}) {
+    for (int iter = 0; iter < 1000; ++iter) {
+      uint32_t colors[kMaxMsaaSamples];
+      for (uint32_t s = 0; s < samples; ++s) colors[s] = rng();
+      const uint32_t resolved = ResolveSamples(colors, 1, samples);
+      for (int c = 0; c < 4; ++c) {
+        double mean = 0.0;
+        for (uint32_t s = 0; s < samples; ++s) {
+          mean += (colors[s] >> (c * 8)) & 0xFFu;
+        }
+        mean /= samples;
+        const auto channel = static_cast<int>((resolved >> (c * 8)) & 0xFFu);
+        // 四舍五入：误差不超过半个单位，平局向上
+        EXPECT_LE(std::abs(channel - mean), 0.5);
+        EXPECT_EQ(channel, static_cast<int>(std::floor(mean + 0.5)));
+      }
+    }
+  }
+}
+
+TEST(MsaaTest, FrameSamplesSurviveTileLoadAndResolve) {
+  // 帧模式：样本经 tile 加载、修改、解析后写回帧样本缓冲，
+  // 下一次加载得到的是各样本而非解析后的像素值
+  constexpr size_t kWidth = 8, kHeight = 4, kSamples = 4;
+  constexpr size_t kX0 = 2, kY0 = 1, kTileWidth = 4, kTileHeight = 2;
+  constexpr size_t kPlane = kWidth * kHeight;
+  constexpr size_t kTilePlane = kTileWidth * kTileHeight;
+  std::vector<float> frame_depth(kPlane * kSamples);
+  std::vector<uint32_t> frame_color(kPlane * kSamples);
+  for (size_t i = 0; i < frame_depth.size(); ++i) {
+    frame_depth[i] = static_cast<float>(i) / frame_depth.size();
+    frame_color[i] = static_cast<uint32_t>(i * 0x01010101u);
+  }
+  const std::vector<float> initial_depth = frame_depth;
+  const std::vector<uint32_t> initial_color = frame_color;
+  const FrameSampleBuffers frame{frame_depth.data(), frame_color.data(),
+                                 kPlane};
+
+  std::vector<float> tile_depth(kTilePlane * kSamples);
+  std::vector<uint32_t> tile_color(kTilePlane * kSamples);
+  LoadTileSamples(frame, kWidth, kX0, kY0, kTileWidth, kTileHeight, kSamples,
+                  tile_depth.data(), tile_color.data());
+  for (size_t s = 0; s < kSamples; ++s) {
+    for (size_t y = 0; y < kTileHeight; ++y) {
+      for (size_t x = 0; x < kTileWidth; ++x) {
+        const size_t t = s * kTilePlane + y * kTileWidth + x;
+        const size_t f = s * kPlane + (kY0 + y) * kWidth + kX0 + x;
+        EXPECT_EQ(tile_depth[t], frame_depth[f]);
+        EXPECT_EQ(tile_color[t], frame_color[f]);
+      }
+    }
+  }
+
+  // 模拟部分覆盖的边缘：只有样本 0 被写入，其余样本保持清除值
+  for (size_t i = 0; i < kTilePlane * kSamples; ++i) {
+    tile_depth[i] = i < kTilePlane ? 0.25f : 1.0f;
+    tile_color[i] = i < kTilePlane ? 0xFF0000FFu : 0u;
+  }
+  std::vector<float> depth(kPlane, -1.0f);
+  std::vector<uint32_t> color(kPlane, 0xDEADBEEFu);
+  ResolveTileSamples(tile_depth.data(), tile_color.data(), kTileWidth,
+                     kTileHeight, kSamples, kWidth, kX0, kY0, depth.data(),
+                     color.data(), frame);
+  for (size_t s = 0; s < kSamples; ++s) {
+    for (size_t y = 0; y < kHeight; ++y) {
+      for (size_t x = 0; x < kWidth; ++x) {
+        const size_t p = y * kWidth + x;
+        const size_t f = s * kPlane + p;
+        const bool inside = x >= kX0 && x < kX0 + kTileWidth && y >= kY0 &&
+                            y < kY0 + kTileHeight;
+        if (!inside) {
+          EXPECT_EQ(frame_depth[f], initial_depth[f]);
+          EXPECT_EQ(frame_color[f], initial_color[f]);
+          if (s == 0) {
+            EXPECT_EQ(depth[p], -1.0f);
+            EXPECT_EQ(color[p], 0xDEADBEEFu);
+          }
+          continue;
+        }
+        EXPECT_EQ(frame_depth[f], s == 0 ? 0.25f : 1.0f);
+        EXPECT_EQ(frame_color[f], s == 0 ? 0xFF0000FFu : 0u);
+        if (s == 0) {
+          // 解析结果：深度取样本最大值，颜色取平均
+          EXPECT_EQ(depth[p], 1.0f);
+          EXPECT_EQ(color[p], 0x40000040u);
+        }
+      }
+    }
+  }
+
+  LoadTileSamples(frame, kWidth, kX0, kY0, kTileWidth, kTileHeight, kSamples,
+                  tile_depth.data(), tile_color.data());
+  EXPECT_EQ(tile_depth[0], 0.25f);
+  EXPECT_EQ(tile_depth[kTilePlane], 1.0f);
+  EXPECT_EQ(tile_color[0], 0xFF0000FFu);
+}
+
+}  // namespace
+}  // namespace simple_renderer
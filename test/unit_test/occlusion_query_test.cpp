@@ -0,0 +1,171 @@
+
+/**
+ * @file occlusion_query_test.cpp
+ * @brief 遮挡查询与包围盒代理测试
+ * @copyright MIT LICENSE
+ * https://github.com/Simple-XX/SimpleRenderer
+ */
+
+#include "occlusion_query.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <glm/gtc/matrix_transform.hpp>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "renderer.h"
+#include "renderers/renderer_base.hpp"
+
+namespace simple_renderer {
+namespace {
+
+constexpr size_t kWidth = 64;
+constexpr size_t kHeight = 64;
+
+/// 暴露深度缓冲的最小渲染器，用于构造上一次绘制残留的深度
+class DepthOnlyRenderer final : public RendererBase {
+ public:
+  using RendererBase::AcquireDepthBuffer;
+  using RendererBase::RendererBase;
+  bool Render(const Model&, const Shader&, uint32_t*) override { return false; }
+};
+
+/// 相机位于 z = 3 看向原点
+Shader MakeShader() {
+  Shader shader;
+  shader.SetUniform("modelMatrix", Matrix4f(1.0f));
+  shader.SetUniform("viewMatrix",
+                    glm::lookAt(Vector3f(0.0f, 0.0f, 3.0f), Vector3f(0.0f),
+                                Vector3f(0.0f, 1.0f, 0.0f)));
+  shader.SetUniform("projectionMatrix",
+                    glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, 100.0f));
+  return shader;
+}
+
+const Vector3f kBoxMin(-0.5f, -0.5f, -0.5f);
+const Vector3f kBoxMax(0.5f, 0.5f, 0.5f);
+
+TEST(OcclusionQueryTest, BoundingBoxOutsideFrameIgnoresStaleDepth) {
+  DepthOnlyRenderer renderer(kWidth, kHeight);
+  const Shader shader = MakeShader();
+
+  // 帧内、深度为清除值：屏幕矩形内全部通过
+  auto clear = std::make_unique<float[]>(kWidth * kHeight);
+  std::fill_n(clear.get(), kWidth * kHeight, 1.0f);
+  renderer.SetFrameDepthBuffer(clear.get());
+  const uint64_t visible = renderer.TestBoundingBox(kBoxMin, kBoxMax, shader);
+  EXPECT_GT(visible, 0u);
+  EXPECT_LT(visible, kWidth * kHeight);
+
+  // 帧内、深度全部更近：完全遮挡
+  auto occluder = std::make_unique<float[]>(kWidth * kHeight);
+  std::fill_n(occluder.get(), kWidth * kHeight, -1.0f);
+  renderer.SetFrameDepthBuffer(occluder.get());
+  EXPECT_EQ(renderer.TestBoundingBox(kBoxMin, kBoxMax, shader), 0u);
+
+  // 帧外：上一次独立绘制留下的深度不参与测试
+  renderer.SetFrameDepthBuffer(nullptr);
+  renderer.AcquireDepthBuffer(-1.0f);
+  EXPECT_EQ(renderer.TestBoundingBox(kBoxMin, kBoxMax, shader), visible);
+
+  // 视锥体外的包围盒不可见
+  EXPECT_EQ(renderer.TestBoundingBox(Vector3f(0.0f, 0.0f, 5.0f),
+                                     Vector3f(1.0f, 1.0f, 6.0f), shader),
+            0u);
+}
+
+TEST(OcclusionQueryTest, QueryAccumulatesSamplesBetweenBeginAndEnd) {
+  SimpleRenderer renderer(kWidth, kHeight);
+  const Shader shader = MakeShader();
+  const Vector3f small_min(-0.1f, -0.1f, -0.1f);
+  const Vector3f small_max(0.1f, 0.1f, 0.1f);
+
+  OcclusionQuery query;
+  EXPECT_FALSE(query.IsActive());
+  EXPECT_FALSE(query.IsResultAvailable());
+
+  // 查询之外的绘制不计入
+  const uint64_t before = renderer.DrawBoundingBox(kBoxMin, kBoxMax, shader);
+  renderer.BeginQuery(query);
+  EXPECT_TRUE(query.IsActive());
+  EXPECT_FALSE(query.IsResultAvailable());
+  const uint64_t a = renderer.DrawBoundingBox(kBoxMin, kBoxMax, shader);
+  const uint64_t b = renderer.DrawBoundingBox(small_min, small_max, shader);
+  renderer.EndQuery();
+  renderer.DrawBoundingBox(kBoxMin, kBoxMax, shader);
+
+  EXPECT_EQ(a, before);
+  EXPECT_GT(b, 0u);
+  EXPECT_LT(b, a);
+  EXPECT_FALSE(query.IsActive());
+  EXPECT_TRUE(query.IsResultAvailable());
+  EXPECT_EQ(query.GetSamplesPassed(), a + b);
+  EXPECT_TRUE(query.AnySamplesPassed());
+
+  // 再次开始时清零；视锥体外的包围盒不贡献样本
+  renderer.BeginQuery(query);
+  EXPECT_EQ(query.GetSamplesPassed(), 0u);
+  EXPECT_EQ(renderer.DrawBoundingBox(Vector3f(0.0f, 0.0f, 5.0f),
+                                     Vector3f(1.0f, 1.0f, 6.0f), shader),
+            0u);
+  renderer.EndQuery();
+  EXPECT_FALSE(query.AnySamplesPassed());
+}
+
+TEST(OcclusionQueryTest, QueryInsideFrameUsesFrameDepth) {
+  SimpleRenderer renderer(kWidth, kHeight);
+  const Shader shader = MakeShader();
+  const uint64_t outside = renderer.DrawBoundingBox(kBoxMin, kBoxMax, shader);
+
+  OcclusionQuery query;
+  renderer.BeginFrame();
+  renderer.BeginQuery(query);
+  // 帧开始时深度为清除值，与帧外结果一致
+  const uint64_t inside = renderer.DrawBoundingBox(kBoxMin, kBoxMax, shader);
+  renderer.EndQuery();
+  renderer.EndFrame();
+  EXPECT_EQ(inside, outside);
+  EXPECT_EQ(query.GetSamplesPassed(), inside);
+}
+
+TEST(OcclusionQueryTest, CulledDrawOutsideFrameStillClears) {
+  // 远在视锥体外的三角形：包围盒测试剔除，但帧外的绘制仍须清屏
+  const std::string path = ::testing::TempDir() + "offscreen_triangle.obj";
+  std::ofstream(path) << "v 100 0 0\nv 101 0 0\nv 100 1 0\n"
+                         "vn 0 0 1\nf 1//1 2//1 3//1\n";
+  const Model model(path);
+  const Shader shader = MakeShader();
+
+  SimpleRenderer renderer(kWidth, kHeight);
+  renderer.SetOcclusionCullingEnabled(true);
+  std::vector<uint32_t> buffer(kWidth * kHeight, 0xFFFFFFFFu);
+  EXPECT_TRUE(renderer.DrawModel(model, shader, buffer.data()));
+  EXPECT_TRUE(std::all_of(buffer.begin(), buffer.end(),
+                          [](uint32_t c) { return c == 0u; }));
+
+  // 帧内同样的绘制被跳过，保留已有颜色
+  std::fill(buffer.begin(), buffer.end(), 0xFFFFFFFFu);
+  renderer.BeginFrame();
+  EXPECT_TRUE(renderer.DrawModel(model, shader, buffer.data()));
+  renderer.EndFrame();
+  EXPECT_TRUE(std::all_of(buffer.begin(), buffer.end(),
+                          [](uint32_t c) { return c == 0xFFFFFFFFu; }));
+}
+
+TEST(OcclusionQueryTest, QueryMisuseThrows) {
+  SimpleRenderer renderer(kWidth, kHeight);
+  OcclusionQuery first, second;
+  EXPECT_THROW(renderer.EndQuery(), std::runtime_error);
+  renderer.BeginQuery(first);
+  EXPECT_THROW(renderer.BeginQuery(second), std::runtime_error);
+  renderer.EndQuery();
+  EXPECT_TRUE(first.IsResultAvailable());
+  EXPECT_FALSE(second.IsActive());
+}
+
+}  // namespace
+}  // namespace simple_renderer
@@ -0,0 +1,215 @@
+
+/**
+ * @file raster_kernel_test.cpp
+ * @brief raster_kernel.hpp 测试
+ * @copyright MIT LICENSE
+ * https://github.com/Simple-XX/SimpleRenderer
+ */
+
+#include "raster_kernel.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace simple_renderer {
+namespace {
+
+/// 本机支持的全部指令集（不含标量）
+std::vector<RasterIsa> SupportedIsas() {
+  std::vector<RasterIsa> isas;
+  const RasterIsa best = DetectRasterIsa();
+  for (const RasterIsa isa : {RasterIsa::kSse42, RasterIsa::kAvx2,
+                              RasterIsa::kAvx512}) {
+    if (static_cast<uint8_t>(isa) <= static_cast<uint8_t>(best)) {
+      isas.push_back(isa);
+    }
+  }
+  return isas;
+}
+
+/// 比较两个结果：覆盖掩码、存活通道与各插值结果逐位相同
+void ExpectSameResult(const RasterRowResult& expected,
+                      const RasterRowResult& actual, const char* isa) {
+  ASSERT_EQ(expected.cover_mask, actual.cover_mask) << isa;
+  ASSERT_EQ(expected.count, actual.count) << isa;
+  for (uint32_t n = 0; n < expected.count; ++n) {
+    EXPECT_EQ(expected.lane[n], actual.lane[n]) << isa;
+    EXPECT_EQ(std::bit_cast<uint32_t>(expected.b0[n]),
+              std::bit_cast<uint32_t>(actual.b0[n])) << isa;
+    EXPECT_EQ(std::bit_cast<uint32_t>(expected.b1[n]),
+              std::bit_cast<uint32_t>(actual.b1[n])) << isa;
+    EXPECT_EQ(std::bit_cast<uint32_t>(expected.b2[n]),
+              std::bit_cast<uint32_t>(actual.b2[n])) << isa;
+    EXPECT_EQ(std::bit_cast<uint32_t>(expected.z[n]),
+              std::bit_cast<uint32_t>(actual.z[n])) << isa;
+  }
+}
+
+/// 对全部受支持的内核运行同一行并与标量版本比较
+void ExpectKernelsMatchScalar(const RasterTriangle& tri, const RasterRow& row) {
+  static constexpr const char* kNames[] = {"scalar", "sse4.2", "avx2",
+                                           "avx512"};
+  RasterRowResult expected;
+  RasterRowScalar(tri, row, expected);
+  for (const RasterIsa isa : SupportedIsas()) {
+    RasterRowResult actual;
+    GetRasterRowKernel(isa)(tri, row, actual);
+    ExpectSameResult(expected, actual, kNames[static_cast<size_t>(isa)]);
+  }
+}
+
+TEST(RasterKernelTest, UnsupportedIsaFallsBackToScalar) {
+  EXPECT_EQ(GetRasterRowKernel(RasterIsa::kScalar), &RasterRowScalar);
+  const RasterIsa best = DetectRasterIsa();
+  for (const RasterIsa isa : {RasterIsa::kSse42, RasterIsa::kAvx2,
+                              RasterIsa::kAvx512}) {
+    if (static_cast<uint8_t>(isa) > static_cast<uint8_t>(best)) {
+      EXPECT_EQ(GetRasterRowKernel(isa), &RasterRowScalar)
+          << static_cast<int>(isa);
+    }
+  }
+}
+
+TEST(RasterKernelTest, SimdKernelsMatchScalarOnRandomTriangles) {
+  if (SupportedIsas().empty()) {
+    GTEST_SKIP() << "no SIMD raster kernel on this CPU";
+  }
+  std::mt19937 rng(43);
+  // 屏幕坐标覆盖保护带（含负坐标），边函数值可达 2^40 以上
+  std::uniform_real_distribution<float> coord(-16384.0f, 16384.0f);
+  std::uniform_real_distribution<float> inv_w(0.01f, 10.0f);
+  std::uniform_real_distribution<float> ndc_z(-1.0f, 1.0f);
+  std::uniform_int_distribution<int32_t> pixel(-20000, 20000);
+  std::uniform_int_distribution<int32_t> lanes(1, kRasterLanes);
+  std::uniform_int_distribution<int> flag(0, 1);
+
+  int tested_rows = 0;
+  for (int iter = 0; iter < 20000; ++iter) {
+    Vector4f p[3];
+    for (auto& v : p) v = {coord(rng), coord(rng), ndc_z(rng), inv_w(rng)};
+    TriangleSetup setup;
+    if (!setup.Setup(p[0], p[1], p[2])) continue;
+    const RasterTriangle tri = MakeRasterTriangle(setup, p[0], p[1], p[2]);
+
+    // 一半的行取自三角形内部附近，保证有覆盖像素
+    int32_t x, y;
+    if (flag(rng) != 0) {
+      const Vector4f c = (p[0] + p[1] + p[2]) / 3.0f;
+      x = static_cast<int32_t>(c.x) - kRasterLanes / 2;
+      y = static_cast<int32_t>(c.y);
+    } else {
+      x = pixel(rng);
+      y = pixel(rng);
+    }
+    alignas(32) float depth[kRasterLanes];
+    for (float& d : depth) d = ndc_z(rng);
+    const bool test_depth = flag(rng) != 0;
+    const RasterRow row{{setup.Evaluate(0, x, y), setup.Evaluate(1, x, y),
+                         setup.Evaluate(2, x, y)},
+                        lanes(rng),
+                        flag(rng) != 0,
+                        test_depth ? depth : nullptr,
+                        flag(rng) != 0 ? 1e-8f : 0.0f};
+    ExpectKernelsMatchScalar(tri, row);
+    ++tested_rows;
+    if (HasFatalFailure()) return;
+  }
+  EXPECT_GT(tested_rows, 10000);
+}
+
+TEST(RasterKernelTest, SimdKernelsMatchScalarOnExtremeEdgeValues) {
+  if (SupportedIsas().empty()) {
+    GTEST_SKIP() << "no SIMD raster kernel on this CPU";
+  }
+  // 直接构造的边函数值：负值、2^24 附近（float 舍入边界）与接近 2^50
+  std::mt19937_64 rng(430);
+  std::uniform_int_distribution<int> magnitude(0, 49);
+  std::uniform_real_distribution<float> persp(-1e-6f, 1e-6f);
+  std::uniform_int_distribution<int> flag(0, 1);
+  for (int iter = 0; iter < 20000; ++iter) {
+    RasterTriangle tri{};
+    int64_t e[3];
+    for (int k = 0; k < 3; ++k) {
+      const int bits = magnitude(rng);
+      const int64_t value = static_cast<int64_t>(rng() >> (64 - bits - 1));
+      e[k] = flag(rng) != 0 ? value : -value;
+      tri.step_x[k] = static_cast<int64_t>(rng() % 4097) - 2048;
+      tri.bias[k] = flag(rng) != 0 ? 0 : -1;
+      tri.persp[k] = persp(rng);
+      tri.depth[k] = persp(rng);
+    }
+    const RasterRow row{{e[0], e[1], e[2]}, kRasterLanes, flag(rng) != 0,
+                        nullptr, 0.0f};
+    ExpectKernelsMatchScalar(tri, row);
+    if (HasFatalFailure()) return;
+  }
+}
+
+TEST(RasterKernelTest, SimdKernelsMatchScalarAtRoundingBoundaries) {
+  if (SupportedIsas().empty()) {
+    GTEST_SKIP() << "no SIMD raster kernel on this CPU";
+  }
+  // int64 -> float 在 2^24 以上需要舍入，覆盖就近舍入到偶数的分界
+  const int64_t bases[] = {(int64_t{1} << 24) - 3, (int64_t{1} << 25) - 5,
+                           (int64_t{1} << 40) + 7, -(int64_t{1} << 24) - 3,
+                           -(int64_t{1} << 50)};
+  for (const int64_t base : bases) {
+    RasterTriangle tri{};
+    for (int k = 0; k < 3; ++k) {
+      tri.step_x[k] = 1;
+      tri.persp[k] = 1.0f / static_cast<float>(k + 3);
+      tri.depth[k] = 1e-9f;
+    }
+    const RasterRow row{{base, base + 1, base + 2}, kRasterLanes, false,
+                        nullptr, 0.0f};
+    ExpectKernelsMatchScalar(tri, row);
+  }
+}
+
+TEST(RasterKernelTest, SimdKernelsMatchScalarAtMaxViewportExtent) {
+  if (SupportedIsas().empty()) {
+    GTEST_SKIP() << "no SIMD raster kernel on this CPU";
+  }
+  // 最大视口下保护带角点处的三角形：边函数取到允许范围的上端
+  const float extent = static_cast<float>(kMaxViewportExtent);
+  const float lo = (1.0f - kGuardBand) * 0.5f * extent;
+  const float hi = (1.0f + kGuardBand) * 0.5f * extent;
+  const Vector4f corners[][3] = {
+      {{lo, lo, 0.5f, 1.0f}, {hi, lo, -0.5f, 0.5f}, {lo, hi, 0.0f, 2.0f}},
+      {{hi, hi, 0.5f, 1.0f}, {lo, hi, -0.5f, 0.5f}, {hi, lo, 0.0f, 2.0f}},
+      {{lo, lo, 0.5f, 1.0f}, {lo, hi, -0.5f, 0.5f}, {hi, lo, 0.0f, 2.0f}},
+  };
+  const int32_t last = static_cast<int32_t>(kMaxViewportExtent) - kRasterLanes;
+  int64_t largest = 0;
+  for (const auto& p : corners) {
+    TriangleSetup setup;
+    ASSERT_TRUE(setup.Setup(p[0], p[1], p[2]));
+    const RasterTriangle tri = MakeRasterTriangle(setup, p[0], p[1], p[2]);
+    for (const int32_t y : {0, last / 2, last + kRasterLanes - 1}) {
+      for (const int32_t x : {0, last / 2, last}) {
+        const RasterRow row{{setup.Evaluate(0, x, y), setup.Evaluate(1, x, y),
+                             setup.Evaluate(2, x, y)},
+                            kRasterLanes,
+                            true,
+                            nullptr,
+                            0.0f};
+        for (const int64_t e : row.e) {
+          ASSERT_LE(std::abs(e), kMaxEdgeFunctionMagnitude);
+          largest = std::max(largest, std::abs(e));
+        }
+        ExpectKernelsMatchScalar(tri, row);
+        if (HasFatalFailure()) return;
+      }
+    }
+  }
+  // 确实取到了上限附近的边函数值
+  EXPECT_GT(largest, kMaxEdgeFunctionMagnitude / 16);
+}
+
+}  // namespace
+}  // namespace simple_renderer
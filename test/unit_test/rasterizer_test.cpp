@@ -0,0 +1,116 @@
+
+/**
+ * @file rasterizer_test.cpp
+ * @brief rasterizer.hpp 测试
+ * @copyright MIT LICENSE
+ * https://github.com/Simple-XX/SimpleRenderer
+ */
+
+#include "rasterizer.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <span>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace simple_renderer {
+namespace {
+
+constexpr size_t kWidth = 256;
+constexpr size_t kHeight = 256;
+
+/// 透视投影后的纹理四边形：相机位于原点看向 -z，四边形向远处倾斜
+class PerspectiveQuadTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    projection_ = glm::perspective(glm::radians(60.0f),
+                                   float(kWidth) / float(kHeight), 0.1f, 100.0f);
+    // 四边形 P(u, v) = origin_ + u * axis_u_ + v * axis_v_，近处 z = -1.5，远处 z = -9
+    origin_ = Vector3f(-1.0f, -1.0f, -1.5f);
+    axis_u_ = Vector3f(2.0f, 0.0f, 0.0f);
+    axis_v_ = Vector3f(0.0f, 2.0f, -7.5f);
+  }
+
+  /// 与渲染器相同的透视除法（w 保存 1 / w_clip）与视口变换
+  Vertex ToScreen(const Vector2f& uv) const {
+    const Vector3f world = origin_ + uv.x * axis_u_ + uv.y * axis_v_;
+    const Vector4f clip = projection_ * Vector4f(world, 1.0f);
+    const Vector3f ndc = Vector3f(clip) / clip.w;
+    const Vector4f screen((ndc.x + 1.0f) * kWidth / 2.0f,
+                          (1.0f - ndc.y) * kHeight / 2.0f, ndc.z,
+                          1.0f / clip.w);
+    return Vertex(screen, Vector3f(0.0f, 0.0f, 1.0f), uv, Color());
+  }
+
+  /// 像素采样点 (x, y) 的视线与四边形平面求交得到的精确 uv
+  Vector2f AnalyticUv(int32_t x, int32_t y) const {
+    const float ndc_x = 2.0f * static_cast<float>(x) / kWidth - 1.0f;
+    const float ndc_y = 1.0f - 2.0f * static_cast<float>(y) / kHeight;
+    const Vector4f far = glm::inverse(projection_) *
+                         Vector4f(ndc_x, ndc_y, 1.0f, 1.0f);
+    const Vector3f dir = Vector3f(far) / far.w;
+    // origin_ + u * axis_u_ + v * axis_v_ = t * dir
+    const Vector3f solution =
+        glm::inverse(Matrix3f(axis_u_, axis_v_, -dir)) * -origin_;
+    return {solution.x, solution.y};
+  }
+
+  Matrix4f projection_;
+  Vector3f origin_, axis_u_, axis_v_;
+};
+
+TEST_F(PerspectiveQuadTest, InterpolatesTexCoordsPerspectiveCorrectly) {
+  const Vertex v00 = ToScreen({0.0f, 0.0f});
+  const Vertex v10 = ToScreen({1.0f, 0.0f});
+  const Vertex v01 = ToScreen({0.0f, 1.0f});
+  const Vertex v11 = ToScreen({1.0f, 1.0f});
+
+  Rasterizer rasterizer(kWidth, kHeight);
+  std::vector<Fragment> fragments;
+  const FragmentSink sink = [&](std::span<Fragment> batch) {
+    EXPECT_LE(batch.size(), kFragmentBatchSize);
+    fragments.insert(fragments.end(), batch.begin(), batch.end());
+  };
+  rasterizer.Rasterize(v00, v10, v11, sink);
+  rasterizer.Rasterize(v00, v11, v01, sink);
+  ASSERT_GT(fragments.size(), 1000u);
+
+  float max_error = 0.0f;
+  for (const auto& fragment : fragments) {
+    const Vector2f expected =
+        AnalyticUv(fragment.screen_coord[0], fragment.screen_coord[1]);
+    max_error = std::max({max_error, std::abs(fragment.uv.x - expected.x),
+                          std::abs(fragment.uv.y - expected.y)});
+  }
+  // 误差来自顶点吸附到 1/256 像素与 float 运算；线性插值的误差远大于此
+  EXPECT_LT(max_error, 2e-3f);
+}
+
+TEST_F(PerspectiveQuadTest, QuadDerivativesMatchNeighbourDifferences) {
+  const Vertex v00 = ToScreen({0.0f, 0.0f});
+  const Vertex v10 = ToScreen({1.0f, 0.0f});
+  const Vertex v11 = ToScreen({1.0f, 1.0f});
+
+  Rasterizer rasterizer(kWidth, kHeight);
+  std::vector<Fragment> fragments;
+  rasterizer.Rasterize(v00, v10, v11, [&](std::span<Fragment> batch) {
+    fragments.insert(fragments.end(), batch.begin(), batch.end());
+  });
+  ASSERT_FALSE(fragments.empty());
+
+  for (const auto& fragment : fragments) {
+    const int32_t qx = fragment.screen_coord[0] & ~1;
+    const int32_t qy = fragment.screen_coord[1] & ~1;
+    const Vector2f a00 = AnalyticUv(qx, qy);
+    const Vector2f ddx = AnalyticUv(qx + 1, qy) - a00;
+    const Vector2f ddy = AnalyticUv(qx, qy + 1) - a00;
+    EXPECT_NEAR(fragment.uv_dx.x, ddx.x, 1e-3f);
+    EXPECT_NEAR(fragment.uv_dx.y, ddx.y, 1e-3f);
+    EXPECT_NEAR(fragment.uv_dy.x, ddy.x, 1e-3f);
+    EXPECT_NEAR(fragment.uv_dy.y, ddy.y, 1e-3f);
+  }
+}
+
+}  // namespace
+}  // namespace simple_renderer
@@ -0,0 +1,118 @@
+
+/**
+ * @file shader_test.cpp
+ * @brief shader.hpp 测试
+ * @copyright MIT LICENSE
+ * https://github.com/Simple-XX/SimpleRenderer
+ */
+
+#include "shader.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "light.h"
+#include "material.hpp"
+
+namespace simple_renderer {
+namespace {
+
+TEST(ShaderTest, VaryingsDefaultToAll) {
+  const Shader shader;
+  EXPECT_EQ(shader.GetVaryings(), kVaryingAll);
+}
+
+TEST(ShaderTest, NormalVaryingImpliesWorldPosition) {
+  Shader shader;
+  // 光照的视线方向需要插值后的世界空间位置
+  shader.SetVaryings(kVaryingNormal);
+  EXPECT_EQ(shader.GetVaryings(), kVaryingNormal | kVaryingWorldPosition);
+  shader.SetVaryings(kVaryingNormal | kVaryingTexCoords);
+  EXPECT_EQ(shader.GetVaryings(),
+            kVaryingNormal | kVaryingTexCoords | kVaryingWorldPosition);
+
+  // 不做光照时保持声明的属性
+  shader.SetVaryings(kVaryingTexCoords | kVaryingColor);
+  EXPECT_EQ(shader.GetVaryings(), kVaryingTexCoords | kVaryingColor);
+  shader.SetVaryings(0);
+  EXPECT_EQ(shader.GetVaryings(), 0);
+}
+
+/// 光照分支：纹理为纯红，材质常量为灰绿色，光线与法线成 45°、高光为 0
+class LitShaderTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    texels_.assign(2 * 2 * 4, 0);
+    for (size_t i = 0; i < texels_.size(); i += 4) {
+      texels_[i] = 255;
+      texels_[i + 3] = 255;
+    }
+    Texture texture;
+    texture.data = texels_.data();
+    texture.width = 2;
+    texture.height = 2;
+    texture.channels = 4;
+    texture.GenerateMipmaps();
+    material_.ambient = Vector3f(0.4f, 0.6f, 0.2f);
+    material_.diffuse = Vector3f(0.4f, 0.6f, 0.2f);
+    material_.shininess = 32.0f;
+    material_.ambient_texture = texture;
+    material_.diffuse_texture = texture;
+    material_.has_ambient_texture = true;
+    material_.has_diffuse_texture = true;
+
+    Light light("test light");
+    light.dir = Vector3f(0.0f, 1.0f, 1.0f);
+    shader_.SetUniform("light", light);
+    shader_.SetUniform("cameraPos", Vector3f(0.0f, 0.0f, 5.0f));
+
+    fragment_.screen_coord = {0, 0};
+    fragment_.normal = Vector3f(0.0f, 0.0f, 1.0f);
+    fragment_.depth = 0.0f;
+    fragment_.material = &material_;
+  }
+
+  /// ambient * 0.1 + kd * cos(45°)，逐通道比较（允许 8 位量化误差 1）
+  void ExpectLit(const Color& actual, const Vector3f& ambient,
+                 const Vector3f& kd) const {
+    const Vector3f expected = glm::clamp(
+        ambient * 0.1f + kd * std::sqrt(0.5f), Vector3f(0.0f), Vector3f(1.0f));
+    const Color expected_color(expected.x, expected.y, expected.z, 1.0f);
+    for (const auto c : {Color::kColorIndexRed, Color::kColorIndexGreen,
+                         Color::kColorIndexBlue}) {
+      EXPECT_LE(std::abs(int(actual[c]) - int(expected_color[c])), 1) << c;
+    }
+  }
+
+  std::vector<uint8_t> texels_;
+  Material material_;
+  Shader shader_;
+  Fragment fragment_{};
+};
+
+TEST_F(LitShaderTest, NormalOnlyUsesMaterialConstants) {
+  // 未声明 uv 与颜色：不采样纹理，也不使用未插值的顶点颜色
+  shader_.SetVaryings(kVaryingNormal);
+  ExpectLit(shader_.FragmentShader(fragment_), material_.ambient,
+            material_.diffuse);
+}
+
+TEST_F(LitShaderTest, DeclaredTexCoordsSampleTextures) {
+  shader_.SetVaryings(kVaryingNormal | kVaryingTexCoords);
+  fragment_.uv = Vector2f(0.25f, 0.25f);
+  const Vector3f red(1.0f, 0.0f, 0.0f);
+  ExpectLit(shader_.FragmentShader(fragment_), red, red);
+}
+
+TEST_F(LitShaderTest, DeclaredColorReplacesMaterialConstants) {
+  shader_.SetVaryings(kVaryingNormal | kVaryingColor);
+  fragment_.color = Color(uint8_t(51), uint8_t(102), uint8_t(153));
+  const Vector3f vertex_color(0.2f, 0.4f, 0.6f);
+  ExpectLit(shader_.FragmentShader(fragment_), vertex_color, vertex_color);
+}
+
+}  // namespace
+}  // namespace simple_renderer
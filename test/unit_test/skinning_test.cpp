@@ -0,0 +1,237 @@
+
+/**
+ * @file skinning_test.cpp
+ * @brief 蒙皮与变形目标测试
+ * @copyright MIT LICENSE
+ * https://github.com/Simple-XX/SimpleRenderer
+ */
+
+#include "skinning.hpp"
+
+#include <fstream>
+#include <glm/gtc/matrix_transform.hpp>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "model.hpp"
+#include "vertex_kernel.hpp"
+
+namespace simple_renderer {
+namespace {
+
+/// 逐顶点的标量参考：先加变形目标位移，再按骨骼分别变换后加权求和
+struct ReferenceVertex {
+  Vector3f position;
+  Vector3f normal;
+};
+
+ReferenceVertex DeformReference(const Vertex& bind, const uint16_t* joints,
+                                const float* weights,
+                                const std::vector<Matrix4f>& bones,
+                                const std::vector<MorphBlend>& morphs,
+                                size_t local) {
+  Vector3f position(bind.GetPosition());
+  Vector3f normal = bind.GetNormal();
+  for (const auto& morph : morphs) {
+    position += morph.weight * morph.target->position_deltas[local];
+    normal += morph.weight * morph.target->normal_deltas[local];
+  }
+  // 权重和不足 1 的部分保持绑定姿态
+  float residual = 1.0f;
+  Vector3f skinned_position = Vector3f(0.0f);
+  Vector3f skinned_normal = Vector3f(0.0f);
+  for (size_t k = 0; k < kMaxBoneInfluences; ++k) {
+    const Matrix4f& bone = bones[joints[k]];
+    skinned_position += weights[k] * Vector3f(bone * Vector4f(position, 1.0f));
+    skinned_normal += weights[k] * (Matrix3f(bone) * normal);
+    residual -= weights[k];
+  }
+  skinned_position += residual * position;
+  skinned_normal += residual * normal;
+  return {skinned_position, glm::normalize(skinned_normal)};
+}
+
+class DeformTest : public ::testing::Test {
+ protected:
+  static constexpr size_t kVertexCount = 45;
+  /// 与一个网格实例相同：形变区间从非批对齐的位置开始
+  static constexpr size_t kInstanceOffset = 5;
+  static constexpr size_t kBoneCount = 6;
+
+  void SetUp() override {
+    std::mt19937 rng(36);
+    std::uniform_real_distribution<float> coord(-2.0f, 2.0f);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::uniform_int_distribution<uint16_t> joint(0, kBoneCount - 1);
+
+    for (size_t b = 0; b < kBoneCount; ++b) {
+      // 旋转 + 平移 + 均匀缩放（法线变换假设无非均匀缩放）
+      const Vector3f axis =
+          glm::normalize(Vector3f(coord(rng), coord(rng), coord(rng)));
+      Matrix4f bone = glm::translate(Matrix4f(1.0f),
+                                     Vector3f(coord(rng), coord(rng), coord(rng)));
+      bone = glm::rotate(bone, 3.0f * coord(rng), axis);
+      bones_.push_back(glm::scale(bone, Vector3f(0.5f + unit(rng))));
+    }
+
+    for (size_t i = 0; i < kVertexCount; ++i) {
+      const Vector3f normal =
+          glm::normalize(Vector3f(coord(rng), coord(rng), coord(rng)));
+      bind_.push_back(Vertex(Vector4f(coord(rng), coord(rng), coord(rng), 1.0f),
+                             normal, Vector2f(unit(rng), unit(rng)), Color()));
+
+      uint16_t joints[kMaxBoneInfluences];
+      float weights[kMaxBoneInfluences];
+      float sum = 0.0f;
+      for (size_t k = 0; k < kMaxBoneInfluences; ++k) {
+        joints[k] = joint(rng);
+        // 部分影响为 0，部分顶点不绑定骨骼
+        weights[k] = unit(rng) < 0.3f ? 0.0f : unit(rng);
+        sum += weights[k];
+      }
+      const float scale = i % 7 == 3 ? 0.0f : (i % 5 == 1 ? 0.6f : 1.0f);
+      for (float& w : weights) {
+        w = sum > 0.0f ? w / sum * scale : 0.0f;
+      }
+      skin_.push_back(joints, weights);
+    }
+
+    for (int t = 0; t < 2; ++t) {
+      MorphTarget target;
+      target.vertex_offset = kInstanceOffset;
+      for (size_t i = kInstanceOffset; i < kVertexCount; ++i) {
+        target.position_deltas.emplace_back(coord(rng), coord(rng), coord(rng));
+        target.normal_deltas.push_back(0.2f * Vector3f(coord(rng), coord(rng),
+                                                       coord(rng)));
+      }
+      targets_.push_back(std::move(target));
+    }
+  }
+
+  /// 按 Model::ApplyPose 的方式对实例区间分批形变
+  VertexStreams Deform(const std::vector<MorphBlend>& morphs) const {
+    VertexStreams out = bind_;
+    const SkinPalette palette(bones_);
+    for (size_t begin = kInstanceOffset; begin < kVertexCount;
+         begin += kVertexBatchSize) {
+      DeformVertexBatch(bind_, skin_, palette, morphs, begin,
+                        std::min(begin + kVertexBatchSize, kVertexCount), out);
+    }
+    return out;
+  }
+
+  void ExpectMatchesReference(const VertexStreams& out,
+                              const std::vector<MorphBlend>& morphs) const {
+    for (size_t i = 0; i < kVertexCount; ++i) {
+      const Vertex actual = out.Get(i);
+      if (i < kInstanceOffset) {
+        // 区间外的顶点不被修改
+        EXPECT_EQ(actual.GetPosition(), bind_.Get(i).GetPosition()) << i;
+        EXPECT_EQ(actual.GetNormal(), bind_.Get(i).GetNormal()) << i;
+        continue;
+      }
+      uint16_t joints[kMaxBoneInfluences];
+      float weights[kMaxBoneInfluences];
+      for (size_t k = 0; k < kMaxBoneInfluences; ++k) {
+        joints[k] = skin_.GetJoints(k)[i];
+        weights[k] = skin_.GetWeights(k)[i];
+      }
+      const ReferenceVertex expected = DeformReference(
+          bind_.Get(i), joints, weights, bones_, morphs, i - kInstanceOffset);
+      for (int c = 0; c < 3; ++c) {
+        EXPECT_NEAR(actual.GetPosition()[c], expected.position[c], 1e-4f) << i;
+        EXPECT_NEAR(actual.GetNormal()[c], expected.normal[c], 1e-4f) << i;
+      }
+    }
+  }
+
+  std::vector<Matrix4f> bones_;
+  VertexStreams bind_;
+  SkinWeights skin_;
+  std::vector<MorphTarget> targets_;
+};
+
+TEST_F(DeformTest, LinearBlendSkinningMatchesScalarReference) {
+  ExpectMatchesReference(Deform({}), {});
+}
+
+TEST_F(DeformTest, MorphDeltasAndSkinningMatchScalarReference) {
+  const std::vector<MorphBlend> morphs = {{&targets_[0], 0.75f},
+                                          {&targets_[1], -0.3f}};
+  ExpectMatchesReference(Deform(morphs), morphs);
+}
+
+TEST_F(DeformTest, IdentityBonesKeepBindPose) {
+  bones_.assign(kBoneCount, Matrix4f(1.0f));
+  const VertexStreams out = Deform({});
+  for (size_t i = 0; i < kVertexCount; ++i) {
+    for (int c = 0; c < 3; ++c) {
+      EXPECT_NEAR(out.GetPosition(i)[c], bind_.GetPosition(i)[c], 1e-6f) << i;
+      EXPECT_NEAR(out.Get(i).GetNormal()[c], bind_.Get(i).GetNormal()[c],
+                  1e-6f)
+          << i;
+    }
+  }
+}
+
+/// 仅含一个变形目标、无骨骼无动画的三角形：目标将所有顶点沿 +z 移动 1，
+/// 默认权重 0.5
+constexpr char kMorphOnlyGltf[] = R"({
+  "asset": {"version": "2.0"},
+  "scene": 0,
+  "scenes": [{"nodes": [0]}],
+  "nodes": [{"mesh": 0}],
+  "meshes": [{
+    "primitives": [{
+      "attributes": {"POSITION": 0, "NORMAL": 1},
+      "targets": [{"POSITION": 2}],
+      "indices": 3
+    }],
+    "weights": [0.5]
+  }],
+  "buffers": [{
+    "byteLength": 114,
+    "uri": "data:application/octet-stream;base64,AAAAAAAAAAAAAAAAAACAPwAAAAAAAAAAAAAAAAAAgD8AAAAAAAAAAAAAAAAAAIA/AAAAAAAAAAAAAIA/AAAAAAAAAAAAAIA/AAAAAAAAAAAAAIA/AAAAAAAAAAAAAIA/AAAAAAAAAAAAAIA/AAABAAIA"
+  }],
+  "bufferViews": [
+    {"buffer": 0, "byteOffset": 0, "byteLength": 36},
+    {"buffer": 0, "byteOffset": 36, "byteLength": 36},
+    {"buffer": 0, "byteOffset": 72, "byteLength": 36},
+    {"buffer": 0, "byteOffset": 108, "byteLength": 6}
+  ],
+  "accessors": [
+    {"bufferView": 0, "componentType": 5126, "count": 3, "type": "VEC3",
+     "min": [0, 0, 0], "max": [1, 1, 0]},
+    {"bufferView": 1, "componentType": 5126, "count": 3, "type": "VEC3"},
+    {"bufferView": 2, "componentType": 5126, "count": 3, "type": "VEC3",
+     "min": [0, 0, 1], "max": [0, 0, 1]},
+    {"bufferView": 3, "componentType": 5123, "count": 3, "type": "SCALAR"}
+  ]
+})";
+
+TEST(MorphOnlyModelTest, ApplyPoseWithoutBones) {
+  const std::string path = ::testing::TempDir() + "morph_only.gltf";
+  std::ofstream(path) << kMorphOnlyGltf;
+  Model model(path);
+  ASSERT_TRUE(model.IsDeformable());
+  ASSERT_TRUE(model.GetBones().empty());
+  ASSERT_EQ(model.GetMorphTargets().size(), 1u);
+  ASSERT_EQ(model.GetVertices().size(), 3u);
+
+  Pose pose = model.GetBindPose();
+  EXPECT_TRUE(pose.bones.empty());
+  for (const float weight : {0.5f, 1.0f, 0.0f}) {
+    pose.morph_weights[0] = weight;
+    model.ApplyPose(pose);
+    for (size_t i = 0; i < model.GetVertices().size(); ++i) {
+      EXPECT_NEAR(model.GetVertices().GetPosition(i).z, weight, 1e-6f) << i;
+      EXPECT_NEAR(model.GetVertices().Get(i).GetNormal().z, 1.0f, 1e-6f) << i;
+    }
+    EXPECT_NEAR(model.GetMeshInstances()[0].bounds_max.z, weight, 1e-6f);
+  }
+}
+
+}  // namespace
+}  // namespace simple_renderer
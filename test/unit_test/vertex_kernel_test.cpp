@@ -0,0 +1,93 @@
+/**
+ * @file vertex_kernel_test.cpp
+ * @brief vertex_kernel_lanes.hpp 测试
+ * @copyright MIT LICENSE
+ * https://github.com/Simple-XX/SimpleRenderer
+ */
+
+#include "vertex_kernel_lanes.hpp"
+
+#include <bit>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "raster_kernel.hpp"
+
+namespace simple_renderer {
+namespace {
+
+/// 本机支持的位置内核指令集版本
+std::vector<std::pair<const char*, TransformLanesFn>> SupportedKernels() {
+  std::vector<std::pair<const char*, TransformLanesFn>> kernels;
+#if defined(SIMPLE_RENDERER_X86_KERNELS)
+  const RasterIsa best = DetectRasterIsa();
+  if (best >= RasterIsa::kAvx2) {
+    kernels.emplace_back("avx2", TransformLanesAvx2);
+  }
+  if (best >= RasterIsa::kAvx512) {
+    kernels.emplace_back("avx512", TransformLanesAvx512);
+  }
+#endif
+  return kernels;
+}
+
+/// 逐通道逐位比较（NaN 也须相同）
+void ExpectSameLanes(const PositionLanes& expected, const PositionLanes& actual,
+                     const char* isa) {
+  const auto same = [](const float* a, const float* b, size_t l) {
+    return std::bit_cast<uint32_t>(a[l]) == std::bit_cast<uint32_t>(b[l]);
+  };
+  for (size_t l = 0; l < kVertexBatchSize; ++l) {
+    EXPECT_TRUE(same(expected.cx, actual.cx, l)) << isa << " lane " << l;
+    EXPECT_TRUE(same(expected.cy, actual.cy, l)) << isa << " lane " << l;
+    EXPECT_TRUE(same(expected.cz, actual.cz, l)) << isa << " lane " << l;
+    EXPECT_TRUE(same(expected.cw, actual.cw, l)) << isa << " lane " << l;
+    EXPECT_TRUE(same(expected.sx, actual.sx, l)) << isa << " lane " << l;
+    EXPECT_TRUE(same(expected.sy, actual.sy, l)) << isa << " lane " << l;
+    EXPECT_TRUE(same(expected.sz, actual.sz, l)) << isa << " lane " << l;
+    EXPECT_TRUE(same(expected.sw, actual.sw, l)) << isa << " lane " << l;
+    EXPECT_EQ(expected.code[l], actual.code[l]) << isa << " lane " << l;
+  }
+}
+
+TEST(VertexKernelTest, SimdKernelsMatchDefaultTargetBitExactly) {
+  const auto kernels = SupportedKernels();
+  if (kernels.empty()) {
+    GTEST_SKIP() << "no AVX2/AVX-512 vertex kernel on this CPU";
+  }
+  std::mt19937 rng(33);
+  std::uniform_real_distribution<float> coord(-50.0f, 50.0f);
+  std::uniform_real_distribution<float> element(-2.0f, 2.0f);
+  const ViewportParams viewport{1920.0f, 1080.0f};
+
+  for (int iter = 0; iter < 2000; ++iter) {
+    // 随机矩阵使 w 覆盖负值、接近 0 与正值，涵盖裁剪码与 w 过小的分支
+    Matrix4f m;
+    for (int c = 0; c < 4; ++c) {
+      for (int r = 0; r < 4; ++r) {
+        m[c][r] = element(rng);
+      }
+    }
+    alignas(32) float px[kVertexBatchSize];
+    alignas(32) float py[kVertexBatchSize];
+    alignas(32) float pz[kVertexBatchSize];
+    for (size_t l = 0; l < kVertexBatchSize; ++l) {
+      px[l] = coord(rng);
+      py[l] = coord(rng);
+      pz[l] = coord(rng);
+    }
+    PositionLanes expected;
+    TransformLanesDefault(m, px, py, pz, viewport, expected);
+    for (const auto& [name, kernel] : kernels) {
+      PositionLanes actual;
+      kernel(m, px, py, pz, viewport, actual);
+      ExpectSameLanes(expected, actual, name);
+    }
+    if (HasFailure()) return;
+  }
+}
+
+}  // namespace
+}  // namespace simple_renderer
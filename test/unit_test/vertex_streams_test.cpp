@@ -0,0 +1,137 @@
+
+/**
+ * @file vertex_streams_test.cpp
+ * @brief vertex_streams.hpp 测试
+ * @copyright MIT LICENSE
+ * https://github.com/Simple-XX/SimpleRenderer
+ */
+
+#include "vertex_streams.hpp"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace simple_renderer {
+namespace {
+
+/// 随机单位向量（含下半球）
+Vector3f RandomUnit(std::mt19937& rng) {
+  std::normal_distribution<float> gaussian;
+  Vector3f v;
+  do {
+    v = {gaussian(rng), gaussian(rng), gaussian(rng)};
+  } while (glm::dot(v, v) < 1e-6f);
+  return glm::normalize(v);
+}
+
+TEST(VertexStreamsTest, HalfFloatRoundTripsEveryFiniteHalf) {
+  for (uint32_t h = 0; h <= 0xffffu; ++h) {
+    const auto half = static_cast<uint16_t>(h);
+    const float value = HalfToFloat(half);
+    if (std::isnan(value)) {
+      EXPECT_EQ(half & 0x7c00u, 0x7c00u) << h;
+      EXPECT_TRUE(std::isnan(HalfToFloat(FloatToHalf(value)))) << h;
+      continue;
+    }
+    EXPECT_EQ(FloatToHalf(value), half) << h;
+  }
+}
+
+TEST(VertexStreamsTest, FloatToHalfRoundsToNearestEven) {
+  // [1, 2) 内半精度的间隔为 2^-10
+  EXPECT_EQ(FloatToHalf(1.0f + 0x1p-11f), 0x3c00u);      // 平局，舍入到偶数
+  EXPECT_EQ(FloatToHalf(1.0f + 3 * 0x1p-11f), 0x3c02u);  // 平局，舍入到偶数
+  EXPECT_EQ(FloatToHalf(1.0f + 0x1p-11f + 0x1p-20f), 0x3c01u);
+  EXPECT_EQ(FloatToHalf(65520.0f), 0x7c00u);  // 溢出为无穷大
+  EXPECT_EQ(FloatToHalf(-0.0f), 0x8000u);
+
+  // UV 常见范围内的误差不超过半个 ulp
+  std::mt19937 rng(35);
+  std::uniform_real_distribution<float> uv(-4.0f, 4.0f);
+  for (int i = 0; i < 100000; ++i) {
+    const float value = uv(rng);
+    const float decoded = HalfToFloat(FloatToHalf(value));
+    const float ulp =
+        std::max(std::exp2(std::floor(std::log2(std::abs(value))) - 10.0f),
+                 0x1p-24f);
+    EXPECT_LE(std::abs(decoded - value), ulp / 2) << value;
+  }
+}
+
+TEST(VertexStreamsTest, OctahedralNormalRoundTrip) {
+  std::vector<Vector3f> normals = {{1, 0, 0},  {-1, 0, 0}, {0, 1, 0},
+                                   {0, -1, 0}, {0, 0, 1},  {0, 0, -1}};
+  std::mt19937 rng(350);
+  for (int i = 0; i < 100000; ++i) normals.push_back(RandomUnit(rng));
+
+  float max_error = 0.0f;
+  for (const Vector3f& normal : normals) {
+    const Vector3f decoded = DecodeOctahedral(EncodeOctahedral(normal));
+    EXPECT_NEAR(glm::length(decoded), 1.0f, 1e-6f);
+    max_error = std::max(max_error, glm::length(decoded - normal));
+  }
+  // snorm16 的量化步长为 1/32767，角度误差约为其量级
+  EXPECT_LT(max_error, 1e-4f);
+  // 退化法线编码为 +Z
+  EXPECT_EQ(DecodeOctahedral(EncodeOctahedral(Vector3f(0.0f))),
+            Vector3f(0.0f, 0.0f, 1.0f));
+}
+
+TEST(VertexStreamsTest, CompressRoundTripsWithinQuantizationBound) {
+  // 两段范围差别很大的网格，各自使用独立的量化范围
+  std::mt19937 rng(3500);
+  std::uniform_real_distribution<float> small(-0.5f, 0.5f);
+  std::uniform_real_distribution<float> large(-300.0f, 900.0f);
+  std::uniform_real_distribution<float> uv(0.0f, 1.0f);
+  constexpr size_t kFirst = 37, kCount = 100;
+  VertexStreams streams;
+  std::vector<Vertex> original;
+  for (size_t i = 0; i < kCount; ++i) {
+    auto& coord = i < kFirst ? small : large;
+    const Vertex vertex(Vector4f(coord(rng), coord(rng), coord(rng), 1.0f),
+                        RandomUnit(rng), Vector2f(uv(rng), uv(rng)),
+                        Color(static_cast<uint32_t>(rng())));
+    streams.push_back(vertex);
+    original.push_back(vertex);
+  }
+  const size_t float_bytes = streams.GetMemoryBytes();
+
+  streams.Compress({0, kFirst});
+  ASSERT_EQ(streams.GetFormat(), VertexFormat::kCompact);
+  ASSERT_EQ(streams.size(), kCount);
+  ASSERT_EQ(streams.GetSegments().size(), 2u);
+  EXPECT_LT(streams.GetMemoryBytes(), float_bytes);
+
+  for (size_t i = 0; i < kCount; ++i) {
+    const PositionSegment& segment =
+        streams.GetSegments()[streams.FindSegment(i)];
+    EXPECT_EQ(segment.begin, i < kFirst ? 0u : kFirst) << i;
+    const Vertex decoded = streams.Get(i);
+    const Vector4f expected = original[i].GetPosition();
+    for (int c = 0; c < 3; ++c) {
+      // 量化误差不超过半个步长，另加反量化时 float 运算的舍入误差
+      const float magnitude =
+          std::abs(segment.offset[c]) + segment.scale[c] * 65535.0f;
+      const float bound = segment.scale[c] * 0.5f + 0x1p-22f * magnitude;
+      EXPECT_NEAR(decoded.GetPosition()[c], expected[c], bound) << i;
+      EXPECT_EQ(streams.GetPosition(i)[c], decoded.GetPosition()[c]) << i;
+    }
+    EXPECT_EQ(decoded.GetPosition().w, 1.0f);
+    EXPECT_LT(glm::length(decoded.GetNormal() - original[i].GetNormal()), 1e-4f)
+        << i;
+    const Vector2f uv_error =
+        decoded.GetTexCoords() - original[i].GetTexCoords();
+    EXPECT_LE(std::max(std::abs(uv_error.x), std::abs(uv_error.y)), 0x1p-12f)
+        << i;
+    EXPECT_EQ(static_cast<uint32_t>(decoded.GetColor()),
+              static_cast<uint32_t>(original[i].GetColor()));
+  }
+  // 小网格的量化步长不受大网格范围影响
+  EXPECT_LE(streams.GetSegments()[0].scale.x, 1.0f / 65535.0f);
+}
+
+}  // namespace
+}  // namespace simple_renderer